@@ -17,6 +17,9 @@ struct VS_INPUT_MESH
     float3 Pos : ATTRIB0;
     float2 UV : ATTRIB4;
     float3 Color : ATTRIB5;
+
+    // Per-instance transformation matrices
+    INSTANCE_ATTRIBUTES
 };
 
 struct VS_OUTPUT
@@ -28,6 +31,8 @@ struct VS_OUTPUT
 
 VS_OUTPUT vs_main(VS_INPUT_MESH In)
 {
+    float4x4 World = instance_world(In);
+
     VS_OUTPUT Out;
 
     Out.Pos = mul(float4(In.Pos, 1), mul(World, ViewProj));
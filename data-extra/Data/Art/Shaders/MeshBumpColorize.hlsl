@@ -23,9 +23,12 @@ struct VS_INPUT_MESH
 {
     float3 Pos : ATTRIB0;
     float3 Normal : ATTRIB1;
-    float3 Tangent : ATTRIB2;
+    float4 Tangent : ATTRIB2; // W is the binormal's sign with compact vertices
     float3 Binormal : ATTRIB3;
     float2 UV : ATTRIB4;
+
+    // Per-instance transformation matrices
+    INSTANCE_ATTRIBUTES
 };
 
 struct VS_OUTPUT
@@ -39,6 +42,9 @@ struct VS_OUTPUT
 
 VS_OUTPUT vs_main(VS_INPUT_MESH In)
 {
+    float4x4 World = instance_world(In);
+    float4x4 WorldInv = instance_world_inv(In);
+
     float4 world_pos = mul(float4(In.Pos, 1), World);
     float3 camera_pos = camera_position();
 
@@ -46,7 +52,7 @@ VS_OUTPUT vs_main(VS_INPUT_MESH In)
     Out.Pos = mul(world_pos, ViewProj);
 
     // Store the light direction in tangent space
-    float3x3 local_to_tangent = to_tangent_matrix(In.Tangent,In.Binormal,In.Normal);
+    float3x3 local_to_tangent = to_tangent_matrix(In.Tangent.xyz, vertex_binormal(In.Normal, In.Tangent, In.Binormal), In.Normal);
     float3x3 world_to_tangent = mul((float3x3)WorldInv, local_to_tangent);
 
     float3 light0_dir = normalize(mul(-DirectionalLights[0].direction, world_to_tangent));
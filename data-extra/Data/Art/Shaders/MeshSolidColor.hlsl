@@ -10,6 +10,9 @@ cbuffer Material
 struct VS_INPUT_MESH
 {
     float3 Pos : ATTRIB0;
+
+    // Per-instance transformation matrices
+    INSTANCE_ATTRIBUTES
 };
 
 struct VS_OUTPUT
@@ -20,6 +23,8 @@ struct VS_OUTPUT
 
 VS_OUTPUT vs_main(VS_INPUT_MESH In)
 {
+    float4x4 World = instance_world(In);
+
     VS_OUTPUT Out;
     Out.Pos  = mul(float4(In.Pos, 1), mul(World, ViewProj));
     Out.Diffuse = Color;
@@ -21,6 +21,9 @@ struct VS_INPUT_MESH
     float3 Normal : ATTRIB1;
     float2 UV : ATTRIB4;
     float3 Color : ATTRIB5;
+
+    // Per-instance transformation matrices
+    INSTANCE_ATTRIBUTES
 };
 
 struct VS_OUTPUT
@@ -32,6 +35,8 @@ struct VS_OUTPUT
 
 VS_OUTPUT vs_main(VS_INPUT_MESH In)
 {
+    float4x4 World = instance_world(In);
+
     VS_OUTPUT Out;
 
     float3 world_pos = mul(float4(In.Pos,1), World).xyz;
@@ -32,9 +32,12 @@ struct VS_INPUT_MESH
 {
     float3 Pos : ATTRIB0;
     float3 Normal : ATTRIB1;
-    float3 Tangent : ATTRIB2;
+    float4 Tangent : ATTRIB2; // W is the binormal's sign with compact vertices
     float3 Binormal : ATTRIB3;
     float2 UV : ATTRIB4;
+
+    // Per-instance transformation matrices
+    INSTANCE_ATTRIBUTES
 };
 
 struct VS_OUTPUT
@@ -50,6 +53,9 @@ struct VS_OUTPUT
 
 VS_OUTPUT vs_main(VS_INPUT_MESH In)
 {
+    float4x4 World = instance_world(In);
+    float4x4 WorldInv = instance_world_inv(In);
+
     float Time = 0;
 
     float4 world_pos = mul(float4(In.Pos, 1), World);
@@ -67,7 +73,7 @@ VS_OUTPUT vs_main(VS_INPUT_MESH In)
 
     // Compute the tangent-space light vector and half-angle vector for per-pixel lighting
     // Note that we are doing everything in object space here.
-    float3x3 local_to_tangent = to_tangent_matrix(In.Tangent, In.Binormal, In.Normal);
+    float3x3 local_to_tangent = to_tangent_matrix(In.Tangent.xyz, vertex_binormal(In.Normal, In.Tangent, In.Binormal), In.Normal);
     float3x3 world_to_tangent = mul((float3x3)WorldInv, local_to_tangent);
 
     float3 light0_dir = normalize(mul(-DirectionalLights[0].direction, world_to_tangent));
@@ -1,3 +1,5 @@
+#include "vertex_format.hlsli"
+
 struct DirectionalLight
 {
     float3 direction;	// Direction the light is pointing to, in world space.
@@ -15,11 +17,28 @@ struct PointLight
     float max_distance; // in world space
 };
 
-cbuffer InstanceConstants
-{
-    float4x4 World;
-    float4x4 WorldInv;
-};
+// Note: the per-instance World and WorldInv matrices are not in a constant buffer. Meshes are
+// rendered instanced, and the renderer passes these matrices as per-instance vertex attributes
+// ATTRIB6-ATTRIB9 (World) and ATTRIB10-ATTRIB13 (WorldInv), one row per attribute.
+// Mesh shaders declare them with INSTANCE_ATTRIBUTES in their vertex input structure, and read
+// them with instance_world() and instance_world_inv(). These are macros because every shader has
+// its own vertex input structure.
+#define INSTANCE_ATTRIBUTES      \
+    float4 World0 : ATTRIB6;     \
+    float4 World1 : ATTRIB7;     \
+    float4 World2 : ATTRIB8;     \
+    float4 World3 : ATTRIB9;     \
+    float4 WorldInv0 : ATTRIB10; \
+    float4 WorldInv1 : ATTRIB11; \
+    float4 WorldInv2 : ATTRIB12; \
+    float4 WorldInv3 : ATTRIB13;
+
+// Returns the World matrix from a vertex input with INSTANCE_ATTRIBUTES
+#define instance_world(In) float4x4((In).World0, (In).World1, (In).World2, (In).World3)
+
+// Returns the WorldInv matrix from a vertex input with INSTANCE_ATTRIBUTES
+#define instance_world_inv(In) \
+    float4x4((In).WorldInv0, (In).WorldInv1, (In).WorldInv2, (In).WorldInv3)
 
 cbuffer ViewConstants
 {
@@ -90,6 +109,18 @@ float3x3 from_tangent_matrix(float3 tangent, float3 binormal, float3 normal)
     return tm;
 }
 
+// Returns a vertex's binormal from its vertex attributes.
+// The renderer defines COMPACT_VERTICES in "vertex_format.hlsli". Compact vertices don't store a
+// binormal, so it's derived from the normal and tangent, with the binormal's sign in tangent.w.
+float3 vertex_binormal(float3 normal, float4 tangent, float3 binormal)
+{
+#if COMPACT_VERTICES
+    return cross(normal, tangent.xyz) * tangent.w;
+#else
+    return binormal;
+#endif
+}
+
 // Returns a matrix that transforms vectors object space to the tangent space defined by the arguments
 float3x3 to_tangent_matrix(float3 tangent, float3 binormal, float3 normal)
 {
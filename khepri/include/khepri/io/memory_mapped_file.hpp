@@ -0,0 +1,44 @@
+#pragma once
+
+#include <gsl/gsl-lite.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace khepri::io {
+
+/**
+ * \brief A read-only, memory-mapped file
+ *
+ * The entire file is mapped into memory on construction. Its contents can then be accessed
+ * directly via #data(), without any copying or system calls.
+ */
+class MemoryMappedFile final
+{
+public:
+    /// Maps the file at \a path into memory.
+    /// \throws khepri::io::Error if the file cannot be opened or mapped.
+    explicit MemoryMappedFile(const std::filesystem::path& path);
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&)            = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    MemoryMappedFile(MemoryMappedFile&& other) noexcept;
+    MemoryMappedFile& operator=(MemoryMappedFile&& other) noexcept;
+
+    /// Returns the contents of the file
+    [[nodiscard]] gsl::span<const std::uint8_t> data() const noexcept
+    {
+        return {m_data, m_size};
+    }
+
+private:
+    void unmap() noexcept;
+
+    const std::uint8_t* m_data{nullptr};
+    std::size_t         m_size{0};
+};
+
+} // namespace khepri::io
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "stream.hpp"
+
+#include <gsl/gsl-lite.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace khepri::io {
+
+/**
+ * \brief A read-only stream over a contiguous block of memory
+ *
+ * Reading from this stream copies from memory without any system calls. Parsers that can work on
+ * contiguous memory can use #data() to access the stream's contents in-place, without copying.
+ *
+ * \note The stream does not own the memory. The caller must ensure that the memory outlives the
+ * stream.
+ */
+class SpanStream final : public Stream
+{
+public:
+    explicit SpanStream(gsl::span<const std::uint8_t> data) noexcept : m_data(data) {}
+    ~SpanStream() noexcept override = default;
+
+    SpanStream(const SpanStream&)            = delete;
+    SpanStream& operator=(const SpanStream&) = delete;
+    SpanStream(SpanStream&&)                 = delete;
+    SpanStream& operator=(SpanStream&&)      = delete;
+
+    /// \see stream::readable
+    [[nodiscard]] bool readable() const noexcept override
+    {
+        return true;
+    }
+
+    /// \see stream::writable
+    [[nodiscard]] bool writable() const noexcept override
+    {
+        return false;
+    }
+
+    /// \see stream::seekable
+    [[nodiscard]] bool seekable() const noexcept override
+    {
+        return true;
+    }
+
+    /// \see stream::read
+    std::size_t read(void* buffer, std::size_t count) override;
+
+    /// \see stream::write
+    std::size_t write(const void* buffer, std::size_t count) override;
+
+    /// \see stream::seek
+    long long seek(long long offset, SeekOrigin origin) override;
+
+    /// Returns the entire contents of the stream, regardless of the current position
+    [[nodiscard]] gsl::span<const std::uint8_t> data() const noexcept
+    {
+        return m_data;
+    }
+
+    /// Returns the current position in the stream
+    [[nodiscard]] std::size_t position() const noexcept
+    {
+        return m_position;
+    }
+
+private:
+    gsl::span<const std::uint8_t> m_data;
+    std::size_t                   m_position{0};
+};
+
+} // namespace khepri::io
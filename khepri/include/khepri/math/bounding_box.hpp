@@ -0,0 +1,112 @@
+#pragma once
+
+#include "sphere.hpp"
+#include "vector3.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace khepri {
+
+/**
+ * \brief Axis-aligned bounding box
+ */
+class BoundingBox final
+{
+public:
+    /// Constructs a box from its minimum and maximum corners
+    BoundingBox(const Vector3& min, const Vector3& max) noexcept : m_min(min), m_max(max)
+    {
+        assert(min.x <= max.x && min.y <= max.y && min.z <= max.z);
+    }
+
+    /// Constructs the smallest box that encloses \a sphere
+    explicit BoundingBox(const Sphere& sphere) noexcept
+        : m_min(sphere.center() - Vector3{sphere.radius(), sphere.radius(), sphere.radius()})
+        , m_max(sphere.center() + Vector3{sphere.radius(), sphere.radius(), sphere.radius()})
+    {
+    }
+
+    /// Returns the minimum corner of the box
+    [[nodiscard]] const Vector3& min() const noexcept
+    {
+        return m_min;
+    }
+
+    /// Returns the maximum corner of the box
+    [[nodiscard]] const Vector3& max() const noexcept
+    {
+        return m_max;
+    }
+
+    /// Returns the center of the box
+    [[nodiscard]] Vector3 center() const noexcept
+    {
+        return (m_min + m_max) * 0.5;
+    }
+
+    /// Returns the size of the box along each axis
+    [[nodiscard]] Vector3 size() const noexcept
+    {
+        return m_max - m_min;
+    }
+
+    /// Returns the surface area of the box
+    [[nodiscard]] double surface_area() const noexcept
+    {
+        const auto s = size();
+        return 2 * (s.x * s.y + s.y * s.z + s.z * s.x);
+    }
+
+    /// Checks if the point represented by \a v lies inside the box
+    [[nodiscard]] bool inside(const Vector3& v) const noexcept
+    {
+        return v.x >= m_min.x && v.y >= m_min.y && v.z >= m_min.z && v.x <= m_max.x &&
+               v.y <= m_max.y && v.z <= m_max.z;
+    }
+
+    /// Checks if \a box lies entirely inside this box
+    [[nodiscard]] bool contains(const BoundingBox& box) const noexcept
+    {
+        return inside(box.m_min) && inside(box.m_max);
+    }
+
+    /// Checks if any part of \a box intersects with this box
+    [[nodiscard]] bool intersects(const BoundingBox& box) const noexcept
+    {
+        return box.m_min.x <= m_max.x && box.m_min.y <= m_max.y && box.m_min.z <= m_max.z &&
+               box.m_max.x >= m_min.x && box.m_max.y >= m_min.y && box.m_max.z >= m_min.z;
+    }
+
+    /// Checks if any part of \a sphere intersects with this box
+    [[nodiscard]] bool intersects(const Sphere& sphere) const noexcept
+    {
+        // Find the point in the box that's closest to the sphere's center
+        const auto& c = sphere.center();
+        const Vector3 closest{std::clamp(c.x, m_min.x, m_max.x), std::clamp(c.y, m_min.y, m_max.y),
+                              std::clamp(c.z, m_min.z, m_max.z)};
+        return (closest - c).length_sq() <= sphere.radius_sq();
+    }
+
+    /// Returns a copy of this box, grown by \a margin on every side
+    [[nodiscard]] BoundingBox grow(double margin) const noexcept
+    {
+        const Vector3 offset{margin, margin, margin};
+        return {m_min - offset, m_max + offset};
+    }
+
+    /// Returns the smallest box that encloses both \a a and \a b
+    [[nodiscard]] static BoundingBox merge(const BoundingBox& a, const BoundingBox& b) noexcept
+    {
+        return {{std::min(a.m_min.x, b.m_min.x), std::min(a.m_min.y, b.m_min.y),
+                 std::min(a.m_min.z, b.m_min.z)},
+                {std::max(a.m_max.x, b.m_max.x), std::max(a.m_max.y, b.m_max.y),
+                 std::max(a.m_max.z, b.m_max.z)}};
+    }
+
+private:
+    Vector3 m_min;
+    Vector3 m_max;
+};
+
+} // namespace khepri
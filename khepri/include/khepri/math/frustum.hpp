@@ -1,5 +1,6 @@
 #pragma once
 
+#include "bounding_box.hpp"
 #include "plane.hpp"
 #include "sphere.hpp"
 #include "vector3.hpp"
@@ -75,6 +76,28 @@ public:
                above(m_near) && above(m_far);
     }
 
+    /**
+     * Checks if any part of \a box intersects with this frustum
+     *
+     * \note this test is conservative: boxes near the frustum's edges that lie outside of the
+     *       frustum, but not entirely outside any one plane, are also reported as intersecting.
+     */
+    [[nodiscard]] bool intersects(const BoundingBox& box) const noexcept
+    {
+        // Returns true if any part of the box is above the plane, by testing the corner that lies
+        // furthest along the plane's normal
+        auto above = [&box](const Plane& plane) {
+            const auto& n = plane.normal();
+            const Vector3 corner{(n.x >= 0) ? box.max().x : box.min().x,
+                                 (n.y >= 0) ? box.max().y : box.min().y,
+                                 (n.z >= 0) ? box.max().z : box.min().z};
+            return plane.signed_distance(corner) >= 0.0;
+        };
+
+        return above(m_left) && above(m_right) && above(m_top) && above(m_bottom) &&
+               above(m_near) && above(m_far);
+    }
+
     /**
      * Checks if the point represented by \a v is inside this frustum
      */
@@ -101,6 +124,25 @@ public:
                above(m_near) && above(m_far);
     }
 
+    /**
+     * Checks if \a box is entirely contained in this frustum
+     */
+    [[nodiscard]] bool inside(const BoundingBox& box) const noexcept
+    {
+        // Returns true if the whole box is above the plane, by testing the corner that lies
+        // furthest against the plane's normal
+        auto above = [&box](const Plane& plane) {
+            const auto& n = plane.normal();
+            const Vector3 corner{(n.x >= 0) ? box.min().x : box.max().x,
+                                 (n.y >= 0) ? box.min().y : box.max().y,
+                                 (n.z >= 0) ? box.min().z : box.max().z};
+            return plane.signed_distance(corner) >= 0.0;
+        };
+
+        return above(m_left) && above(m_right) && above(m_top) && above(m_bottom) &&
+               above(m_near) && above(m_far);
+    }
+
 private:
     Plane m_left, m_right;
     Plane m_bottom, m_top;
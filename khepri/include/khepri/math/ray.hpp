@@ -1,5 +1,6 @@
 #pragma once
 
+#include "bounding_box.hpp"
 #include "matrix.hpp"
 #include "quaternion.hpp"
 #include "sphere.hpp"
@@ -7,6 +8,8 @@
 
 #include <cassert>
 #include <cmath>
+#include <limits>
+#include <utility>
 
 namespace khepri {
 
@@ -84,6 +87,44 @@ public:
         return -1.0;
     }
 
+    /**
+     * \brief Find intersection distance with \a box.
+     *
+     * Returns the distance along the ray of the first intersection with the box, if any. Returns
+     * zero if the starting point is inside the box, and a negative number if there is no
+     * intersection.
+     */
+    [[nodiscard]] double intersect_distance(const BoundingBox& box) const noexcept
+    {
+        double min_distance = 0.0;
+        double max_distance = std::numeric_limits<double>::max();
+
+        // Clip the ray against the slab between the box's planes on every axis
+        const auto clip = [&](double start, double direction, double min, double max) {
+            if (direction == 0.0) {
+                // Parallel to the slab: the start must lie inside it
+                return start >= min && start <= max;
+            }
+            auto near_ = (min - start) / direction;
+            auto far_  = (max - start) / direction;
+            if (near_ > far_) {
+                std::swap(near_, far_);
+            }
+            min_distance = std::max(min_distance, near_);
+            max_distance = std::min(max_distance, far_);
+            return min_distance <= max_distance;
+        };
+
+        if (clip(m_start.x, m_direction.x, box.min().x, box.max().x) &&
+            clip(m_start.y, m_direction.y, box.min().y, box.max().y) &&
+            clip(m_start.z, m_direction.z, box.min().z, box.max().z)) {
+            return min_distance;
+        }
+
+        // No intersection
+        return -1.0;
+    }
+
 private:
     Vector3 m_start;
     Vector3 m_direction;
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "matrix.hpp"
 #include "vector3.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace khepri {
 
@@ -54,6 +57,20 @@ public:
         return {m_center, m_radius * scale};
     }
 
+    /**
+     * \brief Returns a copy of this sphere, transformed by \a transform
+     *
+     * The radius is scaled by the largest scale factor of the transformation's axes, so the
+     * resulting sphere still encloses the original after non-uniform scaling.
+     */
+    [[nodiscard]] Sphere transform(const Matrix& transform) const noexcept
+    {
+        const auto [x_axis, y_axis, z_axis] = transform.basis();
+        const auto max_scale_sq =
+            std::max({x_axis.length_sq(), y_axis.length_sq(), z_axis.length_sq()});
+        return {transform.transform_coord(m_center), m_radius * std::sqrt(max_scale_sq)};
+    }
+
 private:
     Vector3 m_center;
     double  m_radius;
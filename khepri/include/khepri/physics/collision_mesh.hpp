@@ -4,7 +4,10 @@
 #include <khepri/math/ray.hpp>
 #include <khepri/math/vector3.hpp>
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 namespace khepri::physics {
@@ -13,6 +16,9 @@ namespace khepri::physics {
  * \brief Collision mesh
  *
  * A collision mesh is an optimized data structure for collision detection.
+ *
+ * The triangles of the mesh are organized in a bounding volume hierarchy when the mesh is
+ * constructed, so queries only have to test the triangles near the queried shape.
  */
 class CollisionMesh final
 {
@@ -43,8 +49,35 @@ public:
     [[nodiscard]] bool intersect(const Frustum& frustum) const;
 
 private:
+    // Number of children of every node in the bounding volume hierarchy
+    static constexpr std::size_t NODE_WIDTH = 4;
+
+    // Value of Node::count for children that are nodes themselves
+    static constexpr std::uint32_t INNER = std::numeric_limits<std::uint32_t>::max();
+
+    // A node of the bounding volume hierarchy. The bounds of the children are stored per
+    // component, so a ray can be tested against all children at once.
+    struct Node
+    {
+        std::array<float, NODE_WIDTH> min_x{}, min_y{}, min_z{};
+        std::array<float, NODE_WIDTH> max_x{}, max_y{}, max_z{};
+
+        // For nodes, the index of the node. For leaves, the index of the first triangle.
+        std::array<std::uint32_t, NODE_WIDTH> first{};
+
+        // For leaves, the number of triangles. INNER for nodes, 0 for unused children.
+        std::array<std::uint32_t, NODE_WIDTH> count{};
+    };
+
+    // Builds the bounding volume hierarchy and orders the triangles by leaf
+    void build_hierarchy();
+
     std::vector<Vector3f> m_vertices;
     std::vector<Index>    m_indices;
+    std::vector<Node>     m_nodes; // The first node is the root
+
+    // The vertices that are not part of any triangle, so not in the hierarchy
+    std::vector<Index> m_unreferenced_vertices;
 };
 
 } // namespace khepri::physics
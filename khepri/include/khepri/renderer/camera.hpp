@@ -2,6 +2,7 @@
 
 #include <khepri/math/frustum.hpp>
 #include <khepri/math/matrix.hpp>
+#include <khepri/math/sphere.hpp>
 #include <khepri/math/vector3.hpp>
 
 #include <cstdint>
@@ -164,6 +165,16 @@ public:
      */
     [[nodiscard]] double lod(const Vector3& world_pos) const noexcept;
 
+    /**
+     * \brief Computes the projected size of a sphere in the world
+     * \param[in] sphere the world-space sphere to compute the projected size for
+     * \return the ratio of the sphere's projected diameter to the height of the viewport
+     *
+     * The result exceeds 1 if the sphere appears larger than the viewport, and is infinite if the
+     * camera is inside the sphere.
+     */
+    [[nodiscard]] double projected_size(const Sphere& sphere) const noexcept;
+
     /**
      * \brief Unprojects a 2D point on the camera surface to two 3D points.
      *
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <khepri/renderer/renderer.hpp>
+#include <khepri/renderer/vertex_format.hpp>
 
 #include <any>
+#include <cstdint>
+#include <filesystem>
 #include <memory>
 
 namespace khepri::renderer::diligent {
@@ -15,11 +18,29 @@ namespace khepri::renderer::diligent {
 class Renderer : public khepri::renderer::Renderer
 {
 public:
+    /// When the graphics pipelines of materials are created
+    enum class PipelineCreation : std::uint8_t
+    {
+        /// Pipelines are created when the material or render pipeline is created
+        immediate,
+
+        /// Pipelines are created on worker threads when the material or render pipeline is
+        /// created, and waited for when first rendered. If the backend does not support creating
+        /// pipelines on other threads, they are created immediately instead.
+        background,
+
+        /// Pipelines are created when a material is first rendered in a render pass
+        lazy,
+    };
+
     /**
      * Constructs the Diligent-based renderer.
      *
      * \param[in] window the native window to create the renderer in
      * \param[in] color_space the color space for the output buffer.
+     * \param[in] shader_cache_path directory to cache compiled shaders in between runs. If empty,
+     *                              shaders are compiled on every run.
+     * \param[in] vertex_format the format to store mesh vertices in.
      *
      * \throws khepri::ArgumentError if \a window does not contain the expected type
      * \throws khepri::renderer::Error if the renderer could not be created
@@ -32,8 +53,17 @@ public:
      * The \a color_space argument matters to determine if gamma conversion is to be performed on
      * the rendered pixels. If the color space is srgb, gamma conversion will be performed. In
      * linear mode, the shader logic has to make sure the pixels are suitably converted for display.
+     *
+     * Shaders in the cache are only used if none of their source files have changed.
+     *
+     * With the compact \a vertex_format, vertex shaders can't read the binormal attribute, but
+     * have to derive it (see #khepri::renderer::CompactVertex). To support both formats, the
+     * renderer provides a "vertex_format.hlsli" include file to shaders, which defines the
+     * COMPACT_VERTICES macro to 1 for the compact format and to 0 otherwise.
      */
-    Renderer(const std::any& window, ColorSpace color_space);
+    Renderer(const std::any& window, ColorSpace color_space,
+             const std::filesystem::path& shader_cache_path = {},
+             VertexFormat                 vertex_format     = VertexFormat::full);
     ~Renderer() override;
 
     Renderer(const Renderer&)            = delete;
@@ -49,6 +79,14 @@ public:
     /// \see #khepri::renderer::Renderer::render_size
     [[nodiscard]] Size render_size() const noexcept override;
 
+    /**
+     * Sets when the graphics pipelines of materials are created. Defaults to
+     * PipelineCreation::background.
+     *
+     * This only affects pipelines for materials and render pipelines that are created afterwards.
+     */
+    void pipeline_creation(PipelineCreation mode);
+
     /// \see #khepri::renderer::Renderer::create_shader
     std::unique_ptr<Shader> create_shader(const std::filesystem::path& path,
                                           const ShaderLoader&          loader) override;
@@ -51,6 +51,14 @@ enum TextureFormat : std::uint8_t
      * Only the first mip level is stored.
      */
     targa,
+
+    /**
+     * DirectDraw Surface.
+     *
+     * This format can only store 2D non-array textures with an RGBA8, BGRA8, BC1, BC2 or BC3
+     * pixel format. All mip levels are stored, but the color space is not.
+     */
+    dds,
 };
 
 /**
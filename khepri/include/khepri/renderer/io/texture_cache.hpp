@@ -0,0 +1,57 @@
+#pragma once
+
+#include <khepri/renderer/texture_desc.hpp>
+
+#include <gsl/gsl-lite.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace khepri::renderer::io {
+
+/**
+ * \brief Persistent cache of processed textures
+ *
+ * Processing textures (e.g. generating mips and block-compressing them) is expensive, so the
+ * results are stored as files in a directory between runs.
+ *
+ * An entry is identified by a key that describes how the texture was processed (e.g. the texture's
+ * name and the processing options). Every entry also records the size and checksum of the source
+ * texture's file data, and is only used if the source is unchanged.
+ */
+class TextureCache
+{
+public:
+    /**
+     * Creates a cache in a directory, which is created if it doesn't exist.
+     * If the directory cannot be created, the cache is disabled.
+     */
+    explicit TextureCache(std::filesystem::path directory);
+
+    /**
+     * Returns the texture of the entry with the specified key, if it exists and was created from
+     * the same source data.
+     */
+    [[nodiscard]] std::optional<TextureDesc> find(const std::string&            key,
+                                                  gsl::span<const std::uint8_t> source) const;
+
+    /**
+     * Stores a texture as the entry with the specified key, replacing any existing entry.
+     * Failure to write the entry is logged, but is not an error.
+     *
+     * \param key          the key of the entry
+     * \param source       the file data of the source texture that \a texture_desc was created from
+     * \param texture_desc the texture to store. It must be a 2D non-array texture.
+     */
+    void store(const std::string& key, gsl::span<const std::uint8_t> source,
+               const TextureDesc& texture_desc) const;
+
+private:
+    [[nodiscard]] std::filesystem::path entry_path(const std::string& key) const;
+
+    std::filesystem::path m_directory;
+};
+
+} // namespace khepri::renderer::io
@@ -1,8 +1,14 @@
 #pragma once
 
 #include "material_desc.hpp"
+#include "texture.hpp"
+
+#include <gsl/gsl-lite.hpp>
 
 #include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace khepri::renderer {
 
@@ -29,9 +35,45 @@ public:
         ParamValue value;
     };
 
+    /**
+     * \brief Material parameters, resolved for a specific material
+     *
+     * A parameter block holds the values of all of a material's properties, in the form that the
+     * renderer passes to the shaders. Resolving parameters by name is relatively expensive, so
+     * this is done once with #compile_params, after which the block can be used to render any
+     * number of instances with the material.
+     *
+     * \see #khepri::renderer::MeshInstance::material_params
+     */
+    struct ParamBlock
+    {
+        /// The material that the parameters were compiled for
+        const Material* material{nullptr};
+
+        /// Values of the non-texture properties, laid out as in the material's constant buffer
+        std::vector<std::uint8_t> constants;
+
+        /// Values of the texture properties, in order of the material's properties
+        std::vector<const Texture*> textures;
+    };
+
     Material()          = default;
     virtual ~Material() = default;
 
+    /**
+     * Resolves material parameters by name into a parameter block for this material.
+     *
+     * Properties of the material that are not specified in \a params take the material's default
+     * value. Parameters that don't match a property of the material, or whose type doesn't match
+     * the property's type, are ignored.
+     *
+     * \param[in] params the parameters to resolve
+     *
+     * \throws khepri::ArgumentError if a texture parameter holds a texture that was not created by
+     *         the same renderer as this material.
+     */
+    [[nodiscard]] virtual ParamBlock compile_params(gsl::span<const Param> params) const = 0;
+
 protected:
     Material(const Material&)            = default;
     Material(Material&&)                 = default;
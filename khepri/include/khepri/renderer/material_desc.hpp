@@ -24,10 +24,10 @@ namespace khepri::renderer {
  * (integers, floats, vectors, matrices and textures) that can be passed into a shader when
  * rendering a mesh.
  *
- * The properties in a material can be set by name in a #khepri::renderer::MeshInstance when passed
- * to the renderer. The specified (non-texture) properties are set in the shader's constant buffer
- * with name @c Material (if present). Texture properties are set on the shader's texture resource
- * with the same name directly.
+ * The properties in a material can be set by name with #khepri::renderer::Material::compile_params,
+ * and passed in a #khepri::renderer::MeshInstance to the renderer. The specified (non-texture)
+ * properties are set in the shader's constant buffer with name @c Material (if present). Texture
+ * properties are set on the shader's texture resource with the same name directly.
  *
  * @c num_directional_lights and @c num_point_lights define the number of @c{DirectionalLight} and
  * @c{PointLight} objects, respectively, passed in their cbuffers to the shadersm filled with the
@@ -37,8 +37,12 @@ struct MeshInstance
     /// The material to render this instance with
     const Material* material{nullptr};
 
-    /// Material parameters for this instance
-    gsl::span<Material::Param> material_params;
+    /**
+     * Material parameters for this instance, compiled for #material with
+     * #khepri::renderer::Material::compile_params. If null, the material's default parameters are
+     * used.
+     */
+    const Material::ParamBlock* material_params{nullptr};
 };
 
 } // namespace khepri::renderer
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "mesh_desc.hpp"
+
+#include <gsl/gsl-lite.hpp>
+
+#include <cstddef>
+
+namespace khepri::renderer {
+
+/**
+ * Merges the bitwise-identical vertices of a mesh and remaps its indices accordingly.
+ *
+ * Exporters often duplicate vertices per face. Welding them lets triangles share vertices, which
+ * is a prerequisite for an effective post-transform vertex cache.
+ *
+ * \param[in,out] mesh the mesh to weld
+ */
+void weld_vertices(MeshDesc& mesh);
+
+/**
+ * Reorders the triangles of a mesh to improve the hit rate of the GPU's post-transform vertex
+ * cache.
+ *
+ * This uses Tom Forsyth's "Linear-Speed Vertex Cache Optimisation", which does not depend on the
+ * exact cache size of the GPU.
+ *
+ * \param[in,out] mesh the mesh to optimize
+ */
+void optimize_vertex_cache(MeshDesc& mesh);
+
+/**
+ * Reorders the triangles of a vertex cache-optimized mesh to reduce overdraw.
+ *
+ * The triangles are split into clusters at the points where the vertex cache is flushed anyway,
+ * and the clusters are then sorted so that outward-facing clusters are drawn first and are likely
+ * to occlude the others. This keeps the vertex cache efficiency mostly intact.
+ *
+ * Because this changes the draw order of triangles, it should not be used on meshes that are
+ * rendered with blending.
+ *
+ * \param[in,out] mesh the mesh to optimize
+ */
+void optimize_overdraw(MeshDesc& mesh);
+
+/**
+ * Reorders the vertices of a mesh in the order that they are first referenced by its indices, to
+ * improve the locality of vertex fetches. Unreferenced vertices are removed.
+ *
+ * This does not change the order of the triangles, so it should be applied last.
+ *
+ * \param[in,out] mesh the mesh to optimize
+ */
+void optimize_vertex_fetch(MeshDesc& mesh);
+
+/**
+ * Optimizes a mesh for rendering by welding its vertices, optimizing it for the vertex cache and
+ * optionally for overdraw, and finally optimizing it for vertex fetches.
+ *
+ * \param[in,out] mesh            the mesh to optimize
+ * \param[in]     reduce_overdraw whether to also reorder triangles to reduce overdraw
+ *                                (see #optimize_overdraw)
+ */
+void optimize_mesh(MeshDesc& mesh, bool reduce_overdraw = false);
+
+/**
+ * Calculates the average cache miss ratio (ACMR) of a list of triangles: the average number of
+ * vertices per triangle that are not found in a simulated FIFO post-transform vertex cache.
+ *
+ * The result lies between 3 (every vertex is transformed for every triangle) and, for typical
+ * meshes, about 0.5 (every vertex is transformed only once).
+ *
+ * \param[in] indices    the indices of the triangles
+ * \param[in] cache_size the number of vertices in the simulated cache
+ *
+ * \return the average cache miss ratio, or 0 if there are no triangles
+ */
+double calculate_acmr(gsl::span<const MeshDesc::Index> indices, std::size_t cache_size = 16);
+
+} // namespace khepri::renderer
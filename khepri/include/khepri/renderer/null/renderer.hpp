@@ -0,0 +1,132 @@
+#pragma once
+
+#include <khepri/renderer/renderer.hpp>
+#include <khepri/renderer/vertex_format.hpp>
+
+#include <cstddef>
+#include <memory>
+
+namespace khepri::renderer::null {
+
+/**
+ * \brief Headless renderer
+ *
+ * This renderer does not render anything and does not need a GPU or a window. It performs the same
+ * CPU work as a real renderer (validation, render pass filtering, sorting, instancing and packing
+ * of constants) and counts the work that would have been submitted to the GPU instead.
+ *
+ * It can be used to run the game without a display, and to measure the CPU cost of rendering.
+ */
+class Renderer : public khepri::renderer::Renderer
+{
+public:
+    /// The work that would have been submitted to the GPU
+    struct Statistics
+    {
+        /// Number of presented frames
+        std::size_t frames{0};
+
+        /// Number of draw calls
+        std::size_t draw_calls{0};
+
+        /// Number of rendered instances (a draw call can render multiple instances)
+        std::size_t instances{0};
+
+        /// Number of rendered triangles, over all instances
+        std::size_t triangles{0};
+
+        /// Number of times the pipeline state was changed
+        std::size_t pipeline_changes{0};
+
+        /// Number of times material parameters were applied
+        std::size_t material_param_changes{0};
+
+        /// Number of times the shared vertex and index buffers were changed
+        std::size_t mesh_changes{0};
+
+        /// Number of bytes of dynamic data (constants, instances, sprites) that were uploaded
+        std::size_t bytes_uploaded{0};
+
+        /// Number of bytes of resource data (meshes, textures) that were uploaded
+        std::size_t resource_bytes_uploaded{0};
+    };
+
+    /**
+     * Constructs the headless renderer.
+     *
+     * \param[in] render_size the size of the (imaginary) rendering area
+     * \param[in] vertex_format the format that mesh vertices would be stored in. This only
+     *                          affects the number of uploaded resource bytes.
+     */
+    explicit Renderer(const Size& render_size, VertexFormat vertex_format = VertexFormat::full);
+    ~Renderer() override;
+
+    Renderer(const Renderer&)            = delete;
+    Renderer(Renderer&&)                 = delete;
+    Renderer& operator=(const Renderer&) = delete;
+    Renderer& operator=(Renderer&&)      = delete;
+
+    /**
+     * Returns the work that would have been submitted to the GPU since construction or the last
+     * call to #reset_statistics.
+     */
+    [[nodiscard]] const Statistics& statistics() const noexcept;
+
+    /**
+     * Resets all statistics to zero.
+     */
+    void reset_statistics() noexcept;
+
+    /**
+     * Set the render size for this renderer.
+     */
+    void render_size(const Size& size);
+
+    /// \see #khepri::renderer::Renderer::render_size
+    [[nodiscard]] Size render_size() const noexcept override;
+
+    /**
+     * \see #khepri::renderer::Renderer::create_shader
+     *
+     * The shader file is loaded, but not compiled.
+     */
+    std::unique_ptr<Shader> create_shader(const std::filesystem::path& path,
+                                          const ShaderLoader&          loader) override;
+
+    /// \see #khepri::renderer::Renderer::create_material
+    std::unique_ptr<Material> create_material(const MaterialDesc& material_desc) override;
+
+    /// \see #khepri::renderer::Renderer::create_texture;
+    std::unique_ptr<Texture> create_texture(const TextureDesc& texture_desc) override;
+
+    /// \see #khepri::renderer::Renderer::create_mesh
+    std::unique_ptr<Mesh> create_mesh(const MeshDesc& mesh_desc) override;
+
+    /// \see #khepri::renderer::Renderer::create_render_pipeline
+    std::unique_ptr<RenderPipeline>
+    create_render_pipeline(const RenderPipelineDesc& render_pipeline_desc) override;
+
+    /// \see #khepri::renderer::Renderer::set_dynamic_lights
+    void set_dynamic_lights(const DynamicLightDesc& light_desc) override;
+
+    /// \see #khepri::renderer::Renderer::clear
+    void clear(ClearFlags flags) override;
+
+    /// \see #khepri::renderer::Renderer::present
+    void present() override;
+
+    /// \see #khepri::renderer::Renderer::render_meshes
+    void render_meshes(const RenderPipeline& render_pipeline, gsl::span<const MeshInstance> meshes,
+                       const Camera& camera) override;
+
+    /// \see #khepri::renderer::Renderer::render_sprites
+    void render_sprites(const RenderPipeline& render_pipeline, gsl::span<const Sprite> sprites,
+                        const Material& material, gsl::span<const Material::Param> params) override;
+
+private:
+    class Impl;
+
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace khepri::renderer::null
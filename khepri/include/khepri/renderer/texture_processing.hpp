@@ -0,0 +1,90 @@
+#pragma once
+
+#include "texture_desc.hpp"
+
+#include <cstdint>
+
+namespace khepri {
+class ThreadPool;
+} // namespace khepri
+
+namespace khepri::renderer {
+
+/**
+ * Filter used to downsample mip levels
+ */
+enum class MipFilter : std::uint8_t
+{
+    /// Averages every 2x2 block of pixels. Fast, but slightly blurry.
+    box,
+
+    /// Kaiser-windowed sinc filter. Sharper than the box filter, at a higher cost.
+    kaiser,
+};
+
+/**
+ * Options for #process_texture
+ */
+struct TextureProcessOptions
+{
+    /// Generate a full mip chain for textures that only have a single mip level
+    bool generate_mips{true};
+
+    /// The filter used to generate mip levels
+    MipFilter mip_filter{MipFilter::kaiser};
+
+    /// Block-compress textures to BC1, or BC3 if the texture has transparency. Textures that look
+    /// like normal maps are left uncompressed, because BC1 is too coarse for normals.
+    bool compress{true};
+};
+
+/**
+ * Generates a full mip chain for an uncompressed 2D texture from its top-level mip.
+ *
+ * Textures in an sRGB pixel format are filtered in linear space.
+ *
+ * \param[in] texture_desc the texture to generate mips for
+ * \param[in] filter       the filter to downsample each mip level with
+ *
+ * \return the texture with the same top-level mip and pixel format, and a full mip chain
+ *
+ * \throw khepri::ArgumentError if the texture is not an uncompressed 2D texture
+ */
+TextureDesc generate_mips(const TextureDesc& texture_desc, MipFilter filter);
+
+/**
+ * Block-compresses an uncompressed 2D texture to BC1, or to BC3 if any pixel is not fully opaque.
+ *
+ * \param[in] texture_desc the texture to compress
+ * \param[in] thread_pool  optional thread pool to compress the texture with. This must not be
+ *                         called from a task in that pool.
+ *
+ * \return the compressed texture, with the same mip levels and color space
+ *
+ * \throw khepri::ArgumentError if the texture is not an uncompressed 2D texture
+ */
+TextureDesc compress_texture(const TextureDesc& texture_desc, ThreadPool* thread_pool = nullptr);
+
+/**
+ * Checks if #process_texture would change a texture with the specified options.
+ */
+bool can_process_texture(const TextureDesc& texture_desc, const TextureProcessOptions& options);
+
+/**
+ * Prepares a texture for rendering by generating mips and block-compressing it, as far as the
+ * options allow.
+ *
+ * Only uncompressed 2D textures are processed; other textures are returned as-is. Textures with a
+ * top-level size that is not a multiple of 4 are not compressed, because not all graphics APIs
+ * support that for block-compressed textures. Neither are normal maps, see
+ * TextureProcessOptions::compress.
+ *
+ * \param[in] texture_desc the texture to process
+ * \param[in] options      the processing options
+ * \param[in] thread_pool  optional thread pool to compress the texture with. This must not be
+ *                         called from a task in that pool.
+ */
+TextureDesc process_texture(const TextureDesc& texture_desc, const TextureProcessOptions& options,
+                            ThreadPool* thread_pool = nullptr);
+
+} // namespace khepri::renderer
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "mesh_desc.hpp"
+
+#include <khepri/math/vector3.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace khepri::renderer {
+
+/**
+ * \brief Format of mesh vertices in video memory
+ *
+ * Meshes are always described with #khepri::renderer::MeshDesc::Vertex, but a renderer can store
+ * their vertices in a more compact format.
+ */
+enum class VertexFormat : std::uint8_t
+{
+    /// Vertices are stored as #khepri::renderer::MeshDesc::Vertex
+    full,
+
+    /// Vertices are stored as #khepri::renderer::CompactVertex
+    compact,
+};
+
+/**
+ * \brief A quantized mesh vertex
+ *
+ * This stores a #khepri::renderer::MeshDesc::Vertex in less than half the size, at a lower
+ * precision. Positions keep full precision, but normals and tangents are stored with 8 bits per
+ * component, texture coordinates as half-precision floats and colors with 8 bits per channel.
+ *
+ * The binormal is not stored. Instead, shaders derive it from the normal and tangent as
+ * `cross(normal, tangent.xyz) * tangent.w`, where the tangent's W component holds the sign that
+ * makes the result point in the same direction as the original binormal.
+ */
+struct CompactVertex
+{
+    /// The vertex' position
+    Vector3f position;
+
+    /// The vertex' normal vector, as signed-normalized XYZ (W is 0)
+    std::array<std::int8_t, 4> normal;
+
+    /// The vertex' tangent vector, as signed-normalized XYZ, and the binormal's sign in W
+    std::array<std::int8_t, 4> tangent;
+
+    /// The vertex' texture coordinate, as half-precision floats
+    std::array<std::uint16_t, 2> uv;
+
+    /// The vertex' color, as unsigned-normalized RGBA
+    std::array<std::uint8_t, 4> color;
+};
+
+static_assert(sizeof(CompactVertex) == 28, "CompactVertex should not have padding");
+
+/**
+ * Returns the size of a vertex in video memory in the given format, in bytes.
+ */
+constexpr std::size_t vertex_size(VertexFormat format) noexcept
+{
+    return (format == VertexFormat::compact) ? sizeof(CompactVertex) : sizeof(MeshDesc::Vertex);
+}
+
+/**
+ * Converts a mesh vertex to a compact vertex.
+ *
+ * The normal and tangent are expected to be normalized.
+ */
+CompactVertex to_compact_vertex(const MeshDesc::Vertex& vertex) noexcept;
+
+} // namespace khepri::renderer
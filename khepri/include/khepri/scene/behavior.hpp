@@ -5,6 +5,8 @@ namespace khepri::scene {
 /**
  * Base class for behaviors: data containers that represent the components in an
  * entity-component-system.
+ *
+ * Behaviors are stored by value in a #khepri::scene::ComponentPool, so they must be movable.
  */
 class Behavior
 {
@@ -13,9 +15,9 @@ public:
     virtual ~Behavior() = default;
 
     Behavior(const Behavior&)            = delete;
-    Behavior(Behavior&&)                 = delete;
+    Behavior(Behavior&&)                 = default;
     Behavior& operator=(const Behavior&) = delete;
-    Behavior& operator=(Behavior&&)      = delete;
+    Behavior& operator=(Behavior&&)      = default;
 };
 
 } // namespace khepri::scene
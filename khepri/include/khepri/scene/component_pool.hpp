@@ -0,0 +1,173 @@
+#pragma once
+
+#include <gsl/gsl-lite.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace khepri::scene {
+
+namespace detail {
+inline std::size_t next_component_type_id() noexcept
+{
+    static std::atomic<std::size_t> next_id{0};
+    return next_id++;
+}
+
+/// Returns a small, unique number for a component type, to index per-type pools with
+template <typename T>
+std::size_t component_type_id() noexcept
+{
+    static const std::size_t id = next_component_type_id();
+    return id;
+}
+} // namespace detail
+
+/**
+ * \brief Type-erased base class of #khepri::scene::ComponentPool
+ */
+class ComponentPoolBase
+{
+public:
+    ComponentPoolBase()          = default;
+    virtual ~ComponentPoolBase() = default;
+
+    ComponentPoolBase(const ComponentPoolBase&)            = delete;
+    ComponentPoolBase(ComponentPoolBase&&)                 = delete;
+    ComponentPoolBase& operator=(const ComponentPoolBase&) = delete;
+    ComponentPoolBase& operator=(ComponentPoolBase&&)      = delete;
+
+    /**
+     * Removes the component of an object.
+     *
+     * \return true if the component was removed, false if the object had no component
+     */
+    virtual bool remove(std::size_t object) = 0;
+};
+
+/**
+ * \brief Stores the components of a single type for the objects in a scene
+ *
+ * The pool is a sparse set, keyed by object slot (#khepri::scene::ObjectId::index): the components
+ * are stored contiguously, in no particular order, along with the slot of the object that owns each
+ * component. This allows systems to iterate over all components of a type without touching objects
+ * that don't have one.
+ *
+ * Adding or removing components invalidates pointers and references to other components in the
+ * same pool.
+ *
+ * \tparam T the component type. It must be movable.
+ */
+template <typename T>
+class ComponentPool final : public ComponentPoolBase
+{
+public:
+    /// Returns the number of components in the pool
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_components.size();
+    }
+
+    /// Returns true if the pool has no components
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_components.empty();
+    }
+
+    /// Returns the components, in the same order as #owners()
+    [[nodiscard]] gsl::span<T> components() noexcept
+    {
+        return m_components;
+    }
+
+    /// Returns the components, in the same order as #owners()
+    [[nodiscard]] gsl::span<const T> components() const noexcept
+    {
+        return m_components;
+    }
+
+    /// Returns the slots of the objects that own the components, in the same order as
+    /// #components()
+    [[nodiscard]] gsl::span<const std::size_t> owners() const noexcept
+    {
+        return m_owners;
+    }
+
+    /// Returns the component of an object, or nullptr if it has none
+    [[nodiscard]] T* get(std::size_t object) noexcept
+    {
+        const auto index = component_index(object);
+        return (index != NONE) ? &m_components[index] : nullptr;
+    }
+
+    /// Returns the component of an object, or nullptr if it has none
+    [[nodiscard]] const T* get(std::size_t object) const noexcept
+    {
+        const auto index = component_index(object);
+        return (index != NONE) ? &m_components[index] : nullptr;
+    }
+
+    /**
+     * Constructs the component of an object, replacing any existing component.
+     *
+     * \param object the slot of the object
+     * \param args   the arguments to forward to the component's constructor
+     *
+     * \return the new component
+     */
+    template <typename... Args>
+    T& emplace(std::size_t object, Args&&... args)
+    {
+        if (const auto index = component_index(object); index != NONE) {
+            m_components[index] = T(std::forward<Args>(args)...);
+            return m_components[index];
+        }
+
+        if (object >= m_indices.size()) {
+            m_indices.resize(object + 1, NONE);
+        }
+        auto& component   = m_components.emplace_back(std::forward<Args>(args)...);
+        m_indices[object] = m_owners.size();
+        m_owners.push_back(object);
+        return component;
+    }
+
+    bool remove(std::size_t object) override
+    {
+        const auto index = component_index(object);
+        if (index == NONE) {
+            return false;
+        }
+
+        // Move the last component into the hole
+        const auto last = m_components.size() - 1;
+        if (index != last) {
+            m_components[index]        = std::move(m_components[last]);
+            m_owners[index]            = m_owners[last];
+            m_indices[m_owners[index]] = index;
+        }
+        m_components.pop_back();
+        m_owners.pop_back();
+        m_indices[object] = NONE;
+        return true;
+    }
+
+private:
+    static constexpr auto NONE = std::numeric_limits<std::size_t>::max();
+
+    [[nodiscard]] std::size_t component_index(std::size_t object) const noexcept
+    {
+        return (object < m_indices.size()) ? m_indices[object] : NONE;
+    }
+
+    std::vector<T>           m_components;
+    std::vector<std::size_t> m_owners;
+
+    // Maps object slots to indices into m_components, or NONE
+    std::vector<std::size_t> m_indices;
+};
+
+} // namespace khepri::scene
@@ -1,16 +1,60 @@
 #pragma once
 
+#include "component_pool.hpp"
 #include "scene_object.hpp"
+#include "spatial_index.hpp"
 
+#include <khepri/math/bounding_box.hpp>
+#include <khepri/math/matrix.hpp>
+#include <khepri/math/quaternion.hpp>
+#include <khepri/math/sphere.hpp>
+#include <khepri/math/vector3.hpp>
+
+#include <gsl/gsl-lite.hpp>
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <memory>
-#include <set>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace khepri::scene {
 
+template <typename BehaviorType, std::size_t NumScenes = 1, typename SceneType = Scene>
+class ObjectView;
+
+/// A read-only view of the objects with a specific behavior, see #khepri::scene::ObjectView
+template <typename BehaviorType, std::size_t NumScenes = 1>
+using ConstObjectView = ObjectView<BehaviorType, NumScenes, const Scene>;
+
 /**
  * \brief A scene
  *
  * A scene is a collection of scene objects and represents an interactive space.
+ *
+ * The scene is a slot map: every object occupies a slot, which is reused once the object is
+ * removed. Objects are identified by their slot and the slot's generation (see
+ * #khepri::scene::ObjectId), so handles to removed objects can be detected. Creating and removing
+ * objects takes constant time.
+ *
+ * The data of the objects is stored densely: their transformations are stored in separate,
+ * contiguous arrays (see e.g. #positions and #transforms), in the same order as #objects. This
+ * order only depends on the order in which objects are created and removed. Behaviors and user
+ * data are stored in a #khepri::scene::ComponentPool per type, keyed by
+ * #khepri::scene::ObjectId::index. This allows systems to iterate over e.g. all objects with a
+ * specific behavior without visiting other objects.
+ *
+ * Objects with bounds (see #khepri::scene::SceneObject::bounds) are kept in a spatial index, which
+ * is updated whenever they are transformed. This allows efficient spatial queries (see #query).
+ *
+ * A const scene only hands out #khepri::scene::ConstSceneObject handles, so it can't be modified
+ * through the objects it returns.
  */
 class Scene
 {
@@ -23,49 +67,506 @@ public:
     Scene& operator=(const Scene&)     = delete;
     Scene& operator=(Scene&&) noexcept = delete;
 
-    /// Returns the objects in the scene
-    [[nodiscard]] const auto& objects() const noexcept
+    /// Returns the objects in the scene, in the order of the scene's arrays
+    [[nodiscard]] gsl::span<const SceneObject> objects() noexcept
     {
         return m_objects;
     }
 
+    /// Returns the number of objects in the scene
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_objects.size();
+    }
+
+    /**
+     * Creates a new object in the scene, with an identity transformation and no behaviors.
+     */
+    SceneObject create_object();
+
     /**
-     * Adds an object to the scene.
+     * Removes an object and all its behaviors and user data from the scene.
+     *
+     * Does nothing if the object is not in the scene.
      *
-     * Does nothing if the object is already added.
+     * \note removing an object moves the last object in the scene's arrays into its place.
      */
-    void add_object(const std::shared_ptr<SceneObject>& object)
+    void remove_object(const SceneObject& object);
+
+    /// Returns true if the object exists in the scene
+    [[nodiscard]] bool contains(const ConstSceneObject& object) const noexcept
+    {
+        return object.scene() == this && contains(object.id());
+    }
+
+    /// Returns true if an object with the specified ID exists in the scene
+    [[nodiscard]] bool contains(ObjectId id) const noexcept
     {
-        m_objects.insert(object);
+        return id.index < m_slots.size() && m_slots[id.index].generation == id.generation &&
+               m_slots[id.index].data_index != FREE;
     }
 
     /**
-     * Removes an object from the scene.
+     * Returns the object in a slot.
      *
-     * Does nothing if the object is not in the scene.
+     * \param slot the slot of the object, e.g. from #khepri::scene::ComponentPool::owners. The slot
+     *             must be in use.
      */
-    void remove_object(const std::shared_ptr<SceneObject>& object)
+    [[nodiscard]] SceneObject object(std::size_t slot) noexcept
+    {
+        assert(slot < m_slots.size() && m_slots[slot].data_index != FREE);
+        return m_objects[m_slots[slot].data_index];
+    }
+
+    /// \copydoc object(std::size_t)
+    [[nodiscard]] ConstSceneObject object(std::size_t slot) const noexcept
     {
-        m_objects.erase(object);
+        assert(slot < m_slots.size() && m_slots[slot].data_index != FREE);
+        return m_objects[m_slots[slot].data_index];
     }
 
     /**
      * Returns all objects in the scene that have a specified behavior.
+     *
+     * This only visits the objects with the behavior, and does not allocate.
      */
     template <typename BehaviorType>
-    std::vector<std::shared_ptr<SceneObject>> objects() const
+    [[nodiscard]] ObjectView<BehaviorType> objects() noexcept;
+
+    /// \copydoc objects()
+    template <typename BehaviorType>
+    [[nodiscard]] ConstObjectView<BehaviorType> objects() const noexcept;
+
+    /// Returns the positions of the objects, in the same order as #objects
+    [[nodiscard]] gsl::span<const Vector3> positions() const noexcept
+    {
+        return m_positions;
+    }
+
+    /// Returns the scale modifiers of the objects, in the same order as #objects
+    [[nodiscard]] gsl::span<const Vector3> scales() const noexcept
+    {
+        return m_scales;
+    }
+
+    /// Returns the rotations of the objects, in the same order as #objects
+    [[nodiscard]] gsl::span<const Quaternion> rotations() const noexcept
+    {
+        return m_rotations;
+    }
+
+    /// Returns the transformation matrices of the objects, in the same order as #objects
+    [[nodiscard]] gsl::span<const Matrixf> transforms() const noexcept
+    {
+        return m_transforms;
+    }
+
+    /**
+     * Calls \a callback with every object whose bounds intersect \a shape, in no particular order.
+     *
+     * Objects without bounds are never reported. The scene must not be modified from the callback.
+     *
+     * \param shape    the shape to query. This is a #khepri::BoundingBox, #khepri::Sphere,
+     *                 #khepri::Frustum or #khepri::Ray.
+     * \param callback the function to call with every #khepri::scene::SceneObject
+     */
+    template <typename Shape, typename Callback>
+    void query(const Shape& shape, Callback&& callback)
+    {
+        m_spatial_index.query(shape, [&](std::uint32_t slot) { callback(object(slot)); });
+    }
+
+    /// \copydoc query(const Shape&, Callback&&)
+    /// The callback is called with a #khepri::scene::ConstSceneObject instead.
+    template <typename Shape, typename Callback>
+    void query(const Shape& shape, Callback&& callback) const
     {
-        std::vector<std::shared_ptr<SceneObject>> result;
-        for (const auto& object : m_objects) {
-            if (object->behavior<BehaviorType>()) {
-                result.push_back(object);
+        m_spatial_index.query(shape, [&](std::uint32_t slot) { callback(object(slot)); });
+    }
+
+    /**
+     * Returns the behaviors of a type of all objects in the scene.
+     *
+     * \return the pool of behaviors, or nullptr if no behavior of this type was ever created in the
+     *         scene.
+     */
+    template <typename BehaviorType>
+    [[nodiscard]] const ComponentPool<BehaviorType>* behaviors() const noexcept
+    {
+        return find_pool<BehaviorType>(m_behaviors);
+    }
+
+    /// \copydoc behaviors() const
+    template <typename BehaviorType>
+    [[nodiscard]] ComponentPool<BehaviorType>* behaviors() noexcept
+    {
+        return find_pool<BehaviorType>(m_behaviors);
+    }
+
+    /**
+     * Returns the user data of a type of all objects in the scene.
+     *
+     * User data is not part of the state of the scene (e.g. it's used to cache state for systems),
+     * so it can be modified in a const scene.
+     */
+    template <typename DataType>
+    [[nodiscard]] ComponentPool<DataType>& user_data() const
+    {
+        return get_or_create_pool<DataType>(m_user_data);
+    }
+
+private:
+    friend class SceneObject;
+
+    using Pools = std::vector<std::unique_ptr<ComponentPoolBase>>;
+
+    // Marks a slot that's not in use
+    static constexpr auto FREE = std::numeric_limits<std::uint32_t>::max();
+
+    struct Slot
+    {
+        // Index of the object's data in the arrays, or FREE
+        std::uint32_t data_index;
+
+        // Incremented every time the slot is freed
+        std::uint32_t generation;
+    };
+
+    template <typename T>
+    static ComponentPool<T>* find_pool(const Pools& pools) noexcept
+    {
+        const auto id = detail::component_type_id<T>();
+        return (id < pools.size()) ? static_cast<ComponentPool<T>*>(pools[id].get()) : nullptr;
+    }
+
+    template <typename T>
+    static ComponentPool<T>& get_or_create_pool(Pools& pools)
+    {
+        const auto id = detail::component_type_id<T>();
+        if (id >= pools.size()) {
+            pools.resize(id + 1);
+        }
+        if (!pools[id]) {
+            pools[id] = std::make_unique<ComponentPool<T>>();
+        }
+        return static_cast<ComponentPool<T>&>(*pools[id]);
+    }
+
+    void update_transform(std::size_t index)
+    {
+        m_transforms[index] = Matrixf::create_srt(Vector3f{m_scales[index]},
+                                                  Quaternionf{m_rotations[index]},
+                                                  Vector3f{m_positions[index]});
+        if (m_index_entries[index] != SpatialIndex::NONE) {
+            m_spatial_index.update(m_index_entries[index], world_bounds(index));
+        }
+    }
+
+    // Returns the bounds of an object with bounds, in the scene
+    [[nodiscard]] BoundingBox world_bounds(std::size_t index) const noexcept
+    {
+        assert(m_bounds[index]);
+        return BoundingBox(m_bounds[index]->transform(Matrix{m_transforms[index]}));
+    }
+
+    void set_bounds(std::size_t index, const std::optional<Sphere>& bounds);
+
+    std::vector<Slot> m_slots;
+
+    // The slots that are not in use. Reused in LIFO order.
+    std::vector<std::uint32_t> m_free_slots;
+
+    // The objects and their transformations, densely packed
+    std::vector<SceneObject> m_objects;
+    std::vector<Vector3>     m_positions;
+    std::vector<Vector3>     m_scales;
+    std::vector<Quaternion>  m_rotations;
+    std::vector<Matrixf>     m_transforms;
+
+    // The bounds of the objects, in object space, and their entries in the spatial index
+    std::vector<std::optional<Sphere>> m_bounds;
+    std::vector<SpatialIndex::EntryId> m_index_entries;
+    SpatialIndex                       m_spatial_index;
+
+    // Component pools, indexed by component type ID
+    Pools         m_behaviors;
+    mutable Pools m_user_data;
+};
+
+/**
+ * \brief A view of the objects with a specific behavior in one or more scenes
+ *
+ * The view iterates over the behavior's #khepri::scene::ComponentPool of every scene in turn, so
+ * it only visits the objects that have the behavior. Its iterators yield
+ * #khepri::scene::SceneObject handles by value, or #khepri::scene::ConstSceneObject handles for a
+ * view of const scenes (see #khepri::scene::ConstObjectView).
+ *
+ * The view and its iterators are invalidated when a behavior of this type is created or removed
+ * in one of the scenes, or when an object is removed from one of the scenes.
+ *
+ * \tparam BehaviorType the behavior type
+ * \tparam NumScenes    the number of scenes to view
+ * \tparam SceneType    the type of the scenes, @c Scene or @c const Scene
+ */
+template <typename BehaviorType, std::size_t NumScenes, typename SceneType>
+class ObjectView
+{
+    using Object = std::conditional_t<std::is_const_v<SceneType>, ConstSceneObject, SceneObject>;
+
+    struct Segment
+    {
+        SceneType*                   scene{nullptr};
+        gsl::span<const std::size_t> owners;
+    };
+
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Object;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = Object;
+
+        iterator() noexcept = default;
+
+        Object operator*() const noexcept
+        {
+            const auto& segment = (*m_segments)[m_segment];
+            return segment.scene->object(segment.owners[m_index]);
+        }
+
+        iterator& operator++() noexcept
+        {
+            ++m_index;
+            skip_empty_segments();
+            return *this;
+        }
+
+        iterator operator++(int) noexcept
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs) noexcept
+        {
+            return lhs.m_segment == rhs.m_segment && lhs.m_index == rhs.m_index;
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class ObjectView;
+
+        iterator(const std::array<Segment, NumScenes>& segments, std::size_t segment) noexcept
+            : m_segments(&segments), m_segment(segment)
+        {
+            skip_empty_segments();
+        }
+
+        void skip_empty_segments() noexcept
+        {
+            while (m_segment < NumScenes && m_index >= (*m_segments)[m_segment].owners.size()) {
+                ++m_segment;
+                m_index = 0;
             }
         }
-        return result;
+
+        const std::array<Segment, NumScenes>* m_segments{nullptr};
+        std::size_t                           m_segment{NumScenes};
+        std::size_t                           m_index{0};
+    };
+
+    /**
+     * Constructs a view of the objects with a behavior in a list of scenes.
+     *
+     * \param scenes the scenes to view, in the order in which their objects are visited
+     */
+    explicit ObjectView(const std::array<SceneType*, NumScenes>& scenes) noexcept
+    {
+        for (std::size_t i = 0; i < NumScenes; ++i) {
+            m_segments[i].scene = scenes[i];
+            if (const auto* pool = scenes[i]->template behaviors<BehaviorType>()) {
+                m_segments[i].owners = pool->owners();
+            }
+        }
+    }
+
+    [[nodiscard]] iterator begin() const noexcept
+    {
+        return {m_segments, 0};
+    }
+
+    [[nodiscard]] iterator end() const noexcept
+    {
+        return {m_segments, NumScenes};
+    }
+
+    /// Returns the number of objects in the view
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        std::size_t size = 0;
+        for (const auto& segment : m_segments) {
+            size += segment.owners.size();
+        }
+        return size;
+    }
+
+    /// Returns true if the view has no objects
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size() == 0;
     }
 
 private:
-    std::set<std::shared_ptr<SceneObject>> m_objects;
+    std::array<Segment, NumScenes> m_segments;
 };
 
+template <typename BehaviorType>
+ObjectView<BehaviorType> Scene::objects() noexcept
+{
+    return ObjectView<BehaviorType>({this});
+}
+
+template <typename BehaviorType>
+ConstObjectView<BehaviorType> Scene::objects() const noexcept
+{
+    return ConstObjectView<BehaviorType>({this});
+}
+
+inline bool SceneObject::valid() const noexcept
+{
+    return m_scene != nullptr && m_scene->contains(m_id);
+}
+
+inline std::size_t SceneObject::data_index() const noexcept
+{
+    assert(valid());
+    return m_scene->m_slots[m_id.index].data_index;
+}
+
+inline const Vector3& SceneObject::position() const noexcept
+{
+    return m_scene->m_positions[data_index()];
+}
+
+inline const Vector3& SceneObject::scale() const noexcept
+{
+    return m_scene->m_scales[data_index()];
+}
+
+inline const Quaternion& SceneObject::rotation() const noexcept
+{
+    return m_scene->m_rotations[data_index()];
+}
+
+inline const Matrixf& SceneObject::transform() const noexcept
+{
+    return m_scene->m_transforms[data_index()];
+}
+
+inline void SceneObject::position(const Vector3& position)
+{
+    const auto index            = data_index();
+    m_scene->m_positions[index] = position;
+    m_scene->update_transform(index);
+}
+
+inline void SceneObject::scale(const Vector3& scale)
+{
+    const auto index         = data_index();
+    m_scene->m_scales[index] = scale;
+    m_scene->update_transform(index);
+}
+
+inline void SceneObject::rotation(const Quaternion& rotation)
+{
+    const auto index            = data_index();
+    m_scene->m_rotations[index] = rotation;
+    m_scene->update_transform(index);
+}
+
+inline const std::optional<Sphere>& SceneObject::bounds() const noexcept
+{
+    return m_scene->m_bounds[data_index()];
+}
+
+inline std::optional<BoundingBox> SceneObject::world_bounds() const noexcept
+{
+    const auto index = data_index();
+    if (!m_scene->m_bounds[index]) {
+        return {};
+    }
+    return m_scene->world_bounds(index);
+}
+
+inline void SceneObject::bounds(const std::optional<Sphere>& bounds)
+{
+    m_scene->set_bounds(data_index(), bounds);
+}
+
+template <typename Behavior>
+const Behavior* SceneObject::behavior() const noexcept
+{
+    assert(valid());
+    const auto* pool = Scene::find_pool<Behavior>(m_scene->m_behaviors);
+    return (pool != nullptr) ? pool->get(m_id.index) : nullptr;
+}
+
+template <typename Behavior>
+Behavior* SceneObject::behavior() noexcept
+{
+    assert(valid());
+    auto* pool = Scene::find_pool<Behavior>(m_scene->m_behaviors);
+    return (pool != nullptr) ? pool->get(m_id.index) : nullptr;
+}
+
+template <typename Behavior, typename... Args>
+Behavior& SceneObject::create_behavior(Args&&... args)
+{
+    static_assert(std::is_base_of_v<khepri::scene::Behavior, Behavior>,
+                  "behaviors must derive from khepri::scene::Behavior");
+    assert(valid());
+    return Scene::get_or_create_pool<Behavior>(m_scene->m_behaviors)
+        .emplace(m_id.index, std::forward<Args>(args)...);
+}
+
+template <typename Behavior>
+bool SceneObject::remove_behavior()
+{
+    assert(valid());
+    auto* pool = Scene::find_pool<Behavior>(m_scene->m_behaviors);
+    return (pool != nullptr) && pool->remove(m_id.index);
+}
+
+template <typename DataType>
+const DataType* SceneObject::user_data() const
+{
+    assert(valid());
+    const auto* pool = Scene::find_pool<DataType>(m_scene->m_user_data);
+    return (pool != nullptr) ? pool->get(m_id.index) : nullptr;
+}
+
+template <typename DataType>
+DataType* SceneObject::user_data()
+{
+    assert(valid());
+    auto* pool = Scene::find_pool<DataType>(m_scene->m_user_data);
+    return (pool != nullptr) ? pool->get(m_id.index) : nullptr;
+}
+
+template <typename DataType>
+void SceneObject::user_data(DataType&& data_type)
+{
+    assert(valid());
+    Scene::get_or_create_pool<std::decay_t<DataType>>(m_scene->m_user_data)
+        .emplace(m_id.index, std::forward<DataType>(data_type));
+}
+
 } // namespace khepri::scene
@@ -2,173 +2,284 @@
 
 #include "behavior.hpp"
 
+#include <khepri/math/bounding_box.hpp>
 #include <khepri/math/matrix.hpp>
 #include <khepri/math/quaternion.hpp>
+#include <khepri/math/sphere.hpp>
 #include <khepri/math/vector3.hpp>
 
-#include <any>
-#include <memory>
-#include <typeindex>
-#include <typeinfo>
-#include <unordered_map>
-#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 
 namespace khepri::scene {
 
+class Scene;
+
+/**
+ * \brief Identifies an object in a #khepri::scene::Scene
+ *
+ * The index identifies the object's slot in the scene. Slots are reused when objects are removed,
+ * so the generation tells apart the objects that used the same slot over time.
+ */
+struct ObjectId
+{
+    /// The slot of the object in the scene
+    std::uint32_t index{0};
+
+    /// The generation of the slot when the object was created
+    std::uint32_t generation{0};
+};
+
+inline bool operator==(const ObjectId& lhs, const ObjectId& rhs) noexcept
+{
+    return lhs.index == rhs.index && lhs.generation == rhs.generation;
+}
+
+inline bool operator!=(const ObjectId& lhs, const ObjectId& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
 /**
  * Represents an object in a #khepri::scene::Scene.
  *
  * A @c SceneObject has positional information and a list of behaviors. The behaviors implement the
  * components of the entity-component-system.
+ *
+ * The object itself is a lightweight handle: its data is stored by the scene, together with the
+ * data of the other objects in the scene (see #khepri::scene::Scene). Objects are created with
+ * #khepri::scene::Scene::create_object. Handles can be freely copied. Once the object is removed
+ * from its scene, #valid returns false for all its handles; other members must only be called on
+ * valid handles.
+ *
+ * A const scene hands out #khepri::scene::ConstSceneObject handles instead, which can't modify the
+ * object.
  */
 class SceneObject
 {
 public:
-    SceneObject()          = default;
-    virtual ~SceneObject() = default;
-
-    SceneObject(const SceneObject&)            = delete;
-    SceneObject(SceneObject&&)                 = delete;
-    SceneObject& operator=(const SceneObject&) = delete;
-    SceneObject& operator=(SceneObject&&)      = delete;
+    /// Constructs a handle that refers to no object
+    SceneObject() noexcept = default;
 
-    /// Returns the position of the object in the scene
-    const auto& position() const noexcept
+    /// Returns the scene that the object was created in, or nullptr if the handle refers to no
+    /// object
+    [[nodiscard]] Scene* scene() const noexcept
     {
-        return m_position;
+        return m_scene;
     }
 
-    /// Returns the scale modifier of the object
-    const auto& scale() const noexcept
+    /// Returns the ID of the object in its scene
+    [[nodiscard]] ObjectId id() const noexcept
     {
-        return m_scale;
+        return m_id;
     }
 
+    /// Returns true if the object still exists in its scene
+    [[nodiscard]] bool valid() const noexcept;
+
+    /// Returns the position of the object in the scene
+    [[nodiscard]] const Vector3& position() const noexcept;
+
+    /// Returns the scale modifier of the object
+    [[nodiscard]] const Vector3& scale() const noexcept;
+
     /// Returns the rotation of the object in the scene
-    const auto& rotation() const noexcept
-    {
-        return m_rotation;
-    }
+    [[nodiscard]] const Quaternion& rotation() const noexcept;
 
     /// Returns a transformation matrix for the object's position, scale and rotation.
-    const auto& transform() const noexcept
-    {
-        return m_transform;
-    }
+    [[nodiscard]] const Matrixf& transform() const noexcept;
 
     /// Sets the position of the object in the scene
     /// \param position the new position
-    void position(const Vector3& position) noexcept
-    {
-        m_position = position;
-        update_transform();
-    }
+    void position(const Vector3& position);
 
     /// Sets the scale modifier the object
     /// \param scale the new scale modifier
-    void scale(const Vector3& scale) noexcept
-    {
-        m_scale = scale;
-        update_transform();
-    }
+    void scale(const Vector3& scale);
 
     /// Sets the rotation of the object
     /// \param rotation the new rotation
-    void rotation(const Quaternion& rotation) noexcept
-    {
-        m_rotation = rotation;
-        update_transform();
-    }
+    void rotation(const Quaternion& rotation);
+
+    /// Returns the bounds of the object in object space, if any
+    [[nodiscard]] const std::optional<Sphere>& bounds() const noexcept;
+
+    /// Returns the bounds of the object in the scene, if it has bounds
+    [[nodiscard]] std::optional<BoundingBox> world_bounds() const noexcept;
+
+    /// Sets the bounds of the object in object space. Only objects with bounds are found by the
+    /// scene's spatial queries (see #khepri::scene::Scene::query).
+    /// \param bounds the new bounds, or std::nullopt to remove the bounds
+    void bounds(const std::optional<Sphere>& bounds);
 
     /// Gets a behavior from the object
     /// \tparam Behavior the type of the behavior to retrieve
     /// \return the behavior, or null if the behavior does not exist
     template <typename Behavior>
-    const Behavior* behavior() const noexcept
-    {
-        return static_cast<const Behavior*>(behavior(typeid(Behavior)));
-    }
+    const Behavior* behavior() const noexcept;
 
     /// Gets a behavior from the object
     /// \tparam Behavior the type of the behavior to retrieve
     /// \return the behavior, or null if the behavior does not exist
     template <typename Behavior>
-    Behavior* behavior() noexcept
-    {
-        return static_cast<Behavior*>(behavior(typeid(Behavior)));
-    }
+    Behavior* behavior() noexcept;
 
-    /// Creates and adds a behavior on the object
+    /// Creates and adds a behavior on the object, replacing any existing behavior of that type.
+    /// Behaviors are stored by the scene per type; creating or removing a behavior invalidates
+    /// references to other behaviors of the same type.
     /// \tparam Behavior the type of the behavior to create
     /// \param args the arguments to forward to the behavior's constructor
     /// \return the new behavior
     template <typename Behavior, typename... Args>
-    Behavior& create_behavior(Args&&... args)
-    {
-        return static_cast<Behavior&>(add_behavior(
-            typeid(Behavior), std::make_unique<Behavior>(std::forward<Args>(args)...)));
-    }
+    Behavior& create_behavior(Args&&... args);
 
     /// Removes a behavior from the object
     /// \tparam Behavior the type of the behavior to create
     /// \return true if the behavior was removed, false otherwise
     template <typename Behavior>
-    bool remove_behavior()
-    {
-        return remove_behavior(typeid(Behavior));
-    }
+    bool remove_behavior();
 
     /// Retrieves user data from the object.
     /// \tparam DataType the type of the user data to retrieve.
     /// \return the user data, or nullptr if no such user data was attached.
     template <typename DataType>
-    const DataType* user_data() const
-    {
-        return std::any_cast<DataType>(user_data_typeless(typeid(DataType)));
-    }
+    const DataType* user_data() const;
 
     /// Retrieves user data from the object.
     /// \tparam DataType the type of the user data to retrieve.
     /// \return the user data, or nullptr if no such user data was attached.
     template <typename DataType>
-    DataType* user_data()
-    {
-        return std::any_cast<DataType>(user_data_typeless(typeid(DataType)));
-    }
+    DataType* user_data();
 
     /// Sets user data on the object
     /// \param data_type the user data to set on the object
     template <typename DataType>
-    void user_data(DataType&& data_type)
+    void user_data(DataType&& data_type);
+
+private:
+    friend class Scene;
+
+    SceneObject(Scene& scene, ObjectId id) noexcept : m_scene(&scene), m_id(id) {}
+
+    // Returns the index of the object's data in the scene's arrays
+    [[nodiscard]] std::size_t data_index() const noexcept;
+
+    Scene*   m_scene{nullptr};
+    ObjectId m_id;
+};
+
+inline bool operator==(const SceneObject& lhs, const SceneObject& rhs) noexcept
+{
+    return lhs.scene() == rhs.scene() && lhs.id() == rhs.id();
+}
+
+inline bool operator!=(const SceneObject& lhs, const SceneObject& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+/**
+ * A read-only handle to an object in a #khepri::scene::Scene.
+ *
+ * This is the handle that a const scene hands out, so that the scene can't be modified through
+ * it. It offers the same accessors as #khepri::scene::SceneObject, but none of its modifiers. Every
+ * @c SceneObject converts to a @c ConstSceneObject.
+ */
+class ConstSceneObject
+{
+public:
+    /// Constructs a handle that refers to no object
+    ConstSceneObject() noexcept = default;
+
+    /// Constructs a read-only handle to the same object as \a object
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    ConstSceneObject(const SceneObject& object) noexcept : m_object(object) {}
+
+    /// \copydoc SceneObject::scene
+    [[nodiscard]] const Scene* scene() const noexcept
     {
-        user_data_typeless(typeid(DataType),
-                           std::make_any<DataType>(std::forward<DataType>(data_type)));
+        return m_object.scene();
     }
 
-private:
-    void update_transform() noexcept
+    /// \copydoc SceneObject::id
+    [[nodiscard]] ObjectId id() const noexcept
+    {
+        return m_object.id();
+    }
+
+    /// \copydoc SceneObject::valid
+    [[nodiscard]] bool valid() const noexcept
+    {
+        return m_object.valid();
+    }
+
+    /// \copydoc SceneObject::position() const
+    [[nodiscard]] const Vector3& position() const noexcept
+    {
+        return m_object.position();
+    }
+
+    /// \copydoc SceneObject::scale() const
+    [[nodiscard]] const Vector3& scale() const noexcept
     {
-        m_transform =
-            Matrixf::create_srt(Vector3f{m_scale}, Quaternionf{m_rotation}, Vector3f{m_position});
+        return m_object.scale();
     }
 
-    const class Behavior* behavior(std::type_index index) const noexcept;
-    class Behavior*       behavior(std::type_index index) noexcept;
-    class Behavior&       add_behavior(std::type_index index, std::unique_ptr<Behavior> behavior);
-    bool                  remove_behavior(std::type_index index);
+    /// \copydoc SceneObject::rotation() const
+    [[nodiscard]] const Quaternion& rotation() const noexcept
+    {
+        return m_object.rotation();
+    }
 
-    std::any*       user_data_typeless(std::type_index index);
-    const std::any* user_data_typeless(std::type_index index) const;
-    void            user_data_typeless(std::type_index index, std::any data);
+    /// \copydoc SceneObject::transform
+    [[nodiscard]] const Matrixf& transform() const noexcept
+    {
+        return m_object.transform();
+    }
 
-    Vector3    m_position{0, 0, 0};
-    Vector3    m_scale{1, 1, 1};
-    Quaternion m_rotation  = Quaternion::IDENTITY;
-    Matrixf    m_transform = Matrixf::IDENTITY;
+    /// \copydoc SceneObject::bounds() const
+    [[nodiscard]] const std::optional<Sphere>& bounds() const noexcept
+    {
+        return m_object.bounds();
+    }
 
-    std::unordered_map<std::type_index, std::unique_ptr<Behavior>> m_behaviors;
+    /// \copydoc SceneObject::world_bounds
+    [[nodiscard]] std::optional<BoundingBox> world_bounds() const noexcept
+    {
+        return m_object.world_bounds();
+    }
 
-    mutable std::unordered_map<std::type_index, std::any> m_userdata;
+    /// \copydoc SceneObject::behavior() const
+    template <typename Behavior>
+    const Behavior* behavior() const noexcept
+    {
+        return m_object.behavior<Behavior>();
+    }
+
+    /// \copydoc SceneObject::user_data() const
+    template <typename DataType>
+    const DataType* user_data() const
+    {
+        return m_object.user_data<DataType>();
+    }
+
+private:
+    // Only the const members of the handle are ever called
+    SceneObject m_object;
 };
 
+inline bool operator==(const ConstSceneObject& lhs, const ConstSceneObject& rhs) noexcept
+{
+    return lhs.scene() == rhs.scene() && lhs.id() == rhs.id();
+}
+
+inline bool operator!=(const ConstSceneObject& lhs, const ConstSceneObject& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
 } // namespace khepri::scene
+
+// The inline members of SceneObject are defined along with the Scene that stores its data
+#include "scene.hpp"
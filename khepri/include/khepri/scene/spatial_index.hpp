@@ -0,0 +1,185 @@
+#pragma once
+
+#include <khepri/math/bounding_box.hpp>
+#include <khepri/math/frustum.hpp>
+#include <khepri/math/ray.hpp>
+#include <khepri/math/sphere.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace khepri::scene {
+
+/**
+ * \brief Spatial index of axis-aligned bounding boxes
+ *
+ * The index is a dynamic bounding volume hierarchy: a binary tree whose leaves are the entries and
+ * whose internal nodes enclose their children. Entries are inserted next to the node that grows
+ * the tree's surface area the least, and the tree is rebalanced with rotations, so queries take
+ * logarithmic time in the number of entries.
+ *
+ * Every leaf stores an enlarged ("fat") copy of the entry's bounds, so entries that move a little
+ * don't have to be moved in the tree. Queries still test entries against their exact bounds.
+ */
+class SpatialIndex final
+{
+public:
+    /// Identifies an entry in the index
+    using EntryId = std::int32_t;
+
+    /// An invalid entry ID
+    static constexpr EntryId NONE = -1;
+
+    /**
+     * Inserts an entry into the index.
+     *
+     * \param bounds the bounds of the entry
+     * \param value  the value that queries report for the entry
+     *
+     * \return the ID of the new entry
+     */
+    EntryId insert(const BoundingBox& bounds, std::uint32_t value);
+
+    /// Removes an entry from the index
+    void remove(EntryId entry);
+
+    /**
+     * Changes the bounds of an entry.
+     *
+     * \return true if the entry was moved in the tree, false if its enlarged bounds still enclose
+     *         the new bounds.
+     */
+    bool update(EntryId entry, const BoundingBox& bounds);
+
+    /// Returns the number of entries in the index
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    /// Returns the height of the tree; a tree with a single entry has height 0
+    [[nodiscard]] int height() const noexcept
+    {
+        return (m_root != NONE) ? m_nodes[m_root].height : 0;
+    }
+
+    /// Calls \a callback with the value of every entry that intersects \a box
+    template <typename Callback>
+    void query(const BoundingBox& box, Callback&& callback) const
+    {
+        traverse([&](const BoundingBox& bounds) { return bounds.intersects(box); }, callback);
+    }
+
+    /// Calls \a callback with the value of every entry that intersects \a sphere
+    template <typename Callback>
+    void query(const Sphere& sphere, Callback&& callback) const
+    {
+        traverse([&](const BoundingBox& bounds) { return bounds.intersects(sphere); }, callback);
+    }
+
+    /// Calls \a callback with the value of every entry that intersects \a frustum
+    template <typename Callback>
+    void query(const Frustum& frustum, Callback&& callback) const
+    {
+        traverse([&](const BoundingBox& bounds) { return frustum.intersects(bounds); }, callback);
+    }
+
+    /// Calls \a callback with the value of every entry that is hit by \a ray
+    template <typename Callback>
+    void query(const Ray& ray, Callback&& callback) const
+    {
+        traverse([&](const BoundingBox& bounds) { return ray.intersect_distance(bounds) >= 0; },
+                 callback);
+    }
+
+private:
+    // Entries up to this depth are traversed without allocating
+    static constexpr std::size_t STACK_SIZE = 64;
+
+    // Vectors are packed, so align the nodes to keep the bounds' components aligned in m_nodes
+    struct alignas(8) Node
+    {
+        // The bounds of the subtree. For leaves, the enlarged bounds of the entry.
+        BoundingBox box{{0, 0, 0}, {0, 0, 0}};
+
+        // For leaves, the exact bounds of the entry
+        BoundingBox bounds{{0, 0, 0}, {0, 0, 0}};
+
+        // The parent node, or the next free node for nodes that are not in use
+        EntryId parent{NONE};
+
+        EntryId child1{NONE};
+        EntryId child2{NONE};
+
+        // The height of the subtree: 0 for leaves, -1 for nodes that are not in use
+        std::int32_t height{-1};
+
+        std::uint32_t value{0};
+
+        [[nodiscard]] bool leaf() const noexcept
+        {
+            return child1 == NONE;
+        }
+    };
+
+    template <typename Test, typename Callback>
+    void traverse(const Test& test, Callback& callback) const
+    {
+        if (m_root == NONE) {
+            return;
+        }
+
+        // Depth-first traversal. The overflow stack is only used for very deep trees.
+        std::array<EntryId, STACK_SIZE> stack{};
+        std::size_t                     stack_size = 0;
+        std::vector<EntryId>            overflow;
+
+        const auto push = [&](EntryId node) {
+            if (stack_size < STACK_SIZE) {
+                stack[stack_size++] = node;
+            } else {
+                overflow.push_back(node);
+            }
+        };
+
+        push(m_root);
+        while (stack_size > 0) {
+            EntryId index = NONE;
+            if (!overflow.empty()) {
+                index = overflow.back();
+                overflow.pop_back();
+            } else {
+                index = stack[--stack_size];
+            }
+
+            const auto& node = m_nodes[index];
+            if (!test(node.box)) {
+                continue;
+            }
+            if (node.leaf()) {
+                if (test(node.bounds)) {
+                    callback(node.value);
+                }
+            } else {
+                push(node.child1);
+                push(node.child2);
+            }
+        }
+    }
+
+    EntryId allocate_node();
+    void    free_node(EntryId node);
+    void    insert_leaf(EntryId leaf);
+    void    remove_leaf(EntryId leaf);
+    void    refit(EntryId node);
+    EntryId balance(EntryId node);
+
+    std::vector<Node> m_nodes;
+    EntryId           m_root{NONE};
+    EntryId           m_free_list{NONE};
+    std::size_t       m_size{0};
+};
+
+} // namespace khepri::scene
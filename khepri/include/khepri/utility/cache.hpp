@@ -2,11 +2,18 @@
 
 #include "string.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
 #include <functional>
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 
 namespace khepri {
 
@@ -85,4 +92,219 @@ private:
     std::map<Key, std::unique_ptr<Value>, CaseInsensitiveLess> m_items;
 };
 
+/**
+ * \brief Thread-safe cache that owns the cached items.
+ *
+ * This cache behaves like #OwningCache, but can be used from multiple threads concurrently. Cached
+ * objects are handed out as shared pointers, so that one thread can erase an object while another
+ * thread is still using it.
+ *
+ * Items are distributed over a number of shards, each with its own lock, to reduce contention.
+ * The loader is called without holding any lock. Concurrent requests for an item that is being
+ * loaded wait for that load to finish, rather than loading the item again.
+ *
+ * \tparam Value the type of object being cached. This cache owns the objects.
+ * \tparam Key the type of key used to identify the object.
+ * \tparam KeyView a non-owning view of the Key type for lookups.
+ * \tparam Hash the hash function for keys.
+ * \tparam KeyEqual the equality comparator for keys.
+ */
+template <typename Value, typename Key = std::string, typename KeyView = std::string_view,
+          typename Hash = CaseInsensitiveHash, typename KeyEqual = CaseInsensitiveEqual>
+class ConcurrentOwningCache final
+{
+public:
+    /// Callback type for loading items on-demand
+    using Loader = std::function<std::unique_ptr<Value>(const KeyView&)>;
+
+    /// The default number of shards
+    static constexpr std::size_t DEFAULT_NUM_SHARDS = 16;
+
+    /**
+     * Constructs the cache.
+     *
+     * \param item_loader the callback used to load items on-demand.
+     * \param num_shards the number of independently locked shards.
+     *
+     * \note the cache takes ownership of loaded items
+     * \note the loader can be called from any thread that calls #get.
+     */
+    explicit ConcurrentOwningCache(Loader item_loader, std::size_t num_shards = DEFAULT_NUM_SHARDS)
+        : m_item_loader(std::move(item_loader))
+        , m_num_shards(std::max<std::size_t>(num_shards, 1))
+        , m_shards(std::make_unique<Shard[]>(m_num_shards))
+    {
+    }
+
+    /**
+     * Returns a callable that returns the same thing as calling #get on this cache
+     */
+    auto as_loader()
+    {
+        return [this](std::string_view id) { return this->get(id); };
+    }
+
+    /**
+     * Finds or loads an object with the specified id.
+     *
+     * If the object does not exist in this cache, the cache's loader is called on the calling
+     * thread and the result is cached. If another thread is already loading the object, this
+     * waits for that load instead.
+     *
+     * \param id the ID of the object to retrieve or load.
+     *
+     * \return a shared pointer to the cached object, or nullptr if the loader returned nullptr.
+     *
+     * \throws any exception thrown by the loader. Threads waiting for the same load receive the
+     *         same exception.
+     *
+     * \note the object stays alive as long as the returned pointer exists, even if the object is
+     *       erased from the cache or the cache is cleared by another thread in the meantime.
+     * \note this method is thread-safe. The loader must not request the same id, as it would
+     *       wait for itself.
+     */
+    std::shared_ptr<Value> get(const KeyView& id)
+    {
+        auto& shard = m_shards[m_hash(id) % m_num_shards];
+
+        std::shared_ptr<Entry> entry;
+        std::promise<Value*>   promise;
+        bool                   load = false;
+        {
+            const std::lock_guard lock(shard.mutex);
+            auto [it, inserted] = shard.items.try_emplace(Key{id});
+            if (!inserted) {
+                // Loaded, or being loaded by another thread
+                entry = it->second;
+            } else {
+                entry         = std::make_shared<Entry>();
+                entry->future = promise.get_future().share();
+                it->second    = entry;
+                load          = true;
+            }
+        }
+
+        if (!load) {
+            return share(entry, entry->future.get());
+        }
+
+        // This thread is responsible for loading the item
+        try {
+            entry->item = m_item_loader(id);
+        } catch (...) {
+            erase_entry(shard, id, entry);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+
+        auto* item = entry->item.get();
+        if (item == nullptr) {
+            // Like OwningCache, don't cache failed loads so that they are retried
+            erase_entry(shard, id, entry);
+        }
+        promise.set_value(item);
+        return share(entry, item);
+    }
+
+    /**
+     * Calls a function for every cached object.
+     *
+     * Objects that are still being loaded are skipped.
+     *
+     * \param function the function to call as \c function(const Key&, Value&). It is called while
+     *                 holding a shard's lock, so it must not use the cache.
+     */
+    template <typename Function>
+    void for_each(Function&& function)
+    {
+        for (std::size_t i = 0; i < m_num_shards; ++i) {
+            const std::lock_guard lock(m_shards[i].mutex);
+            for (const auto& [key, entry] : m_shards[i].items) {
+                if (is_loaded(*entry)) {
+                    function(key, *entry->item);
+                }
+            }
+        }
+    }
+
+    /**
+     * Removes an object from the cache.
+     *
+     * Objects that are still being loaded are not removed.
+     *
+     * \param id the ID of the object to remove.
+     *
+     * \return true if the object was removed.
+     *
+     * \note the object is destroyed when the last pointer obtained via #get for it is released.
+     */
+    bool erase(const KeyView& id)
+    {
+        auto& shard = m_shards[m_hash(id) % m_num_shards];
+
+        const std::lock_guard lock(shard.mutex);
+        const auto            it = shard.items.find(Key{id});
+        if (it == shard.items.end() || !is_loaded(*it->second)) {
+            return false;
+        }
+        shard.items.erase(it);
+        return true;
+    }
+
+    /**
+     * Clears all items from the cache.
+     *
+     * \note objects are destroyed when the last pointers obtained via #get for them are released.
+     * \note this must not be called while other threads are using the cache.
+     */
+    void clear()
+    {
+        for (std::size_t i = 0; i < m_num_shards; ++i) {
+            const std::lock_guard lock(m_shards[i].mutex);
+            m_shards[i].items.clear();
+        }
+    }
+
+private:
+    struct Entry
+    {
+        std::shared_future<Value*> future;
+        std::unique_ptr<Value>     item;
+    };
+
+    struct Shard
+    {
+        std::mutex                                                      mutex;
+        std::unordered_map<Key, std::shared_ptr<Entry>, Hash, KeyEqual> items;
+    };
+
+    // The loader's result is stored before the future is made ready, so this is safe to call
+    // while another thread is loading the entry.
+    static bool is_loaded(const Entry& entry)
+    {
+        return entry.future.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+               entry.item != nullptr;
+    }
+
+    // Returns a pointer to an entry's item that keeps the entry alive
+    static std::shared_ptr<Value> share(const std::shared_ptr<Entry>& entry, Value* item)
+    {
+        return (item != nullptr) ? std::shared_ptr<Value>(entry, item) : nullptr;
+    }
+
+    // Removes the entry for a key, unless it has since been replaced by another entry
+    static void erase_entry(Shard& shard, const KeyView& id, const std::shared_ptr<Entry>& entry)
+    {
+        const std::lock_guard lock(shard.mutex);
+        if (auto it = shard.items.find(Key{id}); it != shard.items.end() && it->second == entry) {
+            shard.items.erase(it);
+        }
+    }
+
+    Loader                   m_item_loader;
+    Hash                     m_hash;
+    std::size_t              m_num_shards;
+    std::unique_ptr<Shard[]> m_shards;
+};
+
 } // namespace khepri
\ No newline at end of file
@@ -82,6 +82,44 @@ public:
     using is_transparent = std::bool_constant<true>;
 };
 
+/**
+ * Equality comparator for case-insensitive comparisons on string-like objects.
+ *
+ * @note This class cannot be used with character pointers or literals. Use a \a string or \a
+ * string_view, instead.
+ * @note the case-insensitive comparison is locale-independent
+ */
+class CaseInsensitiveEqual
+{
+public:
+    /// Checks if the two string-like arguments are equal, ignoring case
+    template <typename T, typename U>
+    bool operator()(const T& t, const U& u) const noexcept
+    {
+        return case_insensitive_equals(t, u);
+    }
+
+    /// Marks the comparator as a transparent comparator
+    using is_transparent = std::bool_constant<true>;
+};
+
+/**
+ * Hash function for string-like objects that is consistent with #CaseInsensitiveEqual.
+ *
+ * Strings that differ only in case have the same hash value.
+ *
+ * @note the case-insensitive hash is locale-independent
+ */
+class CaseInsensitiveHash
+{
+public:
+    /// Returns the case-insensitive hash of a string-like argument
+    std::size_t operator()(std::string_view str) const noexcept;
+
+    /// Marks the hash as a transparent hash
+    using is_transparent = std::bool_constant<true>;
+};
+
 /**
  * Tokenizes a string
  */
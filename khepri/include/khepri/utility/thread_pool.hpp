@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace khepri {
+
+/**
+ * \brief A fixed-size pool of worker threads
+ *
+ * Tasks submitted to the pool are executed in submission order by the first available worker.
+ * Tasks must not throw; any exception escaping a task terminates the program.
+ */
+class ThreadPool final
+{
+public:
+    /// Type of a task executed by the pool
+    using Task = std::function<void()>;
+
+    /**
+     * Constructs the pool and starts its worker threads.
+     *
+     * \param num_threads the number of worker threads. If 0, one less than the number of hardware
+     *                    threads is used (but always at least one).
+     */
+    explicit ThreadPool(std::size_t num_threads = 0);
+
+    /**
+     * Destroys the pool.
+     *
+     * Tasks that have not started yet are discarded; running tasks are waited for.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool(ThreadPool&&)                 = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&)      = delete;
+
+    /// Returns the number of worker threads in the pool
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_threads.size();
+    }
+
+    /**
+     * Queues a task for execution on one of the worker threads.
+     *
+     * This method is thread-safe and can be called from within tasks.
+     */
+    void submit(Task task);
+
+private:
+    void run();
+
+    std::mutex               m_mutex;
+    std::condition_variable  m_cv;
+    std::deque<Task>         m_tasks;
+    bool                     m_stopping{false};
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace khepri
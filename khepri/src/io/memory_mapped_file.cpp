@@ -0,0 +1,125 @@
+#include <khepri/io/exceptions.hpp>
+#include <khepri/io/memory_mapped_file.hpp>
+
+#include <utility>
+
+#ifdef _MSC_VER
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace khepri::io {
+
+#ifdef _MSC_VER
+MemoryMappedFile::MemoryMappedFile(const std::filesystem::path& path)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw Error("Unable to open file");
+    }
+
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) == FALSE) {
+        CloseHandle(file);
+        throw Error("Unable to get file size");
+    }
+
+    if (size.QuadPart > 0) {
+        // The view keeps the mapping alive, so the handles can be closed right away
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            throw Error("Unable to map file");
+        }
+
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr) {
+            throw Error("Unable to map file");
+        }
+
+        m_data = static_cast<const std::uint8_t*>(view);
+        m_size = static_cast<std::size_t>(size.QuadPart);
+    } else {
+        // Empty files can't be mapped
+        CloseHandle(file);
+    }
+}
+
+void MemoryMappedFile::unmap() noexcept
+{
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+#else
+MemoryMappedFile::MemoryMappedFile(const std::filesystem::path& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY); // NOLINT - vararg function
+    if (fd == -1) {
+        throw Error("Unable to open file");
+    }
+
+    struct stat info = {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw Error("Unable to get file size");
+    }
+
+    if (info.st_size > 0) {
+        // The mapping stays valid after closing the file descriptor
+        void* const view =
+            ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) { // NOLINT - C-style cast in macro
+            throw Error("Unable to map file");
+        }
+
+        m_data = static_cast<const std::uint8_t*>(view);
+        m_size = static_cast<std::size_t>(info.st_size);
+    } else {
+        // Empty files can't be mapped
+        ::close(fd);
+    }
+}
+
+void MemoryMappedFile::unmap() noexcept
+{
+    if (m_data != nullptr) {
+        ::munmap(const_cast<std::uint8_t*>(m_data), m_size); // NOLINT - const_cast
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+#endif
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    unmap();
+}
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0))
+{
+}
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& other) noexcept
+{
+    if (this != &other) {
+        unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+} // namespace khepri::io
@@ -0,0 +1,46 @@
+#include <khepri/io/exceptions.hpp>
+#include <khepri/io/span_stream.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace khepri::io {
+
+std::size_t SpanStream::read(void* buffer, std::size_t count)
+{
+    count = std::min(count, m_data.size() - m_position);
+    if (count > 0) {
+        std::memcpy(buffer, m_data.data() + m_position, count);
+        m_position += count;
+    }
+    return count;
+}
+
+std::size_t SpanStream::write(const void* /*buffer*/, std::size_t /*count*/)
+{
+    throw NotSupportedError();
+}
+
+long long SpanStream::seek(long long offset, SeekOrigin origin)
+{
+    const auto size     = static_cast<long long>(m_data.size());
+    long long  position = 0;
+    switch (origin) {
+    case SeekOrigin::begin:
+        position = offset;
+        break;
+    case SeekOrigin::current:
+        position = static_cast<long long>(m_position) + offset;
+        break;
+    case SeekOrigin::end:
+        position = size + offset;
+        break;
+    default:
+        throw Error("Invalid seek origin");
+    }
+
+    m_position = static_cast<std::size_t>(std::clamp(position, 0LL, size));
+    return static_cast<long long>(m_position);
+}
+
+} // namespace khepri::io
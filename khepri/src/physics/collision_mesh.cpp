@@ -1,7 +1,11 @@
 #include <khepri/physics/collision_mesh.hpp>
 
+#include <khepri/math/bounding_box.hpp>
+
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <limits>
 #include <utility>
 
@@ -52,29 +56,418 @@ double intersect_distance(const Ray& ray, const Vector3f& v0, const Vector3f& v1
 
     return d;
 }
+
+// Maximum number of triangles in a leaf of the hierarchy
+constexpr std::size_t MAX_LEAF_SIZE = 4;
+
+// Number of bins that the triangles are sorted into to find the best split of a node
+constexpr std::size_t SPLIT_BINS = 16;
+
+// Relative margin by which ray distances to boxes are extended, so rounding errors in the box
+// tests can't cause triangles to be skipped
+constexpr float BOX_DISTANCE_MARGIN = 1.0F + 1e-5F;
+
+// Returns 1 / value, or positive infinity if that overflows. For a ray that is parallel to an
+// axis, the direction along the ray is then irrelevant to the box tests, and so is its sign.
+float inverse(double value) noexcept
+{
+    const auto inverse = static_cast<float>(1.0 / value);
+    return std::isinf(inverse) ? std::numeric_limits<float>::infinity() : inverse;
+}
+
+// The larger and the smaller of two values, or a if either is NaN
+float max_or_first(float a, float b) noexcept
+{
+    return (a < b) ? b : a;
+}
+
+float min_or_first(float a, float b) noexcept
+{
+    return (b < a) ? b : a;
+}
+
+// Axis-aligned bounds that can be empty, for building the hierarchy
+struct Bounds
+{
+    Vector3f min{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                 std::numeric_limits<float>::max()};
+    Vector3f max{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                 std::numeric_limits<float>::lowest()};
+
+    void grow(const Vector3f& point) noexcept
+    {
+        min = {std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z)};
+        max = {std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z)};
+    }
+
+    void grow(const Bounds& bounds) noexcept
+    {
+        if (!bounds.empty()) {
+            grow(bounds.min);
+            grow(bounds.max);
+        }
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return min.x > max.x;
+    }
+
+    [[nodiscard]] float surface_area() const noexcept
+    {
+        if (empty()) {
+            return 0.0F;
+        }
+        const auto s = max - min;
+        return 2 * (s.x * s.y + s.y * s.z + s.z * s.x);
+    }
+};
+
+// A node of the binary hierarchy that is built first
+struct BinaryNode
+{
+    Bounds                       bounds;
+    std::uint32_t                first{0}; // For leaves, the first triangle
+    std::uint32_t                count{0}; // For leaves, the number of triangles; 0 for nodes
+    std::array<std::uint32_t, 2> children{};
+};
+
+/*
+ * Builds a binary bounding volume hierarchy over the triangles with the bounds and centroids in
+ * \a triangles and \a centroids. Nodes are split so as to minimize the surface area heuristic
+ * (SAH): the sum of the children's surface areas, weighted by their number of triangles.
+ *
+ * Reorders \a order, the indices of the triangles, so every leaf refers to a range in it.
+ */
+std::vector<BinaryNode> build_binary_hierarchy(const std::vector<Bounds>&   triangles,
+                                               const std::vector<Vector3f>& centroids,
+                                               std::vector<std::uint32_t>&  order)
+{
+    std::vector<BinaryNode> nodes(1);
+    nodes[0].count = static_cast<std::uint32_t>(order.size());
+
+    // Nodes that may have to be split
+    std::vector<std::uint32_t> pending{0};
+    while (!pending.empty()) {
+        const auto index = pending.back();
+        pending.pop_back();
+
+        const auto begin = nodes[index].first;
+        const auto end   = begin + nodes[index].count;
+
+        Bounds centroid_bounds;
+        for (auto i = begin; i < end; ++i) {
+            nodes[index].bounds.grow(triangles[order[i]]);
+            centroid_bounds.grow(centroids[order[i]]);
+        }
+
+        if (end - begin <= MAX_LEAF_SIZE) {
+            continue;
+        }
+
+        // Split along the axis in which the centroids are spread the most
+        const auto extent = centroid_bounds.max - centroid_bounds.min;
+        const auto axis   = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0U : 2U)
+                                                  : ((extent.y > extent.z) ? 1U : 2U);
+        if (extent[axis] <= 0) {
+            // All centroids coincide, so the triangles can't be split
+            continue;
+        }
+
+        const auto bin_of = [&](std::uint32_t triangle) {
+            const auto offset =
+                (centroids[triangle][axis] - centroid_bounds.min[axis]) / extent[axis];
+            return std::min(static_cast<std::size_t>(offset * SPLIT_BINS), SPLIT_BINS - 1);
+        };
+
+        struct Bin
+        {
+            Bounds      bounds;
+            std::size_t count{0};
+        };
+        std::array<Bin, SPLIT_BINS> bins{};
+        for (auto i = begin; i < end; ++i) {
+            auto& bin = bins[bin_of(order[i])];
+            bin.bounds.grow(triangles[order[i]]);
+            ++bin.count;
+        }
+
+        // Find the cost of every split between bins: sweep from the right, then from the left
+        std::array<float, SPLIT_BINS> right_costs{};
+        Bounds                        right;
+        std::size_t                   right_count = 0;
+        for (std::size_t bin = SPLIT_BINS - 1; bin > 0; --bin) {
+            right.grow(bins[bin].bounds);
+            right_count += bins[bin].count;
+            right_costs[bin] = right.surface_area() * static_cast<float>(right_count);
+        }
+
+        Bounds      left;
+        std::size_t left_count = 0;
+        std::size_t best_split = 0;
+        float       best_cost  = std::numeric_limits<float>::max();
+        for (std::size_t bin = 1; bin < SPLIT_BINS; ++bin) {
+            left.grow(bins[bin - 1].bounds);
+            left_count += bins[bin - 1].count;
+            const auto cost =
+                left.surface_area() * static_cast<float>(left_count) + right_costs[bin];
+            if (left_count > 0 && left_count < end - begin && cost < best_cost) {
+                best_cost  = cost;
+                best_split = bin;
+            }
+        }
+
+        if (best_split == 0) {
+            // No split has triangles on both sides
+            continue;
+        }
+
+        const auto middle = static_cast<std::uint32_t>(
+            std::partition(order.begin() + begin, order.begin() + end,
+                           [&](std::uint32_t triangle) { return bin_of(triangle) < best_split; }) -
+            order.begin());
+
+        const auto child = static_cast<std::uint32_t>(nodes.size());
+        nodes.resize(nodes.size() + 2);
+        nodes[child].first     = begin;
+        nodes[child].count     = middle - begin;
+        nodes[child + 1].first = middle;
+        nodes[child + 1].count = end - middle;
+        nodes[index].count     = 0;
+        nodes[index].children  = {child, child + 1};
+        pending.push_back(child);
+        pending.push_back(child + 1);
+    }
+    return nodes;
+}
+
+// Stack of entries to visit while traversing the hierarchy. The stack only allocates memory for
+// very deep hierarchies.
+template <typename T>
+class TraversalStack
+{
+public:
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    void push(const T& entry)
+    {
+        if (m_size < m_stack.size()) {
+            m_stack[m_size++] = entry;
+        } else {
+            m_overflow.push_back(entry);
+        }
+    }
+
+    T pop()
+    {
+        if (!m_overflow.empty()) {
+            const auto entry = m_overflow.back();
+            m_overflow.pop_back();
+            return entry;
+        }
+        return m_stack[--m_size];
+    }
+
+private:
+    static constexpr std::size_t STACK_SIZE = 64;
+
+    std::array<T, STACK_SIZE> m_stack{};
+    std::size_t               m_size{0};
+    std::vector<T>            m_overflow;
+};
 } // namespace
 
 CollisionMesh::CollisionMesh(std::vector<Vector3f> vertices, std::vector<Index> indices)
     : m_vertices(std::move(vertices)), m_indices(std::move(indices))
 {
     assert(m_indices.size() % 3 == 0);
+
+    // Vertices that are not part of any triangle are not in the hierarchy
+    std::vector<bool> referenced(m_vertices.size(), false);
+    for (const auto index : m_indices) {
+        referenced[index] = true;
+    }
+    for (std::size_t i = 0; i < m_vertices.size(); ++i) {
+        if (!referenced[i]) {
+            m_unreferenced_vertices.push_back(static_cast<Index>(i));
+        }
+    }
+
+    build_hierarchy();
+}
+
+void CollisionMesh::build_hierarchy()
+{
+    const auto triangle_count = m_indices.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    std::vector<Bounds>        triangles(triangle_count);
+    std::vector<Vector3f>      centroids(triangle_count);
+    std::vector<std::uint32_t> order(triangle_count);
+    for (std::size_t i = 0; i < triangle_count; ++i) {
+        const auto& v0 = m_vertices[m_indices[i * 3 + 0]];
+        const auto& v1 = m_vertices[m_indices[i * 3 + 1]];
+        const auto& v2 = m_vertices[m_indices[i * 3 + 2]];
+        triangles[i].grow(v0);
+        triangles[i].grow(v1);
+        triangles[i].grow(v2);
+        centroids[i] = (v0 + v1 + v2) / 3.0F;
+        order[i]     = static_cast<std::uint32_t>(i);
+    }
+
+    const auto binary_nodes = build_binary_hierarchy(triangles, centroids, order);
+
+    // Collapse the binary hierarchy into one with NODE_WIDTH children per node: every node
+    // replaces its inner child with the largest surface area by that child's children, until it
+    // has enough children. Every entry maps a binary node to the node that takes its place.
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pending{{0, 0}};
+    m_nodes.emplace_back();
+    while (!pending.empty()) {
+        const auto [binary_index, index] = pending.back();
+        pending.pop_back();
+
+        std::array<std::uint32_t, NODE_WIDTH> children{binary_index};
+        std::size_t                           child_count = 1;
+        while (child_count < NODE_WIDTH) {
+            std::size_t largest      = NODE_WIDTH;
+            float       largest_area = -1;
+            for (std::size_t i = 0; i < child_count; ++i) {
+                const auto& child = binary_nodes[children[i]];
+                if (child.count == 0 && child.bounds.surface_area() > largest_area) {
+                    largest      = i;
+                    largest_area = child.bounds.surface_area();
+                }
+            }
+            if (largest == NODE_WIDTH) {
+                // All children are leaves
+                break;
+            }
+            const auto& opened      = binary_nodes[children[largest]];
+            children[largest]       = opened.children[0];
+            children[child_count++] = opened.children[1];
+        }
+
+        for (std::size_t i = 0; i < child_count; ++i) {
+            const auto& child       = binary_nodes[children[i]];
+            m_nodes[index].min_x[i] = child.bounds.min.x;
+            m_nodes[index].min_y[i] = child.bounds.min.y;
+            m_nodes[index].min_z[i] = child.bounds.min.z;
+            m_nodes[index].max_x[i] = child.bounds.max.x;
+            m_nodes[index].max_y[i] = child.bounds.max.y;
+            m_nodes[index].max_z[i] = child.bounds.max.z;
+            if (child.count == 0) {
+                const auto node = static_cast<std::uint32_t>(m_nodes.size());
+                m_nodes.emplace_back();
+                m_nodes[index].first[i] = node;
+                m_nodes[index].count[i] = INNER;
+                pending.emplace_back(children[i], node);
+            } else {
+                m_nodes[index].first[i] = child.first;
+                m_nodes[index].count[i] = child.count;
+            }
+        }
+    }
+
+    // Order the triangles by leaf, so leaves refer to a range of triangles
+    std::vector<Index> indices(m_indices.size());
+    for (std::size_t i = 0; i < triangle_count; ++i) {
+        std::copy_n(m_indices.begin() + order[i] * 3, 3, indices.begin() + i * 3);
+    }
+    m_indices = std::move(indices);
 }
 
 double CollisionMesh::intersect_distance(const Ray& ray) const
 {
-    // Unoptimized implementation: iterate through the triangles and find the closest one that
-    // intersects
+    if (m_nodes.empty()) {
+        return -1.0;
+    }
+
     double min_distance = std::numeric_limits<double>::max();
     bool   found        = false;
 
-    for (std::size_t i = 0; i < m_indices.size(); i += 3) {
-        const double distance =
-            physics::intersect_distance(ray, m_vertices[m_indices[i + 0]],
-                                        m_vertices[m_indices[i + 1]], m_vertices[m_indices[i + 2]]);
+    // The boxes are stored, and tested, in single precision
+    const Vector3f start(ray.start());
+    const Vector3f inv_direction(inverse(ray.direction().x), inverse(ray.direction().y),
+                                 inverse(ray.direction().z));
+
+    struct Entry
+    {
+        std::uint32_t node;
+        float         distance;
+    };
+
+    // Visit the hierarchy depth-first, nearest children first, so that far away nodes can be
+    // skipped once an intersection has been found
+    TraversalStack<Entry> stack;
+    stack.push({0, 0.0F});
+    while (!stack.empty()) {
+        const auto entry = stack.pop();
+        if (found && entry.distance > min_distance) {
+            continue;
+        }
+        const auto& node = m_nodes[entry.node];
+
+        // Clip the ray against the boxes of all children at once. This loop has no branches, so
+        // the compiler can vectorize it.
+        //
+        // For a ray that is parallel to an axis, a box side at the ray's start gives a distance
+        // of 0 * infinity = NaN. All comparisons with NaN are false, so such a distance ends up
+        // as the axis' entry or exit distance, and is then ignored: the ray is treated as inside
+        // that box side.
+        const auto max_distance =
+            static_cast<float>(std::min<double>(min_distance, std::numeric_limits<float>::max()));
+        std::array<float, NODE_WIDTH> near_{};
+        std::array<float, NODE_WIDTH> far_{};
+        for (std::size_t i = 0; i < NODE_WIDTH; ++i) {
+            const auto x1 = (node.min_x[i] - start.x) * inv_direction.x;
+            const auto x2 = (node.max_x[i] - start.x) * inv_direction.x;
+            const auto y1 = (node.min_y[i] - start.y) * inv_direction.y;
+            const auto y2 = (node.max_y[i] - start.y) * inv_direction.y;
+            const auto z1 = (node.min_z[i] - start.z) * inv_direction.z;
+            const auto z2 = (node.max_z[i] - start.z) * inv_direction.z;
+            near_[i] = max_or_first(max_or_first(max_or_first(0.0F, min_or_first(x1, x2)),
+                                                 min_or_first(y1, y2)),
+                                    min_or_first(z1, z2));
+            far_[i]  = min_or_first(min_or_first(min_or_first(max_distance, max_or_first(x2, x1)),
+                                                 max_or_first(y2, y1)),
+                                    max_or_first(z2, z1)) *
+                      BOX_DISTANCE_MARGIN;
+        }
+
+        // Test the triangles in hit leaves right away, and push the hit nodes
+        std::array<Entry, NODE_WIDTH> hit_nodes{};
+        std::size_t                   hit_node_count = 0;
+        for (std::size_t i = 0; i < NODE_WIDTH; ++i) {
+            if (node.count[i] == 0 || near_[i] > far_[i]) {
+                continue;
+            }
+            if (node.count[i] == INNER) {
+                hit_nodes[hit_node_count++] = {node.first[i], near_[i]};
+                continue;
+            }
+            const auto end = (node.first[i] + node.count[i]) * 3;
+            for (std::size_t j = node.first[i] * 3; j < end; j += 3) {
+                const double distance = physics::intersect_distance(
+                    ray, m_vertices[m_indices[j + 0]], m_vertices[m_indices[j + 1]],
+                    m_vertices[m_indices[j + 2]]);
 
-        if (distance != -1) {
-            min_distance = std::min(min_distance, distance);
-            found        = true;
+                if (distance >= 0) {
+                    min_distance = std::min(min_distance, distance);
+                    found        = true;
+                }
+            }
+        }
+
+        // Push the furthest node first, so the nearest node is visited first
+        std::sort(hit_nodes.begin(), hit_nodes.begin() + hit_node_count,
+                  [](const Entry& a, const Entry& b) { return a.distance > b.distance; });
+        for (std::size_t i = 0; i < hit_node_count; ++i) {
+            stack.push(hit_nodes[i]);
         }
     }
 
@@ -83,9 +476,47 @@ double CollisionMesh::intersect_distance(const Ray& ray) const
 
 bool CollisionMesh::intersect(const Frustum& frustum) const
 {
-    // Every vertex has to be inside the frustum
-    return std::all_of(m_vertices.begin(), m_vertices.end(),
-                       [&](auto& v) { return frustum.inside(v); });
+    // Every vertex has to be inside the frustum. The vertices in boxes that lie inside the
+    // frustum don't have to be tested, and a box that lies outside of it has vertices outside.
+    // Vertices that are not part of a triangle are not in any box, so test those separately.
+    if (!std::all_of(m_unreferenced_vertices.begin(), m_unreferenced_vertices.end(),
+                     [&](Index index) { return frustum.inside(m_vertices[index]); })) {
+        return false;
+    }
+
+    TraversalStack<std::uint32_t> stack;
+    if (!m_nodes.empty()) {
+        stack.push(0);
+    }
+    while (!stack.empty()) {
+        const auto& node = m_nodes[stack.pop()];
+        for (std::size_t i = 0; i < NODE_WIDTH; ++i) {
+            if (node.count[i] == 0) {
+                continue;
+            }
+
+            const BoundingBox box({node.min_x[i], node.min_y[i], node.min_z[i]},
+                                  {node.max_x[i], node.max_y[i], node.max_z[i]});
+            if (frustum.inside(box)) {
+                continue;
+            }
+            if (!frustum.intersects(box)) {
+                return false;
+            }
+
+            if (node.count[i] == INNER) {
+                stack.push(node.first[i]);
+                continue;
+            }
+            const auto begin = m_indices.begin() + node.first[i] * 3;
+            const auto end   = begin + node.count[i] * 3;
+            if (!std::all_of(begin, end,
+                             [&](Index index) { return frustum.inside(m_vertices[index]); })) {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
 } // namespace khepri::physics
@@ -3,6 +3,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <limits>
 
 namespace khepri::renderer {
 
@@ -154,6 +156,20 @@ double Camera::lod(const Vector3& world_pos) const noexcept
     return saturate((m_properties.zfar - v.w) / (m_properties.zfar - m_properties.znear));
 }
 
+double Camera::projected_size(const Sphere& sphere) const noexcept
+{
+    if (m_properties.type == Type::orthographic) {
+        // The size doesn't depend on the distance
+        return 2 * sphere.radius() * m_properties.aspect / m_properties.width;
+    }
+
+    const auto distance = (sphere.center() - m_properties.position).length();
+    if (distance <= sphere.radius()) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return sphere.radius() / (distance * std::tan(m_properties.fov / 2));
+}
+
 void Camera::clear_cache()
 {
     m_matrices = {};
@@ -1,5 +1,10 @@
+#include "../material_params.hpp"
+#include "../mesh_allocator.hpp"
+#include "../render_queue.hpp"
+#include "../ring_allocator.hpp"
 #include "native_window.hpp"
 #include "refcnt_ptr.hpp"
+#include "shader_cache.hpp"
 #include "shader_stream_factory.hpp"
 
 #include <khepri/exceptions.hpp>
@@ -8,23 +13,32 @@
 #include <khepri/renderer/diligent/renderer.hpp>
 #include <khepri/renderer/exceptions.hpp>
 #include <khepri/utility/string.hpp>
+#include <khepri/utility/thread_pool.hpp>
 
 #ifdef _MSC_VER
 #include <EngineFactoryD3D11.h>
 #else
 #include <EngineFactoryOpenGL.h>
 #endif
+#include <APIInfo.h>
 #include <DebugOutput.h>
 #include <DeviceContext.h>
+#include <Fence.h>
 #include <HLSL2GLSLConverter.h>
 #include <MapHelper.hpp>
 #include <RenderDevice.h>
 #include <Sampler.h>
 #include <SwapChain.h>
 #include <Texture.h>
+#include <fmt/format.h>
+
+#include <cstring>
 #include <functional>
+#include <future>
 #include <iterator>
+#include <memory>
 #include <stack>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 
@@ -32,8 +46,17 @@ using namespace Diligent;
 
 namespace khepri::renderer::diligent {
 namespace {
+using detail::IdAllocator;
+
 constexpr khepri::log::Logger LOG("diligent");
 
+// Required alignment of offsets into vertex buffers
+constexpr std::size_t VERTEX_BUFFER_ALIGNMENT = 16;
+
+// Initial sizes of the dynamic buffers for per-frame data
+constexpr std::size_t MATERIAL_CONSTANTS_BUFFER_SIZE = 4 * 1024 * 1024;
+constexpr std::size_t INSTANCE_BUFFER_SIZE           = 4 * 1024 * 1024;
+
 // Index of a render pass in a render pipeline
 using LocalRenderPassIndex = std::size_t;
 
@@ -41,12 +64,14 @@ using LocalRenderPassIndex = std::size_t;
 using GlobalRenderPassIndex = std::size_t;
 
 #pragma pack(push, 4)
-struct InstanceConstantBuffer
+// Per-instance data, passed to the mesh shaders as per-instance vertex attributes.
+// The matrices are stored transposed, so that every attribute holds one row of a matrix.
+struct InstanceData
 {
     Matrixf world;
     Matrixf world_inv;
 };
-static_assert(sizeof(InstanceConstantBuffer) == 8 * 16); // Validate packing
+static_assert(sizeof(InstanceData) == 8 * 16); // Validate packing
 
 struct ViewConstantBuffer
 {
@@ -79,6 +104,70 @@ struct PointLight
 static_assert(sizeof(PointLight) == 3 * 16); // Validate packing
 #pragma pack(pop)
 
+// Number of mesh input layout elements for the vertices and for the instance data
+constexpr Uint32 NUM_VERTEX_ELEMENTS   = 6;
+constexpr Uint32 NUM_INSTANCE_ELEMENTS = 8; // One for each row of the instance matrices
+
+// Returns the input layout for meshes with vertices in the given format.
+// The mesh's vertices are in buffer slot 0, the instance data in buffer slot 1.
+std::array<LayoutElement, NUM_VERTEX_ELEMENTS + NUM_INSTANCE_ELEMENTS>
+vertex_layout(VertexFormat format)
+{
+    static_assert(sizeof(MeshDesc::Vertex) < std::numeric_limits<Uint32>::max(),
+                  "Vertex is too large");
+
+    std::array<LayoutElement, NUM_VERTEX_ELEMENTS + NUM_INSTANCE_ELEMENTS> layout;
+    if (format == VertexFormat::compact) {
+        using Vertex          = CompactVertex;
+        constexpr auto stride = static_cast<Uint32>(sizeof(Vertex));
+        layout[0] = {0, 0, 3, VT_FLOAT32, false, offsetof(Vertex, position), stride};
+        layout[1] = {1, 0, 4, VT_INT8, true, offsetof(Vertex, normal), stride};
+        layout[2] = {2, 0, 4, VT_INT8, true, offsetof(Vertex, tangent), stride};
+        // There is no binormal; shaders derive it. The attribute is still set, so that shaders
+        // that declare it can be used with either format.
+        layout[3] = {3, 0, 4, VT_INT8, true, offsetof(Vertex, tangent), stride};
+        layout[4] = {4, 0, 2, VT_FLOAT16, false, offsetof(Vertex, uv), stride};
+        layout[5] = {5, 0, 4, VT_UINT8, true, offsetof(Vertex, color), stride};
+    } else {
+        using Vertex          = MeshDesc::Vertex;
+        constexpr auto stride = static_cast<Uint32>(sizeof(Vertex));
+        layout[0] = {0, 0, 3, VT_FLOAT32, false, offsetof(Vertex, position), stride};
+        layout[1] = {1, 0, 3, VT_FLOAT32, false, offsetof(Vertex, normal), stride};
+        layout[2] = {2, 0, 3, VT_FLOAT32, false, offsetof(Vertex, tangent), stride};
+        layout[3] = {3, 0, 3, VT_FLOAT32, false, offsetof(Vertex, binormal), stride};
+        layout[4] = {4, 0, 2, VT_FLOAT32, false, offsetof(Vertex, uv), stride};
+        layout[5] = {5, 0, 4, VT_FLOAT32, false, offsetof(Vertex, color), stride};
+    }
+
+    for (Uint32 i = 0; i < NUM_INSTANCE_ELEMENTS; ++i) {
+        layout[NUM_VERTEX_ELEMENTS + i] =
+            LayoutElement{NUM_VERTEX_ELEMENTS + i,
+                          1,
+                          4,
+                          VT_FLOAT32,
+                          false,
+                          static_cast<Uint32>(i * sizeof(Vector4f)),
+                          static_cast<Uint32>(sizeof(InstanceData)),
+                          INPUT_ELEMENT_FREQUENCY_PER_INSTANCE};
+    }
+    return layout;
+}
+
+// Writes vertices to \a dest in the given format
+void write_vertices(VertexFormat format, gsl::span<const MeshDesc::Vertex> vertices,
+                    std::uint8_t* dest)
+{
+    if (format == VertexFormat::compact) {
+        for (const auto& vertex : vertices) {
+            const auto compact = to_compact_vertex(vertex);
+            std::memcpy(dest, &compact, sizeof(compact));
+            dest += sizeof(compact);
+        }
+    } else {
+        std::memcpy(dest, vertices.data(), vertices.size_bytes());
+    }
+}
+
 // Combine the default and override options into a final set of options.
 // All optional members in the result will be set.
 GraphicsPipelineOptions combine_options(const GraphicsPipelineOptions& default_options,
@@ -193,15 +282,6 @@ COMPARISON_FUNCTION to_comparison_func(GraphicsPipelineOptions::ComparisonFunc f
     return COMPARISON_FUNC_UNKNOWN;
 }
 
-// helper type for a variant visitor
-template <class... Ts>
-struct Overloaded : Ts...
-{
-    using Ts::operator()...;
-};
-template <class... Ts>
-Overloaded(Ts...) -> Overloaded<Ts...>;
-
 void diligent_debug_message_callback(DEBUG_MESSAGE_SEVERITY severity, const char* message,
                                      const char* /*function*/, const char* /*file*/, int /*line*/)
 {
@@ -219,6 +299,127 @@ void diligent_debug_message_callback(DEBUG_MESSAGE_SEVERITY severity, const char
     }
 }
 
+// Checks if the device can map dynamic constant buffers with MAP_FLAG_NO_OVERWRITE and bind
+// ranges of them. Direct3D 11 devices need Direct3D 11.1 for both.
+bool supports_constant_buffer_ranges(const RenderDeviceInfo& info) noexcept
+{
+    if (info.Type == RENDER_DEVICE_TYPE_D3D11) {
+        return info.APIVersion.Major > 11 ||
+               (info.APIVersion.Major == 11 && info.APIVersion.Minor >= 1);
+    }
+    return true;
+}
+
+// A buffer for data that is written by the CPU every frame, such as constants and instance data.
+// The frame's data is allocated linearly from the buffer and written without waiting for the GPU.
+// A fence that is signaled at the end of every frame tells when the GPU is done with a frame's
+// data, so the allocations can wrap around safely while several frames are in flight.
+//
+// The buffer is not persistently mapped: Diligent only supports that for some backends. Instead,
+// every allocation maps the buffer with MAP_FLAG_NO_OVERWRITE, which is cheap because the driver
+// doesn't have to synchronize with the GPU. Devices that don't support this for a kind of buffer
+// (see supports_constant_buffer_ranges) can use the buffer in discard mode instead, where every
+// allocation discards the whole buffer and starts at offset 0.
+class DynamicBuffer
+{
+public:
+    DynamicBuffer(const char* name, BIND_FLAGS bind_flags, std::size_t capacity,
+                  std::size_t alignment)
+        : m_name(name), m_bind_flags(bind_flags), m_alignment(alignment), m_ring(capacity)
+    {
+    }
+
+    IBuffer* buffer() const noexcept
+    {
+        return m_buffer;
+    }
+
+    // Makes every allocation discard the buffer rather than append to it. An allocation's data
+    // then remains valid for the GPU commands issued before the next allocation is mapped.
+    void set_discard_mode(bool discard_mode) noexcept
+    {
+        m_discard_mode = discard_mode;
+    }
+
+    // Allocates \a size bytes for the current frame and returns their offset in the buffer.
+    // Waits for the GPU if the buffer is full, and replaces the buffer with a larger one if the
+    // current frame alone doesn't fit.
+    std::size_t allocate(IRenderDevice& device, IFence& fence, std::size_t size)
+    {
+        if (m_discard_mode) {
+            // The driver renames the buffer on every discard, so the GPU never waits
+            if (m_buffer == nullptr || m_ring.capacity() < size) {
+                create_buffer(device, std::max(m_ring.capacity(), size));
+            }
+            return 0;
+        }
+
+        if (m_buffer == nullptr) {
+            create_buffer(device, m_ring.capacity());
+        }
+
+        m_ring.release(fence.GetCompletedValue());
+        auto offset = m_ring.allocate(size, m_alignment);
+        while (!offset) {
+            if (const auto frame = m_ring.oldest_frame()) {
+                fence.Wait(*frame);
+                m_ring.release(*frame);
+            } else {
+                // The old buffer is kept alive by the GPU until it's done with it
+                create_buffer(device, std::max(m_ring.capacity() * 2, size));
+            }
+            offset = m_ring.allocate(size, m_alignment);
+        }
+        return *offset;
+    }
+
+    // Maps the buffer to write the current frame's allocations. Existing data is not overwritten,
+    // unless the buffer is in discard mode.
+    MapHelper<std::uint8_t> map(IDeviceContext& context)
+    {
+        const auto flags = (m_discard || m_discard_mode) ? MAP_FLAG_DISCARD : MAP_FLAG_NO_OVERWRITE;
+        m_discard        = false;
+        return MapHelper<std::uint8_t>(&context, m_buffer, MAP_WRITE, flags);
+    }
+
+    // Marks the end of the current frame. \a frame_id is the value the fence is signaled with
+    // when the GPU has finished the frame.
+    void finish_frame(std::uint64_t frame_id)
+    {
+        m_ring.finish_frame(frame_id);
+    }
+
+private:
+    void create_buffer(IRenderDevice& device, std::size_t capacity)
+    {
+        BufferDesc desc;
+        desc.Name           = m_name;
+        desc.Size           = capacity;
+        desc.Usage          = USAGE_DYNAMIC;
+        desc.BindFlags      = m_bind_flags;
+        desc.CPUAccessFlags = CPU_ACCESS_WRITE;
+
+        device.CreateBuffer(desc, nullptr, &m_buffer);
+        if (m_buffer == nullptr) {
+            throw khepri::renderer::Error("Failed to create dynamic buffer");
+        }
+        m_ring    = detail::RingAllocator(capacity);
+        m_discard = true;
+    }
+
+    const char*           m_name;
+    BIND_FLAGS            m_bind_flags;
+    std::size_t           m_alignment;
+    RefCntPtr<IBuffer>    m_buffer;
+    detail::RingAllocator m_ring;
+
+    // The first map of a new buffer discards it, later maps don't overwrite used data
+    bool m_discard{true};
+
+    // Every map discards the buffer, see #set_discard_mode
+    bool m_discard_mode{false};
+};
+
 constexpr bool using_shader_conversion()
 {
 #ifdef _MSC_VER
@@ -235,7 +436,6 @@ class Renderer::Impl
 {
     struct ConstantsBuffers
     {
-        RefCntPtr<IBuffer> instance;
         RefCntPtr<IBuffer> view;
         RefCntPtr<IBuffer> directional_lights;
         RefCntPtr<IBuffer> point_lights;
@@ -252,7 +452,39 @@ class Renderer::Impl
     {
         using Index = khepri::renderer::MeshDesc::Index;
 
-        Index              index_count{0};
+        Mesh(IdAllocator& id_allocator, detail::MeshAllocator& mesh_allocator,
+             const MeshDesc& mesh_desc)
+            : id(id_allocator.allocate())
+            , ids(id_allocator)
+            , allocation(
+                  mesh_allocator.allocate(mesh_desc.vertices.size(), mesh_desc.indices.size()))
+            , allocator(mesh_allocator)
+        {
+        }
+
+        ~Mesh() override
+        {
+            allocator.free(allocation);
+            ids.free(id);
+        }
+
+        Mesh(const Mesh&)            = delete;
+        Mesh(Mesh&&)                 = delete;
+        Mesh& operator=(const Mesh&) = delete;
+        Mesh& operator=(Mesh&&)      = delete;
+
+        // Unique ID of this mesh, for sorting
+        std::uint32_t id;
+        IdAllocator&  ids;
+
+        // Location of the mesh's vertices and indices in the shared mesh buffers
+        detail::MeshAllocator::Allocation allocation;
+        detail::MeshAllocator&            allocator;
+    };
+
+    // The shared vertex and index buffer of a page of the mesh allocator
+    struct MeshPage
+    {
         RefCntPtr<IBuffer> vertex_buffer;
         RefCntPtr<IBuffer> index_buffer;
     };
@@ -271,54 +503,38 @@ class Renderer::Impl
         }
 
     public:
-        Material(IRenderDevice& device, ISwapChain& swapchain, const MaterialDesc& desc,
+        Material(IRenderDevice& device, ISwapChain& swapchain, IBuffer& view_constants,
+                 VertexFormat vertex_format, const MaterialDesc& desc, std::uint32_t id,
                  std::function<void(Material&)> destroy_callback)
-            : m_device(device)
-            , m_swapchain(swapchain)
-            , m_destroy_callback(destroy_callback)
+            : m_destroy_callback(destroy_callback)
+            , m_id(id)
             , m_type(desc.type)
             , m_num_directional_lights(desc.num_directional_lights)
             , m_num_point_lights(desc.num_point_lights)
             , m_graphics_pipeline_options(desc.graphics_pipeline_options)
-            , m_shader(copy_shader(desc.shader))
-            , m_dynamic_variables(determine_dynamic_material_variables(m_shader, desc.properties))
+            , m_properties(desc.properties)
+            , m_param_layout(detail::layout_material_params(desc.properties))
         {
             if (desc.num_directional_lights < 0 || desc.num_point_lights < 0) {
                 throw ArgumentError();
             }
 
-            Uint32 buffer_size = 0;
-            m_params.reserve(desc.properties.size());
-            for (const auto& p : desc.properties) {
-                // Every type has its own size, except for textures, which don't take up space.
-                const auto property_size = std::visit(
-                    Overloaded{[&](const khepri::renderer::Texture*) -> Uint32 { return 0; },
-                               [&](const auto& value) -> Uint32 { return sizeof(value); }},
-                    p.default_value);
-
-                constexpr auto param_alignment = 16;
-                const auto     remaining_size  = param_alignment - (buffer_size % param_alignment);
-                if (property_size > remaining_size) {
-                    // The next property doesn't fit in the remaining space in this alignment
-                    // 'block'. Align parameter to multiple of 16 bytes.
-                    buffer_size =
-                        (buffer_size + param_alignment - 1) / param_alignment * param_alignment;
+            auto source               = std::make_shared<PipelineSource>();
+            source->device            = RefCntPtr<IRenderDevice>(&device);
+            source->view_constants    = RefCntPtr<IBuffer>(&view_constants);
+            source->color_format      = swapchain.GetDesc().ColorBufferFormat;
+            source->depth_format      = swapchain.GetDesc().DepthBufferFormat;
+            source->vertex_format     = vertex_format;
+            source->shader            = copy_shader(desc.shader);
+            source->dynamic_variables = determine_dynamic_material_variables(source->shader,
+                                                                             desc.properties);
+            for (const auto& p : m_properties) {
+                if (std::holds_alternative<const khepri::renderer::Texture*>(p.default_value)) {
+                    source->texture_names.push_back(p.name);
                 }
-
-                m_params.push_back({p.name, p.default_value, buffer_size});
-                buffer_size += property_size;
-            }
-
-            // Create the material properties buffer
-            if (buffer_size > 0) {
-                BufferDesc desc;
-                desc.Name           = "Material Constants";
-                desc.Size           = buffer_size;
-                desc.Usage          = USAGE_DYNAMIC;
-                desc.BindFlags      = BIND_UNIFORM_BUFFER;
-                desc.CPUAccessFlags = CPU_ACCESS_WRITE;
-                m_device.CreateBuffer(desc, nullptr, &m_param_buffer);
             }
+            m_pipeline_source = std::move(source);
+            m_default_params  = compile_params({});
         }
 
         ~Material() override
@@ -326,6 +542,12 @@ class Renderer::Impl
             m_destroy_callback(*this);
         }
 
+        // Unique ID of this material, for sorting
+        std::uint32_t id() const noexcept
+        {
+            return m_id;
+        }
+
         int num_directional_lights() const noexcept
         {
             return m_num_directional_lights;
@@ -336,8 +558,40 @@ class Renderer::Impl
             return m_num_point_lights;
         }
 
+        // Size of the material's constants buffer ("Material"), in bytes
+        std::size_t param_size() const noexcept
+        {
+            return m_param_layout.size;
+        }
+
+        /// \see #khepri::renderer::Material::compile_params
+        ParamBlock compile_params(
+            gsl::span<const khepri::renderer::Material::Param> params) const override
+        {
+            auto block =
+                detail::compile_material_params(*this, m_properties, m_param_layout, params);
+            for (const auto* texture : block.textures) {
+                if (texture != nullptr && dynamic_cast<const Texture*>(texture) == nullptr) {
+                    throw ArgumentError();
+                }
+            }
+            return block;
+        }
+
+        // Writes the material's constants for the given parameters to \a dest, which must hold
+        // #param_size bytes. If \a params is null, the material's defaults are written.
+        void write_params(const ParamBlock* params, std::uint8_t* dest) const
+        {
+            const auto& block = (params != nullptr) ? *params : m_default_params;
+            assert(block.constants.size() == param_size());
+            std::copy(block.constants.begin(), block.constants.end(), dest);
+        }
+
+        // Sets up the material for the render pass, if the material is rendered in it.
+        // The graphics pipeline for the render pass is created according to \a creation. Pipelines
+        // that are created in the background are created on \a thread_pool.
         void set_render_pass(GlobalRenderPassIndex render_pass_index, const RenderPassDesc& desc,
-                             ConstantsBuffers& constants)
+                             PipelineCreation creation, ThreadPool* thread_pool)
         {
             // Check if this material is rendered in the render pass
             if (!khepri::case_insensitive_equals(desc.material_type, m_type)) {
@@ -349,16 +603,185 @@ class Renderer::Impl
                 m_render_pass_data.resize(render_pass_index + 1);
             }
 
+            RenderPassData data;
+            data.used    = true;
+            data.options = combine_options(desc.default_graphics_pipeline_options,
+                                           m_graphics_pipeline_options);
+            switch (creation) {
+            case PipelineCreation::immediate:
+                data.pipeline = create_pipeline(*m_pipeline_source, data.options);
+                break;
+            case PipelineCreation::background: {
+                assert(thread_pool != nullptr);
+                // The task shares the pipeline source, so it can outlive this material
+                auto promise          = std::make_shared<std::promise<Pipeline>>();
+                data.pending_pipeline = promise->get_future();
+                thread_pool->submit(
+                    [source = m_pipeline_source, options = data.options, promise] {
+                        try {
+                            promise->set_value(create_pipeline(*source, options));
+                        } catch (...) {
+                            promise->set_exception(std::current_exception());
+                        }
+                    });
+                break;
+            }
+            case PipelineCreation::lazy:
+                // Created by #pipeline when the material is first rendered in this render pass
+                break;
+            }
+            m_render_pass_data[render_pass_index] = std::move(data);
+        }
+
+        void clear_render_pass(GlobalRenderPassIndex render_pass_index)
+        {
+            if (render_pass_index < m_render_pass_data.size()) {
+                m_render_pass_data[render_pass_index] = {};
+            }
+        }
+
+        // Checks if this material is used during this render pass
+        bool is_used(GlobalRenderPassIndex render_pass_index) const noexcept
+        {
+            return render_pass_index < m_render_pass_data.size() &&
+                   m_render_pass_data[render_pass_index].used;
+        }
+
+        // Activates the material for the given render pass on the context with specified
+        // parameters. See #set_params for the constants buffer.
+        void set_active(GlobalRenderPassIndex render_pass_index, IDeviceContext& context,
+                        const ParamBlock* params, IBuffer* constants_buffer,
+                        std::optional<std::size_t> constants_offset,
+                        IBuffer&                   directional_lights_buffer) const
+        {
+            set_pipeline_state(render_pass_index, context);
+            set_params(render_pass_index, context, params, constants_buffer, constants_offset,
+                       directional_lights_buffer);
+        }
+
+        // Sets the material's pipeline state for the given render pass on the context.
+        // Follow this with a call to #set_params.
+        void set_pipeline_state(GlobalRenderPassIndex render_pass_index,
+                                IDeviceContext&       context) const
+        {
+            if (const auto* pipeline = get_pipeline(render_pass_index)) {
+                context.SetPipelineState(pipeline->pipeline_state);
+            }
+        }
+
+        // Applies and commits the material's parameters for the given render pass on the context.
+        // If \a params is null, the material's defaults are used.
+        // The material's pipeline state for this render pass must be active.
+        // The material's constants must have been written with #write_params to \a
+        // constants_buffer at \a constants_offset, unless #param_size is zero. If
+        // \a constants_offset is std::nullopt, the constants are at the start of the buffer and
+        // the whole buffer is bound, for devices that can't bind constant buffer ranges.
+        void set_params(GlobalRenderPassIndex render_pass_index, IDeviceContext& context,
+                        const ParamBlock* params, IBuffer* constants_buffer,
+                        std::optional<std::size_t> constants_offset,
+                        IBuffer&                   directional_lights_buffer) const
+        {
+            if (const auto* pipeline = get_pipeline(render_pass_index)) {
+                const auto& block = (params != nullptr) ? *params : m_default_params;
+                assert(block.textures.size() == pipeline->textures.size());
+                for (std::size_t i = 0; i < block.textures.size(); ++i) {
+                    // Textures have been validated by compile_params
+                    if (const auto* texture = static_cast<const Texture*>(block.textures[i])) {
+                        for (auto* var : pipeline->textures[i]) {
+                            if (var != nullptr) {
+                                var->Set(texture->shader_view);
+                            }
+                        }
+                    }
+                }
+
+                if (param_size() > 0) {
+                    assert(constants_buffer != nullptr);
+                    for (auto* var : pipeline->material_constants) {
+                        if (var != nullptr && constants_offset) {
+                            var->SetBufferRange(constants_buffer, *constants_offset, param_size());
+                        } else if (var != nullptr) {
+                            var->Set(constants_buffer);
+                        }
+                    }
+                }
+
+                for (auto* var : pipeline->directional_lights) {
+                    if (var != nullptr) {
+                        var->Set(&directional_lights_buffer);
+                    }
+                }
+
+                context.CommitShaderResources(pipeline->shader_resource_binding,
+                                              RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            }
+        }
+
+    private:
+        // A shader variable in the vertex and pixel shader (null if the shader doesn't use it)
+        using ShaderVariables = std::array<IShaderResourceVariable*, 2>;
+
+        // Everything needed to create the material's graphics pipelines. This is shared with
+        // pipeline creation tasks on worker threads, so it must not change after construction.
+        struct PipelineSource
+        {
+            RefCntPtr<IRenderDevice> device;
+            RefCntPtr<IBuffer>       view_constants;
+            TEXTURE_FORMAT           color_format{};
+            TEXTURE_FORMAT           depth_format{};
+            VertexFormat             vertex_format{};
+
+            // The material's original shader
+            Shader shader;
+            // Names of variables in the shaders that are dynamic (can change on every render)
+            std::vector<std::string> dynamic_variables;
+            // Names of the material's texture properties, in order
+            std::vector<std::string> texture_names;
+        };
+
+        // A graphics pipeline for a render pass/material combo
+        struct Pipeline
+        {
+            RefCntPtr<IPipelineState>         pipeline_state;
+            RefCntPtr<IShaderResourceBinding> shader_resource_binding;
+
+            // The dynamic variables of the shader resource binding. The texture variables are in
+            // order of the material's texture properties.
+            ShaderVariables              material_constants{};
+            ShaderVariables              directional_lights{};
+            std::vector<ShaderVariables> textures;
+        };
+
+        // Data for this material for a particular render pass.
+        // The indices for render passes are shared by all materials and managed by the renderer,
+        // not here.
+        struct RenderPassData
+        {
+            // Set if this material is rendered in this render pass
+            bool used{false};
+
+            // The graphics pipeline options for this render pass/material combo
+            GraphicsPipelineOptions options;
+
+            // The graphics pipeline, once it has been created
+            std::optional<Pipeline> pipeline;
+
+            // The graphics pipeline being created on a worker thread, if any
+            std::future<Pipeline> pending_pipeline;
+        };
+
+        // Creates a graphics pipeline. This can be called from any thread if the backend supports
+        // it, because it only accesses \a source.
+        static Pipeline create_pipeline(const PipelineSource&          source,
+                                        const GraphicsPipelineOptions& options)
+        {
             GraphicsPipelineStateCreateInfo ci;
             ci.PSODesc.PipelineType              = PIPELINE_TYPE_GRAPHICS;
             ci.GraphicsPipeline.NumRenderTargets = 1;
-            ci.GraphicsPipeline.RTVFormats[0]    = m_swapchain.GetDesc().ColorBufferFormat;
-            ci.GraphicsPipeline.DSVFormat        = m_swapchain.GetDesc().DepthBufferFormat;
-
-            const auto combined_options = combine_options(desc.default_graphics_pipeline_options,
-                                                          m_graphics_pipeline_options);
+            ci.GraphicsPipeline.RTVFormats[0]    = source.color_format;
+            ci.GraphicsPipeline.DSVFormat        = source.depth_format;
 
-            switch (*combined_options.alpha_blend_mode) {
+            switch (*options.alpha_blend_mode) {
             case GraphicsPipelineOptions::AlphaBlendMode::additive:
                 ci.GraphicsPipeline.BlendDesc.RenderTargets[0].BlendEnable = true;
                 ci.GraphicsPipeline.BlendDesc.RenderTargets[0].SrcBlend    = BLEND_FACTOR_ONE;
@@ -377,46 +800,29 @@ class Renderer::Impl
                 break;
             }
 
-            ci.GraphicsPipeline.DepthStencilDesc.DepthEnable = *combined_options.depth_enable;
-            ci.GraphicsPipeline.DepthStencilDesc.DepthWriteEnable =
-                *combined_options.depth_write_enable;
+            ci.GraphicsPipeline.DepthStencilDesc.DepthEnable      = *options.depth_enable;
+            ci.GraphicsPipeline.DepthStencilDesc.DepthWriteEnable = *options.depth_write_enable;
             ci.GraphicsPipeline.DepthStencilDesc.DepthFunc =
-                to_comparison_func(*combined_options.depth_comparison_func);
-            ci.GraphicsPipeline.RasterizerDesc.CullMode = to_cull_mode(*combined_options.cull_mode);
+                to_comparison_func(*options.depth_comparison_func);
+            ci.GraphicsPipeline.RasterizerDesc.CullMode = to_cull_mode(*options.cull_mode);
             ci.GraphicsPipeline.RasterizerDesc.FrontCounterClockwise = true;
 
-            static_assert(sizeof(MeshDesc::Vertex) < std::numeric_limits<Uint32>::max(),
-                          "Vertex is too large");
-
-            constexpr auto                                 num_layout_elements = 6;
-            std::array<LayoutElement, num_layout_elements> layout{
-                LayoutElement{0, 0, 3, VT_FLOAT32, false,
-                              static_cast<Uint32>(offsetof(MeshDesc::Vertex, position)),
-                              static_cast<Uint32>(sizeof(MeshDesc::Vertex))},
-                LayoutElement{1, 0, 3, VT_FLOAT32, false,
-                              static_cast<Uint32>(offsetof(MeshDesc::Vertex, normal)),
-                              static_cast<Uint32>(sizeof(MeshDesc::Vertex))},
-                LayoutElement{2, 0, 3, VT_FLOAT32, false,
-                              static_cast<Uint32>(offsetof(MeshDesc::Vertex, tangent)),
-                              static_cast<Uint32>(sizeof(MeshDesc::Vertex))},
-                LayoutElement{3, 0, 3, VT_FLOAT32, false,
-                              static_cast<Uint32>(offsetof(MeshDesc::Vertex, binormal)),
-                              static_cast<Uint32>(sizeof(MeshDesc::Vertex))},
-                LayoutElement{4, 0, 2, VT_FLOAT32, false,
-                              static_cast<Uint32>(offsetof(MeshDesc::Vertex, uv)),
-                              static_cast<Uint32>(sizeof(MeshDesc::Vertex))},
-                LayoutElement{5, 0, 4, VT_FLOAT32, false,
-                              static_cast<Uint32>(offsetof(MeshDesc::Vertex, color)),
-                              static_cast<Uint32>(sizeof(MeshDesc::Vertex))}};
+            const auto layout = vertex_layout(source.vertex_format);
             ci.GraphicsPipeline.InputLayout.LayoutElements = layout.data();
             ci.GraphicsPipeline.InputLayout.NumElements    = static_cast<Uint32>(layout.size());
 
-            ci.pPS = m_shader.pixel_shader;
-            ci.pVS = m_shader.vertex_shader;
+            ci.pPS = source.shader.pixel_shader;
+            ci.pVS = source.shader.vertex_shader;
 
-            // Mark all material properties as dynamic (the rest is static by default)
+            // Mark all material properties as dynamic (the rest is static by default).
+            // The material constants are dynamic as well, because every draw call binds a
+            // different range of the renderer's constants buffer.
             std::vector<ShaderResourceVariableDesc> variables;
-            for (const auto& var : m_dynamic_variables) {
+            variables.emplace_back(SHADER_TYPE_VERTEX, "Material",
+                                   SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC);
+            variables.emplace_back(SHADER_TYPE_PIXEL, "Material",
+                                   SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC);
+            for (const auto& var : source.dynamic_variables) {
                 variables.emplace_back(SHADER_TYPE_VERTEX, var.c_str(),
                                        SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC);
                 variables.emplace_back(SHADER_TYPE_PIXEL, var.c_str(),
@@ -426,136 +832,61 @@ class Renderer::Impl
             ci.PSODesc.ResourceLayout.Variables    = variables.data();
             ci.PSODesc.ResourceLayout.NumVariables = static_cast<Uint32>(variables.size());
 
-            RenderPassData data;
-            m_device.CreateGraphicsPipelineState(ci, &data.pipeline);
+            Pipeline pipeline;
+            source.device->CreateGraphicsPipelineState(ci, &pipeline.pipeline_state);
+            if (!pipeline.pipeline_state) {
+                throw khepri::renderer::Error("Failed to create graphics pipeline");
+            }
 
             const auto& set_variable = [&](const char* name, IDeviceObject* object) {
-                if (auto* var = data.pipeline->GetStaticVariableByName(SHADER_TYPE_VERTEX, name)) {
+                auto& pso = *pipeline.pipeline_state;
+                if (auto* var = pso.GetStaticVariableByName(SHADER_TYPE_VERTEX, name)) {
                     var->Set(object);
                 }
-                if (auto* var = data.pipeline->GetStaticVariableByName(SHADER_TYPE_PIXEL, name)) {
+                if (auto* var = pso.GetStaticVariableByName(SHADER_TYPE_PIXEL, name)) {
                     var->Set(object);
                 }
             };
 
-            set_variable("InstanceConstants", constants.instance);
-            set_variable("ViewConstants", constants.view);
-
-            data.pipeline->CreateShaderResourceBinding(&data.shader_resource_binding, true);
+            set_variable("ViewConstants", source.view_constants);
 
-            m_render_pass_data[render_pass_index] = std::move(data);
-        }
+            pipeline.pipeline_state->CreateShaderResourceBinding(&pipeline.shader_resource_binding,
+                                                                 true);
 
-        void clear_render_pass(GlobalRenderPassIndex render_pass_index)
-        {
-            if (render_pass_index < m_render_pass_data.size()) {
-                m_render_pass_data[render_pass_index] = {};
+            // Look up the dynamic variables once, so they can be set without name lookups
+            const auto& get_variables = [&](const char* name) {
+                auto& srb = *pipeline.shader_resource_binding;
+                return ShaderVariables{srb.GetVariableByName(SHADER_TYPE_VERTEX, name),
+                                       srb.GetVariableByName(SHADER_TYPE_PIXEL, name)};
+            };
+            pipeline.material_constants = get_variables("Material");
+            pipeline.directional_lights = get_variables("DirectionalLightConstants");
+            for (const auto& name : source.texture_names) {
+                pipeline.textures.push_back(get_variables(name.c_str()));
             }
+            return pipeline;
         }
 
-        // Checks if this material is used during this render pass
-        bool is_used(GlobalRenderPassIndex render_pass_index) const noexcept
+        // Returns the graphics pipeline for the render pass, or null if this material is not
+        // rendered in it. A pipeline that is still being created is waited for, and a pipeline
+        // that is created lazily is created now.
+        const Pipeline* get_pipeline(GlobalRenderPassIndex render_pass_index) const
         {
-            return render_pass_index < m_render_pass_data.size() &&
-                   m_render_pass_data[render_pass_index].pipeline;
-        }
-
-        // Activates the material for the given render pass on the context with specified
-        // parameters.
-        void set_active(GlobalRenderPassIndex render_pass_index, IDeviceContext& context,
-                        gsl::span<const khepri::renderer::Material::Param> params,
-                        IBuffer& directional_lights_buffer) const
-        {
-            if (render_pass_index < m_render_pass_data.size()) {
-                if (auto& data = m_render_pass_data[render_pass_index]; data.pipeline) {
-                    context.SetPipelineState(data.pipeline);
-
-                    apply_material_params(data, context, params);
-
-                    set_variable(data, "DirectionalLightConstants", &directional_lights_buffer);
-
-                    context.CommitShaderResources(data.shader_resource_binding,
-                                                  RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-                }
+            if (!is_used(render_pass_index)) {
+                return nullptr;
             }
-        }
-
-    private:
-        struct Param
-        {
-            std::string                                   name;
-            khepri::renderer::MaterialDesc::PropertyValue default_value;
-            size_t                                        buffer_offset;
-        };
 
-        // Data for this material for a particular render pass.
-        // The indices for render passes are shared by all materials and managed by the renderer,
-        // not here.
-        struct RenderPassData
-        {
-            // The graphics pipeline for this render pass/material combo.
-            // Not set if this material is not renderer in this render pass.
-            RefCntPtr<IPipelineState> pipeline;
-
-            RefCntPtr<IShaderResourceBinding> shader_resource_binding;
-        };
-
-        void apply_material_params(const RenderPassData& data, IDeviceContext& context,
-                                   gsl::span<const khepri::renderer::Material::Param> params) const
-        {
-            std::optional<MapHelper<std::uint8_t>> map_helper;
-            if (m_param_buffer != nullptr) {
-                map_helper =
-                    MapHelper<std::uint8_t>(&context, m_param_buffer, MAP_WRITE, MAP_FLAG_DISCARD);
-            }
-
-            for (const auto& param : m_params) {
-                // Use the value from the provided params if it exists, otherwise the material's
-                // default
-                const auto* const it =
-                    std::find_if(params.begin(), params.end(),
-                                 [&](const auto& p) { return p.name == param.name; });
-                const auto& value = (it != params.end()) ? it->value : param.default_value;
-
-                std::visit(
-                    Overloaded{[&](const khepri::renderer::Texture* value) {
-                                   auto* texture = dynamic_cast<const Texture*>(value);
-                                   if (texture != nullptr) {
-                                       set_variable(data, param.name.c_str(), texture->shader_view);
-                                   }
-                               },
-                               [&](const auto& value) {
-                                   if (map_helper) {
-                                       // NOLINTBEGIN - pointer arithmetic and reinterpret_cast
-                                       auto* param_data = static_cast<std::uint8_t*>(*map_helper) +
-                                                          param.buffer_offset;
-                                       *reinterpret_cast<std::decay_t<decltype(value)>*>(
-                                           param_data) = value;
-                                       // NOLINTEND
-                                   }
-                               }},
-                    value);
-            }
-
-            if (m_param_buffer != nullptr) {
-                set_variable(data, "Material", m_param_buffer);
+            auto& data = m_render_pass_data[render_pass_index];
+            if (!data.pipeline) {
+                data.pipeline = data.pending_pipeline.valid()
+                                    ? data.pending_pipeline.get()
+                                    : create_pipeline(*m_pipeline_source, data.options);
             }
+            return &*data.pipeline;
         }
 
-        void set_variable(const RenderPassData& data, const char* name, IDeviceObject* object) const
-        {
-            auto& srb = *data.shader_resource_binding;
-            if (auto* var = srb.GetVariableByName(SHADER_TYPE_VERTEX, name)) {
-                var->Set(object);
-            }
-            if (auto* var = srb.GetVariableByName(SHADER_TYPE_PIXEL, name)) {
-                var->Set(object);
-            }
-        }
-
-        IRenderDevice&                 m_device;
-        ISwapChain&                    m_swapchain;
         std::function<void(Material&)> m_destroy_callback;
+        std::uint32_t                  m_id;
 
         //
         // The material's original data (as specified in the material description)
@@ -571,17 +902,17 @@ class Renderer::Impl
         // The material's graphics pipeline options
         GraphicsPipelineOptions m_graphics_pipeline_options;
 
-        // The material's original shader
-        Shader m_shader;
-        // Names of variables in the shaders that are dynamic (can change on every render)
-        std::vector<std::string> m_dynamic_variables;
+        // What the material's graphics pipelines are created from
+        std::shared_ptr<const PipelineSource> m_pipeline_source;
 
-        // The graphics pipelines for each render pass in each render pipeline
-        std::vector<RenderPassData> m_render_pass_data;
+        // The graphics pipelines for each render pass in each render pipeline.
+        // Mutable, because pipelines can be created when they're first used.
+        mutable std::vector<RenderPassData> m_render_pass_data;
 
-        // Buffer for the material's parameters
-        RefCntPtr<IBuffer> m_param_buffer;
-        std::vector<Param> m_params;
+        // The material's properties, their layout in the constants buffer and their defaults
+        std::vector<MaterialDesc::Property> m_properties;
+        detail::MaterialParamLayout         m_param_layout;
+        ParamBlock                          m_default_params;
     };
 
     struct Texture : public khepri::renderer::Texture
@@ -618,8 +949,14 @@ class Renderer::Impl
     };
 
 public:
-    Impl(const std::any& window, ColorSpace color_space)
+    Impl(const std::any& window, ColorSpace color_space,
+         const std::filesystem::path& shader_cache_path, VertexFormat vertex_format)
+        : m_vertex_format(vertex_format)
     {
+        if (!shader_cache_path.empty()) {
+            m_shader_cache.emplace(shader_cache_path);
+        }
+
         SetDebugMessageCallback(diligent_debug_message_callback);
         const auto native_window = get_native_window(window);
 
@@ -659,17 +996,26 @@ public:
             throw khepri::renderer::Error("Failed to create renderer");
         }
 
-        // Create constants buffers for vertex shader
+        // Create the fence that signals the end of every frame on the GPU
         {
-            BufferDesc desc;
-            desc.Name           = "VS Instance Constants";
-            desc.Size           = sizeof(InstanceConstantBuffer);
-            desc.Usage          = USAGE_DYNAMIC;
-            desc.BindFlags      = BIND_UNIFORM_BUFFER;
-            desc.CPUAccessFlags = CPU_ACCESS_WRITE;
-            m_device->CreateBuffer(desc, nullptr, &m_constants.instance);
+            FenceDesc desc;
+            desc.Name = "Frame Fence";
+            desc.Type = FENCE_TYPE_CPU_WAIT_ONLY;
+            m_device->CreateFence(desc, &m_frame_fence);
+            if (m_frame_fence == nullptr) {
+                throw khepri::renderer::Error("Failed to create frame fence");
+            }
+        }
+
+        // Without constant buffer ranges, every material parameter change gets its own copy of
+        // the material constants buffer
+        m_constant_buffer_ranges = supports_constant_buffer_ranges(m_device->GetDeviceInfo());
+        m_material_constants.set_discard_mode(!m_constant_buffer_ranges);
+        if (!m_constant_buffer_ranges) {
+            LOG.info("constant buffer ranges are not supported; discarding material constants");
         }
 
+        // Create constants buffers for vertex shader
         {
             BufferDesc desc;
             desc.Name           = "VS View Constants";
@@ -685,7 +1031,7 @@ public:
             const BufferData buffer_data{};
             BufferDesc       desc;
             desc.Size           = static_cast<Uint32>(SPRITE_BUFFER_COUNT * VERTICES_PER_SPRITE *
-                                                      sizeof(SpriteVertex));
+                                                      vertex_size(m_vertex_format));
             desc.BindFlags      = BIND_VERTEX_BUFFER;
             desc.Usage          = USAGE_DYNAMIC;
             desc.CPUAccessFlags = CPU_ACCESS_WRITE;
@@ -716,6 +1062,19 @@ public:
             desc.Usage     = USAGE_IMMUTABLE;
             m_device->CreateBuffer(desc, &bufdata, &m_sprite_index_buffer);
         }
+
+        {
+            // Sprites are rendered as a single instance with an identity transformation
+            const InstanceData instance{Matrixf::IDENTITY, Matrixf::IDENTITY};
+            const BufferData   bufdata{&instance, sizeof(instance)};
+            BufferDesc         desc;
+            desc.Size      = bufdata.DataSize;
+            desc.BindFlags = BIND_VERTEX_BUFFER;
+            desc.Usage     = USAGE_IMMUTABLE;
+            m_device->CreateBuffer(desc, &bufdata, &m_sprite_instance_buffer);
+        }
+
+        pipeline_creation(PipelineCreation::background);
     }
 
     Impl(const Impl&)            = delete;
@@ -736,10 +1095,34 @@ public:
         return {desc.Width, desc.Height};
     }
 
+    void pipeline_creation(PipelineCreation mode)
+    {
+        if (mode == PipelineCreation::background && m_device->GetDeviceInfo().IsGLDevice()) {
+            // OpenGL objects can only be created on the thread that owns the GL context
+            mode = PipelineCreation::immediate;
+        }
+        if (mode == PipelineCreation::background && !m_pipeline_threads) {
+            m_pipeline_threads.emplace();
+        }
+        m_pipeline_creation = mode;
+    }
+
     [[nodiscard]] std::unique_ptr<Shader> create_shader(const std::filesystem::path& path,
                                                         const ShaderLoader&          loader)
     {
-        RefCntPtr<ShaderStreamFactory> factory(MakeNewRCObj<ShaderStreamFactory>()(loader));
+        // Provide the vertex format include file (see Renderer's constructor) to the shaders
+        const auto& vertex_format_loader =
+            [&](const std::filesystem::path& name) -> std::optional<ShaderDesc> {
+            if (name == VERTEX_FORMAT_INCLUDE) {
+                const std::string_view source = (m_vertex_format == VertexFormat::compact)
+                                                    ? "#define COMPACT_VERTICES 1\n"
+                                                    : "#define COMPACT_VERTICES 0\n";
+                return ShaderDesc({source.begin(), source.end()});
+            }
+            return loader(name);
+        };
+        RefCntPtr<ShaderStreamFactory> factory(
+            MakeNewRCObj<ShaderStreamFactory>()(vertex_format_loader));
 
         auto shader = std::make_unique<Shader>();
         shader->vertex_shader =
@@ -769,8 +1152,11 @@ public:
                                                static_cast<unsigned int>(mat.num_point_lights()));
         };
 
-        auto material =
-            std::make_unique<Material>(*m_device, *m_swapchain, material_desc, [=](auto& mat) {
+        auto material = std::make_unique<Material>(
+            *m_device, *m_swapchain, *m_constants.view, m_vertex_format, material_desc,
+            m_material_ids.allocate(), [=](auto& mat) {
+                m_material_ids.free(mat.id());
+
                 // Remove the destroyed material from the alive list, and update the max light count
                 // in the process.
                 m_max_directional_light_count = 0;
@@ -787,7 +1173,8 @@ public:
         // Set all existing render passes on the material
         for (GlobalRenderPassIndex i = 0; i < m_render_passes.size(); ++i) {
             if (m_render_passes[i]) {
-                material->set_render_pass(i, *m_render_passes[i], m_constants);
+                material->set_render_pass(i, *m_render_passes[i], m_pipeline_creation,
+                                          pipeline_threads());
             }
         }
 
@@ -880,32 +1267,27 @@ public:
 
     [[nodiscard]] std::unique_ptr<Mesh> create_mesh(const MeshDesc& mesh_desc)
     {
-        auto mesh         = std::make_unique<Mesh>();
-        mesh->index_count = static_cast<Mesh::Index>(mesh_desc.indices.size());
+        using Index = khepri::renderer::MeshDesc::Index;
 
-        {
-            using Vertex = khepri::renderer::MeshDesc::Vertex;
-            const BufferData bufdata{
-                mesh_desc.vertices.data(),
-                static_cast<Uint32>(mesh_desc.vertices.size() * sizeof(Vertex))};
-            BufferDesc desc;
-            desc.Size      = bufdata.DataSize;
-            desc.BindFlags = BIND_VERTEX_BUFFER;
-            desc.Usage     = USAGE_IMMUTABLE;
-            m_device->CreateBuffer(desc, &bufdata, &mesh->vertex_buffer);
+        auto        mesh       = std::make_unique<Mesh>(m_mesh_ids, m_mesh_allocator, mesh_desc);
+        const auto& allocation = mesh->allocation;
+        const auto& page       = mesh_page(allocation.page);
+
+        // Copy the mesh into its place in the page's buffers
+        if (!mesh_desc.vertices.empty()) {
+            const auto stride = vertex_size(m_vertex_format);
+            m_vertex_data.resize(mesh_desc.vertices.size() * stride);
+            write_vertices(m_vertex_format, mesh_desc.vertices, m_vertex_data.data());
+            m_context->UpdateBuffer(page.vertex_buffer, allocation.base_vertex * stride,
+                                    m_vertex_data.size(), m_vertex_data.data(),
+                                    RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
         }
-
-        {
-            const BufferData bufdata{
-                mesh_desc.indices.data(),
-                static_cast<Uint32>(mesh_desc.indices.size() * sizeof(MeshDesc::Index))};
-            BufferDesc desc;
-            desc.Size      = bufdata.DataSize;
-            desc.BindFlags = BIND_INDEX_BUFFER;
-            desc.Usage     = USAGE_IMMUTABLE;
-            m_device->CreateBuffer(desc, &bufdata, &mesh->index_buffer);
+        if (!mesh_desc.indices.empty()) {
+            m_context->UpdateBuffer(page.index_buffer, allocation.first_index * sizeof(Index),
+                                    mesh_desc.indices.size() * sizeof(Index),
+                                    mesh_desc.indices.data(),
+                                    RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
         }
-
         return mesh;
     }
 
@@ -944,7 +1326,8 @@ public:
         for (auto* const material : m_alive_materials) {
             for (std::size_t i = 0; i < render_pass_indices.size(); ++i) {
                 material->set_render_pass(render_pass_indices[i],
-                                          render_pipeline_desc.render_passes[i], m_constants);
+                                          render_pipeline_desc.render_passes[i],
+                                          m_pipeline_creation, pipeline_threads());
             }
         }
 
@@ -989,6 +1372,12 @@ public:
 
     void present()
     {
+        // The dynamic buffers can reuse this frame's data when the GPU has signaled the fence
+        ++m_frame_id;
+        m_material_constants.finish_frame(m_frame_id);
+        m_instances.finish_frame(m_frame_id);
+        m_context->EnqueueSignal(m_frame_fence, m_frame_id);
+
         m_swapchain->Present();
     }
 
@@ -1004,7 +1393,9 @@ public:
         for (const auto& mesh_info : meshes) {
             const auto* const material = dynamic_cast<const Material*>(mesh_info.material);
             const auto* const mesh     = dynamic_cast<const Mesh*>(mesh_info.mesh);
-            if (material == nullptr || mesh == nullptr) {
+            if (material == nullptr || mesh == nullptr ||
+                (mesh_info.material_params != nullptr &&
+                 mesh_info.material_params->material != material)) {
                 throw ArgumentError();
             }
         }
@@ -1024,82 +1415,144 @@ public:
             // Note that view space's Z axis (pointing from the camera into the scene) is the
             // *negative* Z axis. So we invert Z to get the the view distance, where larger is
             // further away.
-            return -(mesh_info.transform.get_translation() * camera.matrices().view_proj).z;
+            return -(mesh_info.transform.get_translation() * camera_matrices.view_proj).z;
         };
 
-        // Space to filter and sort meshes per render pass. Reserved once and reused.
-        std::vector<const MeshInstance*> render_pass_meshes;
-        render_pass_meshes.reserve(meshes.size());
-
-        // Execute all render passes, in order
-        for (const auto render_pass_index : pipeline->render_pass_indices()) {
-            // Collect the meshes for this render pass
-            render_pass_meshes.clear();
-            for (const auto& mesh_info : meshes) {
+        // Instances that share a mesh, material and material parameters are rendered with a
+        // single instanced draw call.
+        m_render_queue.build(
+            pipeline->render_pass_indices(), meshes,
+            [&](GlobalRenderPassIndex render_pass_index,
+                const MeshInstance&   mesh_info) -> std::optional<std::uint64_t> {
                 const auto* const material = static_cast<const Material*>(mesh_info.material);
-                if (material->is_used(render_pass_index)) {
-                    render_pass_meshes.push_back(&mesh_info);
+                if (!material->is_used(render_pass_index)) {
+                    return std::nullopt;
                 }
-            }
+                const auto* const mesh = static_cast<const Mesh*>(mesh_info.mesh);
+                return detail::render_sort_key(
+                    m_render_passes[render_pass_index]->depth_sorting, material->id(), mesh->id,
+                    [&] { return static_cast<float>(get_view_distance(mesh_info)); });
+            });
 
-            // Depth-sort the meshes if needed.
-            switch (m_render_passes[render_pass_index]->depth_sorting) {
-            default:
-                assert(false);
-                // Fall-through
-            case RenderPassDesc::DepthSorting::none:
-                // Nothing to do
-                break;
-            case RenderPassDesc::DepthSorting::front_to_back:
-                // Smaller distance gets rendered first
-                std::sort(render_pass_meshes.begin(), render_pass_meshes.end(),
-                          [&](const MeshInstance* lhs, const MeshInstance* rhs) {
-                              return get_view_distance(*lhs) < get_view_distance(*rhs);
-                          });
-                break;
-            case RenderPassDesc::DepthSorting::back_to_front:
-                // Larger distance gets rendered first
-                std::sort(render_pass_meshes.begin(), render_pass_meshes.end(),
-                          [&](const MeshInstance* lhs, const MeshInstance* rhs) {
-                              return get_view_distance(*lhs) > get_view_distance(*rhs);
-                          });
-                break;
+        const auto& instances = m_render_queue.instances();
+
+        if (instances.empty()) {
+            return;
+        }
+
+        // Upload the instance data of all draw calls at once
+        const auto instances_offset = m_instances.allocate(*m_device, *m_frame_fence,
+                                                           instances.size() * sizeof(InstanceData));
+        {
+            auto instances_map = m_instances.map(*m_context);
+            // NOLINTNEXTLINE - pointer arithmetic and reinterpret_cast
+            auto* instance_data = reinterpret_cast<InstanceData*>(
+                static_cast<std::uint8_t*>(instances_map) + instances_offset);
+            for (std::size_t i = 0; i < instances.size(); ++i) {
+                instance_data[i].world     = transpose(instances[i]->transform);
+                instance_data[i].world_inv = transpose(inverse(instances[i]->transform));
             }
+        }
 
-            // Now render the meshes in order
-            for (const auto* mesh_info : render_pass_meshes) {
-                auto* const material = static_cast<const Material*>(mesh_info->material);
-                auto* const mesh     = static_cast<const Mesh*>(mesh_info->mesh);
+        // Meshes in the same page share their vertex and index buffers
+        const auto& get_mesh_page = [](const khepri::renderer::Mesh& mesh) {
+            return static_cast<const Mesh&>(mesh).allocation.page;
+        };
 
-                assert(material->is_used(render_pass_index));
-                material->set_active(render_pass_index, *m_context, mesh_info->material_params,
-                                     *m_constants.directional_lights);
+        // Material parameters only need to be applied when they change between draw calls.
+        // Write the constants of all those changes at once, and remember where they are. Without
+        // constant buffer ranges, the constants are written when they are applied instead.
+        std::size_t constants_size = 0;
+        m_draw_constants_offsets.clear();
+        if (m_constant_buffer_ranges) {
+            m_render_queue.for_each_draw_call(get_mesh_page, [&](const auto& draw_call,
+                                                                 const auto& changes) {
+                if (changes.params) {
+                    const auto* material =
+                        static_cast<const Material*>(draw_call.mesh_info->material);
+                    m_draw_constants_offsets.push_back(constants_size);
+                    constants_size += detail::align_constants(material->param_size());
+                }
+            });
+        }
 
-                std::array<IBuffer*, 1> vertex_buffers{mesh->vertex_buffer};
-                m_context->SetVertexBuffers(
-                    0, static_cast<Uint32>(vertex_buffers.size()), vertex_buffers.data(), nullptr,
-                    RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
-                m_context->SetIndexBuffer(mesh->index_buffer, 0,
-                                          RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        if (constants_size > 0) {
+            const auto constants_offset =
+                m_material_constants.allocate(*m_device, *m_frame_fence, constants_size);
+            auto constants_map = m_material_constants.map(*m_context);
+            auto offset        = m_draw_constants_offsets.begin();
+            m_render_queue.for_each_draw_call(get_mesh_page, [&](const auto& draw_call,
+                                                                 const auto& changes) {
+                if (changes.params) {
+                    const auto& mesh_info = *draw_call.mesh_info;
+                    *offset += constants_offset;
+                    static_cast<const Material*>(mesh_info.material)
+                        ->write_params(mesh_info.material_params,
+                                       static_cast<std::uint8_t*>(constants_map) + *offset);
+                    ++offset;
+                }
+            });
+        }
 
-                // Set instance-specific constants
-                {
-                    MapHelper<InstanceConstantBuffer> constants(m_context, m_constants.instance,
-                                                                MAP_WRITE, MAP_FLAG_DISCARD);
-                    constants->world     = mesh_info->transform;
-                    constants->world_inv = inverse(mesh_info->transform);
+        // Now render the meshes in order, skipping state changes that are not needed
+        auto constants_offset = m_draw_constants_offsets.begin();
+        m_render_queue.for_each_draw_call(get_mesh_page, [&](const auto& draw_call,
+                                                             const auto& changes) {
+            auto* const material = static_cast<const Material*>(draw_call.mesh_info->material);
+            auto* const mesh     = static_cast<const Mesh*>(draw_call.mesh_info->mesh);
+            assert(material->is_used(draw_call.render_pass_index));
+
+            if (changes.pipeline) {
+                material->set_pipeline_state(draw_call.render_pass_index, *m_context);
+            }
+
+            if (changes.params) {
+                std::optional<std::size_t> offset;
+                if (m_constant_buffer_ranges) {
+                    offset = *constants_offset++;
+                } else {
+                    write_material_constants(*material, draw_call.mesh_info->material_params);
                 }
+                material->set_params(draw_call.render_pass_index, *m_context,
+                                     draw_call.mesh_info->material_params,
+                                     m_material_constants.buffer(), offset,
+                                     *m_constants.directional_lights);
+            }
 
-                static_assert(sizeof(Mesh::Index) == sizeof(std::uint16_t));
-                DrawIndexedAttribs draw_attribs;
-                draw_attribs.NumIndices = mesh->index_count;
-                draw_attribs.IndexType  = VT_UINT16;
+            // Meshes in the same page share their buffers, so only rebind on page changes
+            if (changes.mesh_buffers) {
+                const auto& page          = m_mesh_pages[mesh->allocation.page];
+                IBuffer*    vertex_buffer = page.vertex_buffer;
+                Uint64      vertex_offset = 0;
+                m_context->SetVertexBuffers(0, 1, &vertex_buffer, &vertex_offset,
+                                            RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                            SET_VERTEX_BUFFERS_FLAG_RESET);
+                m_context->SetIndexBuffer(page.index_buffer, 0,
+                                          RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            }
+
+            // Point the instance buffer at the draw call's instances, rather than using a first
+            // instance location: base instances need GL 4.2 (or ARB_base_instance), which not
+            // every OpenGL device supports.
+            IBuffer* instance_buffer = m_instances.buffer();
+            Uint64   instance_offset =
+                instances_offset + draw_call.first_instance * sizeof(InstanceData);
+            m_context->SetVertexBuffers(1, 1, &instance_buffer, &instance_offset,
+                                        RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                        SET_VERTEX_BUFFERS_FLAG_NONE);
+
+            static_assert(sizeof(Mesh::Index) == sizeof(std::uint16_t));
+            DrawIndexedAttribs draw_attribs;
+            draw_attribs.NumIndices         = static_cast<Uint32>(mesh->allocation.index_count);
+            draw_attribs.BaseVertex         = static_cast<Uint32>(mesh->allocation.base_vertex);
+            draw_attribs.FirstIndexLocation = static_cast<Uint32>(mesh->allocation.first_index);
+            draw_attribs.NumInstances       = static_cast<Uint32>(draw_call.instance_count);
+            draw_attribs.IndexType          = VT_UINT16;
 #ifndef NDEBUG
-                draw_attribs.Flags = DRAW_FLAG_VERIFY_ALL;
+            draw_attribs.Flags = DRAW_FLAG_VERIFY_ALL;
 #endif
-                m_context->DrawIndexed(draw_attribs);
-            }
-        }
+            m_context->DrawIndexed(draw_attribs);
+        });
     }
 
     void render_sprites(const khepri::renderer::RenderPipeline& render_pipeline,
@@ -1116,6 +1569,10 @@ public:
             throw ArgumentError();
         }
 
+        // The material parameters are the same in all render passes
+        const auto param_block      = mat->compile_params(params);
+        const auto constants_offset = write_material_constants(*mat, &param_block);
+
         // Execute all render passes, in order
         for (const auto render_pass_index : pipeline->render_pass_indices()) {
             if (!mat->is_used(render_pass_index)) {
@@ -1123,7 +1580,9 @@ public:
                 continue;
             }
 
-            mat->set_active(render_pass_index, *m_context, params, *m_constants.directional_lights);
+            mat->set_active(render_pass_index, *m_context, &param_block,
+                            m_material_constants.buffer(), constants_offset,
+                            *m_constants.directional_lights);
 
             std::size_t sprite_index = 0;
             while (sprite_index < sprites.size()) {
@@ -1131,15 +1590,10 @@ public:
                 const std::size_t sprite_count = std::min(sprites_left, SPRITE_BUFFER_COUNT);
 
                 {
-                    // Copy the vertex data
-                    MapHelper<SpriteVertex> vertices_map(m_context, m_sprite_vertex_buffer,
-                                                         MAP_WRITE, MAP_FLAG_DISCARD);
-
-                    const auto vertices = gsl::span<SpriteVertex>(
-                        vertices_map,
-                        m_sprite_vertex_buffer->GetDesc().Size / sizeof(SpriteVertex));
-
-                    for (std::size_t i = 0; i < sprite_count * VERTICES_PER_SPRITE;
+                    // Build the vertex data, then copy it in the renderer's vertex format
+                    auto& vertices = m_sprite_vertices;
+                    vertices.assign(sprite_count * VERTICES_PER_SPRITE, SpriteVertex{});
+                    for (std::size_t i = 0; i < vertices.size();
                          i += VERTICES_PER_SPRITE, ++sprite_index) {
                         const auto& sprite = sprites[sprite_index];
                         vertices[i + 0].position =
@@ -1158,11 +1612,17 @@ public:
                         vertices[i + 3].uv =
                             Vector2f(sprite.uv_top_left.x, sprite.uv_bottom_right.y);
                     }
+
+                    MapHelper<std::uint8_t> vertices_map(m_context, m_sprite_vertex_buffer,
+                                                         MAP_WRITE, MAP_FLAG_DISCARD);
+                    write_vertices(m_vertex_format, vertices, vertices_map);
                 }
 
-                m_context->SetVertexBuffers(0, 1, &m_sprite_vertex_buffer, nullptr,
-                                            RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
-                                            SET_VERTEX_BUFFERS_FLAG_RESET);
+                std::array<IBuffer*, 2> vertex_buffers{m_sprite_vertex_buffer,
+                                                       m_sprite_instance_buffer};
+                m_context->SetVertexBuffers(
+                    0, static_cast<Uint32>(vertex_buffers.size()), vertex_buffers.data(), nullptr,
+                    RESOURCE_STATE_TRANSITION_MODE_TRANSITION, SET_VERTEX_BUFFERS_FLAG_RESET);
 
                 m_context->SetIndexBuffer(m_sprite_index_buffer, 0,
                                           RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
@@ -1190,8 +1650,32 @@ private:
     // Number of sprites that fit in the sprite vertex/index buffers
     static constexpr std::size_t SPRITE_BUFFER_COUNT = 1024;
 
+    // Name of the include file that describes the vertex format to shaders
+    static constexpr std::string_view VERTEX_FORMAT_INCLUDE = "vertex_format.hlsli";
+
     using SpriteVertex = MeshDesc::Vertex;
 
+    // Writes a material's constants to the material constants buffer. Returns the offset to bind
+    // them at, or std::nullopt to bind the whole buffer (see Material::set_params).
+    std::optional<std::size_t> write_material_constants(const Material&             material,
+                                                        const Material::ParamBlock* params)
+    {
+        std::size_t offset = 0;
+        if (material.param_size() > 0) {
+            offset =
+                m_material_constants.allocate(*m_device, *m_frame_fence, material.param_size());
+            auto constants_map = m_material_constants.map(*m_context);
+            material.write_params(params, static_cast<std::uint8_t*>(constants_map) + offset);
+        }
+        return m_constant_buffer_ranges ? std::optional(offset) : std::nullopt;
+    }
+
+    // The worker threads for creating graphics pipelines in the background, if enabled
+    ThreadPool* pipeline_threads() noexcept
+    {
+        return m_pipeline_threads ? &*m_pipeline_threads : nullptr;
+    }
+
     RefCntPtr<IShader> create_shader_object(const std::string& path, ShaderStreamFactory& factory,
                                             SHADER_TYPE shader_type, const std::string& entrypoint)
     {
@@ -1215,6 +1699,44 @@ private:
         ci.Desc.UseCombinedTextureSamplers = true;
         ci.Desc.CombinedSamplerSuffix      = "Sampler";
 
+        // The cached result is the converted GLSL source for OpenGL, or the compiled bytecode
+        // otherwise. The key describes everything the result depends on, except the source files.
+        const auto cache_key =
+            fmt::format("{}|{}|{}|{}|{}", path, entrypoint, static_cast<int>(shader_type),
+                        using_shader_conversion() ? "glsl" : "bytecode", DILIGENT_API_VERSION);
+        if (m_shader_cache) {
+            const auto& hash_file = [&](const std::string& name) {
+                return factory.hash_file(name);
+            };
+            if (const auto data = m_shader_cache->find(cache_key, hash_file)) {
+                if (auto shader = create_cached_shader_object(ci, *data)) {
+                    return shader;
+                }
+                LOG.warning("Failed to create shader {} from cache, recompiling", path);
+            }
+        }
+
+        factory.clear_loaded_files();
+
+        RefCntPtr<IDataBlob> glsl_source;
+        if constexpr (using_shader_conversion()) {
+            if (m_shader_cache) {
+                // Convert the shader ourselves, so the converted source can be cached
+                const bool use_location_qualifiers =
+                    m_device->GetDeviceInfo().Features.SeparablePrograms ==
+                    DEVICE_FEATURE_STATE_ENABLED;
+                glsl_source = convert_to_glsl({}, path, factory, shader_type, entrypoint,
+                                              use_location_qualifiers);
+                if (glsl_source != nullptr) {
+                    const auto glsl   = blob_text(*glsl_source);
+                    ci.FilePath       = nullptr;
+                    ci.Source         = glsl.data();
+                    ci.SourceLength   = glsl.size();
+                    ci.SourceLanguage = SHADER_SOURCE_LANGUAGE_GLSL;
+                }
+            }
+        }
+
         RefCntPtr<IShader> shader;
         m_device->CreateShader(ci, &shader);
         if (shader == nullptr) {
@@ -1226,16 +1748,67 @@ private:
                 print_converted_glsl_source(std::move(conversion_stream), path, factory,
                                             shader_type, entrypoint);
             }
+            return shader;
+        }
+
+        if (m_shader_cache) {
+            if constexpr (using_shader_conversion()) {
+                if (glsl_source != nullptr) {
+                    const auto glsl = blob_text(*glsl_source);
+                    // NOLINTNEXTLINE - reinterpret_cast
+                    const auto* glsl_data = reinterpret_cast<const std::uint8_t*>(glsl.data());
+                    m_shader_cache->store(cache_key, factory.loaded_files(),
+                                          {glsl_data, glsl.size()});
+                }
+            } else {
+                const void* bytecode      = nullptr;
+                Uint64      bytecode_size = 0;
+                shader->GetBytecode(&bytecode, bytecode_size);
+                if (bytecode != nullptr) {
+                    m_shader_cache->store(cache_key, factory.loaded_files(),
+                                          {static_cast<const std::uint8_t*>(bytecode),
+                                           static_cast<std::size_t>(bytecode_size)});
+                }
+            }
         }
         return shader;
     }
 
-    static void print_converted_glsl_source(RefCntPtr<IHLSL2GLSLConversionStream> conversion_stream,
-                                            const std::string& path, ShaderStreamFactory& factory,
-                                            SHADER_TYPE shader_type, const std::string& entrypoint)
+    // Creates a shader from the result of a previous compilation, see #create_shader_object
+    RefCntPtr<IShader> create_cached_shader_object(ShaderCreateInfo                 ci,
+                                                   const std::vector<std::uint8_t>& data)
+    {
+        ci.FilePath           = nullptr;
+        ci.ppConversionStream = nullptr;
+        if constexpr (using_shader_conversion()) {
+            ci.Source         = reinterpret_cast<const char*>(data.data()); // NOLINT
+            ci.SourceLength   = data.size();
+            ci.SourceLanguage = SHADER_SOURCE_LANGUAGE_GLSL;
+        } else {
+            ci.ByteCode     = data.data();
+            ci.ByteCodeSize = data.size();
+        }
+
+        RefCntPtr<IShader> shader;
+        m_device->CreateShader(ci, &shader);
+        return shader;
+    }
+
+    // Returns the text in a data blob, without the terminating null character (if any)
+    static std::string_view blob_text(IDataBlob& blob)
+    {
+        const std::string_view text(static_cast<const char*>(blob.GetConstDataPtr()),
+                                    blob.GetSize());
+        return text.substr(0, text.find('\0'));
+    }
+
+    // Converts an HLSL shader to GLSL, using the conversion stream if provided
+    static RefCntPtr<IDataBlob>
+    convert_to_glsl(RefCntPtr<IHLSL2GLSLConversionStream> conversion_stream,
+                    const std::string& path, ShaderStreamFactory& factory, SHADER_TYPE shader_type,
+                    const std::string& entrypoint, bool use_location_qualifiers)
     {
         if (conversion_stream == nullptr) {
-            // If we didn't get a conversion stream, try to create one ourselves
             RefCntPtr<IHLSL2GLSLConverter> converter;
             CreateHLSL2GLSLConverter(&converter);
             converter->CreateStream(path.c_str(), &factory, nullptr, 0, &conversion_stream);
@@ -1243,10 +1816,19 @@ private:
 
         RefCntPtr<IDataBlob> glsl_source;
         if (conversion_stream != nullptr) {
-            conversion_stream->Convert(entrypoint.c_str(), shader_type, true, "Sampler", false,
-                                       &glsl_source);
+            conversion_stream->Convert(entrypoint.c_str(), shader_type, true, "Sampler",
+                                       use_location_qualifiers, &glsl_source);
         }
+        return glsl_source;
+    }
 
+    static void print_converted_glsl_source(RefCntPtr<IHLSL2GLSLConversionStream> conversion_stream,
+                                            const std::string& path, ShaderStreamFactory& factory,
+                                            SHADER_TYPE shader_type, const std::string& entrypoint)
+    {
+        // If we didn't get a conversion stream, this creates one ourselves
+        const auto glsl_source = convert_to_glsl(std::move(conversion_stream), path, factory,
+                                                 shader_type, entrypoint, false);
         if (glsl_source != nullptr) {
             const char* glsl = static_cast<const char*>(glsl_source->GetConstDataPtr());
             LOG.info("Converted GLSL source:");
@@ -1266,7 +1848,6 @@ private:
     {
         // Any top-level material property with the same name as these is an error
         const std::unordered_map<std::string, SHADER_RESOURCE_TYPE> predefined_variables{
-            {"InstanceConstants", SHADER_RESOURCE_TYPE_CONSTANT_BUFFER},
             {"ViewConstants", SHADER_RESOURCE_TYPE_CONSTANT_BUFFER},
             {"Material", SHADER_RESOURCE_TYPE_CONSTANT_BUFFER},
             {"DirectionalLightConstants", SHADER_RESOURCE_TYPE_CONSTANT_BUFFER},
@@ -1372,6 +1953,33 @@ private:
         }
     }
 
+    // Returns the buffers of a mesh allocator page, creating them for new pages
+    const MeshPage& mesh_page(std::size_t page_index)
+    {
+        while (m_mesh_pages.size() <= page_index) {
+            const auto index = m_mesh_pages.size();
+
+            MeshPage   page;
+            BufferDesc desc;
+            desc.Name      = "Mesh Vertices";
+            desc.Size = m_mesh_allocator.page_vertex_count(index) * vertex_size(m_vertex_format);
+            desc.BindFlags = BIND_VERTEX_BUFFER;
+            desc.Usage     = USAGE_DEFAULT;
+            m_device->CreateBuffer(desc, nullptr, &page.vertex_buffer);
+
+            desc.Name      = "Mesh Indices";
+            desc.Size      = m_mesh_allocator.page_index_count(index) * sizeof(MeshDesc::Index);
+            desc.BindFlags = BIND_INDEX_BUFFER;
+            m_device->CreateBuffer(desc, nullptr, &page.index_buffer);
+
+            if (page.vertex_buffer == nullptr || page.index_buffer == nullptr) {
+                throw khepri::renderer::Error("Failed to create mesh buffers");
+            }
+            m_mesh_pages.push_back(std::move(page));
+        }
+        return m_mesh_pages[page_index];
+    }
+
     void fill_directional_light_buffer(IBuffer&                              buffer,
                                        gsl::span<const DirectionalLightDesc> lights) const
     {
@@ -1402,10 +2010,43 @@ private:
     RefCntPtr<IDeviceContext> m_context;
     RefCntPtr<ISwapChain>     m_swapchain;
 
+    // The format of the vertices in the mesh and sprite vertex buffers
+    VertexFormat m_vertex_format;
+
+    // Compiled shaders from previous runs, if enabled
+    std::optional<ShaderCache> m_shader_cache;
+
     ConstantsBuffers m_constants;
 
     RefCntPtr<IBuffer> m_sprite_vertex_buffer;
     RefCntPtr<IBuffer> m_sprite_index_buffer;
+    RefCntPtr<IBuffer> m_sprite_instance_buffer;
+
+    // Reused for converting mesh and sprite vertices to the vertex format, to avoid allocations
+    std::vector<std::uint8_t> m_vertex_data;
+    std::vector<SpriteVertex> m_sprite_vertices;
+
+    // All meshes are packed into the vertex and index buffers of a few pages
+    detail::MeshAllocator m_mesh_allocator;
+    std::vector<MeshPage> m_mesh_pages;
+
+    // Signaled with the frame ID at the end of every frame
+    RefCntPtr<IFence> m_frame_fence;
+    std::uint64_t     m_frame_id{0};
+
+    // Per-frame material constants and per-instance data for instanced mesh rendering
+    DynamicBuffer m_material_constants{"Material Constants", BIND_UNIFORM_BUFFER,
+                                       MATERIAL_CONSTANTS_BUFFER_SIZE,
+                                       detail::CONSTANT_BUFFER_ALIGNMENT};
+    DynamicBuffer m_instances{"Mesh Instances", BIND_VERTEX_BUFFER, INSTANCE_BUFFER_SIZE,
+                              VERTEX_BUFFER_ALIGNMENT};
+
+    // Whether material constants can be bound as ranges of the material constants buffer
+    bool m_constant_buffer_ranges{true};
+
+    // Reused between calls to render_meshes, to avoid allocations
+    detail::RenderQueue      m_render_queue;
+    std::vector<std::size_t> m_draw_constants_offsets;
 
     // This is a non-owning set of all alive materials.
     // This is necessary for when new render pipelines are created. When that happens, all alive
@@ -1426,10 +2067,21 @@ private:
 
     // Currently active dynamic lighting
     DynamicLightDesc m_dynamic_light_desc{};
+
+    // IDs for alive materials and meshes
+    IdAllocator m_material_ids;
+    IdAllocator m_mesh_ids;
+
+    // When graphics pipelines of materials are created, and the worker threads that create them
+    // in the background. Destroyed first, so no pipeline is created while the renderer is being
+    // destroyed.
+    PipelineCreation          m_pipeline_creation{PipelineCreation::immediate};
+    std::optional<ThreadPool> m_pipeline_threads;
 };
 
-Renderer::Renderer(const std::any& window, ColorSpace color_space)
-    : m_impl(std::make_unique<Impl>(window, color_space))
+Renderer::Renderer(const std::any& window, ColorSpace color_space,
+                   const std::filesystem::path& shader_cache_path, VertexFormat vertex_format)
+    : m_impl(std::make_unique<Impl>(window, color_space, shader_cache_path, vertex_format))
 {
 }
 
@@ -1445,6 +2097,11 @@ Size Renderer::render_size() const noexcept
     return m_impl->render_size();
 }
 
+void Renderer::pipeline_creation(PipelineCreation mode)
+{
+    m_impl->pipeline_creation(mode);
+}
+
 std::unique_ptr<Shader> Renderer::create_shader(const std::filesystem::path& path,
                                                 const ShaderLoader&          loader)
 {
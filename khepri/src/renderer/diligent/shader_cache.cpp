@@ -0,0 +1,130 @@
+#include "shader_cache.hpp"
+
+#include <khepri/io/exceptions.hpp>
+#include <khepri/io/file.hpp>
+#include <khepri/log/log.hpp>
+
+#include <fmt/format.h>
+
+#include <exception>
+#include <system_error>
+#include <utility>
+
+namespace khepri::renderer::diligent {
+namespace {
+constexpr khepri::log::Logger LOG("shader_cache");
+
+// Identifies a cache entry file. Change the version when the format or contents of entries
+// change, to invalidate existing entries.
+constexpr std::uint32_t ENTRY_MAGIC   = 0x4348534B; // "KSHC"
+constexpr std::uint32_t ENTRY_VERSION = 1;
+} // namespace
+
+std::uint64_t hash_data(gsl::span<const std::uint8_t> data) noexcept
+{
+    constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    constexpr std::uint64_t FNV_PRIME        = 1099511628211ULL;
+
+    std::uint64_t hash = FNV_OFFSET_BASIS;
+    for (const auto byte : data) {
+        hash ^= byte;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+ShaderCache::ShaderCache(std::filesystem::path directory) : m_directory(std::move(directory))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+    if (ec) {
+        LOG.warning("unable to create shader cache directory \"{}\": {}", m_directory.string(),
+                    ec.message());
+        m_directory.clear();
+    }
+}
+
+std::filesystem::path ShaderCache::entry_path(const std::string& key) const
+{
+    const auto* const key_data = reinterpret_cast<const std::uint8_t*>(key.data()); // NOLINT
+    return m_directory / fmt::format("{:016x}.bin", hash_data({key_data, key.size()}));
+}
+
+std::optional<std::vector<std::uint8_t>>
+ShaderCache::find(const std::string& key, const DependencyHasher& hash_dependency) const
+{
+    if (m_directory.empty()) {
+        return {};
+    }
+
+    const auto path = entry_path(key);
+    if (!std::filesystem::exists(path)) {
+        return {};
+    }
+
+    try {
+        io::File file(path, io::OpenMode::read);
+        if (file.read_uint32() != ENTRY_MAGIC || file.read_uint32() != ENTRY_VERSION ||
+            file.read_string() != key) {
+            // Outdated entry, or a different key with the same hash
+            return {};
+        }
+
+        const auto dependency_count = file.read_uint32();
+        for (std::uint32_t i = 0; i < dependency_count; ++i) {
+            const auto name = file.read_string();
+            const auto hash = file.read_uint64();
+            if (hash_dependency(name) != hash) {
+                LOG.info("shader cache entry for \"{}\" is outdated: \"{}\" has changed", key,
+                         name);
+                return {};
+            }
+        }
+
+        std::vector<std::uint8_t> data(file.read_uint64());
+        if (file.read(data.data(), data.size()) != data.size()) {
+            throw io::InvalidFormatError();
+        }
+        return data;
+    } catch (const io::Error& e) {
+        LOG.warning("unable to read shader cache entry \"{}\": {}", path.string(), e.what());
+    }
+    return {};
+}
+
+void ShaderCache::store(const std::string& key, gsl::span<const Dependency> dependencies,
+                        gsl::span<const std::uint8_t> data) const
+{
+    if (m_directory.empty()) {
+        return;
+    }
+
+    // Write to a temporary file first, so an interrupted write never leaves a partial entry
+    const auto path      = entry_path(key);
+    auto       temp_path = path;
+    temp_path += ".tmp";
+    try {
+        {
+            io::File file(temp_path, io::OpenMode::read_write);
+            file.write_uint32(ENTRY_MAGIC);
+            file.write_uint32(ENTRY_VERSION);
+            file.write_string(key);
+            file.write_uint32(static_cast<std::uint32_t>(dependencies.size()));
+            for (const auto& dependency : dependencies) {
+                file.write_string(dependency.name);
+                file.write_uint64(dependency.hash);
+            }
+            file.write_uint64(data.size());
+            if (file.write(data.data(), data.size()) != data.size()) {
+                throw io::Error("write failed");
+            }
+        }
+        std::filesystem::rename(temp_path, path);
+    } catch (const std::exception& e) {
+        LOG.warning("unable to write shader cache entry \"{}\": {}", path.string(), e.what());
+        std::error_code ec;
+        std::filesystem::remove(temp_path, ec);
+    }
+}
+
+} // namespace khepri::renderer::diligent
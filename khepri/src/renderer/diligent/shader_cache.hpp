@@ -0,0 +1,57 @@
+#pragma once
+
+#include <gsl/gsl-lite.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace khepri::renderer::diligent {
+
+// Returns the 64-bit FNV-1a hash of a block of data
+std::uint64_t hash_data(gsl::span<const std::uint8_t> data) noexcept;
+
+// Persistent cache of shader compilation results, stored as files in a directory between runs.
+//
+// An entry is identified by a key that describes everything that determines the result, except
+// for the shader's source files (e.g. the shader path, entry point, compile options and backend).
+// Every entry also records the source files that were read to produce it, with a hash of their
+// contents. An entry is only used if all of those files are unchanged, so editing a shader or any
+// file it includes invalidates the entry.
+class ShaderCache
+{
+public:
+    // A source file that an entry depends on
+    struct Dependency
+    {
+        std::string   name;
+        std::uint64_t hash;
+    };
+
+    // Returns the hash of the current contents of a source file, or std::nullopt if it doesn't
+    // exist anymore
+    using DependencyHasher = std::function<std::optional<std::uint64_t>(const std::string& name)>;
+
+    // Creates a cache in \a directory, which is created if it doesn't exist.
+    // If the directory cannot be created, the cache is disabled.
+    explicit ShaderCache(std::filesystem::path directory);
+
+    // Returns the data of the entry with \a key if it exists and all its dependencies are unchanged
+    std::optional<std::vector<std::uint8_t>> find(const std::string&      key,
+                                                  const DependencyHasher& hash_dependency) const;
+
+    // Stores the data of the entry with \a key, replacing any existing entry.
+    // Failure to write the entry is logged, but is not an error.
+    void store(const std::string& key, gsl::span<const Dependency> dependencies,
+               gsl::span<const std::uint8_t> data) const;
+
+private:
+    std::filesystem::path entry_path(const std::string& key) const;
+
+    std::filesystem::path m_directory;
+};
+
+} // namespace khepri::renderer::diligent
@@ -1,11 +1,16 @@
 #pragma once
 
+#include "shader_cache.hpp"
+
 #include <khepri/renderer/renderer.hpp>
 
 #include <ObjectBase.hpp>
 #include <Shader.h>
 #include <cassert>
 #include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace khepri::renderer::diligent {
 
@@ -86,15 +91,39 @@ public:
     {
         assert(ppStream != nullptr);
         auto shader = m_loader(Name);
+        if (shader) {
+            m_loaded_files.push_back({Name, hash_data(shader->data())});
+        }
         *ppStream = (shader) ? Diligent::MakeNewRCObj<MemoryStream>()(std::move(*shader)) : nullptr;
     }
 
+    // Returns the hash of the current contents of a file, or std::nullopt if it can't be loaded
+    std::optional<std::uint64_t> hash_file(const std::string& name) const
+    {
+        if (auto shader = m_loader(name)) {
+            return hash_data(shader->data());
+        }
+        return {};
+    }
+
+    // Files that have been loaded through this factory, with the hash of their contents
+    const std::vector<ShaderCache::Dependency>& loaded_files() const noexcept
+    {
+        return m_loaded_files;
+    }
+
+    void clear_loaded_files() noexcept
+    {
+        m_loaded_files.clear();
+    }
+
     IMPLEMENT_QUERY_INTERFACE_IN_PLACE(
         Diligent::IID_IShaderSourceInputStreamFactory,
         Diligent::ObjectBase<Diligent::IShaderSourceInputStreamFactory>);
 
 private:
-    Renderer::ShaderLoader m_loader;
+    Renderer::ShaderLoader               m_loader;
+    std::vector<ShaderCache::Dependency> m_loaded_files;
 };
 
 } // namespace khepri::renderer::diligent
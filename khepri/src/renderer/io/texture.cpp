@@ -6,6 +6,8 @@ namespace khepri::renderer::io {
 // DirectDraw surface
 extern bool        is_texture_dds(khepri::io::Stream& stream);
 extern TextureDesc load_texture_dds(khepri::io::Stream& stream, const TextureLoadOptions& options);
+extern void        save_texture_dds(khepri::io::Stream& stream, const TextureDesc& texture_desc,
+                                    const TextureSaveOptions& options);
 
 // TrueVision TGA
 extern bool        is_texture_tga(khepri::io::Stream& stream);
@@ -56,6 +58,9 @@ void save_texture(khepri::io::Stream& stream, const TextureDesc& texture_desc,
     case TextureFormat::targa:
         save_texture_tga(stream, texture_desc, options);
         break;
+    case TextureFormat::dds:
+        save_texture_dds(stream, texture_desc, options);
+        break;
     default:
         throw ArgumentError();
     }
@@ -0,0 +1,127 @@
+#include <khepri/io/exceptions.hpp>
+#include <khepri/io/file.hpp>
+#include <khepri/io/span_stream.hpp>
+#include <khepri/log/log.hpp>
+#include <khepri/renderer/io/texture.hpp>
+#include <khepri/renderer/io/texture_cache.hpp>
+#include <khepri/utility/crc.hpp>
+
+#include <fmt/format.h>
+
+#include <exception>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace khepri::renderer::io {
+namespace {
+constexpr khepri::log::Logger LOG("texture_cache");
+
+// Identifies a cache entry file. Change the version when the format or contents of entries
+// change, to invalidate existing entries.
+constexpr std::uint32_t ENTRY_MAGIC   = 0x4358544B; // "KTXC"
+constexpr std::uint32_t ENTRY_VERSION = 2;
+
+std::uint32_t checksum(gsl::span<const std::uint8_t> data)
+{
+    const auto* const chars = reinterpret_cast<const char*>(data.data()); // NOLINT
+    return CRC32::calculate({chars, data.size()});
+}
+} // namespace
+
+TextureCache::TextureCache(std::filesystem::path directory) : m_directory(std::move(directory))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+    if (ec) {
+        LOG.warning("unable to create texture cache directory \"{}\": {}", m_directory.string(),
+                    ec.message());
+        m_directory.clear();
+    }
+}
+
+std::filesystem::path TextureCache::entry_path(const std::string& key) const
+{
+    return m_directory / fmt::format("{:08x}.bin", CRC32::calculate(key));
+}
+
+std::optional<TextureDesc> TextureCache::find(const std::string&            key,
+                                              gsl::span<const std::uint8_t> source) const
+{
+    if (m_directory.empty()) {
+        return {};
+    }
+
+    const auto path = entry_path(key);
+    if (!std::filesystem::exists(path)) {
+        return {};
+    }
+
+    try {
+        khepri::io::File file(path, khepri::io::OpenMode::read);
+        if (file.read_uint32() != ENTRY_MAGIC || file.read_uint32() != ENTRY_VERSION ||
+            file.read_string() != key) {
+            // Outdated entry, or a different key with the same hash
+            return {};
+        }
+
+        if (file.read_uint64() != source.size() || file.read_uint32() != checksum(source)) {
+            LOG.info("texture cache entry for \"{}\" is outdated", key);
+            return {};
+        }
+
+        const auto color_space = static_cast<ColorSpace>(file.read_uint8());
+
+        // The rest of the entry is the texture, as a DDS file
+        std::vector<std::uint8_t> data(file.read_uint64());
+        if (file.read(data.data(), data.size()) != data.size()) {
+            throw khepri::io::InvalidFormatError();
+        }
+        khepri::io::SpanStream stream(data);
+        return load_texture(stream, {color_space});
+    } catch (const khepri::io::Error& e) {
+        LOG.warning("unable to read texture cache entry \"{}\": {}", path.string(), e.what());
+    }
+    return {};
+}
+
+void TextureCache::store(const std::string& key, gsl::span<const std::uint8_t> source,
+                         const TextureDesc& texture_desc) const
+{
+    if (m_directory.empty()) {
+        return;
+    }
+
+    // Write to a temporary file first, so an interrupted write never leaves a partial entry
+    const auto path      = entry_path(key);
+    auto       temp_path = path;
+    temp_path += ".tmp";
+    try {
+        {
+            khepri::io::File file(temp_path, khepri::io::OpenMode::read_write);
+            file.write_uint32(ENTRY_MAGIC);
+            file.write_uint32(ENTRY_VERSION);
+            file.write_string(key);
+            file.write_uint64(source.size());
+            file.write_uint32(checksum(source));
+            file.write_uint8(static_cast<std::uint8_t>(color_space(texture_desc.pixel_format())));
+
+            // Reserve the texture's size, and fill it in once the texture has been written
+            const auto size_offset = file.seek(0, khepri::io::SeekOrigin::current);
+            file.write_uint64(0);
+            save_texture(file, texture_desc, {TextureFormat::dds});
+            const auto end = file.seek(0, khepri::io::SeekOrigin::current);
+            file.seek(size_offset, khepri::io::SeekOrigin::begin);
+            file.write_uint64(static_cast<std::uint64_t>(end - size_offset) -
+                              sizeof(std::uint64_t));
+        }
+        std::filesystem::rename(temp_path, path);
+    } catch (const std::exception& e) {
+        LOG.warning("unable to write texture cache entry \"{}\": {}", path.string(), e.what());
+        std::error_code ec;
+        std::filesystem::remove(temp_path, ec);
+    }
+}
+
+} // namespace khepri::renderer::io
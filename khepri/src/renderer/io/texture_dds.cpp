@@ -317,6 +317,37 @@ std::unique_ptr<PixelFormatHandler> pixel_format_handler(const DdsPixelFormat& d
     return {};
 }
 
+// Returns the pixel format description for saving a texture in the specified format
+std::optional<DdsPixelFormat> to_dds_pixel_format(PixelFormat format)
+{
+    constexpr auto RGBA_MASK_R = 0x000000ffUL;
+    constexpr auto RGBA_MASK_G = 0x0000ff00UL;
+    constexpr auto RGBA_MASK_B = 0x00ff0000UL;
+    constexpr auto RGBA_MASK_A = 0xff000000UL;
+
+    switch (format) {
+    case PixelFormat::r8g8b8a8_unorm:
+    case PixelFormat::r8g8b8a8_unorm_srgb:
+        return DdsPixelFormat{ddpf_rgb | ddpf_alphapixels, 0, 32, RGBA_MASK_R, RGBA_MASK_G,
+                              RGBA_MASK_B, RGBA_MASK_A};
+    case PixelFormat::b8g8r8a8_unorm:
+    case PixelFormat::b8g8r8a8_unorm_srgb:
+        return DdsPixelFormat{ddpf_rgb | ddpf_alphapixels, 0, 32, RGBA_MASK_B, RGBA_MASK_G,
+                              RGBA_MASK_R, RGBA_MASK_A};
+    case PixelFormat::bc1_unorm:
+    case PixelFormat::bc1_unorm_srgb:
+        return DdsPixelFormat{ddpf_fourcc, fourcc('D', 'X', 'T', '1'), 0, 0, 0, 0, 0};
+    case PixelFormat::bc2_unorm:
+    case PixelFormat::bc2_unorm_srgb:
+        return DdsPixelFormat{ddpf_fourcc, fourcc('D', 'X', 'T', '3'), 0, 0, 0, 0, 0};
+    case PixelFormat::bc3_unorm:
+    case PixelFormat::bc3_unorm_srgb:
+        return DdsPixelFormat{ddpf_fourcc, fourcc('D', 'X', 'T', '5'), 0, 0, 0, 0, 0};
+    default:
+        return {};
+    }
+}
+
 } // namespace
 
 bool is_texture_dds(khepri::io::Stream& stream)
@@ -459,4 +490,79 @@ TextureDesc load_texture_dds(khepri::io::Stream& stream, const TextureLoadOption
             std::move(data)};
 }
 
+void save_texture_dds(khepri::io::Stream& stream, const TextureDesc& texture_desc,
+                      const TextureSaveOptions& /*options*/)
+{
+    assert(stream.writable());
+
+    if (texture_desc.dimension() != TextureDimension::texture_2d ||
+        texture_desc.array_size() != 0) {
+        // Only plain 2D textures are supported
+        throw ArgumentError();
+    }
+
+    const auto ddpf = to_dds_pixel_format(texture_desc.pixel_format());
+    if (!ddpf) {
+        // Unsupported pixel format
+        throw ArgumentError();
+    }
+
+    // Note: the file doesn't store the texture's color space; it's decided when loading it (see
+    // TextureLoadOptions::default_color_space).
+    const auto& top_level  = texture_desc.subresource(0);
+    const bool  compressed = (ddpf->flags & ddpf_fourcc) != 0;
+    const auto  mip_levels = static_cast<std::uint32_t>(texture_desc.mip_levels());
+
+    std::uint32_t flags = DDS_REQUIRED_FLAGS | (compressed ? ddsf_linearsize : ddsf_pitch);
+    if (mip_levels > 1) {
+        flags |= ddsf_mipmapcount;
+    }
+
+    constexpr std::uint32_t ddscaps_complex = 0x8;
+    constexpr std::uint32_t ddscaps_texture = 0x1000;
+    constexpr std::uint32_t ddscaps_mipmap  = 0x400000;
+
+    stream.write_uint32(DDS_MAGIC);
+    stream.write_uint32(DDS_HEADER_SIZE);
+    stream.write_uint32(flags);
+    stream.write_uint32(static_cast<std::uint32_t>(texture_desc.height()));
+    stream.write_uint32(static_cast<std::uint32_t>(texture_desc.width()));
+    stream.write_uint32(
+        static_cast<std::uint32_t>(compressed ? top_level.data_size : top_level.stride));
+    stream.write_uint32(0); // Depth
+    stream.write_uint32(mip_levels);
+
+    // Reserved data
+    constexpr auto num_reserved_uints = 11;
+    for (int i = 0; i < num_reserved_uints; ++i) {
+        stream.write_uint32(0);
+    }
+
+    // Pixel format
+    stream.write_uint32(DDS_PIXELFORMAT_SIZE);
+    stream.write_uint32(ddpf->flags);
+    stream.write_uint32(ddpf->fourcc);
+    stream.write_uint32(ddpf->rgb_bitcount);
+    stream.write_uint32(ddpf->r_mask);
+    stream.write_uint32(ddpf->g_mask);
+    stream.write_uint32(ddpf->b_mask);
+    stream.write_uint32(ddpf->a_mask);
+
+    stream.write_uint32(ddscaps_texture |
+                        ((mip_levels > 1) ? (ddscaps_complex | ddscaps_mipmap) : 0));
+    stream.write_uint32(0); // Caps2
+    stream.write_uint32(0); // Caps3
+    stream.write_uint32(0); // Caps4
+    stream.write_uint32(0); // Reserved
+
+    for (std::size_t mip = 0; mip < mip_levels; ++mip) {
+        const auto& subresource = texture_desc.subresource(texture_desc.subresource_index(mip, 0));
+        const auto  data =
+            texture_desc.data().subspan(subresource.data_offset, subresource.data_size);
+        if (stream.write(data.data(), data.size()) != data.size()) {
+            throw khepri::io::Error("unable to write to stream");
+        }
+    }
+}
+
 } // namespace khepri::renderer::io
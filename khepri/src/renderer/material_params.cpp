@@ -0,0 +1,67 @@
+#include "material_params.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <variant>
+
+namespace khepri::renderer::detail {
+
+MaterialParamLayout layout_material_params(gsl::span<const MaterialDesc::Property> properties)
+{
+    constexpr std::size_t param_alignment = 16;
+
+    MaterialParamLayout layout;
+    layout.offsets.reserve(properties.size());
+    for (const auto& p : properties) {
+        // Every type has its own size, except for textures, which don't take up space.
+        const std::size_t property_size =
+            std::holds_alternative<const Texture*>(p.default_value)
+                ? 0
+                : std::visit([](const auto& value) { return sizeof(value); }, p.default_value);
+
+        const auto remaining_size = param_alignment - (layout.size % param_alignment);
+        if (property_size > remaining_size) {
+            // The next property doesn't fit in the remaining space in this alignment 'block'.
+            // Align parameter to multiple of 16 bytes.
+            layout.size = (layout.size + param_alignment - 1) / param_alignment * param_alignment;
+        }
+
+        layout.offsets.push_back(layout.size);
+        layout.size += property_size;
+    }
+    return layout;
+}
+
+Material::ParamBlock compile_material_params(const Material&                         material,
+                                             gsl::span<const MaterialDesc::Property> properties,
+                                             const MaterialParamLayout&              layout,
+                                             gsl::span<const Material::Param>        params)
+{
+    Material::ParamBlock block;
+    block.material = &material;
+    block.constants.resize(layout.size);
+    for (std::size_t i = 0; i < properties.size(); ++i) {
+        const auto& property = properties[i];
+
+        // Use the value from the provided params if it exists, otherwise the material's default
+        const auto* const it = std::find_if(params.begin(), params.end(), [&](const auto& p) {
+            return p.name == property.name && p.value.index() == property.default_value.index();
+        });
+        const auto& value = (it != params.end()) ? it->value : property.default_value;
+
+        std::visit(
+            [&](const auto& value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, const Texture*>) {
+                    block.textures.push_back(value);
+                } else {
+                    std::memcpy(&block.constants[layout.offsets[i]], &value, sizeof(T));
+                }
+            },
+            value);
+    }
+    return block;
+}
+
+} // namespace khepri::renderer::detail
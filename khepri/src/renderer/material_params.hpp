@@ -0,0 +1,45 @@
+#pragma once
+
+#include <khepri/renderer/material.hpp>
+#include <khepri/renderer/material_desc.hpp>
+
+#include <gsl/gsl-lite.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace khepri::renderer::detail {
+
+// Required alignment of offsets into constant buffers
+constexpr std::size_t CONSTANT_BUFFER_ALIGNMENT = 256;
+
+// Rounds a size of constants up to the alignment of constant buffer offsets
+constexpr std::size_t align_constants(std::size_t size) noexcept
+{
+    return (size + CONSTANT_BUFFER_ALIGNMENT - 1) & ~(CONSTANT_BUFFER_ALIGNMENT - 1);
+}
+
+// Layout of a material's non-texture properties in its constants buffer
+struct MaterialParamLayout
+{
+    // Offset in the buffer of every material property, in order of declaration.
+    // Textures don't take up space in the buffer.
+    std::vector<std::size_t> offsets;
+
+    // Total size of the buffer
+    std::size_t size{0};
+};
+
+// Determines the constants buffer layout for a material's properties.
+// Properties are packed in 16-byte blocks; a property that doesn't fit in the remainder of a block
+// starts at the next block.
+MaterialParamLayout layout_material_params(gsl::span<const MaterialDesc::Property> properties);
+
+// Resolves parameters by name into a parameter block for \a material, which has the specified
+// properties and layout. See Material::compile_params. Texture values are not validated.
+Material::ParamBlock compile_material_params(const Material&                         material,
+                                             gsl::span<const MaterialDesc::Property> properties,
+                                             const MaterialParamLayout&              layout,
+                                             gsl::span<const Material::Param>        params);
+
+} // namespace khepri::renderer::detail
@@ -0,0 +1,111 @@
+#include "mesh_allocator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace khepri::renderer::detail {
+
+RangeAllocator::RangeAllocator(std::size_t capacity) : m_capacity(capacity)
+{
+    if (capacity > 0) {
+        m_free_ranges.emplace(0, capacity);
+    }
+}
+
+std::optional<std::size_t> RangeAllocator::allocate(std::size_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+
+    const auto it = std::find_if(m_free_ranges.begin(), m_free_ranges.end(),
+                                 [&](const auto& range) { return range.second >= size; });
+    if (it == m_free_ranges.end()) {
+        return std::nullopt;
+    }
+
+    const auto [offset, range_size] = *it;
+    m_free_ranges.erase(it);
+    if (range_size > size) {
+        // Return the remainder of the range to the free-list
+        m_free_ranges.emplace(offset + size, range_size - size);
+    }
+    return offset;
+}
+
+void RangeAllocator::free(std::size_t offset, std::size_t size)
+{
+    if (size == 0) {
+        return;
+    }
+    assert(offset + size <= m_capacity);
+
+    auto next = m_free_ranges.lower_bound(offset);
+    assert(next == m_free_ranges.end() || next->first >= offset + size);
+
+    // Merge with the preceding free range, if adjacent
+    if (next != m_free_ranges.begin()) {
+        const auto prev = std::prev(next);
+        assert(prev->first + prev->second <= offset);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+            m_free_ranges.erase(prev);
+        }
+    }
+
+    // Merge with the following free range, if adjacent
+    if (next != m_free_ranges.end() && next->first == offset + size) {
+        size += next->second;
+        m_free_ranges.erase(next);
+    }
+
+    m_free_ranges.emplace(offset, size);
+}
+
+MeshAllocator::MeshAllocator(std::size_t page_vertex_count, std::size_t page_index_count)
+    : m_page_vertex_count(page_vertex_count), m_page_index_count(page_index_count)
+{
+}
+
+MeshAllocator::Allocation MeshAllocator::allocate(std::size_t vertex_count,
+                                                  std::size_t index_count)
+{
+    const auto& allocate_in_page = [&](std::size_t page_index) -> std::optional<Allocation> {
+        auto&      page        = m_pages[page_index];
+        const auto base_vertex = page.vertices.allocate(vertex_count);
+        if (!base_vertex) {
+            return std::nullopt;
+        }
+        const auto first_index = page.indices.allocate(index_count);
+        if (!first_index) {
+            page.vertices.free(*base_vertex, vertex_count);
+            return std::nullopt;
+        }
+        return Allocation{page_index, *base_vertex, vertex_count, *first_index, index_count};
+    };
+
+    for (std::size_t i = 0; i < m_pages.size(); ++i) {
+        if (const auto allocation = allocate_in_page(i)) {
+            return *allocation;
+        }
+    }
+
+    // No room in any page; add a page that is large enough for this mesh
+    m_pages.push_back({RangeAllocator(std::max(vertex_count, m_page_vertex_count)),
+                       RangeAllocator(std::max(index_count, m_page_index_count))});
+    const auto allocation = allocate_in_page(m_pages.size() - 1);
+    assert(allocation);
+    return *allocation;
+}
+
+void MeshAllocator::free(const Allocation& allocation)
+{
+    assert(allocation.page < m_pages.size());
+    auto& page = m_pages[allocation.page];
+    page.vertices.free(allocation.base_vertex, allocation.vertex_count);
+    page.indices.free(allocation.first_index, allocation.index_count);
+}
+
+} // namespace khepri::renderer::detail
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace khepri::renderer::detail {
+
+// Suballocates ranges of elements from a fixed-size range [0, capacity).
+// Free ranges are kept in a free-list ordered by offset. Allocation is first-fit, and freed ranges
+// are merged with adjacent free ranges to limit fragmentation.
+class RangeAllocator
+{
+public:
+    explicit RangeAllocator(std::size_t capacity);
+
+    std::size_t capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    // Allocates a range of \a size elements and returns its offset, or std::nullopt if there is no
+    // free range large enough. Empty ranges are always allocated at offset 0.
+    std::optional<std::size_t> allocate(std::size_t size);
+
+    // Frees a range that was returned by #allocate
+    void free(std::size_t offset, std::size_t size);
+
+private:
+    std::size_t m_capacity;
+
+    // Offset to size of every free range
+    std::map<std::size_t, std::size_t> m_free_ranges;
+};
+
+// Packs the vertices and indices of meshes into a few large vertex and index buffers ("pages"),
+// so that meshes can be drawn one after the other without binding other buffers.
+// This only tracks the allocations; the renderer owns the buffers of every page.
+class MeshAllocator
+{
+public:
+    // The location of a mesh's vertices and indices
+    struct Allocation
+    {
+        // Index of the page that holds the mesh
+        std::size_t page;
+
+        // Offset and size of the mesh in the page's vertex buffer, in vertices
+        std::size_t base_vertex;
+        std::size_t vertex_count;
+
+        // Offset and size of the mesh in the page's index buffer, in indices
+        std::size_t first_index;
+        std::size_t index_count;
+    };
+
+    // Default capacity of a page, in vertices and indices. For the standard vertex format, this is
+    // 5 MiB of vertices and 512 KiB of indices.
+    static constexpr std::size_t DEFAULT_PAGE_VERTEX_COUNT = 64 * 1024;
+    static constexpr std::size_t DEFAULT_PAGE_INDEX_COUNT  = 256 * 1024;
+
+    // Constructs the allocator with the default capacity of a page, in vertices and indices.
+    // Meshes that don't fit in a default page get a page of their own.
+    explicit MeshAllocator(std::size_t page_vertex_count = DEFAULT_PAGE_VERTEX_COUNT,
+                           std::size_t page_index_count  = DEFAULT_PAGE_INDEX_COUNT);
+
+    // Returns the number of pages. Pages are created by #allocate and never removed, so the
+    // renderer should create the buffers of a page when it sees a new page index.
+    std::size_t page_count() const noexcept
+    {
+        return m_pages.size();
+    }
+
+    // Returns the capacity of a page's vertex buffer, in vertices
+    std::size_t page_vertex_count(std::size_t page) const noexcept
+    {
+        return m_pages[page].vertices.capacity();
+    }
+
+    // Returns the capacity of a page's index buffer, in indices
+    std::size_t page_index_count(std::size_t page) const noexcept
+    {
+        return m_pages[page].indices.capacity();
+    }
+
+    // Allocates space for a mesh, in an existing page if possible
+    Allocation allocate(std::size_t vertex_count, std::size_t index_count);
+
+    // Frees the space of a mesh that was returned by #allocate
+    void free(const Allocation& allocation);
+
+private:
+    struct Page
+    {
+        RangeAllocator vertices;
+        RangeAllocator indices;
+    };
+
+    std::size_t       m_page_vertex_count;
+    std::size_t       m_page_index_count;
+    std::vector<Page> m_pages;
+};
+
+} // namespace khepri::renderer::detail
@@ -0,0 +1,389 @@
+#include <khepri/renderer/mesh_optimizer.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace khepri::renderer {
+namespace {
+using Index = MeshDesc::Index;
+
+static_assert(sizeof(MeshDesc::Vertex) == 18 * sizeof(float),
+              "MeshDesc::Vertex should not have padding; welding compares vertices bitwise");
+
+// Size of the vertex cache that's modelled when scoring vertices in optimize_vertex_cache.
+// The algorithm is not sensitive to the exact size; this works well for all cache sizes.
+constexpr std::size_t SCORING_CACHE_SIZE = 32;
+
+// Vertex scoring parameters from Forsyth's paper
+constexpr float CACHE_DECAY_POWER   = 1.5F;
+constexpr float LAST_TRIANGLE_SCORE = 0.75F;
+constexpr float VALENCE_BOOST_SCALE = 2.0F;
+constexpr float VALENCE_BOOST_POWER = 0.5F;
+
+// Size of the FIFO vertex cache that is simulated to find the cluster boundaries for
+// optimize_overdraw.
+constexpr std::size_t CLUSTER_CACHE_SIZE = 16;
+
+std::size_t triangle_count(const MeshDesc& mesh) noexcept
+{
+    return mesh.indices.size() / 3;
+}
+
+// Scores a vertex by its position in the simulated cache (-1 if it's not in the cache) and the
+// number of triangles that still have to be emitted that use the vertex.
+float vertex_score(int cache_position, std::size_t remaining_triangles) noexcept
+{
+    if (remaining_triangles == 0) {
+        // The vertex is not used anymore
+        return -1.0F;
+    }
+
+    float score = 0.0F;
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            // The vertex was used in the last triangle. Give it a fixed score so that it doesn't
+            // matter which of the three vertices is used, or the algorithm would favor strips.
+            score = LAST_TRIANGLE_SCORE;
+        } else {
+            constexpr float scaler = 1.0F / (SCORING_CACHE_SIZE - 3);
+            score = std::pow(1.0F - static_cast<float>(cache_position - 3) * scaler,
+                             CACHE_DECAY_POWER);
+        }
+    }
+
+    // Boost vertices with few remaining triangles, to get rid of lone triangles
+    score += VALENCE_BOOST_SCALE *
+             std::pow(static_cast<float>(remaining_triangles), -VALENCE_BOOST_POWER);
+    return score;
+}
+
+// Reorders whole triangles of a mesh according to the (triangle) indices in the order
+void reorder_triangles(MeshDesc& mesh, const std::vector<std::size_t>& order)
+{
+    std::vector<Index> indices;
+    indices.reserve(mesh.indices.size());
+    for (const auto triangle : order) {
+        const auto* const tri = &mesh.indices[triangle * 3];
+        indices.insert(indices.end(), tri, tri + 3);
+    }
+    mesh.indices = std::move(indices);
+}
+} // namespace
+
+void weld_vertices(MeshDesc& mesh)
+{
+    const auto vertex_count = mesh.vertices.size();
+    const auto compare      = [&](std::size_t v1, std::size_t v2) {
+        return std::memcmp(&mesh.vertices[v1], &mesh.vertices[v2], sizeof(MeshDesc::Vertex));
+    };
+
+    // Sort the vertices so that identical vertices are adjacent. The sort is stable, so the first
+    // vertex of every run of identical vertices is the one that comes first in the mesh.
+    std::vector<std::size_t> order(vertex_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t v1, std::size_t v2) { return compare(v1, v2) < 0; });
+
+    // Map every vertex to the first of its identical vertices
+    std::vector<std::size_t> remap(vertex_count);
+    for (std::size_t i = 0; i < vertex_count;) {
+        std::size_t j = i;
+        for (; j < vertex_count && compare(order[i], order[j]) == 0; ++j) {
+            remap[order[j]] = order[i];
+        }
+        i = j;
+    }
+
+    // Remove the duplicates, keeping the remaining vertices in their original order
+    std::vector<MeshDesc::Vertex> vertices;
+    std::vector<Index>            new_index(vertex_count);
+    for (std::size_t i = 0; i < vertex_count; ++i) {
+        if (remap[i] == i) {
+            new_index[i] = static_cast<Index>(vertices.size());
+            vertices.push_back(mesh.vertices[i]);
+        }
+    }
+
+    for (auto& index : mesh.indices) {
+        assert(index < vertex_count);
+        index = new_index[remap[index]];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+void optimize_vertex_cache(MeshDesc& mesh)
+{
+    constexpr auto none = std::numeric_limits<std::size_t>::max();
+
+    const auto  triangles    = triangle_count(mesh);
+    const auto  vertex_count = mesh.vertices.size();
+    const auto& indices      = mesh.indices;
+    if (triangles == 0) {
+        return;
+    }
+
+    // Build the vertex-to-triangle adjacency. The first remaining[v] entries of a vertex' list
+    // are the triangles that still have to be emitted.
+    std::vector<std::size_t> remaining(vertex_count, 0);
+    for (std::size_t i = 0; i < triangles * 3; ++i) {
+        assert(indices[i] < vertex_count);
+        ++remaining[indices[i]];
+    }
+    std::vector<std::size_t> offsets(vertex_count + 1, 0);
+    std::partial_sum(remaining.begin(), remaining.end(), offsets.begin() + 1);
+    std::vector<std::size_t> adjacency(offsets.back());
+    {
+        std::vector<std::size_t> fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < triangles * 3; ++i) {
+            adjacency[fill[indices[i]]++] = i / 3;
+        }
+    }
+
+    std::vector<int>   cache_position(vertex_count, -1);
+    std::vector<float> vertex_scores(vertex_count);
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        vertex_scores[v] = vertex_score(-1, remaining[v]);
+    }
+
+    std::vector<float> triangle_scores(triangles);
+    std::vector<bool>  emitted(triangles, false);
+    for (std::size_t t = 0; t < triangles; ++t) {
+        triangle_scores[t] = vertex_scores[indices[t * 3 + 0]] +
+                             vertex_scores[indices[t * 3 + 1]] +
+                             vertex_scores[indices[t * 3 + 2]];
+    }
+
+    std::vector<std::size_t> order;
+    order.reserve(triangles);
+
+    std::vector<Index> cache;
+    std::vector<Index> new_cache;
+    cache.reserve(SCORING_CACHE_SIZE + 3);
+    new_cache.reserve(SCORING_CACHE_SIZE + 3);
+
+    // Triangles are scanned in order when no triangle in the cache can be emitted. All triangles
+    // before this cursor have been emitted.
+    std::size_t scan_cursor   = 0;
+    std::size_t best_triangle = none;
+    while (order.size() < triangles) {
+        if (best_triangle == none) {
+            // Dead end: continue with the first triangle that has not been emitted yet. Scanning
+            // all triangles for the best score would make this quadratic for meshes that consist
+            // of many small disconnected parts.
+            while (emitted[scan_cursor]) {
+                ++scan_cursor;
+            }
+            best_triangle = scan_cursor;
+        }
+
+        // Emit the triangle and remove it from its vertices' remaining triangles
+        order.push_back(best_triangle);
+        emitted[best_triangle] = true;
+        const auto* const tri  = &indices[best_triangle * 3];
+        for (std::size_t i = 0; i < 3; ++i) {
+            const auto v     = tri[i];
+            auto*      first = &adjacency[offsets[v]];
+            auto*      last  = first + remaining[v];
+            std::iter_swap(std::find(first, last, best_triangle), last - 1);
+            --remaining[v];
+        }
+
+        // Move the triangle's vertices to the front of the cache
+        new_cache.clear();
+        for (std::size_t i = 0; i < 3; ++i) {
+            // Degenerate triangles can reference a vertex more than once
+            if (std::find(new_cache.begin(), new_cache.end(), tri[i]) == new_cache.end()) {
+                new_cache.push_back(tri[i]);
+            }
+        }
+        for (const auto v : cache) {
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                new_cache.push_back(v);
+            }
+        }
+
+        // Update the scores of the vertices in the cache, including those that just dropped out
+        for (std::size_t i = 0; i < new_cache.size(); ++i) {
+            const auto v      = new_cache[i];
+            cache_position[v] = (i < SCORING_CACHE_SIZE) ? static_cast<int>(i) : -1;
+            vertex_scores[v]  = vertex_score(cache_position[v], remaining[v]);
+        }
+
+        // Update the scores of the affected triangles and find the next best triangle
+        best_triangle    = none;
+        float best_score = -std::numeric_limits<float>::infinity();
+        for (const auto v : new_cache) {
+            for (std::size_t i = offsets[v]; i < offsets[v] + remaining[v]; ++i) {
+                const auto        t         = adjacency[i];
+                const auto* const t_indices = &indices[t * 3];
+                triangle_scores[t] = vertex_scores[t_indices[0]] + vertex_scores[t_indices[1]] +
+                                     vertex_scores[t_indices[2]];
+                if (triangle_scores[t] > best_score) {
+                    best_score    = triangle_scores[t];
+                    best_triangle = t;
+                }
+            }
+        }
+
+        new_cache.resize(std::min(new_cache.size(), SCORING_CACHE_SIZE));
+        std::swap(cache, new_cache);
+    }
+
+    reorder_triangles(mesh, order);
+}
+
+void optimize_overdraw(MeshDesc& mesh)
+{
+    const auto triangles = triangle_count(mesh);
+    if (triangles == 0) {
+        return;
+    }
+
+    // Split the triangles into clusters at the triangles that miss the cache on every vertex. Such
+    // a triangle starts a new area of the mesh, so clusters can be reordered without (much) loss
+    // of vertex cache efficiency.
+    std::vector<std::size_t> cluster_starts;
+    {
+        std::vector<std::size_t> cache_time(mesh.vertices.size(), 0);
+        std::size_t              time = CLUSTER_CACHE_SIZE + 1;
+        for (std::size_t t = 0; t < triangles; ++t) {
+            std::size_t misses = 0;
+            for (std::size_t i = 0; i < 3; ++i) {
+                const auto v = mesh.indices[t * 3 + i];
+                if (time - cache_time[v] > CLUSTER_CACHE_SIZE) {
+                    cache_time[v] = time++;
+                    ++misses;
+                }
+            }
+            if (t == 0 || misses == 3) {
+                cluster_starts.push_back(t);
+            }
+        }
+        cluster_starts.push_back(triangles);
+    }
+
+    const auto cluster_count = cluster_starts.size() - 1;
+    if (cluster_count < 2) {
+        return;
+    }
+
+    // Calculate the area-weighted centroid and normal of every cluster, and of the whole mesh
+    struct Cluster
+    {
+        Vector3f    centroid{0, 0, 0};
+        Vector3f    normal{0, 0, 0};
+        float       area{0};
+        float       sort_key{0};
+        std::size_t start;
+        std::size_t end;
+    };
+
+    std::vector<Cluster> clusters(cluster_count);
+    Vector3f             mesh_centroid(0, 0, 0);
+    float                mesh_area = 0;
+    for (std::size_t c = 0; c < cluster_count; ++c) {
+        auto& cluster = clusters[c];
+        cluster.start = cluster_starts[c];
+        cluster.end   = cluster_starts[c + 1];
+        for (std::size_t t = cluster.start; t < cluster.end; ++t) {
+            const auto& p0 = mesh.vertices[mesh.indices[t * 3 + 0]].position;
+            const auto& p1 = mesh.vertices[mesh.indices[t * 3 + 1]].position;
+            const auto& p2 = mesh.vertices[mesh.indices[t * 3 + 2]].position;
+
+            // The length of the cross product is twice the triangle's area
+            const auto normal = cross(p1 - p0, p2 - p0);
+            const auto area   = static_cast<float>(normal.length()) / 2;
+            cluster.centroid += (p0 + p1 + p2) * (area / 3);
+            cluster.normal += normal;
+            cluster.area += area;
+        }
+        mesh_centroid += cluster.centroid;
+        mesh_area += cluster.area;
+        if (cluster.area > 0) {
+            cluster.centroid /= cluster.area;
+        }
+    }
+    if (mesh_area > 0) {
+        mesh_centroid /= mesh_area;
+    }
+
+    // Clusters that face away from the mesh' center are more likely to occlude other clusters,
+    // so render those first.
+    for (auto& cluster : clusters) {
+        if (cluster.normal.length() > 0) {
+            cluster.sort_key = static_cast<float>(
+                dot(cluster.centroid - mesh_centroid, normalize(cluster.normal)));
+        }
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const auto& c1, const auto& c2) {
+        return c1.sort_key > c2.sort_key;
+    });
+
+    std::vector<std::size_t> order;
+    order.reserve(triangles);
+    for (const auto& cluster : clusters) {
+        for (std::size_t t = cluster.start; t < cluster.end; ++t) {
+            order.push_back(t);
+        }
+    }
+    reorder_triangles(mesh, order);
+}
+
+void optimize_vertex_fetch(MeshDesc& mesh)
+{
+    constexpr auto unused = std::numeric_limits<std::size_t>::max();
+
+    std::vector<std::size_t>      new_index(mesh.vertices.size(), unused);
+    std::vector<MeshDesc::Vertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (auto& index : mesh.indices) {
+        assert(index < mesh.vertices.size());
+        if (new_index[index] == unused) {
+            new_index[index] = vertices.size();
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = static_cast<Index>(new_index[index]);
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+void optimize_mesh(MeshDesc& mesh, bool reduce_overdraw)
+{
+    weld_vertices(mesh);
+    optimize_vertex_cache(mesh);
+    if (reduce_overdraw) {
+        optimize_overdraw(mesh);
+    }
+    optimize_vertex_fetch(mesh);
+}
+
+double calculate_acmr(gsl::span<const MeshDesc::Index> indices, std::size_t cache_size)
+{
+    const auto triangles = indices.size() / 3;
+    if (triangles == 0 || cache_size == 0) {
+        return triangles == 0 ? 0.0 : 3.0;
+    }
+
+    const std::size_t vertex_count = *std::max_element(indices.begin(), indices.end()) + 1;
+
+    // A vertex is in the FIFO cache if fewer than cache_size vertices were added after it
+    std::vector<std::size_t> cache_time(vertex_count, 0);
+    std::size_t              time   = cache_size + 1;
+    std::size_t              misses = 0;
+    for (std::size_t i = 0; i < triangles * 3; ++i) {
+        const auto v = indices[i];
+        if (time - cache_time[v] > cache_size) {
+            cache_time[v] = time++;
+            ++misses;
+        }
+    }
+    return static_cast<double>(misses) / static_cast<double>(triangles);
+}
+
+} // namespace khepri::renderer
@@ -0,0 +1,652 @@
+#include "../material_params.hpp"
+#include "../mesh_allocator.hpp"
+#include "../render_queue.hpp"
+
+#include <khepri/renderer/camera.hpp>
+#include <khepri/renderer/exceptions.hpp>
+#include <khepri/renderer/null/renderer.hpp>
+#include <khepri/utility/string.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <stack>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace khepri::renderer::null {
+namespace {
+using detail::IdAllocator;
+
+// Index of a render pass in a global render pass collection
+using GlobalRenderPassIndex = std::size_t;
+
+// Per-instance data, as it would be passed to the mesh shaders
+struct InstanceData
+{
+    Matrixf world;
+    Matrixf world_inv;
+};
+
+// Sizes of the constant buffers, as they would be passed to the shaders
+constexpr std::size_t VIEW_CONSTANTS_SIZE    = 3 * sizeof(Matrixf);
+constexpr std::size_t DIRECTIONAL_LIGHT_SIZE = 3 * 16;
+
+constexpr unsigned int TRIANGLES_PER_SPRITE  = 2;
+constexpr unsigned int VERTICES_PER_TRIANGLE = 3;
+
+// Number of vertices to render one sprite
+constexpr std::size_t VERTICES_PER_SPRITE = 4;
+
+// Number of sprites that fit in the sprite vertex/index buffers
+constexpr std::size_t SPRITE_BUFFER_COUNT = 1024;
+
+using SpriteVertex = MeshDesc::Vertex;
+
+} // namespace
+
+class Renderer::Impl
+{
+    struct Shader : public khepri::renderer::Shader
+    {
+    };
+
+    struct Mesh : public khepri::renderer::Mesh
+    {
+        Mesh(IdAllocator& id_allocator, detail::MeshAllocator& mesh_allocator,
+             const MeshDesc& mesh_desc)
+            : id(id_allocator.allocate())
+            , ids(id_allocator)
+            , allocation(
+                  mesh_allocator.allocate(mesh_desc.vertices.size(), mesh_desc.indices.size()))
+            , allocator(mesh_allocator)
+        {
+        }
+
+        ~Mesh() override
+        {
+            allocator.free(allocation);
+            ids.free(id);
+        }
+
+        Mesh(const Mesh&)            = delete;
+        Mesh(Mesh&&)                 = delete;
+        Mesh& operator=(const Mesh&) = delete;
+        Mesh& operator=(Mesh&&)      = delete;
+
+        // Unique ID of this mesh, for sorting
+        std::uint32_t id;
+        IdAllocator&  ids;
+
+        // Location of the mesh in the (imaginary) shared mesh buffers
+        detail::MeshAllocator::Allocation allocation;
+        detail::MeshAllocator&            allocator;
+    };
+
+    struct Texture : public khepri::renderer::Texture
+    {
+        using khepri::renderer::Texture::Texture;
+    };
+
+    class Material : public khepri::renderer::Material
+    {
+    public:
+        Material(const MaterialDesc& desc, std::uint32_t id,
+                 std::function<void(Material&)> destroy_callback)
+            : m_destroy_callback(std::move(destroy_callback))
+            , m_id(id)
+            , m_type(desc.type)
+            , m_num_directional_lights(desc.num_directional_lights)
+            , m_properties(desc.properties)
+            , m_param_layout(detail::layout_material_params(desc.properties))
+        {
+            if (dynamic_cast<const Shader*>(desc.shader) == nullptr) {
+                throw ArgumentError();
+            }
+
+            if (desc.num_directional_lights < 0 || desc.num_point_lights < 0) {
+                throw ArgumentError();
+            }
+
+            m_default_params = compile_params({});
+            m_param_buffer.resize(m_param_layout.size);
+        }
+
+        ~Material() override
+        {
+            m_destroy_callback(*this);
+        }
+
+        Material(const Material&)            = delete;
+        Material(Material&&)                 = delete;
+        Material& operator=(const Material&) = delete;
+        Material& operator=(Material&&)      = delete;
+
+        // Unique ID of this material, for sorting
+        std::uint32_t id() const noexcept
+        {
+            return m_id;
+        }
+
+        int num_directional_lights() const noexcept
+        {
+            return m_num_directional_lights;
+        }
+
+        void set_render_pass(GlobalRenderPassIndex render_pass_index, const RenderPassDesc& desc)
+        {
+            // Check if this material is rendered in the render pass
+            if (!khepri::case_insensitive_equals(desc.material_type, m_type)) {
+                return;
+            }
+
+            if (render_pass_index >= m_render_passes.size()) {
+                m_render_passes.resize(render_pass_index + 1);
+            }
+            m_render_passes[render_pass_index] = true;
+        }
+
+        void clear_render_pass(GlobalRenderPassIndex render_pass_index)
+        {
+            if (render_pass_index < m_render_passes.size()) {
+                m_render_passes[render_pass_index] = false;
+            }
+        }
+
+        // Checks if this material is used during this render pass
+        bool is_used(GlobalRenderPassIndex render_pass_index) const noexcept
+        {
+            return render_pass_index < m_render_passes.size() && m_render_passes[render_pass_index];
+        }
+
+        /// \see #khepri::renderer::Material::compile_params
+        ParamBlock compile_params(
+            gsl::span<const khepri::renderer::Material::Param> params) const override
+        {
+            auto block =
+                detail::compile_material_params(*this, m_properties, m_param_layout, params);
+            for (const auto* texture : block.textures) {
+                if (texture != nullptr && dynamic_cast<const Texture*>(texture) == nullptr) {
+                    throw ArgumentError();
+                }
+            }
+            return block;
+        }
+
+        // Copies the material's parameters into its constants buffer, like a real renderer would.
+        // Returns the number of bytes that would have been uploaded, which includes the padding
+        // up to the next constant buffer offset.
+        std::size_t apply_params(const ParamBlock* params) const
+        {
+            const auto& block = (params != nullptr) ? *params : m_default_params;
+            assert(block.constants.size() == m_param_buffer.size());
+            std::copy(block.constants.begin(), block.constants.end(), m_param_buffer.begin());
+            return detail::align_constants(m_param_buffer.size());
+        }
+
+    private:
+        std::function<void(Material&)> m_destroy_callback;
+        std::uint32_t                  m_id;
+
+        // The material type (for matching with the RenderPass material filter)
+        std::string m_type;
+
+        // The material light count
+        int m_num_directional_lights;
+
+        // Whether this material is rendered in each render pass
+        std::vector<bool> m_render_passes;
+
+        // The material's properties, their layout in the constants buffer and their defaults
+        std::vector<MaterialDesc::Property> m_properties;
+        detail::MaterialParamLayout         m_param_layout;
+        ParamBlock                          m_default_params;
+
+        // CPU-side stand-in for the material's constants buffer
+        mutable std::vector<std::uint8_t> m_param_buffer;
+    };
+
+    class RenderPipeline : public khepri::renderer::RenderPipeline
+    {
+    public:
+        RenderPipeline(const std::vector<GlobalRenderPassIndex>& render_pass_indices,
+                       std::function<void(RenderPipeline&)>      destroy_callback)
+            : m_render_pass_indices(render_pass_indices)
+            , m_destroy_callback(std::move(destroy_callback))
+        {
+        }
+
+        ~RenderPipeline() override
+        {
+            m_destroy_callback(*this);
+        }
+
+        RenderPipeline(const RenderPipeline&)            = delete;
+        RenderPipeline(RenderPipeline&&)                 = delete;
+        RenderPipeline& operator=(const RenderPipeline&) = delete;
+        RenderPipeline& operator=(RenderPipeline&&)      = delete;
+
+        const auto& render_pass_indices() const noexcept
+        {
+            return m_render_pass_indices;
+        }
+
+    private:
+        std::vector<GlobalRenderPassIndex>   m_render_pass_indices;
+        std::function<void(RenderPipeline&)> m_destroy_callback;
+    };
+
+public:
+    Impl(const Size& render_size, VertexFormat vertex_format)
+        : m_render_size(render_size), m_vertex_format(vertex_format)
+    {
+    }
+
+    [[nodiscard]] const Statistics& statistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+    void reset_statistics() noexcept
+    {
+        m_statistics = {};
+    }
+
+    void render_size(const Size& size)
+    {
+        m_render_size = size;
+    }
+
+    [[nodiscard]] Size render_size() const noexcept
+    {
+        return m_render_size;
+    }
+
+    [[nodiscard]] std::unique_ptr<Shader> create_shader(const std::filesystem::path& path,
+                                                        const ShaderLoader&          loader)
+    {
+        if (!loader(path)) {
+            throw khepri::renderer::Error("Failed to load shader from file: " + path.string());
+        }
+        return std::make_unique<Shader>();
+    }
+
+    [[nodiscard]] std::unique_ptr<khepri::renderer::Material>
+    create_material(const MaterialDesc& material_desc)
+    {
+        auto material = std::make_unique<Material>(
+            material_desc, m_material_ids.allocate(), [this](auto& mat) {
+                m_material_ids.free(mat.id());
+                m_alive_materials.erase(
+                    std::find(m_alive_materials.begin(), m_alive_materials.end(), &mat));
+                update_max_light_count();
+            });
+
+        // Set all existing render passes on the material
+        for (GlobalRenderPassIndex i = 0; i < m_render_passes.size(); ++i) {
+            if (m_render_passes[i]) {
+                material->set_render_pass(i, *m_render_passes[i]);
+            }
+        }
+
+        m_alive_materials.push_back(material.get());
+        update_max_light_count();
+        return material;
+    }
+
+    [[nodiscard]] std::unique_ptr<Texture> create_texture(const TextureDesc& texture_desc)
+    {
+        m_statistics.resource_bytes_uploaded += texture_desc.data().size();
+        return std::make_unique<Texture>(Size{texture_desc.width(), texture_desc.height()});
+    }
+
+    [[nodiscard]] std::unique_ptr<Mesh> create_mesh(const MeshDesc& mesh_desc)
+    {
+        auto mesh = std::make_unique<Mesh>(m_mesh_ids, m_mesh_allocator, mesh_desc);
+
+        m_statistics.resource_bytes_uploaded +=
+            mesh_desc.vertices.size() * vertex_size(m_vertex_format) +
+            mesh_desc.indices.size() * sizeof(MeshDesc::Index);
+        return mesh;
+    }
+
+    std::unique_ptr<RenderPipeline>
+    create_render_pipeline(const RenderPipelineDesc& render_pipeline_desc)
+    {
+        const auto render_pass_indices = store_render_passes(render_pipeline_desc.render_passes);
+
+        auto pipeline = std::make_unique<RenderPipeline>(
+            render_pass_indices, [this](RenderPipeline& pipeline) {
+                const auto& render_pass_indices = pipeline.render_pass_indices();
+                for (auto* const material : m_alive_materials) {
+                    for (const auto render_pass_index : render_pass_indices) {
+                        material->clear_render_pass(render_pass_index);
+                    }
+                }
+                remove_render_passes(render_pass_indices);
+            });
+
+        for (auto* const material : m_alive_materials) {
+            for (std::size_t i = 0; i < render_pass_indices.size(); ++i) {
+                material->set_render_pass(render_pass_indices[i],
+                                          render_pipeline_desc.render_passes[i]);
+            }
+        }
+        return pipeline;
+    }
+
+    void set_dynamic_lights(const DynamicLightDesc& /*light_desc*/)
+    {
+        // The light buffer is sized for the material with the most lights
+        m_statistics.bytes_uploaded += m_max_directional_light_count * DIRECTIONAL_LIGHT_SIZE;
+    }
+
+    void clear(ClearFlags /*flags*/) {}
+
+    void present()
+    {
+        ++m_statistics.frames;
+    }
+
+    void render_meshes(const khepri::renderer::RenderPipeline& render_pipeline,
+                       gsl::span<const MeshInstance> meshes, const Camera& camera)
+    {
+        // Validate the input first
+        const auto* const pipeline = dynamic_cast<const RenderPipeline*>(&render_pipeline);
+        if (pipeline == nullptr) {
+            throw ArgumentError();
+        }
+
+        for (const auto& mesh_info : meshes) {
+            const auto* const material = dynamic_cast<const Material*>(mesh_info.material);
+            const auto* const mesh     = dynamic_cast<const Mesh*>(mesh_info.mesh);
+            if (material == nullptr || mesh == nullptr ||
+                (mesh_info.material_params != nullptr &&
+                 mesh_info.material_params->material != material)) {
+                throw ArgumentError();
+            }
+        }
+
+        const auto& camera_matrices = camera.matrices();
+        m_statistics.bytes_uploaded += VIEW_CONSTANTS_SIZE;
+
+        // Returns the mesh's distance 'in front of' the camera
+        const auto& get_view_distance = [&](const MeshInstance& mesh_info) {
+            return -(mesh_info.transform.get_translation() * camera_matrices.view_proj).z;
+        };
+
+        m_render_queue.build(
+            pipeline->render_pass_indices(), meshes,
+            [&](GlobalRenderPassIndex render_pass_index,
+                const MeshInstance&   mesh_info) -> std::optional<std::uint64_t> {
+                const auto* const material = static_cast<const Material*>(mesh_info.material);
+                if (!material->is_used(render_pass_index)) {
+                    return std::nullopt;
+                }
+                const auto* const mesh = static_cast<const Mesh*>(mesh_info.mesh);
+                return detail::render_sort_key(
+                    m_render_passes[render_pass_index]->depth_sorting, material->id(), mesh->id,
+                    [&] { return static_cast<float>(get_view_distance(mesh_info)); });
+            });
+
+        const auto& instances = m_render_queue.instances();
+
+        if (instances.empty()) {
+            return;
+        }
+
+        // Build the instance data of all draw calls at once
+        m_instance_data.resize(instances.size());
+        for (std::size_t i = 0; i < instances.size(); ++i) {
+            m_instance_data[i].world     = transpose(instances[i]->transform);
+            m_instance_data[i].world_inv = transpose(inverse(instances[i]->transform));
+        }
+        m_statistics.bytes_uploaded += instances.size() * sizeof(InstanceData);
+
+        // Now "render" the meshes in order, skipping state changes that are not needed
+        m_render_queue.for_each_draw_call(
+            [](const khepri::renderer::Mesh& mesh) {
+                return static_cast<const Mesh&>(mesh).allocation.page;
+            },
+            [&](const detail::RenderQueue::DrawCall&     draw_call,
+                const detail::RenderQueue::StateChanges& changes) {
+                auto* const material = static_cast<const Material*>(draw_call.mesh_info->material);
+                auto* const mesh     = static_cast<const Mesh*>(draw_call.mesh_info->mesh);
+                assert(material->is_used(draw_call.render_pass_index));
+
+                if (changes.pipeline) {
+                    ++m_statistics.pipeline_changes;
+                }
+
+                if (changes.params) {
+                    m_statistics.bytes_uploaded +=
+                        material->apply_params(draw_call.mesh_info->material_params);
+                    ++m_statistics.material_param_changes;
+                }
+
+                if (changes.mesh_buffers) {
+                    ++m_statistics.mesh_changes;
+                }
+
+                ++m_statistics.draw_calls;
+                m_statistics.instances += draw_call.instance_count;
+                m_statistics.triangles +=
+                    mesh->allocation.index_count / VERTICES_PER_TRIANGLE * draw_call.instance_count;
+            });
+    }
+
+    void render_sprites(const khepri::renderer::RenderPipeline& render_pipeline,
+                        gsl::span<const Sprite> sprites, const khepri::renderer::Material& material,
+                        gsl::span<const khepri::renderer::Material::Param> params)
+    {
+        const auto* const pipeline = dynamic_cast<const RenderPipeline*>(&render_pipeline);
+        if (pipeline == nullptr) {
+            throw ArgumentError();
+        }
+
+        const auto* const mat = dynamic_cast<const Material*>(&material);
+        if (mat == nullptr) {
+            throw ArgumentError();
+        }
+
+        const auto param_block = mat->compile_params(params);
+
+        for (const auto render_pass_index : pipeline->render_pass_indices()) {
+            if (!mat->is_used(render_pass_index)) {
+                // Nothing to do for this material in this render pass
+                continue;
+            }
+
+            ++m_statistics.pipeline_changes;
+            ++m_statistics.material_param_changes;
+            m_statistics.bytes_uploaded += mat->apply_params(&param_block);
+
+            std::size_t sprite_index = 0;
+            while (sprite_index < sprites.size()) {
+                const std::size_t sprites_left = sprites.size() - sprite_index;
+                const std::size_t sprite_count = std::min(sprites_left, SPRITE_BUFFER_COUNT);
+
+                m_sprite_vertices.resize(sprite_count * VERTICES_PER_SPRITE);
+                for (std::size_t i = 0; i < m_sprite_vertices.size();
+                     i += VERTICES_PER_SPRITE, ++sprite_index) {
+                    const auto& sprite = sprites[sprite_index];
+                    auto*       v      = &m_sprite_vertices[i];
+                    v[0].position =
+                        Vector3f(sprite.position_top_left.x, sprite.position_top_left.y, 0);
+                    v[1].position =
+                        Vector3f(sprite.position_bottom_right.x, sprite.position_top_left.y, 0);
+                    v[2].position =
+                        Vector3f(sprite.position_bottom_right.x, sprite.position_bottom_right.y, 0);
+                    v[3].position =
+                        Vector3f(sprite.position_top_left.x, sprite.position_bottom_right.y, 0);
+                    v[0].uv = Vector2f(sprite.uv_top_left.x, sprite.uv_top_left.y);
+                    v[1].uv = Vector2f(sprite.uv_bottom_right.x, sprite.uv_top_left.y);
+                    v[2].uv = Vector2f(sprite.uv_bottom_right.x, sprite.uv_bottom_right.y);
+                    v[3].uv = Vector2f(sprite.uv_top_left.x, sprite.uv_bottom_right.y);
+                }
+                // Sprites are written in the renderer's vertex format, like meshes
+                m_statistics.bytes_uploaded +=
+                    m_sprite_vertices.size() * vertex_size(m_vertex_format);
+
+                ++m_statistics.mesh_changes;
+                ++m_statistics.draw_calls;
+                ++m_statistics.instances;
+                m_statistics.triangles += sprite_count * TRIANGLES_PER_SPRITE;
+            }
+        }
+    }
+
+private:
+    void update_max_light_count()
+    {
+        m_max_directional_light_count = 0;
+        for (const auto* material : m_alive_materials) {
+            m_max_directional_light_count =
+                std::max(m_max_directional_light_count,
+                         static_cast<std::size_t>(material->num_directional_lights()));
+        }
+    }
+
+    std::vector<GlobalRenderPassIndex>
+    store_render_passes(gsl::span<const RenderPassDesc> render_passes)
+    {
+        std::vector<GlobalRenderPassIndex> indices;
+        indices.reserve(render_passes.size());
+        for (const auto& render_pass : render_passes) {
+            std::size_t index;
+            if (!m_unused_render_pass_indices.empty()) {
+                index = m_unused_render_pass_indices.top();
+                m_unused_render_pass_indices.pop();
+            } else {
+                index = m_render_passes.size();
+                m_render_passes.push_back({});
+            }
+            m_render_passes[index] = render_pass;
+            indices.push_back(index);
+        }
+        return indices;
+    }
+
+    void remove_render_passes(gsl::span<const GlobalRenderPassIndex> indices)
+    {
+        for (const auto& index : indices) {
+            m_render_passes[index] = {};
+            m_unused_render_pass_indices.push(index);
+        }
+    }
+
+    Size         m_render_size;
+    VertexFormat m_vertex_format;
+    Statistics   m_statistics;
+
+    // Non-owning set of all alive materials, to update when render pipelines are created
+    std::vector<Material*> m_alive_materials;
+
+    // Maximum count of directional lights in the alive materials
+    std::size_t m_max_directional_light_count{0};
+
+    // Freed and reusable global render pass indices
+    std::stack<GlobalRenderPassIndex> m_unused_render_pass_indices;
+    // Global list of render passes. Indexed by GlobalRenderPassIndex
+    std::vector<std::optional<RenderPassDesc>> m_render_passes;
+
+    // Reused between calls, to avoid allocations
+    detail::RenderQueue       m_render_queue;
+    std::vector<InstanceData> m_instance_data;
+    std::vector<SpriteVertex> m_sprite_vertices;
+
+    // IDs for alive materials and meshes
+    IdAllocator m_material_ids;
+    IdAllocator m_mesh_ids;
+
+    // Tracks how meshes would be packed into shared buffers
+    detail::MeshAllocator m_mesh_allocator;
+};
+
+Renderer::Renderer(const Size& render_size, VertexFormat vertex_format)
+    : m_impl(std::make_unique<Impl>(render_size, vertex_format))
+{
+}
+
+Renderer::~Renderer() = default;
+
+const Renderer::Statistics& Renderer::statistics() const noexcept
+{
+    return m_impl->statistics();
+}
+
+void Renderer::reset_statistics() noexcept
+{
+    m_impl->reset_statistics();
+}
+
+void Renderer::render_size(const Size& size)
+{
+    m_impl->render_size(size);
+}
+
+Size Renderer::render_size() const noexcept
+{
+    return m_impl->render_size();
+}
+
+std::unique_ptr<Shader> Renderer::create_shader(const std::filesystem::path& path,
+                                                const ShaderLoader&          loader)
+{
+    return m_impl->create_shader(path, loader);
+}
+
+std::unique_ptr<khepri::renderer::Material>
+Renderer::create_material(const MaterialDesc& material_desc)
+{
+    return m_impl->create_material(material_desc);
+}
+
+std::unique_ptr<Texture> Renderer::create_texture(const TextureDesc& texture_desc)
+{
+    return m_impl->create_texture(texture_desc);
+}
+
+std::unique_ptr<Mesh> Renderer::create_mesh(const MeshDesc& mesh_desc)
+{
+    return m_impl->create_mesh(mesh_desc);
+}
+
+std::unique_ptr<RenderPipeline>
+Renderer::create_render_pipeline(const RenderPipelineDesc& render_pipeline_desc)
+{
+    return m_impl->create_render_pipeline(render_pipeline_desc);
+}
+
+void Renderer::set_dynamic_lights(const DynamicLightDesc& light_desc)
+{
+    m_impl->set_dynamic_lights(light_desc);
+}
+
+void Renderer::clear(ClearFlags flags)
+{
+    m_impl->clear(flags);
+}
+
+void Renderer::present()
+{
+    m_impl->present();
+}
+
+void Renderer::render_meshes(const khepri::renderer::RenderPipeline& render_pipeline,
+                             gsl::span<const MeshInstance> meshes, const Camera& camera)
+{
+    m_impl->render_meshes(render_pipeline, meshes, camera);
+}
+
+void Renderer::render_sprites(const khepri::renderer::RenderPipeline& render_pipeline,
+                              gsl::span<const Sprite> sprites, const Material& material,
+                              gsl::span<const Material::Param> params)
+{
+    m_impl->render_sprites(render_pipeline, sprites, material, params);
+}
+
+} // namespace khepri::renderer::null
@@ -0,0 +1,45 @@
+#include "render_queue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace khepri::renderer::detail {
+
+void radix_sort(std::vector<RenderQueueItem>& items, std::vector<RenderQueueItem>& scratch)
+{
+    constexpr std::size_t digit_bits   = 8;
+    constexpr std::size_t digit_count  = sizeof(std::uint64_t) * 8 / digit_bits;
+    constexpr std::size_t bucket_count = std::size_t{1} << digit_bits;
+    constexpr std::size_t digit_mask   = bucket_count - 1;
+
+    // Build the histograms of all digits in a single pass over the data
+    std::array<std::array<std::size_t, bucket_count>, digit_count> histograms{};
+    for (const auto& item : items) {
+        for (std::size_t digit = 0; digit < digit_count; ++digit) {
+            ++histograms[digit][(item.key >> (digit * digit_bits)) & digit_mask];
+        }
+    }
+
+    scratch.resize(items.size());
+    for (std::size_t digit = 0; digit < digit_count; ++digit) {
+        auto& histogram = histograms[digit];
+        if (std::find(histogram.begin(), histogram.end(), items.size()) != histogram.end()) {
+            // All items have the same value for this digit; this pass wouldn't change the order
+            continue;
+        }
+
+        // Turn the histogram into the starting offset of every bucket
+        std::size_t offset = 0;
+        for (auto& count : histogram) {
+            offset += std::exchange(count, offset);
+        }
+
+        for (const auto& item : items) {
+            scratch[histogram[(item.key >> (digit * digit_bits)) & digit_mask]++] = item;
+        }
+        items.swap(scratch);
+    }
+}
+
+} // namespace khepri::renderer::detail
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <khepri/renderer/material.hpp>
+#include <khepri/renderer/mesh_instance.hpp>
+#include <khepri/renderer/render_pipeline_desc.hpp>
+
+#include <gsl/gsl-lite.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stack>
+#include <vector>
+
+namespace khepri::renderer::detail {
+
+// Checks if two blocks of material parameters are identical
+inline bool equal_params(const Material::ParamBlock* lhs, const Material::ParamBlock* rhs)
+{
+    return lhs == rhs || (lhs != nullptr && rhs != nullptr && lhs->constants == rhs->constants &&
+                          lhs->textures == rhs->textures);
+}
+
+// Checks if two mesh instances can be rendered in the same instanced draw call
+inline bool can_instance(const MeshInstance& lhs, const MeshInstance& rhs)
+{
+    return lhs.mesh == rhs.mesh && lhs.material == rhs.material &&
+           equal_params(lhs.material_params, rhs.material_params);
+}
+
+// The number of bits of material and mesh IDs that render sort keys can hold without truncation
+// (see render_sort_key).
+constexpr unsigned int SORT_KEY_ID_BITS = 20;
+
+// Allocates small integer IDs and reuses freed ones.
+// These IDs are used to build compact sort keys for rendering. Because freed IDs are reused, IDs
+// stay below the number of live objects, which is limited to 2^SORT_KEY_ID_BITS (about a million)
+// per allocator.
+class IdAllocator
+{
+public:
+    std::uint32_t allocate()
+    {
+        if (m_unused_ids.empty()) {
+            assert(m_next_id < (std::uint32_t{1} << SORT_KEY_ID_BITS));
+            return m_next_id++;
+        }
+        const auto id = m_unused_ids.top();
+        m_unused_ids.pop();
+        return id;
+    }
+
+    void free(std::uint32_t id)
+    {
+        m_unused_ids.push(id);
+    }
+
+private:
+    std::stack<std::uint32_t> m_unused_ids;
+    std::uint32_t             m_next_id{0};
+};
+
+// Maps a float to an unsigned integer such that the integers sort in the same order as the floats
+inline std::uint32_t to_ordered_bits(float value) noexcept
+{
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // Negative numbers sort in reverse, so flip all their bits. Positive numbers just need to be
+    // placed after the negative numbers.
+    constexpr std::uint32_t sign_bit = 0x80000000U;
+    return ((bits & sign_bit) != 0) ? ~bits : (bits | sign_bit);
+}
+
+// Returns the render queue sort key for a mesh in a render pass. From most to least
+// significant bits, the key contains:
+// - back-to-front passes: view distance (32 bits, inverted), material (20), mesh (12).
+// - front-to-back passes: material (20 bits), mesh (20), view distance (24).
+// - other passes: material (32 bits), mesh (32).
+// Every material has its own pipeline state per render pass, so sorting on material also
+// groups by pipeline state. Material and mesh IDs must fit in SORT_KEY_ID_BITS (see IdAllocator).
+// Back-to-front passes only use the IDs to order instances at identical distances, so truncating
+// the mesh ID there only affects batching of those, not correctness.
+template <typename ViewDistanceFunc>
+std::uint64_t render_sort_key(RenderPassDesc::DepthSorting depth_sorting, std::uint32_t material,
+                              std::uint32_t mesh, ViewDistanceFunc&& get_view_distance)
+{
+    constexpr std::uint64_t id_mask = (std::uint64_t{1} << SORT_KEY_ID_BITS) - 1;
+    assert(material <= id_mask && mesh <= id_mask);
+
+    const std::uint64_t material_id = material;
+    const std::uint64_t mesh_id     = mesh;
+    switch (depth_sorting) {
+    case RenderPassDesc::DepthSorting::back_to_front: {
+        // Larger distance gets rendered first
+        const std::uint64_t depth = ~to_ordered_bits(get_view_distance()) & 0xFFFFFFFFU;
+        return (depth << 32) | ((material_id & id_mask) << 12) | (mesh_id & 0xFFFU);
+    }
+    case RenderPassDesc::DepthSorting::front_to_back: {
+        // Smaller distance gets rendered first (within a group of identical meshes)
+        const std::uint64_t depth = to_ordered_bits(get_view_distance()) >> 8;
+        return ((material_id & id_mask) << 44) | ((mesh_id & id_mask) << 24) | depth;
+    }
+    default:
+        assert(false);
+        // Fall-through
+    case RenderPassDesc::DepthSorting::none:
+        break;
+    }
+    return (material_id << 32) | mesh_id;
+}
+
+// An item in a render queue
+struct RenderQueueItem
+{
+    // Key that determines the order of the items in the queue
+    std::uint64_t key;
+
+    const MeshInstance* mesh_info;
+};
+
+// Sorts the render queue items by key using a (stable) LSD radix sort with 8-bit digits.
+// Uses \a scratch as temporary storage.
+void radix_sort(std::vector<RenderQueueItem>& items, std::vector<RenderQueueItem>& scratch);
+
+// Turns a collection of mesh instances into a sorted list of instanced draw calls for every render
+// pass of a render pipeline. This is the renderer-independent part of rendering meshes.
+// The buffers are kept between builds, so reusing a render queue avoids allocations.
+class RenderQueue
+{
+public:
+    // A single (instanced) draw call
+    struct DrawCall
+    {
+        // The render pass to draw in, as identified by the renderer
+        std::size_t render_pass_index;
+
+        // The first instance of the draw call. Its mesh, material and parameters are shared by
+        // all instances.
+        const MeshInstance* mesh_info;
+
+        // The range of the draw call's instances in #instances
+        std::size_t first_instance;
+        std::size_t instance_count;
+    };
+
+    // The state that differs between a draw call and the draw call before it
+    struct StateChanges
+    {
+        // The render pass or material differs, so the pipeline state has to be set
+        bool pipeline;
+
+        // The material parameters differ (always set if the pipeline state differs)
+        bool params;
+
+        // The mesh is stored in different vertex and index buffers
+        bool mesh_buffers;
+    };
+
+    // Builds the draw calls for the render passes, in order.
+    // \a get_sort_key is called as get_sort_key(render_pass_index, mesh_instance) and returns the
+    // instance's sort key in the render pass (see render_sort_key), or std::nullopt if the instance
+    // is not rendered in the render pass.
+    template <typename SortKeyFunc>
+    void build(gsl::span<const std::size_t> render_pass_indices,
+               gsl::span<const MeshInstance> meshes, SortKeyFunc&& get_sort_key)
+    {
+        m_draw_calls.clear();
+        m_instances.clear();
+        m_instances.reserve(meshes.size());
+        m_queue.reserve(meshes.size());
+        m_scratch.reserve(meshes.size());
+
+        for (const auto render_pass_index : render_pass_indices) {
+            // Collect the meshes for this render pass, with their sort keys
+            m_queue.clear();
+            for (const auto& mesh_info : meshes) {
+                if (const std::optional<std::uint64_t> key =
+                        get_sort_key(render_pass_index, mesh_info)) {
+                    m_queue.push_back({*key, &mesh_info});
+                }
+            }
+
+            radix_sort(m_queue, m_scratch);
+
+            // Merge consecutive identical meshes into instanced draw calls
+            const auto first_draw_call = m_draw_calls.size();
+            for (const auto& item : m_queue) {
+                if (m_draw_calls.size() == first_draw_call ||
+                    !can_instance(*m_draw_calls.back().mesh_info, *item.mesh_info)) {
+                    m_draw_calls.push_back(
+                        {render_pass_index, item.mesh_info, m_instances.size(), 0});
+                }
+                m_instances.push_back(item.mesh_info);
+                ++m_draw_calls.back().instance_count;
+            }
+        }
+    }
+
+    // Calls \a draw as draw(draw_call, state_changes) for every draw call of the last build, in
+    // order of rendering, so the renderer only has to apply the state that changed.
+    // \a get_mesh_buffers is called as get_mesh_buffers(mesh) and returns a comparable
+    // identifier of the buffers that store the mesh.
+    template <typename MeshBuffersFunc, typename DrawFunc>
+    void for_each_draw_call(MeshBuffersFunc&& get_mesh_buffers, DrawFunc&& draw) const
+    {
+        const DrawCall* previous = nullptr;
+        for (const auto& draw_call : m_draw_calls) {
+            StateChanges changes{true, true, true};
+            if (previous != nullptr) {
+                const auto& prev = *previous->mesh_info;
+                const auto& curr = *draw_call.mesh_info;
+
+                changes.pipeline     = previous->render_pass_index != draw_call.render_pass_index ||
+                                       prev.material != curr.material;
+                changes.params       = changes.pipeline ||
+                                       !equal_params(prev.material_params, curr.material_params);
+                changes.mesh_buffers = get_mesh_buffers(*prev.mesh) != get_mesh_buffers(*curr.mesh);
+            }
+            draw(draw_call, changes);
+            previous = &draw_call;
+        }
+    }
+
+    // The draw calls of the last build, in order of rendering
+    [[nodiscard]] const std::vector<DrawCall>& draw_calls() const noexcept
+    {
+        return m_draw_calls;
+    }
+
+    // The instances of all draw calls. The instances of a draw call are stored contiguously.
+    [[nodiscard]] const std::vector<const MeshInstance*>& instances() const noexcept
+    {
+        return m_instances;
+    }
+
+private:
+    std::vector<DrawCall>            m_draw_calls;
+    std::vector<const MeshInstance*> m_instances;
+
+    // The render queue for a single render pass, and scratch space for sorting it
+    std::vector<RenderQueueItem> m_queue;
+    std::vector<RenderQueueItem> m_scratch;
+};
+
+} // namespace khepri::renderer::detail
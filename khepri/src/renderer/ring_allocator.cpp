@@ -0,0 +1,62 @@
+#include "ring_allocator.hpp"
+
+#include <cassert>
+
+namespace khepri::renderer::detail {
+
+std::optional<std::size_t> RingAllocator::allocate(std::size_t size, std::size_t alignment)
+{
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    if (m_used == 0) {
+        // Nothing in use; start at the beginning to avoid needless wrapping
+        m_head = m_tail = 0;
+    } else if (m_head == m_tail) {
+        // Completely full
+        return std::nullopt;
+    }
+
+    const auto& commit = [&](std::size_t offset, std::size_t used) {
+        m_head = offset + size;
+        m_used += used;
+        m_frame_size += used;
+        return offset;
+    };
+
+    const std::size_t aligned = (m_head + alignment - 1) & ~(alignment - 1);
+    if (m_head >= m_tail) {
+        // The free space is [head, capacity) followed by [0, tail)
+        if (aligned + size <= m_capacity) {
+            return commit(aligned, aligned + size - m_head);
+        }
+        if (size <= m_tail) {
+            // Wrap around; the end of the buffer is wasted
+            return commit(0, m_capacity - m_head + size);
+        }
+    } else if (aligned + size <= m_tail) {
+        // The free space is [head, tail)
+        return commit(aligned, aligned + size - m_head);
+    }
+    return std::nullopt;
+}
+
+void RingAllocator::finish_frame(std::uint64_t frame_id)
+{
+    assert(m_frames.empty() || m_frames.back().id < frame_id);
+    if (m_frame_size > 0) {
+        m_frames.push_back({frame_id, m_head, m_frame_size});
+        m_frame_size = 0;
+    }
+}
+
+void RingAllocator::release(std::uint64_t completed_frame_id)
+{
+    while (!m_frames.empty() && m_frames.front().id <= completed_frame_id) {
+        const auto& frame = m_frames.front();
+        m_tail            = frame.end;
+        m_used -= frame.size;
+        m_frames.pop_front();
+    }
+}
+
+} // namespace khepri::renderer::detail
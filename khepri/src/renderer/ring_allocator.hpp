@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace khepri::renderer::detail {
+
+// Allocates ranges of bytes from a ring buffer for per-frame data.
+// Allocations are made linearly and wrap around at the end of the buffer. The allocations of a
+// frame are released together once the GPU has finished that frame, as signaled by a fence.
+class RingAllocator
+{
+public:
+    explicit RingAllocator(std::size_t capacity) : m_capacity(capacity) {}
+
+    std::size_t capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    // Allocates \a size bytes at an offset that is a multiple of \a alignment (a power of two).
+    // Returns std::nullopt if there is no room until older frames are released.
+    std::optional<std::size_t> allocate(std::size_t size, std::size_t alignment);
+
+    // Marks the end of the current frame's allocations. \a frame_id is the fence value that is
+    // signaled when the GPU has finished the frame, and must increase with every frame.
+    void finish_frame(std::uint64_t frame_id);
+
+    // Releases the allocations of all finished frames up to and including \a completed_frame_id
+    void release(std::uint64_t completed_frame_id);
+
+    // Returns the ID of the oldest finished frame that has not been released yet
+    std::optional<std::uint64_t> oldest_frame() const noexcept
+    {
+        return m_frames.empty() ? std::nullopt : std::optional(m_frames.front().id);
+    }
+
+private:
+    struct Frame
+    {
+        std::uint64_t id;
+
+        // Offset of the end of the frame's allocations
+        std::size_t end;
+
+        // Number of bytes used by the frame, including alignment and wrap-around padding
+        std::size_t size;
+    };
+
+    std::size_t m_capacity;
+
+    // The next allocation is made at or after m_head. Bytes from m_tail up to m_head (wrapping
+    // around) are in use, unless m_used is zero.
+    std::size_t m_head{0};
+    std::size_t m_tail{0};
+    std::size_t m_used{0};
+
+    // Bytes used by the current, unfinished, frame
+    std::size_t m_frame_size{0};
+
+    // Finished frames that the GPU may still be using, oldest first
+    std::deque<Frame> m_frames;
+};
+
+} // namespace khepri::renderer::detail
@@ -0,0 +1,790 @@
+#include <khepri/exceptions.hpp>
+#include <khepri/math/color_srgb.hpp>
+#include <khepri/math/math.hpp>
+#include <khepri/renderer/texture_processing.hpp>
+#include <khepri/utility/thread_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace khepri::renderer {
+namespace {
+
+constexpr std::size_t CHANNELS = 4;
+
+// Size, in pixels, of a side of a compression block
+constexpr unsigned long BLOCK_DIM = 4;
+
+constexpr std::size_t BC1_BLOCK_SIZE = 8;
+constexpr std::size_t BC3_BLOCK_SIZE = 16;
+
+constexpr float MAX_UNORM8 = 255.0F;
+
+// Kaiser filter parameters. The width is in destination pixels.
+constexpr float KAISER_WIDTH = 3.0F;
+constexpr float KAISER_ALPHA = 4.0F;
+
+using Pixel = std::array<std::uint8_t, CHANNELS>;
+
+bool is_uncompressed(PixelFormat format) noexcept
+{
+    switch (format) {
+    case PixelFormat::r8g8b8a8_unorm:
+    case PixelFormat::r8g8b8a8_unorm_srgb:
+    case PixelFormat::b8g8r8a8_unorm:
+    case PixelFormat::b8g8r8a8_unorm_srgb:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool is_bgra(PixelFormat format) noexcept
+{
+    return format == PixelFormat::b8g8r8a8_unorm || format == PixelFormat::b8g8r8a8_unorm_srgb;
+}
+
+bool is_processable(const TextureDesc& texture_desc) noexcept
+{
+    return texture_desc.dimension() == TextureDimension::texture_2d &&
+           is_uncompressed(texture_desc.pixel_format());
+}
+
+unsigned long mip_size(unsigned long size, std::size_t mip_level) noexcept
+{
+    return std::max(1UL, size >> mip_level);
+}
+
+// Number of array slices of a texture, for iterating its subresources
+std::size_t slice_count(const TextureDesc& texture_desc) noexcept
+{
+    return std::max(1UL, texture_desc.array_size());
+}
+
+// Calls visit(row, width) for every row of pixels of every subresource of an uncompressed 2D
+// texture. Rows are addressed with the subresource's stride, so any padding is skipped. Stops, and
+// returns false, as soon as visit returns false.
+template <typename Visitor>
+bool for_each_row(const TextureDesc& texture_desc, const Visitor& visit)
+{
+    const auto* const data = texture_desc.data().data();
+    for (std::size_t slice = 0; slice < slice_count(texture_desc); ++slice) {
+        for (std::size_t mip = 0; mip < texture_desc.mip_levels(); ++mip) {
+            const auto& subresource =
+                texture_desc.subresource(texture_desc.subresource_index(mip, slice));
+            const auto width  = mip_size(texture_desc.width(), mip);
+            const auto height = mip_size(texture_desc.height(), mip);
+            for (unsigned long y = 0; y < height; ++y) {
+                if (!visit(data + subresource.data_offset + y * subresource.stride, width)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Runs job(i) for every i in [0, count) on the thread pool, if any, and waits for all of them
+template <typename Job>
+void parallel_for(ThreadPool* thread_pool, std::size_t count, const Job& job)
+{
+    if (thread_pool == nullptr || count <= 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    std::mutex              mutex;
+    std::condition_variable done;
+    std::size_t             remaining = count;
+    for (std::size_t i = 0; i < count; ++i) {
+        thread_pool->submit([&, i] {
+            job(i);
+            std::lock_guard lock(mutex);
+            if (--remaining == 0) {
+                done.notify_one();
+            }
+        });
+    }
+
+    std::unique_lock lock(mutex);
+    done.wait(lock, [&] { return remaining == 0; });
+}
+
+//
+// Mip generation
+//
+
+// An image of floating-point RGBA pixels, in linear space
+struct Image
+{
+    unsigned long      width;
+    unsigned long      height;
+    std::vector<float> pixels;
+};
+
+const std::array<float, 256>& srgb_to_linear_table()
+{
+    static const auto table = [] {
+        std::array<float, 256> table{};
+        for (std::size_t i = 0; i < table.size(); ++i) {
+            table[i] = ColorSRGB::srgb_to_linear(static_cast<float>(i) / MAX_UNORM8);
+        }
+        return table;
+    }();
+    return table;
+}
+
+std::uint8_t to_unorm8(float value) noexcept
+{
+    return static_cast<std::uint8_t>(std::lround(std::clamp(value, 0.0F, 1.0F) * MAX_UNORM8));
+}
+
+// Decodes RGBA8 (or BGRA8) pixel data with rows of stride bytes to an image. Color channels in
+// sRGB space are converted to linear space; alpha is always linear.
+Image decode_image(const std::uint8_t* data, std::size_t stride, unsigned long width,
+                   unsigned long height, bool srgb)
+{
+    const auto& to_linear = srgb_to_linear_table();
+
+    Image image{width, height, std::vector<float>(width * height * CHANNELS)};
+    for (unsigned long y = 0; y < height; ++y) {
+        const auto* const src = data + y * stride;
+        float* const      dst = &image.pixels[y * width * CHANNELS];
+        for (std::size_t i = 0; i < width * CHANNELS; i += CHANNELS) {
+            for (std::size_t c = 0; c < 3; ++c) {
+                dst[i + c] = srgb ? to_linear[src[i + c]]
+                                  : static_cast<float>(src[i + c]) / MAX_UNORM8;
+            }
+            dst[i + 3] = static_cast<float>(src[i + 3]) / MAX_UNORM8;
+        }
+    }
+    return image;
+}
+
+void encode_image(const Image& image, bool srgb, std::uint8_t* data)
+{
+    for (std::size_t i = 0; i < image.pixels.size(); i += CHANNELS) {
+        for (std::size_t c = 0; c < 3; ++c) {
+            const auto value = image.pixels[i + c];
+            data[i + c] =
+                to_unorm8(srgb ? ColorSRGB::linear_to_srgb(std::max(value, 0.0F)) : value);
+        }
+        data[i + 3] = to_unorm8(image.pixels[i + 3]);
+    }
+}
+
+float sinc(float x) noexcept
+{
+    if (std::abs(x) < 1e-4F) {
+        return 1.0F;
+    }
+    const auto px = static_cast<float>(PI) * x;
+    return std::sin(px) / px;
+}
+
+// Zeroth-order modified Bessel function of the first kind
+float bessel_i0(float x) noexcept
+{
+    constexpr int max_terms = 32;
+    float         sum       = 1.0F;
+    float         term      = 1.0F;
+    for (int k = 1; k < max_terms && term > sum * 1e-8F; ++k) {
+        const float t = x / (2.0F * static_cast<float>(k));
+        term *= t * t;
+        sum += term;
+    }
+    return sum;
+}
+
+// Returns the weight of a filter at a distance of x destination pixels from its center
+float filter_weight(MipFilter filter, float x) noexcept
+{
+    switch (filter) {
+    case MipFilter::kaiser: {
+        const float t = x / KAISER_WIDTH;
+        if (t <= -1.0F || t >= 1.0F) {
+            return 0.0F;
+        }
+        return sinc(x) * bessel_i0(KAISER_ALPHA * std::sqrt(1.0F - t * t)) /
+               bessel_i0(KAISER_ALPHA);
+    }
+
+    case MipFilter::box:
+    default:
+        return (x >= -0.5F && x < 0.5F) ? 1.0F : 0.0F;
+    }
+}
+
+float filter_support(MipFilter filter) noexcept
+{
+    return (filter == MipFilter::kaiser) ? KAISER_WIDTH : 0.5F;
+}
+
+// The source pixels and their weights that contribute to a destination pixel
+struct Contribution
+{
+    std::size_t        first;
+    std::vector<float> weights;
+};
+
+// Calculates the contributions for downsampling \a src_size pixels to \a dst_size pixels
+std::vector<Contribution> calculate_contributions(MipFilter filter, unsigned long src_size,
+                                                  unsigned long dst_size)
+{
+    const float scale   = static_cast<float>(src_size) / static_cast<float>(dst_size);
+    const float support = filter_support(filter) * scale;
+
+    std::vector<Contribution> contributions(dst_size);
+    for (unsigned long i = 0; i < dst_size; ++i) {
+        const float center = (static_cast<float>(i) + 0.5F) * scale;
+        const auto  first  = static_cast<long>(std::floor(center - support));
+        const auto  last   = static_cast<long>(std::ceil(center + support));
+
+        // Gather the weights per source pixel, clamping at the edges
+        const auto clamp = [&](long j) {
+            return static_cast<std::size_t>(std::clamp(j, 0L, static_cast<long>(src_size) - 1));
+        };
+
+        auto& contribution = contributions[i];
+        contribution.first = clamp(first);
+        contribution.weights.assign(clamp(last) - contribution.first + 1, 0.0F);
+
+        float total = 0;
+        for (long j = first; j <= last; ++j) {
+            const float weight =
+                filter_weight(filter, (static_cast<float>(j) + 0.5F - center) / scale);
+            contribution.weights[clamp(j) - contribution.first] += weight;
+            total += weight;
+        }
+        for (auto& weight : contribution.weights) {
+            weight /= total;
+        }
+    }
+    return contributions;
+}
+
+// Downsamples an image to the next mip level with a separable filter. The inner loops operate on
+// whole rows of contiguous floats, so that the compiler can vectorize them.
+Image downsample(const Image& src, MipFilter filter)
+{
+    const auto dst_width  = std::max(1UL, src.width / 2);
+    const auto dst_height = std::max(1UL, src.height / 2);
+    const auto src_stride = src.width * CHANNELS;
+
+    // Vertical pass
+    Image      vertical{src.width, dst_height, std::vector<float>(src_stride * dst_height, 0.0F)};
+    const auto rows = calculate_contributions(filter, src.height, dst_height);
+    for (unsigned long y = 0; y < dst_height; ++y) {
+        float* const dst = &vertical.pixels[y * src_stride];
+        for (std::size_t k = 0; k < rows[y].weights.size(); ++k) {
+            const float        weight = rows[y].weights[k];
+            const float* const row    = &src.pixels[(rows[y].first + k) * src_stride];
+            for (std::size_t x = 0; x < src_stride; ++x) {
+                dst[x] += weight * row[x];
+            }
+        }
+    }
+
+    // Horizontal pass
+    Image      dst{dst_width, dst_height, std::vector<float>(dst_width * dst_height * CHANNELS)};
+    const auto columns = calculate_contributions(filter, src.width, dst_width);
+    for (unsigned long y = 0; y < dst_height; ++y) {
+        const float* const row     = &vertical.pixels[y * src_stride];
+        float* const       dst_row = &dst.pixels[y * dst_width * CHANNELS];
+        for (unsigned long x = 0; x < dst_width; ++x) {
+            std::array<float, CHANNELS> sum{};
+            const auto&                 column = columns[x];
+            for (std::size_t k = 0; k < column.weights.size(); ++k) {
+                const float* const pixel = &row[(column.first + k) * CHANNELS];
+                for (std::size_t c = 0; c < CHANNELS; ++c) {
+                    sum[c] += column.weights[k] * pixel[c];
+                }
+            }
+            std::copy(sum.begin(), sum.end(), &dst_row[x * CHANNELS]);
+        }
+    }
+    return dst;
+}
+
+//
+// Block compression
+//
+
+// Quantizes an RGB color to 5:6:5 bits
+std::uint16_t to_rgb565(const std::array<float, 3>& color) noexcept
+{
+    const auto quantize = [](float value, unsigned int max) {
+        return static_cast<unsigned int>(
+            std::lround(std::clamp(value, 0.0F, MAX_UNORM8) * static_cast<float>(max) /
+                        MAX_UNORM8));
+    };
+    return static_cast<std::uint16_t>((quantize(color[0], 31) << 11) |
+                                      (quantize(color[1], 63) << 5) | quantize(color[2], 31));
+}
+
+// Expands a 5:6:5 color to 8 bits per channel, the same way the decoder does
+std::array<float, 3> from_rgb565(unsigned int value) noexcept
+{
+    return {static_cast<float>(((value >> 11) & 0x1F) * 255 / 31),
+            static_cast<float>(((value >> 5) & 0x3F) * 255 / 63),
+            static_cast<float>((value & 0x1F) * 255 / 31)};
+}
+
+float distance_sq(const std::array<float, 3>& c1, const Pixel& c2) noexcept
+{
+    float sum = 0;
+    for (std::size_t c = 0; c < 3; ++c) {
+        const auto d = c1[c] - static_cast<float>(c2[c]);
+        sum += d * d;
+    }
+    return sum;
+}
+
+// An encoded color block, and its squared error
+struct ColorBlock
+{
+    std::uint16_t color0;
+    std::uint16_t color1;
+    std::uint32_t indices;
+    float         error;
+};
+
+// Chooses the best palette entry for every pixel, given two endpoints.
+// The endpoints are ordered so that color0 > color1, which selects the four-color mode.
+ColorBlock match_colors(const std::array<Pixel, 16>& block, std::uint16_t color0,
+                        std::uint16_t color1) noexcept
+{
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+    if (color0 == color1) {
+        // A single color; every pixel uses the first endpoint
+        const auto color = from_rgb565(color0);
+        float      error = 0;
+        for (const auto& pixel : block) {
+            error += distance_sq(color, pixel);
+        }
+        return {color0, color1, 0, error};
+    }
+
+    const auto c0 = from_rgb565(color0);
+    const auto c1 = from_rgb565(color1);
+
+    std::array<std::array<float, 3>, 4> palette{c0, c1};
+    for (std::size_t c = 0; c < 3; ++c) {
+        palette[2][c] = std::floor((2 * c0[c] + c1[c]) / 3);
+        palette[3][c] = std::floor((c0[c] + 2 * c1[c]) / 3);
+    }
+
+    ColorBlock result{color0, color1, 0, 0};
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        std::uint32_t best_index    = 0;
+        float         best_distance = std::numeric_limits<float>::max();
+        for (std::uint32_t p = 0; p < palette.size(); ++p) {
+            const auto distance = distance_sq(palette[p], block[i]);
+            if (distance < best_distance) {
+                best_distance = distance;
+                best_index    = p;
+            }
+        }
+        result.indices |= best_index << (2 * i);
+        result.error += best_distance;
+    }
+    return result;
+}
+
+// Recalculates the endpoints of a block with a least-squares fit to its pixels, given their
+// current palette indices
+std::optional<std::array<std::array<float, 3>, 2>> fit_endpoints(const std::array<Pixel, 16>& block,
+                                                                 std::uint32_t indices) noexcept
+{
+    // The weight of the first endpoint for every palette index
+    constexpr std::array<float, 4> weights{1.0F, 0.0F, 2.0F / 3.0F, 1.0F / 3.0F};
+
+    float                aa = 0;
+    float                ab = 0;
+    float                bb = 0;
+    std::array<float, 3> ax{};
+    std::array<float, 3> bx{};
+    for (std::size_t i = 0; i < block.size(); ++i, indices >>= 2) {
+        const float a = weights[indices & 3];
+        const float b = 1.0F - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (std::size_t c = 0; c < 3; ++c) {
+            ax[c] += a * static_cast<float>(block[i][c]);
+            bx[c] += b * static_cast<float>(block[i][c]);
+        }
+    }
+
+    const float det = aa * bb - ab * ab;
+    if (std::abs(det) < 1e-6F) {
+        return {};
+    }
+
+    std::array<std::array<float, 3>, 2> endpoints{};
+    for (std::size_t c = 0; c < 3; ++c) {
+        endpoints[0][c] = (ax[c] * bb - bx[c] * ab) / det;
+        endpoints[1][c] = (bx[c] * aa - ax[c] * ab) / det;
+    }
+    return endpoints;
+}
+
+// Encodes the colors of a block of pixels as a BC1 color block
+void encode_color_block(const std::array<Pixel, 16>& block, std::uint8_t* output) noexcept
+{
+    // Find the principal axis of the colors, with a few iterations of the power method on their
+    // covariance matrix
+    std::array<float, 3> mean{};
+    for (const auto& pixel : block) {
+        for (std::size_t c = 0; c < 3; ++c) {
+            mean[c] += static_cast<float>(pixel[c]) / static_cast<float>(block.size());
+        }
+    }
+
+    std::array<float, 6> cov{}; // rr, rg, rb, gg, gb, bb
+    for (const auto& pixel : block) {
+        const float r = static_cast<float>(pixel[0]) - mean[0];
+        const float g = static_cast<float>(pixel[1]) - mean[1];
+        const float b = static_cast<float>(pixel[2]) - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    constexpr int        power_iterations = 4;
+    std::array<float, 3> axis{1.0F, 1.0F, 1.0F};
+    for (int i = 0; i < power_iterations; ++i) {
+        const std::array<float, 3> next{cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                                        cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                                        cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]};
+        const float                length =
+            std::max({std::abs(next[0]), std::abs(next[1]), std::abs(next[2])});
+        if (length < 1e-6F) {
+            break;
+        }
+        axis = {next[0] / length, next[1] / length, next[2] / length};
+    }
+
+    // Use the extreme colors along the axis as the initial endpoints
+    const auto project = [&](const Pixel& pixel) {
+        return static_cast<float>(pixel[0]) * axis[0] + static_cast<float>(pixel[1]) * axis[1] +
+               static_cast<float>(pixel[2]) * axis[2];
+    };
+    const auto [min_it, max_it] = std::minmax_element(
+        block.begin(), block.end(),
+        [&](const Pixel& p1, const Pixel& p2) { return project(p1) < project(p2); });
+
+    const auto to_color = [](const Pixel& pixel) {
+        return std::array<float, 3>{static_cast<float>(pixel[0]), static_cast<float>(pixel[1]),
+                                    static_cast<float>(pixel[2])};
+    };
+    auto best = match_colors(block, to_rgb565(to_color(*max_it)), to_rgb565(to_color(*min_it)));
+
+    // Refine the endpoints once, and keep the result if it's better
+    if (const auto endpoints = fit_endpoints(block, best.indices)) {
+        const auto refined =
+            match_colors(block, to_rgb565((*endpoints)[0]), to_rgb565((*endpoints)[1]));
+        if (refined.error < best.error) {
+            best = refined;
+        }
+    }
+
+    output[0] = static_cast<std::uint8_t>(best.color0 & 0xFF);
+    output[1] = static_cast<std::uint8_t>(best.color0 >> 8);
+    output[2] = static_cast<std::uint8_t>(best.color1 & 0xFF);
+    output[3] = static_cast<std::uint8_t>(best.color1 >> 8);
+    for (std::size_t i = 0; i < 4; ++i) {
+        output[4 + i] = static_cast<std::uint8_t>((best.indices >> (8 * i)) & 0xFF);
+    }
+}
+
+// Encodes the alpha of a block of pixels as a BC4 block, in the eight-alpha mode
+void encode_alpha_block(const std::array<Pixel, 16>& block, std::uint8_t* output) noexcept
+{
+    const auto [min_it, max_it] =
+        std::minmax_element(block.begin(), block.end(),
+                            [](const Pixel& p1, const Pixel& p2) { return p1[3] < p2[3]; });
+    const unsigned int alpha0 = (*max_it)[3];
+    const unsigned int alpha1 = (*min_it)[3];
+
+    std::array<unsigned int, 8> palette{alpha0, alpha1};
+    for (unsigned int i = 1; i < 7; ++i) {
+        palette[i + 1] = (alpha0 * (7 - i) + alpha1 * i) / 7;
+    }
+
+    std::uint64_t indices = 0;
+    if (alpha0 != alpha1) {
+        for (std::size_t i = 0; i < block.size(); ++i) {
+            const unsigned int alpha      = block[i][3];
+            std::uint64_t      best_index = 0;
+            unsigned int       best_diff  = std::numeric_limits<unsigned int>::max();
+            for (std::uint64_t p = 0; p < palette.size(); ++p) {
+                const auto diff = (palette[p] > alpha) ? palette[p] - alpha : alpha - palette[p];
+                if (diff < best_diff) {
+                    best_diff  = diff;
+                    best_index = p;
+                }
+            }
+            indices |= best_index << (3 * i);
+        }
+    }
+
+    output[0] = static_cast<std::uint8_t>(alpha0);
+    output[1] = static_cast<std::uint8_t>(alpha1);
+    for (std::size_t i = 0; i < 6; ++i) {
+        output[2 + i] = static_cast<std::uint8_t>((indices >> (8 * i)) & 0xFF);
+    }
+}
+
+// Reads a 4x4 block of pixels from RGBA8 (or BGRA8) data with rows of stride bytes, repeating the
+// edge pixels for blocks that extend beyond the image
+std::array<Pixel, 16> read_block(const std::uint8_t* data, std::size_t stride, unsigned long width,
+                                 unsigned long height, unsigned long block_x,
+                                 unsigned long block_y, bool bgra) noexcept
+{
+    std::array<Pixel, 16> block{};
+    for (unsigned long y = 0; y < BLOCK_DIM; ++y) {
+        const auto src_y = std::min(block_y * BLOCK_DIM + y, height - 1);
+        for (unsigned long x = 0; x < BLOCK_DIM; ++x) {
+            const auto          src_x = std::min(block_x * BLOCK_DIM + x, width - 1);
+            const auto* const   src   = &data[src_y * stride + src_x * CHANNELS];
+            auto&               pixel = block[y * BLOCK_DIM + x];
+            pixel                     = {src[0], src[1], src[2], src[3]};
+            if (bgra) {
+                std::swap(pixel[0], pixel[2]);
+            }
+        }
+    }
+    return block;
+}
+
+bool has_transparency(const TextureDesc& texture_desc) noexcept
+{
+    return !for_each_row(texture_desc, [](const std::uint8_t* row, unsigned long width) {
+        for (std::size_t i = 3; i < width * CHANNELS; i += CHANNELS) {
+            if (row[i] != std::numeric_limits<std::uint8_t>::max()) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+// Checks if the texture looks like a tangent-space normal map: nearly all of its pixels decode
+// to a vector of unit length that points out of the surface
+bool is_normal_map(const TextureDesc& texture_desc) noexcept
+{
+    constexpr float       MAX_LENGTH_SQ_ERROR = 0.2F;
+    constexpr std::size_t OUTLIER_RATIO       = 20; // At most 1 in this many pixels may be off
+
+    std::size_t pixel_count = 0;
+    for_each_row(texture_desc, [&](const std::uint8_t* /*row*/, unsigned long width) {
+        pixel_count += width;
+        return true;
+    });
+    if (pixel_count == 0) {
+        return false;
+    }
+
+    const bool bgra   = is_bgra(texture_desc.pixel_format());
+    const auto decode = [](std::uint8_t value) {
+        return static_cast<float>(value) * 2.0F / MAX_UNORM8 - 1.0F;
+    };
+
+    const auto  max_outliers = pixel_count / OUTLIER_RATIO;
+    std::size_t outliers     = 0;
+    return for_each_row(texture_desc, [&](const std::uint8_t* row, unsigned long width) {
+        for (std::size_t i = 0; i < width * CHANNELS; i += CHANNELS) {
+            const auto x = decode(row[i + (bgra ? 2 : 0)]);
+            const auto y = decode(row[i + 1]);
+            const auto z = decode(row[i + (bgra ? 0 : 2)]);
+            if ((z <= 0 || std::abs(x * x + y * y + z * z - 1.0F) > MAX_LENGTH_SQ_ERROR) &&
+                ++outliers > max_outliers) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+// Checks if process_texture compresses the texture. Normal maps are not compressed: BC1
+// quantizes the three components of a normal together to a few steps along a line, which shows
+// as banding in the lighting.
+bool should_compress(const TextureDesc& texture_desc, const TextureProcessOptions& options) noexcept
+{
+    return options.compress && texture_desc.width() % BLOCK_DIM == 0 &&
+           texture_desc.height() % BLOCK_DIM == 0 && !is_normal_map(texture_desc);
+}
+
+PixelFormat compressed_format(PixelFormat format, bool alpha) noexcept
+{
+    const auto compressed = alpha ? PixelFormat::bc3_unorm : PixelFormat::bc1_unorm;
+    return (color_space(format) == ColorSpace::srgb) ? to_color_space(compressed, ColorSpace::srgb)
+                                                     : compressed;
+}
+
+} // namespace
+
+TextureDesc generate_mips(const TextureDesc& texture_desc, MipFilter filter)
+{
+    if (!is_processable(texture_desc)) {
+        throw ArgumentError();
+    }
+
+    const auto width  = texture_desc.width();
+    const auto height = texture_desc.height();
+    const bool srgb   = color_space(texture_desc.pixel_format()) == ColorSpace::srgb;
+
+    std::size_t mip_levels = 1;
+    while ((std::max(width, height) >> mip_levels) > 0) {
+        ++mip_levels;
+    }
+
+    std::vector<TextureDesc::Subresource> subresources;
+    std::vector<std::uint8_t>             data;
+    for (std::size_t slice = 0; slice < slice_count(texture_desc); ++slice) {
+        // Keep the top-level mip as-is, to avoid any loss of precision
+        const auto& top = texture_desc.subresource(texture_desc.subresource_index(0, slice));
+        const auto* const top_data = texture_desc.data().data() + top.data_offset;
+
+        auto image = decode_image(top_data, top.stride, width, height, srgb);
+        for (std::size_t mip = 0; mip < mip_levels; ++mip) {
+            const auto mip_width  = mip_size(width, mip);
+            const auto mip_height = mip_size(height, mip);
+            const auto size       = mip_width * mip_height * CHANNELS;
+
+            subresources.push_back(
+                {data.size(), size, mip_width * CHANNELS, mip_width * mip_height * CHANNELS});
+            data.resize(data.size() + size);
+            auto* const dst = data.data() + subresources.back().data_offset;
+            if (mip == 0) {
+                // The generated mips are tightly packed, so drop any padding from the source rows
+                for (unsigned long y = 0; y < height; ++y) {
+                    const auto* const row = top_data + y * top.stride;
+                    std::copy(row, row + width * CHANNELS, dst + y * width * CHANNELS);
+                }
+            } else {
+                image = downsample(image, filter);
+                encode_image(image, srgb, dst);
+            }
+        }
+    }
+
+    return {texture_desc.dimension(),
+            width,
+            height,
+            texture_desc.array_size(),
+            mip_levels,
+            texture_desc.pixel_format(),
+            std::move(subresources),
+            std::move(data)};
+}
+
+TextureDesc compress_texture(const TextureDesc& texture_desc, ThreadPool* thread_pool)
+{
+    if (!is_processable(texture_desc)) {
+        throw ArgumentError();
+    }
+
+    const bool alpha      = has_transparency(texture_desc);
+    const bool bgra       = is_bgra(texture_desc.pixel_format());
+    const auto block_size = alpha ? BC3_BLOCK_SIZE : BC1_BLOCK_SIZE;
+    const auto mip_levels = texture_desc.mip_levels();
+
+    // Lay out the compressed subresources in the same order as the source
+    struct BlockRow
+    {
+        std::size_t   subresource;
+        unsigned long y;
+    };
+    std::vector<TextureDesc::Subresource> subresources;
+    std::vector<BlockRow>                 block_rows;
+    std::size_t                           data_size = 0;
+    for (std::size_t slice = 0; slice < slice_count(texture_desc); ++slice) {
+        for (std::size_t mip = 0; mip < mip_levels; ++mip) {
+            const auto blocks_w = (mip_size(texture_desc.width(), mip) + BLOCK_DIM - 1) / BLOCK_DIM;
+            const auto blocks_h =
+                (mip_size(texture_desc.height(), mip) + BLOCK_DIM - 1) / BLOCK_DIM;
+            const auto stride = blocks_w * block_size;
+
+            for (unsigned long y = 0; y < blocks_h; ++y) {
+                block_rows.push_back({subresources.size(), y});
+            }
+            subresources.push_back({data_size, stride * blocks_h, stride, stride * blocks_h});
+            data_size += stride * blocks_h;
+        }
+    }
+
+    std::vector<std::uint8_t> data(data_size);
+    parallel_for(thread_pool, block_rows.size(), [&](std::size_t index) {
+        const auto& row         = block_rows[index];
+        const auto  mip         = row.subresource % mip_levels;
+        const auto  width       = mip_size(texture_desc.width(), mip);
+        const auto  height      = mip_size(texture_desc.height(), mip);
+        const auto& source      = texture_desc.subresource(row.subresource);
+        const auto& subresource = subresources[row.subresource];
+
+        const auto* const src = texture_desc.data().data() + source.data_offset;
+        auto*             dst = data.data() + subresource.data_offset + row.y * subresource.stride;
+        for (unsigned long x = 0; x < subresource.stride / block_size; ++x, dst += block_size) {
+            const auto block = read_block(src, source.stride, width, height, x, row.y, bgra);
+            if (alpha) {
+                encode_alpha_block(block, dst);
+                encode_color_block(block, dst + BC3_BLOCK_SIZE - BC1_BLOCK_SIZE);
+            } else {
+                encode_color_block(block, dst);
+            }
+        }
+    });
+
+    return {texture_desc.dimension(),
+            texture_desc.width(),
+            texture_desc.height(),
+            texture_desc.array_size(),
+            mip_levels,
+            compressed_format(texture_desc.pixel_format(), alpha),
+            std::move(subresources),
+            std::move(data)};
+}
+
+bool can_process_texture(const TextureDesc& texture_desc, const TextureProcessOptions& options)
+{
+    if (!is_processable(texture_desc)) {
+        return false;
+    }
+    const bool mips = options.generate_mips && texture_desc.mip_levels() == 1 &&
+                      std::max(texture_desc.width(), texture_desc.height()) > 1;
+    return mips || should_compress(texture_desc, options);
+}
+
+TextureDesc process_texture(const TextureDesc& texture_desc, const TextureProcessOptions& options,
+                            ThreadPool* thread_pool)
+{
+    if (!can_process_texture(texture_desc, options)) {
+        return texture_desc;
+    }
+
+    auto result = (options.generate_mips && texture_desc.mip_levels() == 1)
+                      ? generate_mips(texture_desc, options.mip_filter)
+                      : texture_desc;
+    if (should_compress(texture_desc, options)) {
+        result = compress_texture(result, thread_pool);
+    }
+    return result;
+}
+
+} // namespace khepri::renderer
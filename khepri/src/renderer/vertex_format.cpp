@@ -0,0 +1,94 @@
+#include <khepri/renderer/vertex_format.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace khepri::renderer {
+namespace {
+// Converts a value in the range [-1, 1] to a signed-normalized 8-bit integer
+std::int8_t to_snorm8(float value) noexcept
+{
+    constexpr float max = 127.0F;
+    return static_cast<std::int8_t>(std::lround(std::clamp(value, -1.0F, 1.0F) * max));
+}
+
+// Converts a value in the range [0, 1] to an unsigned-normalized 8-bit integer
+std::uint8_t to_unorm8(float value) noexcept
+{
+    constexpr float max = 255.0F;
+    return static_cast<std::uint8_t>(std::lround(std::clamp(value, 0.0F, 1.0F) * max));
+}
+
+// Converts a float to an IEEE 754 half-precision float, rounding to nearest-even.
+// Values that are too large become infinity, values that are too small become (signed) zero or
+// a denormal.
+std::uint16_t to_half(float value) noexcept
+{
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const auto     sign     = static_cast<std::uint16_t>((bits >> 16U) & 0x8000U);
+    const auto     exponent = static_cast<std::int32_t>((bits >> 23U) & 0xFFU);
+    std::uint32_t  mantissa = bits & 0x7FFFFFU;
+    constexpr auto half_inf = 0x7C00U;
+
+    if (exponent == 0xFF) {
+        // Infinity or NaN (keep NaN a NaN)
+        return sign | half_inf | ((mantissa != 0) ? 0x200U : 0U);
+    }
+
+    // Re-bias the exponent from float (127) to half (15)
+    const std::int32_t half_exponent = exponent - 127 + 15;
+    if (half_exponent >= 0x1F) {
+        // Too large
+        return sign | half_inf;
+    }
+
+    if (half_exponent <= 0) {
+        if (half_exponent < -10) {
+            // Too small, even for a denormal
+            return sign;
+        }
+        // Denormal: shift the mantissa (with its implicit 1) into place
+        mantissa |= 0x800000U;
+        const auto shift   = static_cast<std::uint32_t>(14 - half_exponent);
+        auto       result  = mantissa >> shift;
+        const auto rest    = mantissa & ((1U << shift) - 1U);
+        const auto halfway = 1U << (shift - 1U);
+        if (rest > halfway || (rest == halfway && (result & 1U) != 0)) {
+            ++result;
+        }
+        return static_cast<std::uint16_t>(sign | result);
+    }
+
+    auto       result = (static_cast<std::uint32_t>(half_exponent) << 10U) | (mantissa >> 13U);
+    const auto rest   = mantissa & 0x1FFFU;
+    if (rest > 0x1000U || (rest == 0x1000U && (result & 1U) != 0)) {
+        // Rounding up can carry into the exponent, which correctly results in infinity when it
+        // overflows
+        ++result;
+    }
+    return static_cast<std::uint16_t>(sign | result);
+}
+} // namespace
+
+CompactVertex to_compact_vertex(const MeshDesc::Vertex& vertex) noexcept
+{
+    // The binormal is reconstructed as cross(normal, tangent) * sign
+    const float binormal_sign =
+        (dot(cross(vertex.normal, vertex.tangent), vertex.binormal) < 0) ? -1.0F : 1.0F;
+
+    CompactVertex result{};
+    result.position = vertex.position;
+    result.normal   = {to_snorm8(vertex.normal.x), to_snorm8(vertex.normal.y),
+                       to_snorm8(vertex.normal.z), 0};
+    result.tangent  = {to_snorm8(vertex.tangent.x), to_snorm8(vertex.tangent.y),
+                       to_snorm8(vertex.tangent.z), to_snorm8(binormal_sign)};
+    result.uv       = {to_half(vertex.uv.x), to_half(vertex.uv.y)};
+    result.color    = {to_unorm8(vertex.color.r), to_unorm8(vertex.color.g),
+                       to_unorm8(vertex.color.b), to_unorm8(vertex.color.a)};
+    return result;
+}
+
+} // namespace khepri::renderer
@@ -0,0 +1,97 @@
+#include <khepri/scene/scene.hpp>
+
+namespace khepri::scene {
+
+SceneObject Scene::create_object()
+{
+    std::uint32_t slot{};
+    if (m_free_slots.empty()) {
+        slot = static_cast<std::uint32_t>(m_slots.size());
+        m_slots.push_back({FREE, 0});
+    } else {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    }
+
+    m_slots[slot].data_index = static_cast<std::uint32_t>(m_objects.size());
+
+    const SceneObject object(*this, {slot, m_slots[slot].generation});
+    m_objects.push_back(object);
+    m_positions.emplace_back(0, 0, 0);
+    m_scales.emplace_back(1, 1, 1);
+    m_rotations.push_back(Quaternion::IDENTITY);
+    m_transforms.push_back(Matrixf::IDENTITY);
+    m_bounds.emplace_back();
+    m_index_entries.push_back(SpatialIndex::NONE);
+    return object;
+}
+
+void Scene::remove_object(const SceneObject& object_ref)
+{
+    if (!contains(object_ref)) {
+        return;
+    }
+
+    // Copy the handle, in case object_ref refers to the element in m_objects that's overwritten
+    const auto object = object_ref;
+    const auto slot   = object.id().index;
+
+    for (const auto* pools : {&m_behaviors, &m_user_data}) {
+        for (const auto& pool : *pools) {
+            if (pool) {
+                pool->remove(slot);
+            }
+        }
+    }
+
+    const auto index = m_slots[slot].data_index;
+    if (m_index_entries[index] != SpatialIndex::NONE) {
+        m_spatial_index.remove(m_index_entries[index]);
+    }
+
+    // Move the last object into the hole to keep the arrays dense
+    const auto last = m_objects.size() - 1;
+    if (index != last) {
+        m_objects[index]       = m_objects[last];
+        m_positions[index]     = m_positions[last];
+        m_scales[index]        = m_scales[last];
+        m_rotations[index]     = m_rotations[last];
+        m_transforms[index]    = m_transforms[last];
+        m_bounds[index]        = m_bounds[last];
+        m_index_entries[index] = m_index_entries[last];
+
+        m_slots[m_objects[index].id().index].data_index = index;
+    }
+    m_objects.pop_back();
+    m_positions.pop_back();
+    m_scales.pop_back();
+    m_rotations.pop_back();
+    m_transforms.pop_back();
+    m_bounds.pop_back();
+    m_index_entries.pop_back();
+
+    // Invalidate all handles to the object
+    m_slots[slot].data_index = FREE;
+    ++m_slots[slot].generation;
+    m_free_slots.push_back(slot);
+}
+
+void Scene::set_bounds(std::size_t index, const std::optional<Sphere>& bounds)
+{
+    m_bounds[index] = bounds;
+
+    auto& entry = m_index_entries[index];
+    if (!bounds) {
+        if (entry != SpatialIndex::NONE) {
+            m_spatial_index.remove(entry);
+            entry = SpatialIndex::NONE;
+        }
+    } else if (entry == SpatialIndex::NONE) {
+        // The index reports the object's slot, which is stable while the object exists
+        entry = m_spatial_index.insert(world_bounds(index), m_objects[index].id().index);
+    } else {
+        m_spatial_index.update(entry, world_bounds(index));
+    }
+}
+
+} // namespace khepri::scene
@@ -0,0 +1,246 @@
+#include <khepri/scene/spatial_index.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace khepri::scene {
+namespace {
+// Entries' bounds are enlarged by this fraction of their largest dimension on every side, so small
+// movements don't require moving the entry in the tree
+constexpr double FAT_BOUNDS_MARGIN = 0.1;
+
+BoundingBox fatten(const BoundingBox& bounds)
+{
+    const auto size = bounds.size();
+    return bounds.grow(std::max({size.x, size.y, size.z}) * FAT_BOUNDS_MARGIN);
+}
+} // namespace
+
+SpatialIndex::EntryId SpatialIndex::insert(const BoundingBox& bounds, std::uint32_t value)
+{
+    const auto leaf      = allocate_node();
+    m_nodes[leaf].box    = fatten(bounds);
+    m_nodes[leaf].bounds = bounds;
+    m_nodes[leaf].height = 0;
+    m_nodes[leaf].value  = value;
+    insert_leaf(leaf);
+    ++m_size;
+    return leaf;
+}
+
+void SpatialIndex::remove(EntryId entry)
+{
+    assert(entry >= 0 && static_cast<std::size_t>(entry) < m_nodes.size());
+    assert(m_nodes[entry].leaf() && m_nodes[entry].height == 0);
+    remove_leaf(entry);
+    free_node(entry);
+    --m_size;
+}
+
+bool SpatialIndex::update(EntryId entry, const BoundingBox& bounds)
+{
+    assert(entry >= 0 && static_cast<std::size_t>(entry) < m_nodes.size());
+    assert(m_nodes[entry].leaf() && m_nodes[entry].height == 0);
+
+    m_nodes[entry].bounds = bounds;
+    if (m_nodes[entry].box.contains(bounds)) {
+        return false;
+    }
+
+    remove_leaf(entry);
+    m_nodes[entry].box = fatten(bounds);
+    insert_leaf(entry);
+    return true;
+}
+
+SpatialIndex::EntryId SpatialIndex::allocate_node()
+{
+    if (m_free_list == NONE) {
+        m_nodes.emplace_back();
+        return static_cast<EntryId>(m_nodes.size() - 1);
+    }
+
+    const auto node = m_free_list;
+    m_free_list     = m_nodes[node].parent;
+    m_nodes[node]   = Node{};
+    return node;
+}
+
+void SpatialIndex::free_node(EntryId node)
+{
+    m_nodes[node].parent = m_free_list;
+    m_nodes[node].height = -1;
+    m_free_list          = node;
+}
+
+void SpatialIndex::insert_leaf(EntryId leaf)
+{
+    if (m_root == NONE) {
+        m_root               = leaf;
+        m_nodes[leaf].parent = NONE;
+        return;
+    }
+
+    // Find the best sibling for the leaf: descend into the child that increases the surface area of
+    // the tree the least, until creating a new parent for the current node is cheaper.
+    const auto box   = m_nodes[leaf].box;
+    auto       index = m_root;
+    while (!m_nodes[index].leaf()) {
+        const auto& node = m_nodes[index];
+
+        const auto area          = node.box.surface_area();
+        const auto combined_area = BoundingBox::merge(node.box, box).surface_area();
+
+        // Cost of creating a new parent for this node and the new leaf
+        const auto cost = 2 * combined_area;
+
+        // Minimum cost of pushing the leaf further down the tree
+        const auto inheritance_cost = 2 * (combined_area - area);
+
+        const auto descend_cost = [&](EntryId child) {
+            const auto& child_box = m_nodes[child].box;
+            const auto  new_area  = BoundingBox::merge(child_box, box).surface_area();
+            return m_nodes[child].leaf() ? new_area + inheritance_cost
+                                         : new_area - child_box.surface_area() + inheritance_cost;
+        };
+
+        const auto cost1 = descend_cost(node.child1);
+        const auto cost2 = descend_cost(node.child2);
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = (cost1 < cost2) ? node.child1 : node.child2;
+    }
+    const auto sibling = index;
+
+    // Create a new parent for the sibling and the leaf
+    const auto old_parent      = m_nodes[sibling].parent;
+    const auto new_parent      = allocate_node();
+    m_nodes[new_parent].parent = old_parent;
+    m_nodes[new_parent].box    = BoundingBox::merge(box, m_nodes[sibling].box);
+    m_nodes[new_parent].height = m_nodes[sibling].height + 1;
+    m_nodes[new_parent].child1 = sibling;
+    m_nodes[new_parent].child2 = leaf;
+    m_nodes[sibling].parent    = new_parent;
+    m_nodes[leaf].parent       = new_parent;
+
+    if (old_parent == NONE) {
+        m_root = new_parent;
+    } else if (m_nodes[old_parent].child1 == sibling) {
+        m_nodes[old_parent].child1 = new_parent;
+    } else {
+        m_nodes[old_parent].child2 = new_parent;
+    }
+
+    refit(m_nodes[leaf].parent);
+}
+
+void SpatialIndex::remove_leaf(EntryId leaf)
+{
+    if (leaf == m_root) {
+        m_root = NONE;
+        return;
+    }
+
+    const auto parent      = m_nodes[leaf].parent;
+    const auto grandparent = m_nodes[parent].parent;
+    const auto sibling =
+        (m_nodes[parent].child1 == leaf) ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    // Replace the parent with the sibling
+    if (grandparent == NONE) {
+        m_root                  = sibling;
+        m_nodes[sibling].parent = NONE;
+        free_node(parent);
+        return;
+    }
+
+    if (m_nodes[grandparent].child1 == parent) {
+        m_nodes[grandparent].child1 = sibling;
+    } else {
+        m_nodes[grandparent].child2 = sibling;
+    }
+    m_nodes[sibling].parent = grandparent;
+    free_node(parent);
+
+    refit(grandparent);
+}
+
+void SpatialIndex::refit(EntryId node)
+{
+    // Walk back up the tree, rebalancing it and fixing the heights and bounds
+    while (node != NONE) {
+        node = balance(node);
+
+        auto&       n      = m_nodes[node];
+        const auto& child1 = m_nodes[n.child1];
+        const auto& child2 = m_nodes[n.child2];
+        n.height           = 1 + std::max(child1.height, child2.height);
+        n.box              = BoundingBox::merge(child1.box, child2.box);
+
+        node = n.parent;
+    }
+}
+
+SpatialIndex::EntryId SpatialIndex::balance(EntryId a)
+{
+    // Performs a left or right rotation if node A is imbalanced. A has children B and C, which have
+    // children D and E, and F and G, respectively. If C is higher than B, C replaces A, A replaces
+    // C's shorter child and that child replaces C. Vice versa if B is higher than C.
+    auto& node_a = m_nodes[a];
+    if (node_a.leaf() || node_a.height < 2) {
+        return a;
+    }
+
+    const auto b = node_a.child1;
+    const auto c = node_a.child2;
+
+    // Rotates child node X of A up. Y is A's other child.
+    const auto rotate_up = [&](EntryId x, EntryId y, bool x_is_child1) {
+        auto&      node_x = m_nodes[x];
+        const auto f      = node_x.child1;
+        const auto g      = node_x.child2;
+
+        // Move X up into A's place, and make A its child
+        node_x.child1 = a;
+        node_x.parent = node_a.parent;
+        node_a.parent = x;
+
+        if (node_x.parent == NONE) {
+            m_root = x;
+        } else if (m_nodes[node_x.parent].child1 == a) {
+            m_nodes[node_x.parent].child1 = x;
+        } else {
+            m_nodes[node_x.parent].child2 = x;
+        }
+
+        // Keep X's higher child, and give its shorter child to A, in X's old place
+        const auto keep = (m_nodes[f].height > m_nodes[g].height) ? f : g;
+        const auto give = (keep == f) ? g : f;
+
+        node_x.child2        = keep;
+        m_nodes[give].parent = a;
+        if (x_is_child1) {
+            node_a.child1 = give;
+        } else {
+            node_a.child2 = give;
+        }
+
+        node_a.box    = BoundingBox::merge(m_nodes[y].box, m_nodes[give].box);
+        node_a.height = 1 + std::max(m_nodes[y].height, m_nodes[give].height);
+        node_x.box    = BoundingBox::merge(node_a.box, m_nodes[keep].box);
+        node_x.height = 1 + std::max(node_a.height, m_nodes[keep].height);
+        return x;
+    };
+
+    const auto difference = m_nodes[c].height - m_nodes[b].height;
+    if (difference > 1) {
+        return rotate_up(c, b, false);
+    }
+    if (difference < -1) {
+        return rotate_up(b, c, true);
+    }
+    return a;
+}
+
+} // namespace khepri::scene
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <cstdint>
 #include <filesystem>
 
 namespace khepri {
@@ -49,6 +50,23 @@ bool case_insensitive_equals(std::string_view s1, std::string_view s2)
                       [&](CharType c1, CharType c2) { return ct.tolower(c1) == ct.tolower(c2); });
 }
 
+std::size_t CaseInsensitiveHash::operator()(std::string_view str) const noexcept
+{
+    // 64-bit FNV-1a on the lowercase characters
+    constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    constexpr std::uint64_t FNV_PRIME        = 1099511628211ULL;
+
+    using CharType = std::string_view::value_type;
+    auto const& ct = std::use_facet<std::ctype<CharType>>(std::locale::classic());
+
+    std::uint64_t hash = FNV_OFFSET_BASIS;
+    for (const auto ch : str) {
+        hash ^= static_cast<unsigned char>(ct.tolower(ch));
+        hash *= FNV_PRIME;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
 Tokenizer::Tokenizer(std::string_view input, std::string_view delimiters, bool keep_empty)
     : m_input(input)
     , m_delimiters(delimiters)
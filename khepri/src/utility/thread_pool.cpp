@@ -0,0 +1,61 @@
+#include <khepri/utility/thread_pool.hpp>
+
+#include <algorithm>
+
+namespace khepri {
+
+ThreadPool::ThreadPool(std::size_t num_threads)
+{
+    if (num_threads == 0) {
+        // Leave one hardware thread for the thread that creates the pool
+        const std::size_t hw_threads = std::thread::hardware_concurrency();
+        num_threads                  = std::max<std::size_t>(hw_threads, 2) - 1;
+    }
+
+    m_threads.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        m_threads.emplace_back([this] { run(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        const std::lock_guard lock(m_mutex);
+        m_stopping = true;
+        m_tasks.clear();
+    }
+    m_cv.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(Task task)
+{
+    {
+        const std::lock_guard lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+}
+
+void ThreadPool::run()
+{
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace khepri
@@ -0,0 +1,97 @@
+#include "matchers.hpp"
+#include "printers.hpp"
+
+#include <khepri/math/bounding_box.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using khepri::BoundingBox;
+using khepri::Sphere;
+using khepri::Vector3;
+
+TEST(BoundingBoxTest, Properties)
+{
+    const BoundingBox box({-1, 0, 2}, {3, 2, 3});
+
+    EXPECT_THAT(box.min(), IsNearVector3(Vector3(-1, 0, 2), 1e-9));
+    EXPECT_THAT(box.max(), IsNearVector3(Vector3(3, 2, 3), 1e-9));
+    EXPECT_THAT(box.center(), IsNearVector3(Vector3(1, 1, 2.5), 1e-9));
+    EXPECT_THAT(box.size(), IsNearVector3(Vector3(4, 2, 1), 1e-9));
+    EXPECT_DOUBLE_EQ(box.surface_area(), 2 * (4 * 2 + 2 * 1 + 1 * 4));
+}
+
+TEST(BoundingBoxTest, FromSphere)
+{
+    const BoundingBox box(Sphere({1, 2, 3}, 2));
+
+    EXPECT_THAT(box.min(), IsNearVector3(Vector3(-1, 0, 1), 1e-9));
+    EXPECT_THAT(box.max(), IsNearVector3(Vector3(3, 4, 5), 1e-9));
+}
+
+TEST(BoundingBoxTest, Inside)
+{
+    const BoundingBox box({0, 0, 0}, {1, 2, 3});
+
+    EXPECT_TRUE(box.inside({0.5, 1, 1.5}));
+    EXPECT_TRUE(box.inside({0, 0, 0}));
+    EXPECT_TRUE(box.inside({1, 2, 3}));
+    EXPECT_FALSE(box.inside({-0.1, 1, 1}));
+    EXPECT_FALSE(box.inside({0.5, 2.1, 1}));
+    EXPECT_FALSE(box.inside({0.5, 1, 3.1}));
+}
+
+TEST(BoundingBoxTest, Contains)
+{
+    const BoundingBox box({0, 0, 0}, {4, 4, 4});
+
+    EXPECT_TRUE(box.contains(box));
+    EXPECT_TRUE(box.contains(BoundingBox({1, 1, 1}, {2, 2, 2})));
+    EXPECT_FALSE(box.contains(BoundingBox({3, 3, 3}, {5, 5, 5})));
+    EXPECT_FALSE(box.contains(BoundingBox({-2, -2, -2}, {6, 6, 6})));
+}
+
+TEST(BoundingBoxTest, IntersectsBox)
+{
+    const BoundingBox box({0, 0, 0}, {4, 4, 4});
+
+    EXPECT_TRUE(box.intersects(BoundingBox({1, 1, 1}, {2, 2, 2})));
+    EXPECT_TRUE(box.intersects(BoundingBox({3, 3, 3}, {5, 5, 5})));
+    EXPECT_TRUE(box.intersects(BoundingBox({-2, -2, -2}, {6, 6, 6})));
+    EXPECT_TRUE(box.intersects(BoundingBox({4, 4, 4}, {5, 5, 5}))); // Touching corners
+
+    // Overlapping on two axes is not enough
+    EXPECT_FALSE(box.intersects(BoundingBox({5, 1, 1}, {6, 2, 2})));
+    EXPECT_FALSE(box.intersects(BoundingBox({1, -3, 1}, {2, -1, 2})));
+    EXPECT_FALSE(box.intersects(BoundingBox({1, 1, 4.5}, {2, 2, 5})));
+}
+
+TEST(BoundingBoxTest, IntersectsSphere)
+{
+    const BoundingBox box({0, 0, 0}, {4, 4, 4});
+
+    EXPECT_TRUE(box.intersects(Sphere({2, 2, 2}, 1)));
+    EXPECT_TRUE(box.intersects(Sphere({5, 2, 2}, 1.5)));
+    EXPECT_FALSE(box.intersects(Sphere({5, 2, 2}, 0.5)));
+
+    // Near a corner, the sphere can be within range of every face's plane without touching the box
+    EXPECT_FALSE(box.intersects(Sphere({5, 5, 5}, 1.5)));
+    EXPECT_TRUE(box.intersects(Sphere({5, 5, 5}, 1.8)));
+}
+
+TEST(BoundingBoxTest, Grow)
+{
+    const auto box = BoundingBox({0, 1, 2}, {3, 4, 5}).grow(0.5);
+
+    EXPECT_THAT(box.min(), IsNearVector3(Vector3(-0.5, 0.5, 1.5), 1e-9));
+    EXPECT_THAT(box.max(), IsNearVector3(Vector3(3.5, 4.5, 5.5), 1e-9));
+}
+
+TEST(BoundingBoxTest, Merge)
+{
+    const auto box =
+        BoundingBox::merge(BoundingBox({0, 1, -2}, {1, 2, 0}), BoundingBox({-1, 0, 3}, {0, 5, 4}));
+
+    EXPECT_THAT(box.min(), IsNearVector3(Vector3(-1, 0, -2), 1e-9));
+    EXPECT_THAT(box.max(), IsNearVector3(Vector3(1, 5, 4), 1e-9));
+}
@@ -0,0 +1,156 @@
+#include <khepri/utility/cache.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using khepri::ConcurrentOwningCache;
+
+namespace {
+struct Item
+{
+    Item(std::string item_name, std::atomic<int>& live_items)
+        : name(std::move(item_name)), live(live_items)
+    {
+        ++live;
+    }
+
+    Item(const Item&)            = delete;
+    Item(Item&&)                 = delete;
+    Item& operator=(const Item&) = delete;
+    Item& operator=(Item&&)      = delete;
+
+    ~Item()
+    {
+        name.clear();
+        --live;
+    }
+
+    std::string       name;
+    std::atomic<int>& live;
+};
+} // namespace
+
+TEST(ConcurrentOwningCacheTest, CachesLoadedItems)
+{
+    std::atomic<int> live{0};
+    std::atomic<int> loads{0};
+
+    ConcurrentOwningCache<Item> cache([&](std::string_view name) -> std::unique_ptr<Item> {
+        ++loads;
+        if (name == "missing") {
+            return nullptr;
+        }
+        return std::make_unique<Item>(std::string(name), live);
+    });
+
+    const auto item = cache.get("item");
+    ASSERT_NE(item, nullptr);
+    EXPECT_EQ(item->name, "item");
+    EXPECT_EQ(cache.get("ITEM"), item);
+    EXPECT_EQ(loads, 1);
+
+    // Failed loads are retried
+    EXPECT_EQ(cache.get("missing"), nullptr);
+    EXPECT_EQ(cache.get("missing"), nullptr);
+    EXPECT_EQ(loads, 3);
+}
+
+TEST(ConcurrentOwningCacheTest, ErasedItemsStayAliveWhileUsed)
+{
+    std::atomic<int>            live{0};
+    ConcurrentOwningCache<Item> cache(
+        [&](std::string_view name) { return std::make_unique<Item>(std::string(name), live); });
+
+    auto item = cache.get("item");
+    EXPECT_TRUE(cache.erase("item"));
+    EXPECT_FALSE(cache.erase("item"));
+
+    // The erased item is destroyed when it's no longer used
+    EXPECT_EQ(live, 1);
+    EXPECT_EQ(item->name, "item");
+    item.reset();
+    EXPECT_EQ(live, 0);
+
+    // Requesting the item again loads it again
+    item = cache.get("item");
+    cache.clear();
+    EXPECT_EQ(live, 1);
+    EXPECT_EQ(item->name, "item");
+}
+
+TEST(ConcurrentOwningCacheTest, ConcurrentRequestsLoadOnce)
+{
+    std::atomic<int>            live{0};
+    std::atomic<int>            loads{0};
+    ConcurrentOwningCache<Item> cache([&](std::string_view name) {
+        ++loads;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return std::make_unique<Item>(std::string(name), live);
+    });
+
+    std::vector<std::shared_ptr<Item>> items(8);
+    std::vector<std::thread>           threads;
+    for (auto& item : items) {
+        threads.emplace_back([&] { item = cache.get("item"); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(loads, 1);
+    for (const auto& item : items) {
+        EXPECT_EQ(item, items[0]);
+    }
+}
+
+TEST(ConcurrentOwningCacheTest, EraseWhileRequesting)
+{
+    constexpr int num_threads  = 4;
+    constexpr int num_items    = 8;
+    constexpr int num_requests = 2000;
+
+    std::atomic<int>            live{0};
+    ConcurrentOwningCache<Item> cache(
+        [&](std::string_view name) { return std::make_unique<Item>(std::string(name), live); });
+
+    const auto item_name = [](int index) { return "item" + std::to_string(index % num_items); };
+
+    // Request items on several threads, while the main thread keeps erasing them
+    std::atomic<int>         failures{0};
+    std::atomic<int>         running{num_threads};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < num_requests; ++i) {
+                const auto name = item_name(i);
+                const auto item = cache.get(name);
+                if (item == nullptr || item->name != name) {
+                    ++failures;
+                }
+            }
+            --running;
+        });
+    }
+
+    while (running > 0) {
+        for (int i = 0; i < num_items; ++i) {
+            cache.erase(item_name(i));
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(failures, 0);
+
+    cache.clear();
+    EXPECT_EQ(live, 0);
+}
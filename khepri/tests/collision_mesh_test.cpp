@@ -0,0 +1,186 @@
+#include "shapes.hpp"
+
+#include <khepri/math/frustum.hpp>
+#include <khepri/math/math.hpp>
+#include <khepri/math/ray.hpp>
+#include <khepri/physics/collision_mesh.hpp>
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <vector>
+
+using khepri::Frustum;
+using khepri::Ray;
+using khepri::Vector3;
+using khepri::Vector3f;
+using khepri::physics::CollisionMesh;
+using Index = CollisionMesh::Index;
+
+namespace {
+struct Mesh
+{
+    std::vector<Vector3f> vertices;
+    std::vector<Index>    indices;
+};
+
+// Creates a unit sphere with shared vertices, with its triangles in random order
+Mesh create_sphere_mesh(std::size_t segments)
+{
+    const auto rings = segments / 2;
+
+    Mesh mesh;
+    for (std::size_t ring = 0; ring <= rings; ++ring) {
+        for (std::size_t segment = 0; segment <= segments; ++segment) {
+            const auto theta = khepri::PI * static_cast<double>(ring) / static_cast<double>(rings);
+            const auto phi =
+                2 * khepri::PI * static_cast<double>(segment) / static_cast<double>(segments);
+            mesh.vertices.emplace_back(static_cast<float>(std::sin(theta) * std::cos(phi)),
+                                       static_cast<float>(std::sin(theta) * std::sin(phi)),
+                                       static_cast<float>(std::cos(theta)));
+        }
+    }
+
+    const auto vertex = [&](std::size_t ring, std::size_t segment) {
+        return static_cast<Index>(ring * (segments + 1) + segment);
+    };
+
+    std::vector<std::array<Index, 3>> triangles;
+    for (std::size_t ring = 0; ring < rings; ++ring) {
+        for (std::size_t segment = 0; segment < segments; ++segment) {
+            // Counter-clockwise, as seen from outside the sphere
+            if (ring > 0) {
+                triangles.push_back(
+                    {vertex(ring, segment), vertex(ring, segment + 1), vertex(ring + 1, segment)});
+            }
+            if (ring + 1 < rings) {
+                triangles.push_back({vertex(ring, segment + 1), vertex(ring + 1, segment + 1),
+                                     vertex(ring + 1, segment)});
+            }
+        }
+    }
+
+    std::mt19937 rng(0); // Fixed seed, so every run uses the same mesh
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+    for (const auto& triangle : triangles) {
+        mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+    }
+    return mesh;
+}
+
+// Möller-Trumbore ray/triangle intersection, like the collision mesh does it
+double intersect_distance(const Ray& ray, const Vector3f& v0, const Vector3f& v1,
+                          const Vector3f& v2)
+{
+    const Vector3f e1  = v1 - v0;
+    const Vector3f e2  = v2 - v0;
+    const auto     h   = cross(ray.direction(), e2);
+    const auto     det = dot(e1, h);
+    if (det < 0.00001) {
+        return -1;
+    }
+    const auto inv_det = 1.0 / det;
+    const auto s       = ray.start() - v0;
+    const auto u       = inv_det * dot(s, h);
+    if (u < 0.0 || u > 1.0) {
+        return -1;
+    }
+    const auto q = cross(s, e1);
+    const auto v = inv_det * dot(ray.direction(), q);
+    if (v < 0.0 || u + v > 1.0) {
+        return -1;
+    }
+    const auto d = inv_det * dot(e2, q);
+    return (d < 0.0) ? -1 : d;
+}
+
+double brute_force_intersect_distance(const Mesh& mesh, const Ray& ray)
+{
+    double min_distance = std::numeric_limits<double>::max();
+    bool   found        = false;
+    for (std::size_t i = 0; i < mesh.indices.size(); i += 3) {
+        const auto distance = intersect_distance(ray, mesh.vertices[mesh.indices[i + 0]],
+                                                 mesh.vertices[mesh.indices[i + 1]],
+                                                 mesh.vertices[mesh.indices[i + 2]]);
+        if (distance >= 0) {
+            min_distance = std::min(min_distance, distance);
+            found        = true;
+        }
+    }
+    return found ? min_distance : -1.0;
+}
+
+bool brute_force_intersect(const Mesh& mesh, const Frustum& frustum)
+{
+    return std::all_of(mesh.vertices.begin(), mesh.vertices.end(),
+                       [&](const auto& v) { return frustum.inside(v); });
+}
+} // namespace
+
+TEST(CollisionMeshTest, RaysMatchBruteForce)
+{
+    const auto          mesh = create_sphere_mesh(32);
+    const CollisionMesh collision_mesh(mesh.vertices, mesh.indices);
+
+    std::mt19937                           rng(1);
+    std::uniform_real_distribution<double> coord(-1, 1);
+    std::uniform_int_distribution<Index>   vertex(0, static_cast<Index>(mesh.vertices.size() - 1));
+
+    for (int i = 0; i < 1000; ++i) {
+        const Vector3 start = normalize(Vector3{coord(rng), coord(rng), coord(rng)}) * 3;
+        const Vector3 target{coord(rng), coord(rng), coord(rng)};
+        const Ray     ray(start, normalize(target - start));
+        EXPECT_EQ(collision_mesh.intersect_distance(ray),
+                  brute_force_intersect_distance(mesh, ray));
+    }
+
+    // Rays along an axis, starting at the coordinates of vertices, so they lie exactly on the
+    // sides of boxes in the hierarchy
+    for (int i = 0; i < 1000; ++i) {
+        const auto& v = mesh.vertices[vertex(rng)];
+        for (const auto& ray : {Ray({v.x, v.y, -3}, {0, 0, 1}), Ray({v.x, -3, v.z}, {0, 1, 0}),
+                                Ray({3, v.y, v.z}, {-1, 0, 0})}) {
+            EXPECT_NEAR(collision_mesh.intersect_distance(ray),
+                        brute_force_intersect_distance(mesh, ray), 1e-6);
+        }
+    }
+}
+
+TEST(CollisionMeshTest, FrustumsMatchBruteForce)
+{
+    const auto          mesh = create_sphere_mesh(32);
+    const CollisionMesh collision_mesh(mesh.vertices, mesh.indices);
+
+    std::mt19937                           rng(2);
+    std::uniform_real_distribution<double> coord(-1.5, 0.5);
+    std::uniform_real_distribution<double> size(1.0, 3.0);
+
+    for (int i = 0; i < 1000; ++i) {
+        const Vector3 min{coord(rng), coord(rng), coord(rng)};
+        const Vector3 max{min + Vector3{size(rng), size(rng), size(rng)}};
+
+        const auto frustum = create_box_frustum(min, max);
+        EXPECT_EQ(collision_mesh.intersect(frustum), brute_force_intersect(mesh, frustum));
+    }
+
+    EXPECT_TRUE(collision_mesh.intersect(create_box_frustum({-1.1, -1.1, -1.1}, {1.1, 1.1, 1.1})));
+}
+
+TEST(CollisionMeshTest, FrustumTestsUnreferencedVertices)
+{
+    const auto frustum = create_box_frustum({-1, -1, -1}, {1, 1, 1});
+
+    // A triangle inside the frustum and a vertex, that is not part of it, outside
+    const std::vector<Vector3f> vertices{{0, 0, 0}, {0.5F, 0, 0}, {0, 0.5F, 0}, {2, 0, 0}};
+    EXPECT_FALSE(CollisionMesh(vertices, {0, 1, 2}).intersect(frustum));
+    EXPECT_TRUE(CollisionMesh({vertices.begin(), vertices.begin() + 3}, {0, 1, 2})
+                    .intersect(frustum));
+
+    // Without triangles, every vertex is still tested
+    EXPECT_FALSE(CollisionMesh(vertices, {}).intersect(frustum));
+    EXPECT_TRUE(CollisionMesh({vertices.begin(), vertices.begin() + 3}, {}).intersect(frustum));
+}
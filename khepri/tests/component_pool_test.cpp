@@ -0,0 +1,104 @@
+#include <khepri/scene/component_pool.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+
+using khepri::scene::ComponentPool;
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+TEST(ComponentPoolTest, Empty)
+{
+    const ComponentPool<int> pool;
+
+    EXPECT_TRUE(pool.empty());
+    EXPECT_EQ(pool.size(), 0U);
+    EXPECT_EQ(pool.get(0), nullptr);
+    EXPECT_EQ(pool.get(100), nullptr);
+}
+
+TEST(ComponentPoolTest, EmplaceAndGet)
+{
+    ComponentPool<int> pool;
+
+    EXPECT_EQ(pool.emplace(5, 50), 50);
+    EXPECT_EQ(pool.emplace(2, 20), 20);
+
+    EXPECT_EQ(pool.size(), 2U);
+    ASSERT_NE(pool.get(5), nullptr);
+    EXPECT_EQ(*pool.get(5), 50);
+    ASSERT_NE(pool.get(2), nullptr);
+    EXPECT_EQ(*pool.get(2), 20);
+    EXPECT_EQ(pool.get(3), nullptr);
+
+    // Components are stored in order of creation
+    EXPECT_THAT(pool.components(), ElementsAre(50, 20));
+    EXPECT_THAT(pool.owners(), ElementsAre(5, 2));
+}
+
+TEST(ComponentPoolTest, EmplaceReplaces)
+{
+    ComponentPool<int> pool;
+    pool.emplace(1, 10);
+    pool.emplace(1, 11);
+
+    EXPECT_EQ(pool.size(), 1U);
+    ASSERT_NE(pool.get(1), nullptr);
+    EXPECT_EQ(*pool.get(1), 11);
+}
+
+TEST(ComponentPoolTest, Remove)
+{
+    ComponentPool<int> pool;
+    pool.emplace(1, 10);
+
+    EXPECT_FALSE(pool.remove(0));
+    EXPECT_FALSE(pool.remove(100));
+
+    EXPECT_TRUE(pool.remove(1));
+    EXPECT_FALSE(pool.remove(1));
+    EXPECT_TRUE(pool.empty());
+    EXPECT_EQ(pool.get(1), nullptr);
+    EXPECT_THAT(pool.components(), IsEmpty());
+    EXPECT_THAT(pool.owners(), IsEmpty());
+}
+
+TEST(ComponentPoolTest, RemoveMovesLastComponentIntoHole)
+{
+    ComponentPool<int> pool;
+    pool.emplace(0, 0);
+    pool.emplace(1, 10);
+    pool.emplace(2, 20);
+    pool.emplace(3, 30);
+
+    EXPECT_TRUE(pool.remove(1));
+    EXPECT_THAT(pool.components(), ElementsAre(0, 30, 20));
+    EXPECT_THAT(pool.owners(), ElementsAre(0, 3, 2));
+
+    // The moved component can still be found by its owner
+    ASSERT_NE(pool.get(3), nullptr);
+    EXPECT_EQ(*pool.get(3), 30);
+
+    // Removing the last component moves nothing
+    EXPECT_TRUE(pool.remove(2));
+    EXPECT_THAT(pool.components(), ElementsAre(0, 30));
+    EXPECT_THAT(pool.owners(), ElementsAre(0, 3));
+
+    // A removed owner can get a component again
+    pool.emplace(1, 11);
+    EXPECT_THAT(pool.components(), ElementsAre(0, 30, 11));
+    EXPECT_THAT(pool.owners(), ElementsAre(0, 3, 1));
+}
+
+TEST(ComponentPoolTest, MoveOnlyComponents)
+{
+    ComponentPool<std::unique_ptr<int>> pool;
+    pool.emplace(0, std::make_unique<int>(0));
+    pool.emplace(1, std::make_unique<int>(1));
+
+    EXPECT_TRUE(pool.remove(0));
+    ASSERT_NE(pool.get(1), nullptr);
+    EXPECT_EQ(**pool.get(1), 1);
+}
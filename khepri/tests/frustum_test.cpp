@@ -0,0 +1,59 @@
+#include "shapes.hpp"
+
+#include <khepri/math/frustum.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using khepri::BoundingBox;
+using khepri::Frustum;
+using khepri::Plane;
+
+TEST(FrustumTest, InsideBox)
+{
+    const auto frustum = create_box_frustum({-1, -1, 0}, {1, 1, 10});
+
+    EXPECT_TRUE(frustum.inside(BoundingBox({-0.5, -0.5, 1}, {0.5, 0.5, 2})));
+    EXPECT_TRUE(frustum.inside(BoundingBox({-1, -1, 0}, {1, 1, 10})));
+
+    // Partially inside
+    EXPECT_FALSE(frustum.inside(BoundingBox({0.5, -0.5, 1}, {1.5, 0.5, 2})));
+    EXPECT_FALSE(frustum.inside(BoundingBox({-0.5, -0.5, 9}, {0.5, 0.5, 11})));
+    EXPECT_FALSE(frustum.inside(BoundingBox({-2, -2, -1}, {2, 2, 11})));
+
+    // Outside
+    EXPECT_FALSE(frustum.inside(BoundingBox({2, 2, 1}, {3, 3, 2})));
+}
+
+TEST(FrustumTest, IntersectsBox)
+{
+    const auto frustum = create_box_frustum({-1, -1, 0}, {1, 1, 10});
+
+    EXPECT_TRUE(frustum.intersects(BoundingBox({-0.5, -0.5, 1}, {0.5, 0.5, 2})));
+    EXPECT_TRUE(frustum.intersects(BoundingBox({0.5, -0.5, 1}, {1.5, 0.5, 2})));
+    EXPECT_TRUE(frustum.intersects(BoundingBox({-0.5, -0.5, 9}, {0.5, 0.5, 11})));
+
+    // Encloses the whole frustum
+    EXPECT_TRUE(frustum.intersects(BoundingBox({-2, -2, -1}, {2, 2, 11})));
+
+    // Entirely outside a single plane
+    EXPECT_FALSE(frustum.intersects(BoundingBox({2, -0.5, 1}, {3, 0.5, 2})));
+    EXPECT_FALSE(frustum.intersects(BoundingBox({-0.5, -3, 1}, {0.5, -2, 2})));
+    EXPECT_FALSE(frustum.intersects(BoundingBox({-0.5, -0.5, -3}, {0.5, 0.5, -1})));
+    EXPECT_FALSE(frustum.intersects(BoundingBox({-0.5, -0.5, 11}, {0.5, 0.5, 12})));
+}
+
+TEST(FrustumTest, IntersectsBoxIsConservative)
+{
+    // A frustum with slanted sides: the left and right planes converge towards the near plane
+    const Frustum frustum(Plane({-1, 0, 0}, khepri::normalize(khepri::Vector3{1, 0, -1})),
+                          Plane({1, 0, 0}, khepri::normalize(khepri::Vector3{-1, 0, -1})),
+                          Plane({0, 1, 0}, {0, -1, 0}), Plane({0, -1, 0}, {0, 1, 0}),
+                          Plane({0, 0, -2}, {0, 0, 1}), Plane({0, 0, 10}, {0, 0, -1}));
+
+    // This box is outside the frustum, next to the edge between the left and near planes, but not
+    // entirely outside any one plane; it is reported as intersecting.
+    const BoundingBox box({-3.6, -0.5, -2.4}, {-3.1, 0.5, -1.9});
+    EXPECT_TRUE(frustum.intersects(box));
+    EXPECT_FALSE(frustum.inside(box));
+}
@@ -0,0 +1,143 @@
+#include "renderer/mesh_allocator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <optional>
+
+using khepri::renderer::detail::MeshAllocator;
+using khepri::renderer::detail::RangeAllocator;
+
+TEST(RangeAllocatorTest, AllocatesFirstFit)
+{
+    RangeAllocator allocator(100);
+
+    EXPECT_EQ(allocator.allocate(10), 0U);
+    EXPECT_EQ(allocator.allocate(20), 10U);
+    EXPECT_EQ(allocator.allocate(70), 30U);
+    EXPECT_EQ(allocator.allocate(1), std::nullopt);
+
+    // Empty ranges always fit
+    EXPECT_EQ(allocator.allocate(0), 0U);
+}
+
+TEST(RangeAllocatorTest, ReusesFreedRanges)
+{
+    RangeAllocator allocator(100);
+    allocator.allocate(10);
+    allocator.allocate(20);
+    allocator.allocate(30);
+
+    allocator.free(10, 20);
+
+    // Too large for the freed range
+    EXPECT_EQ(allocator.allocate(25), 60U);
+
+    EXPECT_EQ(allocator.allocate(15), 10U);
+    EXPECT_EQ(allocator.allocate(5), 25U);
+    EXPECT_EQ(allocator.allocate(16), std::nullopt);
+    EXPECT_EQ(allocator.allocate(15), 85U);
+}
+
+TEST(RangeAllocatorTest, CoalescesFreedRanges)
+{
+    RangeAllocator allocator(40);
+    allocator.allocate(10);
+    allocator.allocate(10);
+    allocator.allocate(10);
+    allocator.allocate(10);
+
+    // Merges with the following range
+    allocator.free(20, 10);
+    allocator.free(10, 10);
+    EXPECT_EQ(allocator.allocate(20), 10U);
+
+    // Merges with the preceding range
+    allocator.free(10, 10);
+    allocator.free(20, 10);
+    EXPECT_EQ(allocator.allocate(20), 10U);
+
+    // Merges with both ranges
+    allocator.free(0, 10);
+    allocator.free(30, 10);
+    allocator.free(10, 20);
+    EXPECT_EQ(allocator.allocate(40), 0U);
+}
+
+TEST(MeshAllocatorTest, SubAllocatesPages)
+{
+    MeshAllocator allocator(100, 300);
+    EXPECT_EQ(allocator.page_count(), 0U);
+
+    const auto mesh1 = allocator.allocate(40, 120);
+    const auto mesh2 = allocator.allocate(60, 180);
+    EXPECT_EQ(allocator.page_count(), 1U);
+    EXPECT_EQ(allocator.page_vertex_count(0), 100U);
+    EXPECT_EQ(allocator.page_index_count(0), 300U);
+
+    EXPECT_EQ(mesh1.page, 0U);
+    EXPECT_EQ(mesh1.base_vertex, 0U);
+    EXPECT_EQ(mesh1.vertex_count, 40U);
+    EXPECT_EQ(mesh1.first_index, 0U);
+    EXPECT_EQ(mesh1.index_count, 120U);
+
+    EXPECT_EQ(mesh2.page, 0U);
+    EXPECT_EQ(mesh2.base_vertex, 40U);
+    EXPECT_EQ(mesh2.vertex_count, 60U);
+    EXPECT_EQ(mesh2.first_index, 120U);
+    EXPECT_EQ(mesh2.index_count, 180U);
+}
+
+TEST(MeshAllocatorTest, GrowsByAddingPages)
+{
+    MeshAllocator allocator(100, 300);
+    allocator.allocate(80, 30);
+
+    // Too many vertices for the first page
+    const auto mesh1 = allocator.allocate(30, 30);
+    EXPECT_EQ(mesh1.page, 1U);
+    EXPECT_EQ(mesh1.base_vertex, 0U);
+
+    // Meshes that fit in the first page still go there
+    const auto mesh2 = allocator.allocate(20, 30);
+    EXPECT_EQ(mesh2.page, 0U);
+    EXPECT_EQ(mesh2.base_vertex, 80U);
+    EXPECT_EQ(allocator.page_count(), 2U);
+
+    // Meshes larger than a page get a page of their own size
+    const auto mesh3 = allocator.allocate(500, 1000);
+    EXPECT_EQ(mesh3.page, 2U);
+    EXPECT_EQ(allocator.page_vertex_count(2), 500U);
+    EXPECT_EQ(allocator.page_index_count(2), 1000U);
+}
+
+TEST(MeshAllocatorTest, ReusesFreedSpace)
+{
+    MeshAllocator allocator(100, 300);
+    const auto    mesh1 = allocator.allocate(50, 150);
+    const auto    mesh2 = allocator.allocate(50, 150);
+
+    allocator.free(mesh1);
+    allocator.free(mesh2);
+
+    // The freed ranges are merged, so a mesh of the size of the page fits again
+    const auto mesh3 = allocator.allocate(100, 300);
+    EXPECT_EQ(mesh3.page, 0U);
+    EXPECT_EQ(mesh3.base_vertex, 0U);
+    EXPECT_EQ(mesh3.first_index, 0U);
+    EXPECT_EQ(allocator.page_count(), 1U);
+}
+
+TEST(MeshAllocatorTest, ReleasesVerticesIfIndicesDontFit)
+{
+    MeshAllocator allocator(100, 300);
+    allocator.allocate(10, 290);
+
+    // The vertices fit in the first page, but the indices don't
+    const auto mesh1 = allocator.allocate(50, 20);
+    EXPECT_EQ(mesh1.page, 1U);
+
+    // The first page's vertices were not leaked by the failed attempt
+    const auto mesh2 = allocator.allocate(90, 10);
+    EXPECT_EQ(mesh2.page, 0U);
+    EXPECT_EQ(mesh2.base_vertex, 10U);
+}
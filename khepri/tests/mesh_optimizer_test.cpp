@@ -0,0 +1,168 @@
+#include <khepri/renderer/mesh_optimizer.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+using khepri::renderer::calculate_acmr;
+using khepri::renderer::MeshDesc;
+using khepri::renderer::optimize_mesh;
+using khepri::renderer::optimize_overdraw;
+using khepri::renderer::optimize_vertex_cache;
+using Index = MeshDesc::Index;
+
+namespace {
+using Triangle = std::array<Index, 3>;
+
+// Creates a grid of size x size quads with shared vertices. The triangles are in random order if
+// shuffle is true, otherwise row by row.
+MeshDesc create_grid(std::size_t size, bool shuffle)
+{
+    MeshDesc mesh;
+    for (std::size_t y = 0; y <= size; ++y) {
+        for (std::size_t x = 0; x <= size; ++x) {
+            MeshDesc::Vertex vertex{};
+            vertex.position = {static_cast<float>(x), static_cast<float>(y), 0};
+            vertex.normal   = {0, 0, 1};
+            mesh.vertices.push_back(vertex);
+        }
+    }
+
+    const auto vertex = [&](std::size_t x, std::size_t y) {
+        return static_cast<Index>(y * (size + 1) + x);
+    };
+
+    std::vector<Triangle> triangles;
+    for (std::size_t y = 0; y < size; ++y) {
+        for (std::size_t x = 0; x < size; ++x) {
+            triangles.push_back({vertex(x, y), vertex(x + 1, y), vertex(x + 1, y + 1)});
+            triangles.push_back({vertex(x, y), vertex(x + 1, y + 1), vertex(x, y + 1)});
+        }
+    }
+
+    if (shuffle) {
+        std::mt19937 rng(0);
+        std::shuffle(triangles.begin(), triangles.end(), rng);
+    }
+    for (const auto& triangle : triangles) {
+        mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+    }
+    return mesh;
+}
+
+// Returns the triangles of a mesh as vertex indices
+std::vector<Triangle> triangles_of(const MeshDesc& mesh)
+{
+    std::vector<Triangle> triangles;
+    for (std::size_t i = 0; i < mesh.indices.size(); i += 3) {
+        triangles.push_back({mesh.indices[i + 0], mesh.indices[i + 1], mesh.indices[i + 2]});
+    }
+    return triangles;
+}
+
+// Returns the triangles of a mesh as vertex positions, sorted, to compare meshes regardless of the
+// order of their triangles and vertices
+std::vector<std::array<float, 9>> sorted_triangles(const MeshDesc& mesh)
+{
+    std::vector<std::array<float, 9>> triangles;
+    for (std::size_t i = 0; i < mesh.indices.size(); i += 3) {
+        std::array<float, 9> triangle{};
+        for (std::size_t j = 0; j < 3; ++j) {
+            const auto& position = mesh.vertices[mesh.indices[i + j]].position;
+            triangle[j * 3 + 0]  = position.x;
+            triangle[j * 3 + 1]  = position.y;
+            triangle[j * 3 + 2]  = position.z;
+        }
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+} // namespace
+
+TEST(MeshOptimizerTest, CalculateAcmr)
+{
+    EXPECT_EQ(calculate_acmr({}), 0.0);
+
+    const std::vector<Index> triangle{0, 1, 2};
+    EXPECT_EQ(calculate_acmr(triangle), 3.0);
+
+    // The second triangle reuses two cached vertices
+    const std::vector<Index> quad{0, 1, 2, 0, 2, 3};
+    EXPECT_EQ(calculate_acmr(quad), 2.0);
+
+    // With a cache of 3 vertices, the third triangle's vertex 0 was evicted
+    const std::vector<Index> fan{0, 1, 2, 0, 2, 3, 0, 3, 4};
+    EXPECT_DOUBLE_EQ(calculate_acmr(fan, 16), 5.0 / 3.0);
+    EXPECT_DOUBLE_EQ(calculate_acmr(fan, 3), 6.0 / 3.0);
+}
+
+TEST(MeshOptimizerTest, OptimizeVertexCacheReordersTriangles)
+{
+    for (const bool shuffle : {true, false}) {
+        const auto original = create_grid(32, shuffle);
+        auto       mesh     = original;
+        optimize_vertex_cache(mesh);
+
+        // The vertices are unchanged, and the triangles are a permutation of the original ones
+        ASSERT_EQ(mesh.vertices.size(), original.vertices.size());
+        ASSERT_EQ(mesh.indices.size(), original.indices.size());
+        const auto triangles          = triangles_of(mesh);
+        const auto original_triangles = triangles_of(original);
+        EXPECT_TRUE(std::is_permutation(triangles.begin(), triangles.end(),
+                                        original_triangles.begin(), original_triangles.end()));
+
+        // The cache efficiency does not get worse, for common cache sizes
+        for (const std::size_t cache_size : {8, 16, 32}) {
+            EXPECT_LE(calculate_acmr(mesh.indices, cache_size),
+                      calculate_acmr(original.indices, cache_size));
+        }
+    }
+}
+
+TEST(MeshOptimizerTest, OptimizeVertexCacheImprovesShuffledMesh)
+{
+    auto mesh = create_grid(32, true);
+    EXPECT_GT(calculate_acmr(mesh.indices), 2.0);
+
+    optimize_vertex_cache(mesh);
+
+    // A grid has about twice as many triangles as vertices, so the ideal ACMR is 0.5
+    EXPECT_LT(calculate_acmr(mesh.indices), 0.8);
+}
+
+TEST(MeshOptimizerTest, OptimizeOverdrawReordersTriangles)
+{
+    const auto original = create_grid(32, true);
+    auto       mesh     = original;
+    optimize_vertex_cache(mesh);
+    optimize_overdraw(mesh);
+
+    EXPECT_EQ(mesh.vertices.size(), original.vertices.size());
+    EXPECT_EQ(sorted_triangles(mesh), sorted_triangles(original));
+}
+
+TEST(MeshOptimizerTest, OptimizeMeshKeepsGeometry)
+{
+    // Duplicate every vertex per triangle, as exporters do
+    const auto grid = create_grid(16, true);
+    MeshDesc   original;
+    for (const auto index : grid.indices) {
+        original.indices.push_back(static_cast<Index>(original.vertices.size()));
+        original.vertices.push_back(grid.vertices[index]);
+    }
+
+    for (const bool reduce_overdraw : {false, true}) {
+        auto mesh = original;
+        optimize_mesh(mesh, reduce_overdraw);
+
+        // The vertices are welded and the geometry is the same
+        EXPECT_EQ(mesh.vertices.size(), grid.vertices.size());
+        EXPECT_EQ(sorted_triangles(mesh), sorted_triangles(original));
+        EXPECT_LE(calculate_acmr(mesh.indices), calculate_acmr(grid.indices));
+    }
+}
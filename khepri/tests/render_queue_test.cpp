@@ -0,0 +1,203 @@
+#include "renderer/render_queue.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+using khepri::renderer::Material;
+using khepri::renderer::Mesh;
+using khepri::renderer::MeshInstance;
+using khepri::renderer::RenderPassDesc;
+using khepri::renderer::detail::radix_sort;
+using khepri::renderer::detail::render_sort_key;
+using khepri::renderer::detail::RenderQueue;
+using khepri::renderer::detail::RenderQueueItem;
+using testing::ElementsAre;
+
+namespace {
+struct TestMesh : Mesh
+{
+    explicit TestMesh(std::uint32_t mesh_id, std::size_t mesh_page) : id(mesh_id), page(mesh_page)
+    {
+    }
+
+    std::uint32_t id;
+    std::size_t   page;
+};
+
+struct TestMaterial : Material
+{
+    explicit TestMaterial(std::uint32_t material_id) : id(material_id) {}
+
+    [[nodiscard]] ParamBlock compile_params(gsl::span<const Param> /*params*/) const override
+    {
+        return {};
+    }
+
+    std::uint32_t id;
+};
+
+std::uint64_t sort_key(RenderPassDesc::DepthSorting depth_sorting, std::uint32_t material,
+                       std::uint32_t mesh, float view_distance)
+{
+    return render_sort_key(depth_sorting, material, mesh, [&] { return view_distance; });
+}
+} // namespace
+
+TEST(RenderQueueTest, SortKeyKeepsMeshIdsAbove255)
+{
+    for (const auto depth_sorting :
+         {RenderPassDesc::DepthSorting::none, RenderPassDesc::DepthSorting::front_to_back,
+          RenderPassDesc::DepthSorting::back_to_front}) {
+        // Meshes that only differ above the lowest 8 bits must not get the same key
+        EXPECT_NE(sort_key(depth_sorting, 1, 0x001, 10), sort_key(depth_sorting, 1, 0x101, 10));
+        EXPECT_NE(sort_key(depth_sorting, 1, 0x100, 10), sort_key(depth_sorting, 1, 0x200, 10));
+        EXPECT_LT(sort_key(depth_sorting, 1, 0x100, 10), sort_key(depth_sorting, 1, 0x200, 10));
+    }
+
+    // Without back-to-front sorting, all bits of the mesh ID are kept
+    EXPECT_LT(sort_key(RenderPassDesc::DepthSorting::none, 1, 0x00FFFF, 10),
+              sort_key(RenderPassDesc::DepthSorting::none, 1, 0x010000, 10));
+    EXPECT_LT(sort_key(RenderPassDesc::DepthSorting::front_to_back, 1, 0x7FFFF, 10),
+              sort_key(RenderPassDesc::DepthSorting::front_to_back, 1, 0x80000, 10));
+}
+
+TEST(RenderQueueTest, SortKeyKeepsMaterialIdsAbove65535)
+{
+    constexpr auto none          = RenderPassDesc::DepthSorting::none;
+    constexpr auto front_to_back = RenderPassDesc::DepthSorting::front_to_back;
+
+    // Materials that only differ above the lowest 16 bits must not interleave
+    for (const auto depth_sorting : {none, front_to_back}) {
+        EXPECT_LT(sort_key(depth_sorting, 0x00001, 0xFFFFF, 100),
+                  sort_key(depth_sorting, 0x10001, 0, 1));
+        EXPECT_LT(sort_key(depth_sorting, 0x10001, 0xFFFFF, 100),
+                  sort_key(depth_sorting, 0x20001, 0, 1));
+    }
+}
+
+TEST(RenderQueueTest, SortKeyOrder)
+{
+    constexpr auto none          = RenderPassDesc::DepthSorting::none;
+    constexpr auto front_to_back = RenderPassDesc::DepthSorting::front_to_back;
+    constexpr auto back_to_front = RenderPassDesc::DepthSorting::back_to_front;
+
+    // Material is the most significant part, then mesh
+    EXPECT_LT(sort_key(none, 1, 0xFFFFF, 0), sort_key(none, 2, 0, 0));
+    EXPECT_LT(sort_key(front_to_back, 1, 0x300, 100), sort_key(front_to_back, 1, 0x400, 1));
+
+    // Depth is ignored without depth sorting
+    EXPECT_EQ(sort_key(none, 1, 0x300, 1), sort_key(none, 1, 0x300, 100));
+
+    // Within the same mesh, nearer instances go first when sorting front to back
+    EXPECT_LT(sort_key(front_to_back, 1, 0x300, 1), sort_key(front_to_back, 1, 0x300, 100));
+    EXPECT_LT(sort_key(front_to_back, 1, 0x300, -5), sort_key(front_to_back, 1, 0x300, 1));
+
+    // Farther instances go first when sorting back to front, regardless of material and mesh
+    EXPECT_LT(sort_key(back_to_front, 2, 0x400, 100), sort_key(back_to_front, 1, 0x300, 1));
+    EXPECT_LT(sort_key(back_to_front, 1, 0x300, 1), sort_key(back_to_front, 1, 0x300, -5));
+}
+
+TEST(RenderQueueTest, RadixSortSortsStably)
+{
+    const std::vector<std::uint64_t> keys{0x0300000000000000, 0x0000000000000100,
+                                          0xFFFFFFFFFFFFFFFF, 0x0000000000000100,
+                                          0x0000000100000000, 0,
+                                          0x0300000000000000, 0x0000000000000001};
+
+    // The mesh instance of every item identifies its original position
+    const std::vector<MeshInstance> instances(keys.size());
+    std::vector<RenderQueueItem>    items;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        items.push_back({keys[i], &instances[i]});
+    }
+
+    std::vector<RenderQueueItem> scratch;
+    radix_sort(items, scratch);
+
+    std::vector<std::uint64_t>       sorted_keys;
+    std::vector<const MeshInstance*> sorted_instances;
+    for (const auto& item : items) {
+        sorted_keys.push_back(item.key);
+        sorted_instances.push_back(item.mesh_info);
+    }
+
+    EXPECT_THAT(sorted_keys, ElementsAre(0, 0x0000000000000001, 0x0000000000000100,
+                                         0x0000000000000100, 0x0000000100000000,
+                                         0x0300000000000000, 0x0300000000000000,
+                                         0xFFFFFFFFFFFFFFFF));
+    EXPECT_THAT(sorted_instances,
+                ElementsAre(&instances[5], &instances[7], &instances[1], &instances[3],
+                            &instances[4], &instances[0], &instances[6], &instances[2]));
+}
+
+TEST(RenderQueueTest, RadixSortHandlesMeshIdsAbove255)
+{
+    std::vector<RenderQueueItem> items;
+    for (std::uint32_t mesh = 0x300; mesh > 0; mesh -= 0x80) {
+        items.push_back({sort_key(RenderPassDesc::DepthSorting::none, 1, mesh, 0), nullptr});
+    }
+
+    std::vector<RenderQueueItem> scratch;
+    radix_sort(items, scratch);
+
+    for (std::size_t i = 1; i < items.size(); ++i) {
+        EXPECT_LT(items[i - 1].key, items[i].key);
+    }
+    EXPECT_EQ(items.front().key, sort_key(RenderPassDesc::DepthSorting::none, 1, 0x080, 0));
+    EXPECT_EQ(items.back().key, sort_key(RenderPassDesc::DepthSorting::none, 1, 0x300, 0));
+}
+
+TEST(RenderQueueTest, DrawCallStateChanges)
+{
+    const TestMaterial material_a(0);
+    const TestMaterial material_b(1);
+    const TestMesh     mesh_1(1, 0);
+    const TestMesh     mesh_2(2, 0);
+    const TestMesh     mesh_3(3, 1);
+
+    Material::ParamBlock params;
+    params.material  = &material_a;
+    params.constants = {1, 2, 3, 4};
+
+    const std::vector<MeshInstance> meshes{
+        {&mesh_1, {}, &material_a, nullptr}, {&mesh_2, {}, &material_a, nullptr},
+        {&mesh_3, {}, &material_b, nullptr}, {&mesh_1, {}, &material_a, nullptr},
+        {&mesh_1, {}, &material_a, &params},
+    };
+
+    // Render pass 1 only renders material B
+    const std::vector<std::size_t> render_passes{0, 1};
+    RenderQueue                    queue;
+    queue.build(render_passes, meshes,
+                [&](std::size_t render_pass, const MeshInstance& mesh_info)
+                    -> std::optional<std::uint64_t> {
+                    const auto& material = static_cast<const TestMaterial&>(*mesh_info.material);
+                    if (render_pass == 1 && &material != &material_b) {
+                        return std::nullopt;
+                    }
+                    return sort_key(RenderPassDesc::DepthSorting::none, material.id,
+                                    static_cast<const TestMesh&>(*mesh_info.mesh).id, 0);
+                });
+
+    std::vector<std::size_t>         instance_counts;
+    std::vector<std::array<bool, 3>> changes;
+    queue.for_each_draw_call(
+        [](const Mesh& mesh) { return static_cast<const TestMesh&>(mesh).page; },
+        [&](const RenderQueue::DrawCall& draw_call, const RenderQueue::StateChanges& change) {
+            instance_counts.push_back(draw_call.instance_count);
+            changes.push_back({change.pipeline, change.params, change.mesh_buffers});
+        });
+
+    // Identical instances are merged, even when they're not adjacent in the input
+    EXPECT_THAT(instance_counts, ElementsAre(2, 1, 1, 1, 1));
+    EXPECT_THAT(changes, ElementsAre(std::array<bool, 3>{true, true, true},   // pass 0, A, mesh 1
+                                     std::array<bool, 3>{false, true, false}, // new parameters
+                                     std::array<bool, 3>{false, true, false}, // mesh 2, same page
+                                     std::array<bool, 3>{true, true, true},   // B, mesh 3
+                                     std::array<bool, 3>{true, true, false})); // pass 1
+}
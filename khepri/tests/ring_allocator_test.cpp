@@ -0,0 +1,89 @@
+#include "renderer/ring_allocator.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <optional>
+
+using khepri::renderer::detail::RingAllocator;
+using testing::Optional;
+
+TEST(RingAllocatorTest, AllocatesAligned)
+{
+    RingAllocator allocator(1024);
+
+    EXPECT_THAT(allocator.allocate(10, 16), Optional(0U));
+    EXPECT_THAT(allocator.allocate(10, 16), Optional(16U));
+    EXPECT_THAT(allocator.allocate(100, 256), Optional(256U));
+    EXPECT_THAT(allocator.allocate(1, 1), Optional(356U));
+
+    // Does not fit in the remainder of the buffer, and there's nothing to wrap around to
+    EXPECT_EQ(allocator.allocate(1024 - 356, 1), std::nullopt);
+}
+
+TEST(RingAllocatorTest, ReleasesFinishedFrames)
+{
+    RingAllocator allocator(1024);
+
+    EXPECT_THAT(allocator.allocate(512, 16), Optional(0U));
+    allocator.finish_frame(1);
+    EXPECT_THAT(allocator.allocate(512, 16), Optional(512U));
+    allocator.finish_frame(2);
+    EXPECT_EQ(allocator.oldest_frame(), 1U);
+
+    // The buffer is full until the GPU has finished a frame
+    EXPECT_EQ(allocator.allocate(16, 16), std::nullopt);
+
+    // Releasing a frame that isn't finished yet frees nothing
+    allocator.release(0);
+    EXPECT_EQ(allocator.oldest_frame(), 1U);
+    EXPECT_EQ(allocator.allocate(16, 16), std::nullopt);
+
+    allocator.release(1);
+    EXPECT_EQ(allocator.oldest_frame(), 2U);
+    EXPECT_THAT(allocator.allocate(16, 16), Optional(0U));
+
+    // Frames without allocations are not tracked
+    allocator.finish_frame(3);
+    allocator.finish_frame(4);
+    allocator.release(4);
+    EXPECT_EQ(allocator.oldest_frame(), std::nullopt);
+
+    // With everything released, allocations start at the beginning again
+    EXPECT_THAT(allocator.allocate(1024, 16), Optional(0U));
+}
+
+TEST(RingAllocatorTest, WrapsAround)
+{
+    RingAllocator allocator(1024);
+
+    EXPECT_THAT(allocator.allocate(400, 16), Optional(0U));
+    allocator.finish_frame(1);
+    EXPECT_THAT(allocator.allocate(400, 16), Optional(400U));
+    allocator.finish_frame(2);
+
+    // The end of the buffer is too small, and the start is still in use by frame 1
+    EXPECT_EQ(allocator.allocate(400, 16), std::nullopt);
+
+    // Once frame 1 is released, the allocation wraps around to the start of the buffer
+    allocator.release(1);
+    EXPECT_THAT(allocator.allocate(400, 16), Optional(0U));
+
+    // The wrapped allocation ends where frame 2 starts, so the buffer is full
+    EXPECT_EQ(allocator.allocate(16, 16), std::nullopt);
+    allocator.finish_frame(3);
+
+    allocator.release(2);
+    EXPECT_THAT(allocator.allocate(400, 16), Optional(400U));
+    allocator.finish_frame(4);
+
+    // The end of the buffer that was skipped when wrapping is released with frame 3
+    EXPECT_EQ(allocator.allocate(224, 16), std::nullopt);
+    allocator.release(3);
+    EXPECT_THAT(allocator.allocate(224, 16), Optional(800U));
+    EXPECT_THAT(allocator.allocate(400, 16), Optional(0U));
+    allocator.finish_frame(5);
+
+    allocator.release(5);
+    EXPECT_EQ(allocator.oldest_frame(), std::nullopt);
+}
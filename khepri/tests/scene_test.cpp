@@ -0,0 +1,224 @@
+#include "matchers.hpp"
+#include "printers.hpp"
+
+#include <khepri/scene/behavior.hpp>
+#include <khepri/scene/scene.hpp>
+#include <khepri/scene/scene_object.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <type_traits>
+#include <vector>
+
+using khepri::Sphere;
+using khepri::Vector3;
+using khepri::scene::Behavior;
+using khepri::scene::ConstSceneObject;
+using khepri::scene::Scene;
+using khepri::scene::SceneObject;
+using testing::ElementsAre;
+using testing::IsEmpty;
+using testing::UnorderedElementsAre;
+
+namespace {
+class TestBehavior : public Behavior
+{
+public:
+    explicit TestBehavior(int value) : value(value) {}
+
+    int value;
+};
+
+std::vector<ConstSceneObject> objects_with_behavior(const Scene& scene)
+{
+    std::vector<ConstSceneObject> objects;
+    for (const auto object : scene.objects<TestBehavior>()) {
+        objects.push_back(object);
+    }
+    return objects;
+}
+} // namespace
+
+TEST(SceneTest, CreateObject)
+{
+    Scene      scene;
+    const auto object = scene.create_object();
+
+    EXPECT_TRUE(object.valid());
+    EXPECT_TRUE(scene.contains(object));
+    EXPECT_EQ(object.scene(), &scene);
+    EXPECT_EQ(scene.size(), 1U);
+    EXPECT_THAT(scene.objects(), ElementsAre(object));
+    EXPECT_EQ(scene.object(object.id().index), object);
+    EXPECT_THAT(object.position(), IsNearVector3(Vector3(0, 0, 0), 1e-9));
+    EXPECT_THAT(object.scale(), IsNearVector3(Vector3(1, 1, 1), 1e-9));
+
+    // A default-constructed handle refers to no object
+    EXPECT_FALSE(SceneObject().valid());
+    EXPECT_FALSE(scene.contains(SceneObject()));
+}
+
+TEST(SceneTest, RemoveObject)
+{
+    Scene      scene;
+    const auto object = scene.create_object();
+    const auto copy   = object;
+
+    scene.remove_object(object);
+
+    EXPECT_FALSE(object.valid());
+    EXPECT_FALSE(copy.valid());
+    EXPECT_FALSE(scene.contains(object));
+    EXPECT_EQ(scene.size(), 0U);
+    EXPECT_THAT(scene.objects(), IsEmpty());
+
+    // Removing it again does nothing
+    scene.remove_object(object);
+    EXPECT_EQ(scene.size(), 0U);
+}
+
+TEST(SceneTest, ReusesSlots)
+{
+    Scene      scene;
+    const auto object1 = scene.create_object();
+    const auto object2 = scene.create_object();
+    EXPECT_NE(object1.id().index, object2.id().index);
+
+    scene.remove_object(object1);
+    const auto object3 = scene.create_object();
+
+    // The slot is reused with the next generation
+    EXPECT_EQ(object3.id().index, object1.id().index);
+    EXPECT_EQ(object3.id().generation, object1.id().generation + 1);
+    EXPECT_NE(object3, object1);
+    EXPECT_TRUE(object3.valid());
+    EXPECT_TRUE(object2.valid());
+    EXPECT_EQ(scene.size(), 2U);
+}
+
+TEST(SceneTest, RejectsStaleHandles)
+{
+    Scene scene;
+    auto  stale = scene.create_object();
+    scene.remove_object(stale);
+
+    auto object = scene.create_object();
+    object.position({1, 2, 3});
+    ASSERT_EQ(object.id().index, stale.id().index);
+
+    EXPECT_FALSE(stale.valid());
+    EXPECT_FALSE(scene.contains(stale));
+    EXPECT_FALSE(scene.contains(stale.id()));
+
+    // Removing the stale handle doesn't remove the object that now uses its slot
+    scene.remove_object(stale);
+    EXPECT_TRUE(object.valid());
+    EXPECT_EQ(scene.size(), 1U);
+    EXPECT_THAT(object.position(), IsNearVector3(Vector3(1, 2, 3), 1e-9));
+
+    // Handles from other scenes are not contained
+    Scene other;
+    other.create_object();
+    EXPECT_FALSE(other.contains(object));
+}
+
+TEST(SceneTest, RemoveMovesLastObjectIntoHole)
+{
+    Scene scene;
+    auto  object1 = scene.create_object();
+    auto  object2 = scene.create_object();
+    auto  object3 = scene.create_object();
+    object1.position({1, 0, 0});
+    object2.position({2, 0, 0});
+    object3.position({3, 0, 0});
+
+    scene.remove_object(object1);
+
+    // The arrays stay dense, and the moved object keeps its ID and data
+    EXPECT_THAT(scene.objects(), ElementsAre(object3, object2));
+    EXPECT_THAT(scene.positions(), ElementsAre(IsNearVector3(Vector3(3, 0, 0), 1e-9),
+                                               IsNearVector3(Vector3(2, 0, 0), 1e-9)));
+    EXPECT_EQ(scene.transforms().size(), 2U);
+    EXPECT_TRUE(object3.valid());
+    EXPECT_THAT(object3.position(), IsNearVector3(Vector3(3, 0, 0), 1e-9));
+    EXPECT_EQ(scene.object(object3.id().index), object3);
+
+    object3.position({4, 0, 0});
+    EXPECT_THAT(scene.positions(), ElementsAre(IsNearVector3(Vector3(4, 0, 0), 1e-9),
+                                               IsNearVector3(Vector3(2, 0, 0), 1e-9)));
+}
+
+TEST(SceneTest, RemoveObjectRemovesBehaviors)
+{
+    Scene scene;
+    auto  object1 = scene.create_object();
+    auto  object2 = scene.create_object();
+    auto  object3 = scene.create_object();
+    object1.create_behavior<TestBehavior>(1);
+    object3.create_behavior<TestBehavior>(3);
+    object3.user_data(3);
+
+    ASSERT_NE(object1.behavior<TestBehavior>(), nullptr);
+    EXPECT_EQ(object1.behavior<TestBehavior>()->value, 1);
+    EXPECT_EQ(object2.behavior<TestBehavior>(), nullptr);
+    EXPECT_THAT(objects_with_behavior(scene), UnorderedElementsAre(object1, object3));
+
+    scene.remove_object(object3);
+    EXPECT_THAT(objects_with_behavior(scene), ElementsAre(object1));
+    EXPECT_EQ(scene.behaviors<TestBehavior>()->size(), 1U);
+    EXPECT_THAT(scene.user_data<int>().components(), IsEmpty());
+
+    // A new object in the reused slot doesn't inherit the behaviors
+    const auto object4 = scene.create_object();
+    ASSERT_EQ(object4.id().index, object3.id().index);
+    EXPECT_EQ(object4.behavior<TestBehavior>(), nullptr);
+    EXPECT_EQ(object4.user_data<int>(), nullptr);
+
+    EXPECT_TRUE(object1.remove_behavior<TestBehavior>());
+    EXPECT_FALSE(object1.remove_behavior<TestBehavior>());
+    EXPECT_THAT(objects_with_behavior(scene), IsEmpty());
+}
+
+TEST(SceneTest, ConstSceneHandsOutReadOnlyHandles)
+{
+    Scene scene;
+    auto  object = scene.create_object();
+    object.position({1, 2, 3});
+    object.bounds(Sphere({0, 0, 0}, 1));
+    object.create_behavior<TestBehavior>(1);
+    object.user_data(2);
+
+    const Scene& const_scene = scene;
+    static_assert(std::is_same_v<decltype(const_scene.object(0)), ConstSceneObject>);
+    static_assert(std::is_same_v<decltype(*const_scene.objects<TestBehavior>().begin()),
+                                 ConstSceneObject>);
+
+    // The read-only handle refers to the same object
+    const auto handle = const_scene.object(object.id().index);
+    EXPECT_EQ(handle, object);
+    EXPECT_EQ(handle.scene(), &const_scene);
+    EXPECT_TRUE(handle.valid());
+    EXPECT_TRUE(const_scene.contains(handle));
+    EXPECT_THAT(handle.position(), IsNearVector3(Vector3(1, 2, 3), 1e-9));
+    ASSERT_NE(handle.behavior<TestBehavior>(), nullptr);
+    EXPECT_EQ(handle.behavior<TestBehavior>()->value, 1);
+    ASSERT_NE(handle.user_data<int>(), nullptr);
+    EXPECT_EQ(*handle.user_data<int>(), 2);
+
+    std::vector<ConstSceneObject> found;
+    const_scene.query(Sphere({1, 2, 3}, 0.5),
+                      [&](const ConstSceneObject& result) { found.push_back(result); });
+    EXPECT_THAT(found, ElementsAre(object));
+
+    // A non-const scene hands out handles that can modify the object
+    scene.query(Sphere({1, 2, 3}, 0.5), [](SceneObject result) { result.position({4, 5, 6}); });
+    for (auto result : scene.objects<TestBehavior>()) {
+        result.scale({2, 2, 2});
+    }
+    EXPECT_THAT(handle.position(), IsNearVector3(Vector3(4, 5, 6), 1e-9));
+    EXPECT_THAT(handle.scale(), IsNearVector3(Vector3(2, 2, 2), 1e-9));
+
+    scene.remove_object(object);
+    EXPECT_FALSE(handle.valid());
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <khepri/math/frustum.hpp>
+#include <khepri/math/plane.hpp>
+#include <khepri/math/vector3.hpp>
+
+// A box-shaped frustum from min to max, with its near plane at min.z
+inline khepri::Frustum create_box_frustum(const khepri::Vector3& min, const khepri::Vector3& max)
+{
+    using khepri::Plane;
+    return {Plane(min, {1, 0, 0}), Plane(max, {-1, 0, 0}), Plane(max, {0, -1, 0}),
+            Plane(min, {0, 1, 0}), Plane(min, {0, 0, 1}),  Plane(max, {0, 0, -1})};
+}
@@ -0,0 +1,162 @@
+#include <khepri/scene/spatial_index.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using khepri::BoundingBox;
+using khepri::Frustum;
+using khepri::Plane;
+using khepri::Ray;
+using khepri::Sphere;
+using khepri::Vector3;
+using khepri::scene::SpatialIndex;
+using testing::IsEmpty;
+using testing::UnorderedElementsAre;
+using testing::UnorderedElementsAreArray;
+
+namespace {
+template <typename Query>
+std::vector<std::uint32_t> query(const SpatialIndex& index, const Query& query)
+{
+    std::vector<std::uint32_t> values;
+    index.query(query, [&](std::uint32_t value) { values.push_back(value); });
+    return values;
+}
+
+BoundingBox unit_box(const Vector3& min)
+{
+    return {min, min + Vector3{1, 1, 1}};
+}
+} // namespace
+
+TEST(SpatialIndexTest, Empty)
+{
+    const SpatialIndex index;
+
+    EXPECT_EQ(index.size(), 0U);
+    EXPECT_EQ(index.height(), 0);
+    EXPECT_THAT(query(index, BoundingBox({-100, -100, -100}, {100, 100, 100})), IsEmpty());
+}
+
+TEST(SpatialIndexTest, InsertAndQuery)
+{
+    SpatialIndex index;
+    index.insert(unit_box({0, 0, 0}), 1);
+    index.insert(unit_box({10, 0, 0}), 2);
+    index.insert(unit_box({0, 10, 0}), 3);
+    EXPECT_EQ(index.size(), 3U);
+
+    EXPECT_THAT(query(index, BoundingBox({-1, -1, -1}, {11, 0.5, 1})), UnorderedElementsAre(1, 2));
+    EXPECT_THAT(query(index, BoundingBox({5, 5, 5}, {6, 6, 6})), IsEmpty());
+
+    EXPECT_THAT(query(index, Sphere({0.5, 5, 0.5}, 5)), UnorderedElementsAre(1, 3));
+    EXPECT_THAT(query(index, Sphere({5, 5, 0.5}, 1)), IsEmpty());
+
+    // Along the X axis, through the first two boxes
+    EXPECT_THAT(query(index, Ray({-5, 0.5, 0.5}, {1, 0, 0})), UnorderedElementsAre(1, 2));
+    EXPECT_THAT(query(index, Ray({-5, 0.5, 0.5}, {-1, 0, 0})), IsEmpty());
+
+    // A box-shaped frustum around the third box
+    const Frustum frustum(Plane({-1, 0, 0}, {1, 0, 0}), Plane({2, 0, 0}, {-1, 0, 0}),
+                          Plane({0, 12, 0}, {0, -1, 0}), Plane({0, 9, 0}, {0, 1, 0}),
+                          Plane({0, 0, -1}, {0, 0, 1}), Plane({0, 0, 2}, {0, 0, -1}));
+    EXPECT_THAT(query(index, frustum), UnorderedElementsAre(3));
+}
+
+TEST(SpatialIndexTest, QueriesUseExactBounds)
+{
+    SpatialIndex index;
+    index.insert(BoundingBox({0, 0, 0}, {10, 10, 10}), 1);
+
+    // Within the enlarged bounds of the entry, but not its exact bounds
+    EXPECT_THAT(query(index, BoundingBox({10.5, 0, 0}, {10.6, 1, 1})), IsEmpty());
+    EXPECT_THAT(query(index, BoundingBox({9.5, 0, 0}, {10.6, 1, 1})), UnorderedElementsAre(1));
+}
+
+TEST(SpatialIndexTest, Update)
+{
+    SpatialIndex index;
+    const auto   entry = index.insert(unit_box({0, 0, 0}), 1);
+    index.insert(unit_box({10, 0, 0}), 2);
+
+    // A small move stays within the enlarged bounds
+    EXPECT_FALSE(index.update(entry, unit_box({0.05, 0, 0})));
+    EXPECT_THAT(query(index, BoundingBox({1.02, 0, 0}, {1.04, 1, 1})), UnorderedElementsAre(1));
+
+    // A large move moves the entry in the tree
+    EXPECT_TRUE(index.update(entry, unit_box({20, 0, 0})));
+    EXPECT_THAT(query(index, unit_box({0, 0, 0})), IsEmpty());
+    EXPECT_THAT(query(index, unit_box({20, 0, 0})), UnorderedElementsAre(1));
+    EXPECT_EQ(index.size(), 2U);
+}
+
+TEST(SpatialIndexTest, Remove)
+{
+    SpatialIndex index;
+    const auto   entry1 = index.insert(unit_box({0, 0, 0}), 1);
+    const auto   entry2 = index.insert(unit_box({0, 0, 0}), 2);
+
+    index.remove(entry1);
+    EXPECT_EQ(index.size(), 1U);
+    EXPECT_THAT(query(index, unit_box({0, 0, 0})), UnorderedElementsAre(2));
+
+    index.remove(entry2);
+    EXPECT_EQ(index.size(), 0U);
+    EXPECT_THAT(query(index, unit_box({0, 0, 0})), IsEmpty());
+
+    // Removed entries are reused
+    const auto entry3 = index.insert(unit_box({0, 0, 0}), 3);
+    EXPECT_TRUE(entry3 == entry1 || entry3 == entry2);
+    EXPECT_THAT(query(index, unit_box({0, 0, 0})), UnorderedElementsAre(3));
+}
+
+TEST(SpatialIndexTest, MatchesBruteForce)
+{
+    std::mt19937                           rng(0);
+    std::uniform_real_distribution<double> position(0, 100);
+    std::uniform_real_distribution<double> extent(0.1, 5);
+
+    const auto random_box = [&] {
+        const Vector3 min{position(rng), position(rng), position(rng)};
+        return BoundingBox(min, min + Vector3{extent(rng), extent(rng), extent(rng)});
+    };
+
+    SpatialIndex                       index;
+    std::vector<SpatialIndex::EntryId> entries;
+    std::vector<BoundingBox>           boxes;
+    std::vector<bool>                  alive;
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        boxes.push_back(random_box());
+        entries.push_back(index.insert(boxes.back(), i));
+        alive.push_back(true);
+    }
+
+    // Move some entries and remove others
+    for (std::size_t i = 0; i < boxes.size(); i += 3) {
+        boxes[i] = random_box();
+        index.update(entries[i], boxes[i]);
+    }
+    for (std::size_t i = 1; i < boxes.size(); i += 7) {
+        index.remove(entries[i]);
+        alive[i] = false;
+    }
+
+    // A balanced tree of about 850 entries should be far from degenerate
+    EXPECT_LT(index.height(), 30);
+
+    for (int q = 0; q < 100; ++q) {
+        const auto                 box = random_box().grow(5);
+        std::vector<std::uint32_t> expected;
+        for (std::uint32_t i = 0; i < boxes.size(); ++i) {
+            if (alive[i] && boxes[i].intersects(box)) {
+                expected.push_back(i);
+            }
+        }
+        EXPECT_THAT(query(index, box), UnorderedElementsAreArray(expected));
+    }
+}
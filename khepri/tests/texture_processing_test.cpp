@@ -0,0 +1,465 @@
+#include <khepri/renderer/texture_processing.hpp>
+#include <khepri/utility/thread_pool.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+using khepri::renderer::can_process_texture;
+using khepri::renderer::compress_texture;
+using khepri::renderer::generate_mips;
+using khepri::renderer::MipFilter;
+using khepri::renderer::PixelFormat;
+using khepri::renderer::process_texture;
+using khepri::renderer::TextureDesc;
+using khepri::renderer::TextureDimension;
+using khepri::renderer::TextureProcessOptions;
+
+namespace {
+using Pixel = std::array<std::uint8_t, 4>;
+
+constexpr std::size_t CHANNELS = 4;
+
+// Creates a 2D texture with a single mip level. Every row is followed by row_padding bytes of
+// padding, which are filled with garbage.
+template <typename PixelFunc>
+TextureDesc create_texture(unsigned long width, unsigned long height, PixelFormat format,
+                           const PixelFunc& pixel, std::size_t row_padding = 0)
+{
+    const auto                stride = width * CHANNELS + row_padding;
+    std::vector<std::uint8_t> data(stride * height, 0x5A);
+    for (unsigned long y = 0; y < height; ++y) {
+        for (unsigned long x = 0; x < width; ++x) {
+            const Pixel value = pixel(x, y);
+            std::copy(value.begin(), value.end(), &data[y * stride + x * CHANNELS]);
+        }
+    }
+    return {TextureDimension::texture_2d,
+            width,
+            height,
+            0,
+            1,
+            format,
+            {{0, data.size(), stride, data.size()}},
+            std::move(data)};
+}
+
+// Returns a copy of the data of a texture, to compare textures
+std::vector<std::uint8_t> data_of(const TextureDesc& texture)
+{
+    return {texture.data().begin(), texture.data().end()};
+}
+
+// Returns the pixels of an uncompressed subresource, without any row padding
+std::vector<Pixel> read_pixels(const TextureDesc& texture, std::size_t subresource_index)
+{
+    const auto  mip         = subresource_index % texture.mip_levels();
+    const auto  width       = std::max(1UL, texture.width() >> mip);
+    const auto  height      = std::max(1UL, texture.height() >> mip);
+    const auto& subresource = texture.subresource(subresource_index);
+
+    std::vector<Pixel> pixels;
+    for (unsigned long y = 0; y < height; ++y) {
+        for (unsigned long x = 0; x < width; ++x) {
+            const auto* src = &texture.data()[subresource.data_offset + y * subresource.stride +
+                                              x * CHANNELS];
+            pixels.push_back({src[0], src[1], src[2], src[3]});
+        }
+    }
+    return pixels;
+}
+
+std::array<int, 3> from_rgb565(unsigned int value)
+{
+    return {static_cast<int>(((value >> 11) & 0x1F) * 255 / 31),
+            static_cast<int>(((value >> 5) & 0x3F) * 255 / 63),
+            static_cast<int>((value & 0x1F) * 255 / 31)};
+}
+
+// Decodes a BC1 color block as specified by Direct3D. The color block of a BC3 block always uses
+// the four-color mode.
+std::array<Pixel, 16> decode_color_block(const std::uint8_t* block, bool four_colors)
+{
+    const unsigned int c0 = block[0] | (block[1] << 8);
+    const unsigned int c1 = block[2] | (block[3] << 8);
+    const auto         e0 = from_rgb565(c0);
+    const auto         e1 = from_rgb565(c1);
+
+    std::array<Pixel, 4> palette{};
+    for (std::size_t c = 0; c < 3; ++c) {
+        palette[0][c] = static_cast<std::uint8_t>(e0[c]);
+        palette[1][c] = static_cast<std::uint8_t>(e1[c]);
+        if (four_colors || c0 > c1) {
+            palette[2][c] = static_cast<std::uint8_t>((2 * e0[c] + e1[c]) / 3);
+            palette[3][c] = static_cast<std::uint8_t>((e0[c] + 2 * e1[c]) / 3);
+        } else {
+            palette[2][c] = static_cast<std::uint8_t>((e0[c] + e1[c]) / 2);
+        }
+    }
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    palette[3][3] = (four_colors || c0 > c1) ? 255 : 0;
+
+    std::array<Pixel, 16> pixels{};
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = palette[(block[4 + i / 4] >> (2 * (i % 4))) & 3];
+    }
+    return pixels;
+}
+
+// Decodes a BC4 block as specified by Direct3D
+std::array<std::uint8_t, 16> decode_alpha_block(const std::uint8_t* block)
+{
+    const int a0 = block[0];
+    const int a1 = block[1];
+
+    std::array<int, 8> palette{a0, a1};
+    if (a0 > a1) {
+        for (int i = 1; i < 7; ++i) {
+            palette[i + 1] = (a0 * (7 - i) + a1 * i) / 7;
+        }
+    } else {
+        for (int i = 1; i < 5; ++i) {
+            palette[i + 1] = (a0 * (5 - i) + a1 * i) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    std::uint64_t indices = 0;
+    for (std::size_t i = 0; i < 6; ++i) {
+        indices |= static_cast<std::uint64_t>(block[2 + i]) << (8 * i);
+    }
+
+    std::array<std::uint8_t, 16> alpha{};
+    for (std::size_t i = 0; i < alpha.size(); ++i, indices >>= 3) {
+        alpha[i] = static_cast<std::uint8_t>(palette[indices & 7]);
+    }
+    return alpha;
+}
+
+// Decodes the top-level mip of a BC1 or BC3 texture
+std::vector<Pixel> decode_texture(const TextureDesc& texture, bool bc3)
+{
+    const auto  block_size  = bc3 ? 16 : 8;
+    const auto  blocks_w    = (texture.width() + 3) / 4;
+    const auto  blocks_h    = (texture.height() + 3) / 4;
+    const auto& subresource = texture.subresource(0);
+
+    std::vector<Pixel> pixels(texture.width() * texture.height());
+    for (unsigned long by = 0; by < blocks_h; ++by) {
+        for (unsigned long bx = 0; bx < blocks_w; ++bx) {
+            const auto* block = &texture.data()[subresource.data_offset + by * subresource.stride +
+                                                bx * block_size];
+            auto colors = decode_color_block(bc3 ? block + 8 : block, bc3);
+            if (bc3) {
+                const auto alpha = decode_alpha_block(block);
+                for (std::size_t i = 0; i < colors.size(); ++i) {
+                    colors[i][3] = alpha[i];
+                }
+            }
+            for (unsigned long i = 0; i < colors.size(); ++i) {
+                const auto x = bx * 4 + i % 4;
+                const auto y = by * 4 + i / 4;
+                if (x < texture.width() && y < texture.height()) {
+                    pixels[y * texture.width() + x] = colors[i];
+                }
+            }
+        }
+    }
+    return pixels;
+}
+
+struct Error
+{
+    int    max;
+    double mean;
+};
+
+// Returns the error of every channel of the decoded pixels
+std::array<Error, 4> channel_errors(const std::vector<Pixel>& expected,
+                                    const std::vector<Pixel>& actual)
+{
+    std::array<Error, 4> errors{};
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        for (std::size_t c = 0; c < CHANNELS; ++c) {
+            const auto error = std::abs(expected[i][c] - actual[i][c]);
+            errors[c].max    = std::max(errors[c].max, error);
+            errors[c].mean += static_cast<double>(error) / static_cast<double>(expected.size());
+        }
+    }
+    return errors;
+}
+
+// A smooth color gradient with some noise, as in typical diffuse textures
+Pixel gradient(unsigned long x, unsigned long y)
+{
+    const auto noise = static_cast<int>((x * 7 + y * 13) % 5);
+    return {static_cast<std::uint8_t>(x * 3 + noise), static_cast<std::uint8_t>(y * 4),
+            static_cast<std::uint8_t>(255 - x * 2 - y * 2), 255};
+}
+
+// A normal map of gentle bumps, encoded as RGB
+Pixel bumps(unsigned long x, unsigned long y)
+{
+    const auto nx     = 0.4F * std::sin(static_cast<float>(x) * 0.5F);
+    const auto ny     = 0.4F * std::cos(static_cast<float>(y) * 0.3F);
+    const auto nz     = std::sqrt(1.0F - nx * nx - ny * ny);
+    const auto encode = [](float value) {
+        return static_cast<std::uint8_t>(std::lround((value + 1.0F) * 127.5F));
+    };
+    return {encode(nx), encode(ny), encode(nz), 255};
+}
+} // namespace
+
+TEST(TextureProcessingTest, CompressesOpaqueTexturesToBc1)
+{
+    const auto texture = create_texture(64, 32, PixelFormat::r8g8b8a8_unorm_srgb, gradient);
+    const auto compressed = compress_texture(texture);
+
+    EXPECT_EQ(compressed.pixel_format(), PixelFormat::bc1_unorm_srgb);
+    EXPECT_EQ(compressed.width(), 64U);
+    EXPECT_EQ(compressed.height(), 32U);
+    ASSERT_EQ(compressed.mip_levels(), 1U);
+    EXPECT_EQ(compressed.subresource(0).stride, 16U * 8U);
+    EXPECT_EQ(compressed.subresource(0).data_size, 16U * 8U * 8U);
+    ASSERT_EQ(compressed.data().size(), 16U * 8U * 8U);
+
+    const auto errors = channel_errors(read_pixels(texture, 0), decode_texture(compressed, false));
+    for (std::size_t c = 0; c < 3; ++c) {
+        EXPECT_LE(errors[c].max, 16) << "channel " << c;
+        EXPECT_LE(errors[c].mean, 4.0) << "channel " << c;
+    }
+    EXPECT_EQ(errors[3].max, 0);
+}
+
+TEST(TextureProcessingTest, CompressesTransparentTexturesToBc3)
+{
+    const auto texture =
+        create_texture(32, 32, PixelFormat::r8g8b8a8_unorm, [](unsigned long x, unsigned long y) {
+            auto pixel = gradient(x, y);
+            pixel[3]   = static_cast<std::uint8_t>(x * 8 + y % 4);
+            return pixel;
+        });
+    const auto compressed = compress_texture(texture);
+
+    EXPECT_EQ(compressed.pixel_format(), PixelFormat::bc3_unorm);
+    EXPECT_EQ(compressed.subresource(0).stride, 8U * 16U);
+    ASSERT_EQ(compressed.data().size(), 8U * 8U * 16U);
+
+    const auto errors = channel_errors(read_pixels(texture, 0), decode_texture(compressed, true));
+    for (std::size_t c = 0; c < 3; ++c) {
+        EXPECT_LE(errors[c].max, 16) << "channel " << c;
+        EXPECT_LE(errors[c].mean, 4.0) << "channel " << c;
+    }
+
+    // Every block has an alpha range of at most 27, split into 7 steps
+    EXPECT_LE(errors[3].max, 2);
+}
+
+TEST(TextureProcessingTest, CompressesSingleTransparentPixelToBc3)
+{
+    const auto texture =
+        create_texture(8, 8, PixelFormat::r8g8b8a8_unorm, [](unsigned long x, unsigned long y) {
+            return Pixel{255, 0, 0, static_cast<std::uint8_t>((x == 5 && y == 2) ? 0 : 255)};
+        });
+    const auto compressed = compress_texture(texture);
+    ASSERT_EQ(compressed.pixel_format(), PixelFormat::bc3_unorm);
+
+    // Pure red and the alpha extremes are represented exactly
+    EXPECT_EQ(decode_texture(compressed, true), read_pixels(texture, 0));
+}
+
+TEST(TextureProcessingTest, CompressesBgraTextures)
+{
+    const auto rgba = create_texture(16, 16, PixelFormat::r8g8b8a8_unorm, gradient);
+    const auto bgra =
+        create_texture(16, 16, PixelFormat::b8g8r8a8_unorm, [](unsigned long x, unsigned long y) {
+            const auto pixel = gradient(x, y);
+            return Pixel{pixel[2], pixel[1], pixel[0], pixel[3]};
+        });
+
+    // The compressed formats have no channel order, so both compress to the same data
+    const auto compressed = compress_texture(bgra);
+    EXPECT_EQ(compressed.pixel_format(), PixelFormat::bc1_unorm);
+    EXPECT_EQ(data_of(compressed), data_of(compress_texture(rgba)));
+}
+
+TEST(TextureProcessingTest, CompressesWithThreadPool)
+{
+    const auto texture = generate_mips(
+        create_texture(64, 64, PixelFormat::r8g8b8a8_unorm, gradient), MipFilter::box);
+
+    khepri::ThreadPool thread_pool(4);
+    const auto         expected   = compress_texture(texture);
+    const auto         compressed = compress_texture(texture, &thread_pool);
+    ASSERT_EQ(compressed.mip_levels(), 7U);
+    EXPECT_EQ(data_of(compressed), data_of(expected));
+}
+
+TEST(TextureProcessingTest, CompressesPaddedRows)
+{
+    const auto tight  = create_texture(12, 8, PixelFormat::r8g8b8a8_unorm, gradient);
+    const auto padded = create_texture(12, 8, PixelFormat::r8g8b8a8_unorm, gradient, 20);
+
+    // The padding is neither read as pixels nor as alpha
+    const auto compressed = compress_texture(padded);
+    EXPECT_EQ(compressed.pixel_format(), PixelFormat::bc1_unorm);
+    EXPECT_EQ(data_of(compressed), data_of(compress_texture(tight)));
+}
+
+TEST(TextureProcessingTest, GeneratesMipsOfNonSquareTextures)
+{
+    struct Case
+    {
+        unsigned long                              width;
+        unsigned long                              height;
+        std::vector<std::pair<unsigned long, unsigned long>> mips;
+    };
+    const std::vector<Case> cases{
+        {16, 4, {{16, 4}, {8, 2}, {4, 1}, {2, 1}, {1, 1}}},
+        {2, 8, {{2, 8}, {1, 4}, {1, 2}, {1, 1}}},
+        {5, 3, {{5, 3}, {2, 1}, {1, 1}}},
+        {12, 7, {{12, 7}, {6, 3}, {3, 1}, {1, 1}}},
+        {1, 1, {{1, 1}}},
+    };
+
+    for (const auto& c : cases) {
+        for (const auto filter : {MipFilter::box, MipFilter::kaiser}) {
+            const auto texture = create_texture(
+                c.width, c.height, PixelFormat::r8g8b8a8_unorm,
+                [](unsigned long /*x*/, unsigned long /*y*/) { return Pixel{10, 100, 200, 50}; });
+            const auto mips = generate_mips(texture, filter);
+
+            ASSERT_EQ(mips.mip_levels(), c.mips.size()) << c.width << "x" << c.height;
+            EXPECT_EQ(mips.pixel_format(), PixelFormat::r8g8b8a8_unorm);
+
+            std::size_t offset = 0;
+            for (std::size_t mip = 0; mip < c.mips.size(); ++mip) {
+                const auto [width, height] = c.mips[mip];
+                const auto& subresource    = mips.subresource(mip);
+                EXPECT_EQ(subresource.data_offset, offset);
+                EXPECT_EQ(subresource.stride, width * CHANNELS);
+                EXPECT_EQ(subresource.data_size, width * height * CHANNELS);
+                offset += subresource.data_size;
+
+                // A solid color stays the same in every mip
+                for (const auto& pixel : read_pixels(mips, mip)) {
+                    EXPECT_EQ(pixel, (Pixel{10, 100, 200, 50}));
+                }
+            }
+            EXPECT_EQ(mips.data().size(), offset);
+        }
+    }
+}
+
+TEST(TextureProcessingTest, GeneratesMipsOfPaddedRows)
+{
+    const auto tight  = create_texture(12, 6, PixelFormat::r8g8b8a8_unorm_srgb, gradient);
+    const auto padded = create_texture(12, 6, PixelFormat::r8g8b8a8_unorm_srgb, gradient, 12);
+
+    // The generated mips are tightly packed, and the padding is not filtered into them
+    const auto mips = generate_mips(padded, MipFilter::kaiser);
+    EXPECT_EQ(mips.subresource(0).stride, 12U * CHANNELS);
+    EXPECT_EQ(data_of(mips), data_of(generate_mips(tight, MipFilter::kaiser)));
+}
+
+TEST(TextureProcessingTest, DoesNotCompressNormalMaps)
+{
+    TextureProcessOptions options;
+
+    const auto flat = create_texture(16, 16, PixelFormat::r8g8b8a8_unorm,
+                                     [](unsigned long /*x*/, unsigned long /*y*/) {
+                                         return Pixel{128, 128, 255, 255};
+                                     });
+    const auto bumpy =
+        create_texture(16, 16, PixelFormat::b8g8r8a8_unorm, [](unsigned long x, unsigned long y) {
+            const auto pixel = bumps(x, y);
+            return Pixel{pixel[2], pixel[1], pixel[0], pixel[3]};
+        });
+
+    for (const auto* texture : {&flat, &bumpy}) {
+        // The mips are still generated
+        const auto processed = process_texture(*texture, options);
+        EXPECT_EQ(processed.pixel_format(), texture->pixel_format());
+        EXPECT_EQ(processed.mip_levels(), 5U);
+
+        options.generate_mips = false;
+        EXPECT_FALSE(can_process_texture(*texture, options));
+        options.generate_mips = true;
+    }
+
+    // A normal map with a few outliers is still a normal map
+    const auto speckled = create_texture(16, 16, PixelFormat::r8g8b8a8_unorm,
+                                         [](unsigned long x, unsigned long y) {
+                                             return (x == 3 && y < 4) ? Pixel{0, 0, 0, 255}
+                                                                      : bumps(x, y);
+                                         });
+    EXPECT_EQ(process_texture(speckled, options).pixel_format(), PixelFormat::r8g8b8a8_unorm);
+}
+
+TEST(TextureProcessingTest, CompressesTexturesThatAreNotNormalMaps)
+{
+    TextureProcessOptions options;
+    options.generate_mips = false;
+
+    // A grey texture and a mostly-blue texture are not normal maps, and neither is a normal map
+    // that points into the surface
+    const std::vector<TextureDesc> textures{
+        create_texture(16, 16, PixelFormat::r8g8b8a8_unorm,
+                       [](unsigned long /*x*/, unsigned long /*y*/) {
+                           return Pixel{128, 128, 128, 255};
+                       }),
+        create_texture(16, 16, PixelFormat::r8g8b8a8_unorm,
+                       [](unsigned long x, unsigned long y) {
+                           return Pixel{static_cast<std::uint8_t>(x * 4),
+                                        static_cast<std::uint8_t>(y * 4), 230, 255};
+                       }),
+        create_texture(16, 16, PixelFormat::r8g8b8a8_unorm,
+                       [](unsigned long x, unsigned long y) {
+                           auto pixel = bumps(x, y);
+                           pixel[2]   = static_cast<std::uint8_t>(255 - pixel[2]);
+                           return pixel;
+                       }),
+        create_texture(16, 16, PixelFormat::r8g8b8a8_unorm, gradient),
+    };
+
+    for (const auto& texture : textures) {
+        EXPECT_TRUE(can_process_texture(texture, options));
+        EXPECT_EQ(process_texture(texture, options).pixel_format(), PixelFormat::bc1_unorm);
+    }
+}
+
+TEST(TextureProcessingTest, ProcessesOnlyWhatTheOptionsAllow)
+{
+    const auto texture = create_texture(16, 8, PixelFormat::r8g8b8a8_unorm_srgb, gradient);
+
+    TextureProcessOptions options;
+    auto                  processed = process_texture(texture, options);
+    EXPECT_EQ(processed.pixel_format(), PixelFormat::bc1_unorm_srgb);
+    EXPECT_EQ(processed.mip_levels(), 5U);
+
+    // The mips of a compressed texture are padded to whole blocks
+    EXPECT_EQ(processed.subresource(3).stride, 8U);
+    EXPECT_EQ(processed.subresource(4).data_size, 8U);
+
+    options.compress = false;
+    processed        = process_texture(texture, options);
+    EXPECT_EQ(processed.pixel_format(), PixelFormat::r8g8b8a8_unorm_srgb);
+    EXPECT_EQ(processed.mip_levels(), 5U);
+
+    options.generate_mips = false;
+    EXPECT_FALSE(can_process_texture(texture, options));
+    EXPECT_EQ(data_of(process_texture(texture, options)), data_of(texture));
+
+    // Textures that are not a multiple of the block size are not compressed
+    options.compress = true;
+    EXPECT_FALSE(
+        can_process_texture(create_texture(10, 8, PixelFormat::r8g8b8a8_unorm, gradient), options));
+}
@@ -0,0 +1,142 @@
+#include <khepri/renderer/vertex_format.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+using khepri::renderer::MeshDesc;
+using khepri::renderer::to_compact_vertex;
+using testing::ElementsAre;
+
+namespace {
+MeshDesc::Vertex create_vertex()
+{
+    MeshDesc::Vertex vertex{};
+    vertex.normal   = {0, 0, 1};
+    vertex.tangent  = {1, 0, 0};
+    vertex.binormal = {0, 1, 0};
+    vertex.color    = {1, 1, 1, 1};
+    return vertex;
+}
+
+// Converts a float to half precision, by way of a compact vertex' texture coordinate
+std::uint16_t to_half(float value)
+{
+    auto vertex = create_vertex();
+    vertex.uv   = {value, 0};
+    return to_compact_vertex(vertex).uv[0];
+}
+} // namespace
+
+TEST(VertexFormatTest, KeepsPosition)
+{
+    auto vertex     = create_vertex();
+    vertex.position = {1.5F, -2.25F, 1e6F};
+
+    const auto compact = to_compact_vertex(vertex);
+    EXPECT_EQ(compact.position.x, 1.5F);
+    EXPECT_EQ(compact.position.y, -2.25F);
+    EXPECT_EQ(compact.position.z, 1e6F);
+}
+
+TEST(VertexFormatTest, HalfExactValues)
+{
+    EXPECT_EQ(to_half(0.0F), 0x0000);
+    EXPECT_EQ(to_half(-0.0F), 0x8000);
+    EXPECT_EQ(to_half(1.0F), 0x3C00);
+    EXPECT_EQ(to_half(-2.0F), 0xC000);
+    EXPECT_EQ(to_half(0.5F), 0x3800);
+    EXPECT_EQ(to_half(0.75F), 0x3A00);
+    EXPECT_EQ(to_half(65504.0F), 0x7BFF); // Largest half
+}
+
+TEST(VertexFormatTest, HalfRoundsToNearestEven)
+{
+    // Halfway between 1 and the next half rounds down to the even mantissa
+    EXPECT_EQ(to_half(1.0F + std::ldexp(1.0F, -11)), 0x3C00);
+
+    // Halfway between the first and second half after 1 rounds up to the even mantissa
+    EXPECT_EQ(to_half(1.0F + 3 * std::ldexp(1.0F, -11)), 0x3C02);
+
+    // Just over halfway rounds up
+    EXPECT_EQ(to_half(1.0F + std::ldexp(1.0F, -11) + std::ldexp(1.0F, -20)), 0x3C01);
+
+    // Just under halfway rounds down
+    EXPECT_EQ(to_half(1.0F + std::ldexp(1.0F, -11) - std::ldexp(1.0F, -20)), 0x3C00);
+
+    // Rounding up the largest mantissa carries into the exponent
+    EXPECT_EQ(to_half(2.0F - std::ldexp(1.0F, -12)), 0x4000);
+}
+
+TEST(VertexFormatTest, HalfDenormals)
+{
+    EXPECT_EQ(to_half(std::ldexp(1.0F, -14)), 0x0400); // Smallest normal
+    EXPECT_EQ(to_half(std::ldexp(1.0F, -15)), 0x0200);
+    EXPECT_EQ(to_half(std::ldexp(1.0F, -24)), 0x0001); // Smallest denormal
+    EXPECT_EQ(to_half(-std::ldexp(1.0F, -24)), 0x8001);
+    EXPECT_EQ(to_half(3 * std::ldexp(1.0F, -24)), 0x0003);
+
+    // Denormals round to nearest even as well
+    EXPECT_EQ(to_half(std::ldexp(1.0F, -25)), 0x0000);
+    EXPECT_EQ(to_half(1.5F * std::ldexp(1.0F, -25)), 0x0001);
+    EXPECT_EQ(to_half(3 * std::ldexp(1.0F, -25)), 0x0002);
+
+    // Rounding up the largest denormal results in the smallest normal
+    EXPECT_EQ(to_half(std::ldexp(1.0F, -14) - std::ldexp(1.0F, -26)), 0x0400);
+
+    // Too small for a denormal
+    EXPECT_EQ(to_half(std::ldexp(1.0F, -26)), 0x0000);
+    EXPECT_EQ(to_half(-std::ldexp(1.0F, -30)), 0x8000);
+    EXPECT_EQ(to_half(std::numeric_limits<float>::denorm_min()), 0x0000);
+}
+
+TEST(VertexFormatTest, HalfOverflowsToInfinity)
+{
+    EXPECT_EQ(to_half(65519.0F), 0x7BFF);
+    EXPECT_EQ(to_half(65520.0F), 0x7C00); // Rounds up to 65536
+    EXPECT_EQ(to_half(1e6F), 0x7C00);
+    EXPECT_EQ(to_half(-1e6F), 0xFC00);
+    EXPECT_EQ(to_half(std::numeric_limits<float>::max()), 0x7C00);
+    EXPECT_EQ(to_half(std::numeric_limits<float>::infinity()), 0x7C00);
+    EXPECT_EQ(to_half(-std::numeric_limits<float>::infinity()), 0xFC00);
+
+    // NaN stays NaN
+    const auto nan = to_half(std::numeric_limits<float>::quiet_NaN());
+    EXPECT_EQ(nan & 0x7C00, 0x7C00);
+    EXPECT_NE(nan & 0x03FF, 0);
+}
+
+TEST(VertexFormatTest, NormalsAsSnorm8)
+{
+    auto vertex    = create_vertex();
+    vertex.normal  = {0.6F, 0, -0.8F};
+    vertex.tangent = {0, -1, 0};
+
+    const auto compact = to_compact_vertex(vertex);
+    EXPECT_THAT(compact.normal, ElementsAre(76, 0, -102, 0));
+    EXPECT_THAT(compact.tangent, ElementsAre(0, -127, 0, 127));
+
+    // Components out of range are clamped
+    vertex.normal = {1.5F, -1.5F, 0.5F};
+    EXPECT_THAT(to_compact_vertex(vertex).normal, ElementsAre(127, -127, 64, 0));
+}
+
+TEST(VertexFormatTest, BinormalSign)
+{
+    auto vertex = create_vertex();
+    EXPECT_EQ(to_compact_vertex(vertex).tangent[3], 127);
+
+    // A mirrored texture mapping flips the binormal
+    vertex.binormal = {0, -1, 0};
+    EXPECT_EQ(to_compact_vertex(vertex).tangent[3], -127);
+}
+
+TEST(VertexFormatTest, ColorsAsUnorm8)
+{
+    auto vertex  = create_vertex();
+    vertex.color = {0, 0.5F, 1, 2};
+    EXPECT_THAT(to_compact_vertex(vertex).color, ElementsAre(0, 128, 255, 255));
+}
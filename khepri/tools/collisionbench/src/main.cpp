@@ -0,0 +1,295 @@
+#include <khepri/io/file.hpp>
+#include <khepri/math/math.hpp>
+#include <khepri/physics/collision_mesh.hpp>
+#include <khepri/renderer/camera.hpp>
+#include <khepri/renderer/io/kmf.hpp>
+
+#include <cxxopts.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr auto PROGRAM_NAME = "collisionbench";
+
+using khepri::Vector3f;
+using Index = khepri::physics::CollisionMesh::Index;
+
+struct Mesh
+{
+    std::vector<Vector3f> vertices;
+    std::vector<Index>    indices;
+};
+
+// Creates a sphere with shared vertices, with its triangles in random order
+Mesh create_sphere_mesh(std::size_t segments)
+{
+    const auto rings = std::max<std::size_t>(segments / 2, 2);
+    if ((rings + 1) * (segments + 1) > std::numeric_limits<Index>::max()) {
+        throw std::runtime_error("too many segments");
+    }
+
+    Mesh mesh;
+    for (std::size_t ring = 0; ring <= rings; ++ring) {
+        for (std::size_t segment = 0; segment <= segments; ++segment) {
+            const auto theta = khepri::PI * static_cast<double>(ring) / static_cast<double>(rings);
+            const auto phi =
+                2 * khepri::PI * static_cast<double>(segment) / static_cast<double>(segments);
+            mesh.vertices.emplace_back(static_cast<float>(std::sin(theta) * std::cos(phi)),
+                                       static_cast<float>(std::sin(theta) * std::sin(phi)),
+                                       static_cast<float>(std::cos(theta)));
+        }
+    }
+
+    const auto vertex = [&](std::size_t ring, std::size_t segment) {
+        return static_cast<Index>(ring * (segments + 1) + segment);
+    };
+
+    std::vector<std::array<Index, 3>> triangles;
+    for (std::size_t ring = 0; ring < rings; ++ring) {
+        for (std::size_t segment = 0; segment < segments; ++segment) {
+            // Counter-clockwise, as seen from outside the sphere
+            if (ring > 0) {
+                triangles.push_back(
+                    {vertex(ring, segment), vertex(ring, segment + 1), vertex(ring + 1, segment)});
+            }
+            if (ring + 1 < rings) {
+                triangles.push_back({vertex(ring, segment + 1), vertex(ring + 1, segment + 1),
+                                     vertex(ring + 1, segment)});
+            }
+        }
+    }
+
+    std::mt19937 rng(0); // Fixed seed, so every run uses the same mesh
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+    for (const auto& triangle : triangles) {
+        mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+    }
+    return mesh;
+}
+
+// Loads the collision mesh of a model, like khepri::renderer::ModelDesc creates it
+Mesh load_mesh(const std::filesystem::path& path)
+{
+    khepri::io::File file(path, khepri::io::OpenMode::read);
+    const auto       model = khepri::renderer::io::load_kmf(file);
+    if (model.meshes().empty()) {
+        throw std::runtime_error("model has no meshes");
+    }
+
+    Mesh mesh;
+    for (const auto& v : model.meshes()[0].vertices) {
+        mesh.vertices.push_back(v.position);
+    }
+    mesh.indices = model.meshes()[0].indices;
+    return mesh;
+}
+
+// Möller-Trumbore ray/triangle intersection, as used by the brute-force implementation
+double intersect_distance(const khepri::Ray& ray, const Vector3f& v0, const Vector3f& v1,
+                          const Vector3f& v2)
+{
+    const Vector3f e1  = v1 - v0;
+    const Vector3f e2  = v2 - v0;
+    const auto     h   = cross(ray.direction(), e2);
+    const auto     det = dot(e1, h);
+    if (det < 0.00001) {
+        return -1;
+    }
+    const auto inv_det = 1.0 / det;
+    const auto s       = ray.start() - v0;
+    const auto u       = inv_det * dot(s, h);
+    if (u < 0.0 || u > 1.0) {
+        return -1;
+    }
+    const auto q = cross(s, e1);
+    const auto v = inv_det * dot(ray.direction(), q);
+    if (v < 0.0 || u + v > 1.0) {
+        return -1;
+    }
+    const auto d = inv_det * dot(e2, q);
+    return (d < 0.0) ? -1 : d;
+}
+
+double brute_force_intersect_distance(const Mesh& mesh, const khepri::Ray& ray)
+{
+    double min_distance = std::numeric_limits<double>::max();
+    bool   found        = false;
+    for (std::size_t i = 0; i < mesh.indices.size(); i += 3) {
+        const auto distance = intersect_distance(ray, mesh.vertices[mesh.indices[i + 0]],
+                                                 mesh.vertices[mesh.indices[i + 1]],
+                                                 mesh.vertices[mesh.indices[i + 2]]);
+        if (distance >= 0) {
+            min_distance = std::min(min_distance, distance);
+            found        = true;
+        }
+    }
+    return found ? min_distance : -1.0;
+}
+
+bool brute_force_intersect(const Mesh& mesh, const khepri::Frustum& frustum)
+{
+    return std::all_of(mesh.vertices.begin(), mesh.vertices.end(),
+                       [&](const auto& v) { return frustum.inside(v); });
+}
+
+// Runs func for every query and returns the total time in milliseconds
+template <typename Query, typename Func>
+double measure(const std::vector<Query>& queries, Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& query : queries) {
+        func(query);
+    }
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void print_result(const std::string& name, std::size_t queries, double time_ms)
+{
+    std::cout << std::left << std::setw(24) << name << std::right << std::setw(12) << time_ms
+              << std::setw(16) << time_ms * 1000.0 / static_cast<double>(queries) << "\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    try {
+        cxxopts::Options options(PROGRAM_NAME,
+                                 "Measures ray and frustum queries against a collision mesh, "
+                                 "compared to testing every triangle");
+        options.positional_help("[INPUT]");
+
+        auto adder = options.add_options();
+        adder("h,help", "display this help and exit");
+        adder("i,input", "Khepri model file (.kmf) to load the collision mesh from",
+              cxxopts::value<std::filesystem::path>());
+        adder("segments", "Number of segments of the synthetic sphere, if no input is given",
+              cxxopts::value<std::size_t>()->default_value("128"));
+        adder("n,queries", "Number of rays and frustums to test",
+              cxxopts::value<std::size_t>()->default_value("1000"));
+
+        options.parse_positional({"input"});
+        auto result = options.parse(argc, argv);
+        if (result.count("help") != 0) {
+            std::cout << options.help({"", "Group"}) << "\n";
+            return 0;
+        }
+
+        const auto mesh = (result.count("input") != 0)
+                              ? load_mesh(result["input"].as<std::filesystem::path>())
+                              : create_sphere_mesh(
+                                    std::max<std::size_t>(result["segments"].as<std::size_t>(), 3));
+        const auto query_count = std::max<std::size_t>(result["queries"].as<std::size_t>(), 1);
+
+        const auto build_start    = std::chrono::steady_clock::now();
+        const auto collision_mesh = khepri::physics::CollisionMesh(mesh.vertices, mesh.indices);
+        const std::chrono::duration<double, std::milli> build_time =
+            std::chrono::steady_clock::now() - build_start;
+
+        // Look at the mesh from all sides, like a player picking objects with the mouse
+        khepri::Vector3 center{0, 0, 0};
+        double          radius = 0;
+        for (const auto& v : mesh.vertices) {
+            center += khepri::Vector3(v);
+        }
+        center /= static_cast<double>(std::max<std::size_t>(mesh.vertices.size(), 1));
+        for (const auto& v : mesh.vertices) {
+            radius = std::max(radius, (khepri::Vector3(v) - center).length());
+        }
+
+        std::mt19937                           rng(0);
+        std::uniform_real_distribution<double> yaw_angle(0, 2 * khepri::PI);
+        std::uniform_real_distribution<double> pitch_angle(-khepri::PI / 3, khepri::PI / 3);
+        std::uniform_real_distribution<double> coord(-1, 1);
+
+        std::vector<khepri::Ray>     rays;
+        std::vector<khepri::Frustum> frustums;
+        for (std::size_t i = 0; i < query_count; ++i) {
+            const auto yaw   = yaw_angle(rng);
+            const auto pitch = pitch_angle(rng);
+            const khepri::Vector3 offset{std::cos(yaw) * std::cos(pitch),
+                                         std::sin(yaw) * std::cos(pitch), std::sin(pitch)};
+
+            khepri::renderer::Camera::Properties properties{};
+            properties.type     = khepri::renderer::Camera::Type::perspective;
+            properties.position = center + offset * (radius * 3);
+            properties.target   = center;
+            properties.up       = {0, 0, 1};
+            properties.fov      = khepri::to_radians(60.0);
+            properties.aspect   = 16.0 / 9.0;
+            properties.znear    = radius * 0.1;
+            properties.zfar     = radius * 10;
+            const khepri::renderer::Camera camera(properties);
+
+            const auto [near_, far_] = camera.unproject({coord(rng) * 0.5, coord(rng) * 0.5});
+            rays.emplace_back(near_, normalize(far_ - near_));
+
+            const khepri::Vector2 p1{coord(rng), coord(rng)};
+            const khepri::Vector2 p2{coord(rng), coord(rng)};
+            frustums.push_back(camera.frustum({std::min(p1.x, p2.x), std::max(p1.y, p2.y)},
+                                              {std::max(p1.x, p2.x), std::min(p1.y, p2.y)}));
+        }
+
+        // Verify that both implementations agree
+        std::size_t mismatches = 0;
+        for (const auto& ray : rays) {
+            if (collision_mesh.intersect_distance(ray) !=
+                brute_force_intersect_distance(mesh, ray)) {
+                ++mismatches;
+            }
+        }
+        for (const auto& frustum : frustums) {
+            if (collision_mesh.intersect(frustum) != brute_force_intersect(mesh, frustum)) {
+                ++mismatches;
+            }
+        }
+
+        std::cout << "vertices: " << mesh.vertices.size()
+                  << ", triangles: " << mesh.indices.size() / 3 << ", queries: " << query_count
+                  << ", mismatches: " << mismatches << "\n";
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "build time (ms): " << build_time.count() << "\n";
+        std::cout << std::left << std::setw(24) << "query" << std::right << std::setw(12)
+                  << "time (ms)" << std::setw(16) << "per query (us)"
+                  << "\n";
+
+        // Accumulate the results, so the queries can't be optimized away
+        double sink = 0;
+        print_result("ray (brute force)", query_count, measure(rays, [&](const auto& ray) {
+                         sink += brute_force_intersect_distance(mesh, ray);
+                     }));
+        print_result("ray (hierarchy)", query_count, measure(rays, [&](const auto& ray) {
+                         sink += collision_mesh.intersect_distance(ray);
+                     }));
+        print_result("frustum (brute force)", query_count,
+                     measure(frustums, [&](const auto& frustum) {
+                         sink += brute_force_intersect(mesh, frustum) ? 1 : 0;
+                     }));
+        print_result("frustum (hierarchy)", query_count,
+                     measure(frustums, [&](const auto& frustum) {
+                         sink += collision_mesh.intersect(frustum) ? 1 : 0;
+                     }));
+        std::cout << "checksum: " << sink << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << '\n';
+        return 1;
+    } catch (...) {
+        std::cerr << "unknown error\n";
+        return 1;
+    }
+    return 0;
+}
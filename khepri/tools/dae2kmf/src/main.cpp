@@ -1,5 +1,6 @@
 #include <khepri/io/file.hpp>
 #include <khepri/renderer/io/kmf.hpp>
+#include <khepri/renderer/mesh_optimizer.hpp>
 #include <khepri/renderer/model_desc.hpp>
 
 #include <assimp/Importer.hpp>
@@ -66,7 +67,16 @@ auto get_combined_transformation(const aiNode& node) noexcept
     return transform;
 }
 
-khepri::renderer::ModelDesc create_model(const aiScene& scene)
+struct ConvertOptions
+{
+    /// Optimize the meshes for the vertex cache and vertex fetches
+    bool optimize;
+
+    /// Also reorder the triangles of the meshes to reduce overdraw
+    bool reduce_overdraw;
+};
+
+khepri::renderer::ModelDesc create_model(const aiScene& scene, const ConvertOptions& options)
 {
     std::vector<khepri::renderer::MeshDesc> meshes;
 
@@ -111,6 +121,10 @@ khepri::renderer::ModelDesc create_model(const aiScene& scene)
             mesh.indices[j + 2] = indices[2];
         }
 
+        if (options.optimize || options.reduce_overdraw) {
+            khepri::renderer::optimize_mesh(mesh, options.reduce_overdraw);
+        }
+
         meshes.push_back(std::move(mesh));
     }
 
@@ -131,6 +145,8 @@ int main(int argc, char* argv[])
         adder("h,help", "display this help and exit");
         adder("i,input", "Input file", cxxopts::value<std::filesystem::path>());
         adder("o,output", "Output file", cxxopts::value<std::filesystem::path>());
+        adder("optimize", "Optimize the meshes for the vertex cache and vertex fetches");
+        adder("reduce-overdraw", "Also reorder triangles to reduce overdraw (implies --optimize)");
 
         options.parse_positional({"input", "output"});
         auto result = options.parse(argc, argv);
@@ -143,6 +159,9 @@ int main(int argc, char* argv[])
         const auto input_path  = result["input"].as<std::filesystem::path>();
         const auto output_path = result["output"].as<std::filesystem::path>();
 
+        const ConvertOptions convert_options{result.count("optimize") != 0,
+                                             result.count("reduce-overdraw") != 0};
+
         // Import the file
         Assimp::Importer imp;
 
@@ -158,7 +177,7 @@ int main(int argc, char* argv[])
         }
 
         // Convert the imported scene to a Khepri model
-        auto model = create_model(*scene);
+        auto model = create_model(*scene, convert_options);
 
         // Write out the model
         khepri::io::File output(output_path, khepri::io::OpenMode::read_write);
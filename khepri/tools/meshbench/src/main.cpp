@@ -0,0 +1,188 @@
+#include <khepri/io/file.hpp>
+#include <khepri/math/math.hpp>
+#include <khepri/renderer/io/kmf.hpp>
+#include <khepri/renderer/mesh_optimizer.hpp>
+
+#include <cxxopts.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr auto PROGRAM_NAME = "meshbench";
+
+using khepri::renderer::MeshDesc;
+
+// Creates a sphere like an exporter might: every triangle has its own vertices, and the
+// triangles are in random order.
+MeshDesc create_sphere_mesh(std::size_t segments)
+{
+    const auto rings = std::max<std::size_t>(segments / 2, 2);
+
+    const auto point = [&](std::size_t ring, std::size_t segment) {
+        const auto theta = khepri::PI * static_cast<double>(ring) / static_cast<double>(rings);
+        const auto phi =
+            2 * khepri::PI * static_cast<double>(segment) / static_cast<double>(segments);
+        MeshDesc::Vertex vertex{};
+        vertex.position = khepri::Vector3f(static_cast<float>(std::sin(theta) * std::cos(phi)),
+                                           static_cast<float>(std::sin(theta) * std::sin(phi)),
+                                           static_cast<float>(std::cos(theta)));
+        vertex.normal   = vertex.position;
+        vertex.uv       = khepri::Vector2f(
+            static_cast<float>(segment) / static_cast<float>(segments),
+            static_cast<float>(ring) / static_cast<float>(rings));
+        vertex.color    = khepri::ColorRGBA(1, 1, 1, 1);
+        return vertex;
+    };
+
+    std::vector<std::array<MeshDesc::Vertex, 3>> triangles;
+    for (std::size_t ring = 0; ring < rings; ++ring) {
+        for (std::size_t segment = 0; segment < segments; ++segment) {
+            const auto v00 = point(ring, segment);
+            const auto v01 = point(ring, segment + 1);
+            const auto v10 = point(ring + 1, segment);
+            const auto v11 = point(ring + 1, segment + 1);
+            if (ring > 0) {
+                triangles.push_back({v00, v10, v01});
+            }
+            if (ring + 1 < rings) {
+                triangles.push_back({v01, v10, v11});
+            }
+        }
+    }
+
+    std::mt19937 rng(0); // Fixed seed, so every run uses the same mesh
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+
+    MeshDesc mesh;
+    for (const auto& triangle : triangles) {
+        for (const auto& vertex : triangle) {
+            mesh.indices.push_back(static_cast<MeshDesc::Index>(mesh.vertices.size()));
+            mesh.vertices.push_back(vertex);
+        }
+    }
+    return mesh;
+}
+
+std::vector<MeshDesc> load_meshes(const std::vector<std::filesystem::path>& paths)
+{
+    std::vector<MeshDesc> meshes;
+    for (const auto& path : paths) {
+        khepri::io::File file(path, khepri::io::OpenMode::read);
+        const auto       model = khepri::renderer::io::load_kmf(file);
+        meshes.insert(meshes.end(), model.meshes().begin(), model.meshes().end());
+    }
+    return meshes;
+}
+
+struct Stage
+{
+    std::string                     name;
+    std::function<void(MeshDesc&)> optimize;
+};
+
+void print_stage(const std::string& name, const std::vector<MeshDesc>& meshes,
+                 std::size_t cache_size, double time_ms)
+{
+    std::size_t vertices  = 0;
+    std::size_t triangles = 0;
+    double      misses    = 0;
+    for (const auto& mesh : meshes) {
+        const auto mesh_triangles = mesh.indices.size() / 3;
+        vertices += mesh.vertices.size();
+        triangles += mesh_triangles;
+        misses += khepri::renderer::calculate_acmr(mesh.indices, cache_size) *
+                  static_cast<double>(mesh_triangles);
+    }
+
+    const auto acmr = (triangles > 0) ? misses / static_cast<double>(triangles) : 0.0;
+    const auto atvr = (vertices > 0) ? misses / static_cast<double>(vertices) : 0.0;
+    std::cout << std::left << std::setw(16) << name << std::right << std::setw(10) << vertices
+              << std::setw(10) << acmr << std::setw(10) << atvr << std::setw(12) << time_ms
+              << "\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    try {
+        cxxopts::Options options(PROGRAM_NAME,
+                                 "Measures the vertex cache efficiency of meshes before and after "
+                                 "every mesh optimization step");
+        options.positional_help("[INPUT...]");
+
+        auto adder = options.add_options();
+        adder("h,help", "display this help and exit");
+        adder("i,input", "Khepri model files (.kmf) to load the meshes from",
+              cxxopts::value<std::vector<std::filesystem::path>>());
+        adder("segments", "Number of segments of the synthetic sphere, if no input is given",
+              cxxopts::value<std::size_t>()->default_value("128"));
+        adder("c,cache-size", "Number of vertices in the simulated FIFO vertex cache",
+              cxxopts::value<std::size_t>()->default_value("16"));
+        adder("reduce-overdraw", "Also reorder triangles to reduce overdraw");
+
+        options.parse_positional({"input"});
+        auto result = options.parse(argc, argv);
+        if (result.count("help") != 0) {
+            std::cout << options.help({"", "Group"}) << "\n";
+            return 0;
+        }
+
+        const auto cache_size = result["cache-size"].as<std::size_t>();
+        if (cache_size == 0) {
+            throw std::runtime_error("option 'cache-size' must be greater than 0");
+        }
+
+        auto meshes =
+            (result.count("input") != 0)
+                ? load_meshes(result["input"].as<std::vector<std::filesystem::path>>())
+                : std::vector<MeshDesc>{create_sphere_mesh(
+                      std::max<std::size_t>(result["segments"].as<std::size_t>(), 3))};
+
+        std::vector<Stage> stages{{"weld", khepri::renderer::weld_vertices},
+                                  {"vertex cache", khepri::renderer::optimize_vertex_cache}};
+        if (result.count("reduce-overdraw") != 0) {
+            stages.push_back({"overdraw", khepri::renderer::optimize_overdraw});
+        }
+        stages.push_back({"vertex fetch", khepri::renderer::optimize_vertex_fetch});
+
+        // ACMR is the average number of transformed vertices per triangle, ATVR the average number
+        // of times every vertex is transformed.
+        std::cout << "meshes: " << meshes.size() << ", cache size: " << cache_size << "\n";
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << std::left << std::setw(16) << "stage" << std::right << std::setw(10)
+                  << "vertices" << std::setw(10) << "ACMR" << std::setw(10) << "ATVR"
+                  << std::setw(12) << "time (ms)"
+                  << "\n";
+        print_stage("input", meshes, cache_size, 0);
+
+        for (const auto& stage : stages) {
+            const auto start = std::chrono::steady_clock::now();
+            for (auto& mesh : meshes) {
+                stage.optimize(mesh);
+            }
+            const std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+            print_stage(stage.name, meshes, cache_size, elapsed.count());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << '\n';
+        return 1;
+    } catch (...) {
+        std::cerr << "unknown error\n";
+        return 1;
+    }
+    return 0;
+}
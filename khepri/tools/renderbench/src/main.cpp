@@ -0,0 +1,251 @@
+#include <khepri/math/math.hpp>
+#include <khepri/math/matrix.hpp>
+#include <khepri/math/quaternion.hpp>
+#include <khepri/renderer/camera.hpp>
+#include <khepri/renderer/null/renderer.hpp>
+
+#include <cxxopts.hpp>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr auto PROGRAM_NAME = "renderbench";
+
+using khepri::renderer::Material;
+using khepri::renderer::MeshDesc;
+using khepri::renderer::MeshInstance;
+
+// Size, in world units, of the square area that the objects are placed in
+constexpr double SCENE_SIZE = 1000.0;
+
+struct Options
+{
+    std::size_t objects;
+    std::size_t meshes;
+    std::size_t materials;
+    std::size_t param_sets;
+    std::size_t frames;
+};
+
+// The renderer resources and mesh instances of the synthetic scene
+struct Scene
+{
+    std::unique_ptr<khepri::renderer::Shader>                shader;
+    std::unique_ptr<khepri::renderer::Texture>               texture;
+    std::vector<std::unique_ptr<khepri::renderer::Mesh>>     meshes;
+    std::vector<std::unique_ptr<khepri::renderer::Material>> materials;
+    std::unique_ptr<khepri::renderer::RenderPipeline>        render_pipeline;
+    std::vector<std::vector<Material::ParamBlock>>           param_blocks; // [material][set]
+    std::vector<MeshInstance>                                instances;
+};
+
+// Creates a box with 24 vertices and 12 triangles
+MeshDesc create_box_mesh(float size)
+{
+    MeshDesc mesh;
+    for (int axis = 0; axis < 3; ++axis) {
+        for (const float sign : {-1.0F, 1.0F}) {
+            khepri::Vector3f normal(0, 0, 0);
+            khepri::Vector3f tangent(0, 0, 0);
+            khepri::Vector3f binormal(0, 0, 0);
+            normal[axis]             = sign;
+            tangent[(axis + 1) % 3]  = 1;
+            binormal[(axis + 2) % 3] = 1;
+
+            const auto first_vertex = static_cast<MeshDesc::Index>(mesh.vertices.size());
+            for (const auto& [u, v] : {std::pair(-1.0F, -1.0F), std::pair(1.0F, -1.0F),
+                                       std::pair(1.0F, 1.0F), std::pair(-1.0F, 1.0F)}) {
+                MeshDesc::Vertex vertex{};
+                vertex.position = (normal + tangent * u + binormal * v) * (size / 2);
+                vertex.normal   = normal;
+                vertex.tangent  = tangent;
+                vertex.binormal = binormal;
+                vertex.uv       = khepri::Vector2f((u + 1) / 2, (v + 1) / 2);
+                vertex.color    = khepri::ColorRGBA(1, 1, 1, 1);
+                mesh.vertices.push_back(vertex);
+            }
+            for (const MeshDesc::Index index : {0, 1, 2, 0, 2, 3}) {
+                mesh.indices.push_back(first_vertex + index);
+            }
+        }
+    }
+    return mesh;
+}
+
+Scene create_scene(khepri::renderer::Renderer& renderer, const Options& options)
+{
+    using namespace khepri::renderer;
+
+    Scene scene;
+    std::mt19937 rng(0); // Fixed seed, so every run renders the same scene
+
+    scene.shader = renderer.create_shader("renderbench.hlsl", [](const auto&) {
+        return ShaderDesc(std::vector<std::uint8_t>{});
+    });
+
+    scene.texture = renderer.create_texture(TextureDesc(TextureDimension::texture_2d, 1, 1, 0, 1,
+                                                        PixelFormat::r8g8b8a8_unorm,
+                                                        {{0, 4, 4, 0}}, {255, 255, 255, 255}));
+
+    std::uniform_real_distribution<float> mesh_size(1.0F, 10.0F);
+    for (std::size_t i = 0; i < options.meshes; ++i) {
+        scene.meshes.push_back(renderer.create_mesh(create_box_mesh(mesh_size(rng))));
+    }
+
+    // One in four materials is transparent, the rest is opaque
+    for (std::size_t i = 0; i < options.materials; ++i) {
+        MaterialDesc desc;
+        desc.type                   = (i % 4 == 3) ? "Transparent" : "Opaque";
+        desc.num_directional_lights = 1;
+        desc.shader                 = scene.shader.get();
+        desc.properties             = {{"DiffuseTexture", scene.texture.get()},
+                                       {"DiffuseColor", khepri::Vector4f(1, 1, 1, 1)},
+                                       {"Shininess", 1.0F}};
+        scene.materials.push_back(renderer.create_material(desc));
+    }
+
+    RenderPipelineDesc pipeline_desc;
+    pipeline_desc.render_passes.push_back(
+        {"Opaque", RenderPassDesc::DepthSorting::front_to_back, {}});
+    pipeline_desc.render_passes.push_back(
+        {"Transparent", RenderPassDesc::DepthSorting::back_to_front, {}});
+    scene.render_pipeline = renderer.create_render_pipeline(pipeline_desc);
+
+    // Parameter set 0 is empty, so those instances use the material's defaults.
+    // Every parameter set is compiled once for every material.
+    std::uniform_real_distribution<float> color(0.0F, 1.0F);
+    std::vector<std::vector<Material::Param>> param_sets(options.param_sets);
+    for (std::size_t i = 1; i < param_sets.size(); ++i) {
+        param_sets[i] = {{"DiffuseColor", khepri::Vector4f(color(rng), color(rng), color(rng), 1)}};
+    }
+    for (const auto& material : scene.materials) {
+        auto& blocks = scene.param_blocks.emplace_back();
+        for (const auto& params : param_sets) {
+            blocks.push_back(material->compile_params(params));
+        }
+    }
+
+    std::uniform_real_distribution<double> position(-SCENE_SIZE / 2, SCENE_SIZE / 2);
+    std::uniform_real_distribution<double> angle(0, 2 * khepri::PI);
+    std::uniform_int_distribution<std::size_t> mesh_index(0, options.meshes - 1);
+    std::uniform_int_distribution<std::size_t> material_index(0, options.materials - 1);
+    std::uniform_int_distribution<std::size_t> param_set_index(0, options.param_sets - 1);
+
+    scene.instances.reserve(options.objects);
+    for (std::size_t i = 0; i < options.objects; ++i) {
+        const auto material = material_index(rng);
+
+        MeshInstance instance;
+        instance.mesh     = scene.meshes[mesh_index(rng)].get();
+        instance.material = scene.materials[material].get();
+        instance.transform =
+            khepri::Matrixf::create_rotation(
+                khepri::Quaternionf::from_axis_angle({0, 0, 1}, static_cast<float>(angle(rng)))) *
+            khepri::Matrixf::create_translation(khepri::Vector3f(
+                static_cast<float>(position(rng)), static_cast<float>(position(rng)), 0));
+        instance.material_params = &scene.param_blocks[material][param_set_index(rng)];
+        scene.instances.push_back(instance);
+    }
+    return scene;
+}
+
+std::size_t get_option(const cxxopts::ParseResult& result, const std::string& name)
+{
+    const auto value = result[name].as<std::size_t>();
+    if (value == 0) {
+        throw std::runtime_error("option '" + name + "' must be greater than 0");
+    }
+    return value;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    try {
+        cxxopts::Options options(
+            PROGRAM_NAME, "Measures the CPU cost of rendering a list of mesh instances with a "
+                          "headless renderer. Scene culling and level-of-detail selection are not "
+                          "included; see scenebench for those.");
+
+        auto adder = options.add_options();
+        adder("h,help", "display this help and exit");
+        adder("n,objects", "Number of objects in the scene",
+              cxxopts::value<std::size_t>()->default_value("10000"));
+        adder("meshes", "Number of distinct meshes",
+              cxxopts::value<std::size_t>()->default_value("64"));
+        adder("materials", "Number of distinct materials",
+              cxxopts::value<std::size_t>()->default_value("16"));
+        adder("params", "Number of distinct sets of per-object material parameters",
+              cxxopts::value<std::size_t>()->default_value("1"));
+        adder("f,frames", "Number of frames to render",
+              cxxopts::value<std::size_t>()->default_value("100"));
+
+        auto result = options.parse(argc, argv);
+        if (result.count("help") != 0) {
+            std::cout << options.help({"", "Group"}) << "\n";
+            return 0;
+        }
+
+        const Options bench_options{get_option(result, "objects"), get_option(result, "meshes"),
+                                    get_option(result, "materials"), get_option(result, "params"),
+                                    get_option(result, "frames")};
+
+        khepri::renderer::null::Renderer renderer({1920, 1080});
+        const auto                       scene = create_scene(renderer, bench_options);
+
+        khepri::renderer::Camera camera({khepri::renderer::Camera::Type::perspective,
+                                         {0, -SCENE_SIZE / 2, SCENE_SIZE / 2},
+                                         {0, 0, 0},
+                                         {0, 0, 1},
+                                         khepri::PI / 4,
+                                         0,
+                                         16.0 / 9.0,
+                                         1.0,
+                                         SCENE_SIZE * 2});
+
+        // Render one frame to warm up, then measure
+        renderer.render_meshes(*scene.render_pipeline, scene.instances, camera);
+        renderer.present();
+        renderer.reset_statistics();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t frame = 0; frame < bench_options.frames; ++frame) {
+            renderer.clear(khepri::renderer::Renderer::clear_all);
+            renderer.render_meshes(*scene.render_pipeline, scene.instances, camera);
+            renderer.present();
+        }
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        const auto& stats  = renderer.statistics();
+        const auto  frames = static_cast<double>(stats.frames);
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "objects:           " << bench_options.objects << "\n";
+        std::cout << "frames:            " << stats.frames << "\n";
+        std::cout << "time per frame:    " << elapsed.count() / frames << " ms\n";
+        std::cout << "per frame:\n";
+        std::cout << "  draw calls:      " << stats.draw_calls / frames << "\n";
+        std::cout << "  instances:       " << stats.instances / frames << "\n";
+        std::cout << "  triangles:       " << stats.triangles / frames << "\n";
+        std::cout << "  pipeline states: " << stats.pipeline_changes / frames << "\n";
+        std::cout << "  material params: " << stats.material_param_changes / frames << "\n";
+        std::cout << "  mesh changes:    " << stats.mesh_changes / frames << "\n";
+        std::cout << "  bytes uploaded:  " << stats.bytes_uploaded / frames << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << '\n';
+        return 1;
+    } catch (...) {
+        std::cerr << "unknown error\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <khepri/io/file.hpp>
+#include <khepri/renderer/io/texture.hpp>
+#include <khepri/renderer/texture_processing.hpp>
+#include <khepri/utility/thread_pool.hpp>
+
+#include <cxxopts.hpp>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr auto PROGRAM_NAME = "texbake";
+
+void check_required(const cxxopts::ParseResult& result, const std::vector<std::string>& required)
+{
+    for (const auto& r : required) {
+        if (result.count(r) == 0) {
+            throw std::runtime_error("missing option '" + r + "'");
+        }
+    }
+}
+
+khepri::renderer::MipFilter parse_filter(const std::string& name)
+{
+    if (name == "box") {
+        return khepri::renderer::MipFilter::box;
+    }
+    if (name == "kaiser") {
+        return khepri::renderer::MipFilter::kaiser;
+    }
+    throw std::runtime_error("unknown filter '" + name + "'");
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    try {
+        cxxopts::Options options(PROGRAM_NAME,
+                                 "Generates mips for and block-compresses a texture (.tga, .dds) "
+                                 "and writes it as a DirectDraw Surface (.dds)");
+        options.positional_help("INPUT OUTPUT");
+
+        auto adder = options.add_options();
+        adder("h,help", "display this help and exit");
+        adder("i,input", "Input file", cxxopts::value<std::filesystem::path>());
+        adder("o,output", "Output file", cxxopts::value<std::filesystem::path>());
+        adder("filter", "Mip filter: box or kaiser",
+              cxxopts::value<std::string>()->default_value("kaiser"));
+        adder("no-mips", "Do not generate mips");
+        adder("no-compress", "Do not block-compress the texture");
+        adder("srgb", "Treat the texture as sRGB, so mips are filtered in linear space");
+        adder("j,threads", "Number of threads to compress with (0 for automatic)",
+              cxxopts::value<std::size_t>()->default_value("0"));
+
+        options.parse_positional({"input", "output"});
+        auto result = options.parse(argc, argv);
+        if (result.count("help") != 0) {
+            std::cout << options.help({"", "Group"}) << "\n";
+            return 0;
+        }
+
+        check_required(result, {"input", "output"});
+        const auto input_path  = result["input"].as<std::filesystem::path>();
+        const auto output_path = result["output"].as<std::filesystem::path>();
+
+        khepri::renderer::TextureProcessOptions process_options;
+        process_options.generate_mips = result.count("no-mips") == 0;
+        process_options.mip_filter    = parse_filter(result["filter"].as<std::string>());
+        process_options.compress      = result.count("no-compress") == 0;
+
+        const khepri::renderer::io::TextureLoadOptions load_options{
+            (result.count("srgb") != 0) ? khepri::renderer::ColorSpace::srgb
+                                        : khepri::renderer::ColorSpace::linear};
+
+        khepri::io::File input(input_path, khepri::io::OpenMode::read);
+        const auto       texture_desc = khepri::renderer::io::load_texture(input, load_options);
+
+        khepri::ThreadPool thread_pool(result["threads"].as<std::size_t>());
+
+        const auto start     = std::chrono::steady_clock::now();
+        const auto processed = khepri::renderer::process_texture(texture_desc, process_options,
+                                                                 &thread_pool);
+        const auto time      = elapsed_ms(start);
+
+        khepri::io::File output(output_path, khepri::io::OpenMode::read_write);
+        khepri::renderer::io::save_texture(output, processed,
+                                           {khepri::renderer::io::TextureFormat::dds});
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "size:       " << texture_desc.width() << "x" << texture_desc.height() << "\n";
+        std::cout << "mip levels: " << texture_desc.mip_levels() << " -> "
+                  << processed.mip_levels() << "\n";
+        std::cout << "bytes:      " << texture_desc.data().size() << " -> "
+                  << processed.data().size() << "\n";
+        std::cout << "threads:    " << thread_pool.size() << "\n";
+        std::cout << "time:       " << time << " ms\n";
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << '\n';
+        return 1;
+    } catch (...) {
+        std::cerr << "unknown error\n";
+        return 1;
+    }
+    return 0;
+}
@@ -2,27 +2,91 @@
 
 #include "asset_loader.hpp"
 
+#include <khepri/renderer/io/texture_cache.hpp>
 #include <khepri/renderer/renderer.hpp>
+#include <khepri/renderer/texture_processing.hpp>
 #include <khepri/utility/cache.hpp>
+#include <khepri/utility/string.hpp>
+#include <khepri/utility/thread_pool.hpp>
 
 #include <openglyph/renderer/material_store.hpp>
 #include <openglyph/renderer/model_creator.hpp>
 #include <openglyph/renderer/render_pipeline_store.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace openglyph {
 
+/**
+ * Settings for processing textures after they are loaded
+ */
+struct TextureProcessingSettings
+{
+    /// How the textures are processed
+    khepri::renderer::TextureProcessOptions options;
+
+    /// Directory to cache processed textures in, or empty to process textures on every load
+    std::filesystem::path cache_path;
+};
+
 /**
  * @brief Cache of the various assets
  *
  * This class loads, instantiates and subsequently own requested assets.
  *
- * It hands out non-owning references to users of the class that are valid during the lifetime of
- * the object.
+ * Render pipelines and materials are handed out as non-owning references that are valid during
+ * the lifetime of the object.
+ *
+ * Textures and render models are handed out as shared pointers, which pin the asset in the cache.
+ * When the total size of the cached textures and render models exceeds the memory budget, the
+ * least recently used assets that are not pinned are evicted. A render model pins the textures it
+ * uses.
+ *
+ * Textures and render models can also be requested asynchronously. Reading and decoding those
+ * assets happens on a pool of worker threads, while creating their renderer resources is queued
+ * for the main thread, which processes that queue with #process_uploads.
  */
 class AssetCache final
 {
 public:
-    AssetCache(AssetLoader& asset_loader, khepri::renderer::Renderer& renderer);
+    /// Shared pointer to an asset. The asset is not evicted while such pointers exist.
+    template <typename T>
+    using Handle = std::shared_ptr<const T>;
+
+    /// Handle to an asynchronously loaded asset. It resolves to nullptr if the asset wasn't found.
+    /// The future keeps its asset alive, even if the asset is evicted. To keep the asset in the
+    /// cache as well, copy the handle that the future resolves to.
+    template <typename T>
+    using Future = std::shared_future<Handle<T>>;
+
+    /// Memory budget that never evicts anything
+    static constexpr std::size_t UNLIMITED_BUDGET = static_cast<std::size_t>(-1);
+
+    /**
+     * Constructs the asset cache.
+     *
+     * @param asset_loader the loader used to locate assets
+     * @param renderer the renderer used to create renderer resources for the assets
+     * @param num_threads the number of worker threads for asynchronous loading (0 for automatic)
+     * @param texture_processing if set, uncompressed textures are processed (e.g. mip-mapped and
+     *                           block-compressed) after they're loaded
+     */
+    AssetCache(AssetLoader& asset_loader, khepri::renderer::Renderer& renderer,
+               std::size_t                              num_threads        = 0,
+               std::optional<TextureProcessingSettings> texture_processing = std::nullopt);
 
     AssetCache(const AssetCache&)            = delete;
     AssetCache(AssetCache&&)                 = delete;
@@ -34,17 +98,147 @@ public:
 
     const khepri::renderer::Material* get_material(std::string_view name);
 
-    const khepri::renderer::Texture* get_texture(std::string_view name);
+    /**
+     * Returns a texture, loading it if necessary.
+     *
+     * This blocks until the texture is loaded, and processes pending uploads while waiting.
+     * It must only be called from the main thread.
+     */
+    Handle<khepri::renderer::Texture> get_texture(std::string_view name);
+
+    /**
+     * Returns a render model, loading it if necessary.
+     *
+     * This blocks until the render model is loaded, and processes pending uploads while waiting.
+     * It must only be called from the main thread.
+     */
+    Handle<openglyph::renderer::RenderModel> get_render_model(std::string_view name);
+
+    /**
+     * Requests a texture to be loaded in the background.
+     *
+     * The returned future only becomes ready when the texture's upload has been processed by
+     * #process_uploads or a blocking getter, so the main thread must not wait on it directly.
+     *
+     * @note this method is thread-safe.
+     */
+    Future<khepri::renderer::Texture> request_texture(std::string_view name);
+
+    /**
+     * Requests a render model, and the textures it uses, to be loaded in the background.
+     *
+     * The returned future only becomes ready when the render model's upload has been processed by
+     * #process_uploads or a blocking getter, so the main thread must not wait on it directly.
+     *
+     * @note this method is thread-safe.
+     */
+    Future<openglyph::renderer::RenderModel> request_render_model(std::string_view name);
+
+    /**
+     * Creates the renderer resources of assets that have finished loading in the background.
+     *
+     * This should be called once per frame from the main thread. It processes uploads until
+     * the budget has been spent, but always processes at least one pending upload, if any.
+     * Afterwards, assets are evicted if the memory budget is exceeded.
+     */
+    void process_uploads(std::chrono::steady_clock::duration budget);
+
+    /// Returns the memory budget, in bytes, for cached textures and render models
+    [[nodiscard]] std::size_t memory_budget() const noexcept
+    {
+        return m_memory_budget;
+    }
+
+    /// Sets the memory budget, in bytes, for cached textures and render models
+    void memory_budget(std::size_t budget) noexcept
+    {
+        m_memory_budget = budget;
+    }
+
+    /// Returns the total size, in bytes, of the cached textures and render models
+    [[nodiscard]] std::size_t memory_usage() const noexcept
+    {
+        return m_memory_usage;
+    }
 
-    const openglyph::renderer::RenderModel* get_render_model(std::string_view name);
+    /**
+     * Evicts the least recently used assets that are not pinned until the memory usage is within
+     * the memory budget, or no more assets can be evicted.
+     *
+     * This must only be called from the main thread.
+     */
+    void evict();
 
 private:
-    khepri::OwningCache<const khepri::renderer::Shader>         m_shader_cache;
-    khepri::OwningCache<const khepri::renderer::Texture>        m_texture_cache;
-    openglyph::renderer::RenderPipelineStore                    m_render_pipelines;
-    openglyph::renderer::MaterialStore                          m_materials;
-    openglyph::renderer::ModelCreator                           m_model_creator;
-    khepri::OwningCache<const openglyph::renderer::RenderModel> m_render_model_cache;
+    template <typename T>
+    struct AsyncEntry
+    {
+        Future<T>                                future;
+        Handle<T>                                asset;        ///< nullptr if not (yet) loaded
+        std::vector<std::shared_ptr<const void>> dependencies; ///< assets pinned by this asset
+        std::size_t                              size{0};      ///< size of the asset's data
+        std::atomic<std::uint64_t>               last_used{0};
+    };
+
+    // Requests can come from worker threads, so the caches of asynchronously loaded assets are
+    // concurrent. Their loaders only start the asynchronous load.
+    template <typename T>
+    using AsyncCache = khepri::ConcurrentOwningCache<AsyncEntry<T>>;
+
+    struct Upload
+    {
+        std::function<bool()> is_ready; ///< optional; returns false if the upload must wait
+        std::function<void()> run;
+    };
+
+    template <typename T>
+    Handle<T> wait(const Future<T>& future);
+
+    template <typename T>
+    Future<T> request(AsyncCache<T>& cache, std::string_view name);
+
+    template <typename T>
+    Handle<T> get(AsyncCache<T>& cache, std::string_view name);
+
+    std::unique_ptr<AsyncEntry<khepri::renderer::Texture>>
+    start_texture_load(std::string_view name);
+
+    std::unique_ptr<AsyncEntry<openglyph::renderer::RenderModel>>
+    start_render_model_load(std::string_view name);
+
+    khepri::renderer::TextureDesc load_texture(khepri::io::Stream& stream,
+                                               std::string_view    name) const;
+
+    void queue_upload(Upload upload);
+    bool run_upload(bool block);
+
+    AssetLoader&                m_asset_loader;
+    khepri::renderer::Renderer& m_renderer;
+
+    khepri::OwningCache<const khepri::renderer::Shader> m_shader_cache;
+
+    AsyncCache<khepri::renderer::Texture>          m_textures;
+    std::vector<Handle<khepri::renderer::Texture>> m_material_textures;
+
+    openglyph::renderer::RenderPipelineStore m_render_pipelines;
+    openglyph::renderer::MaterialStore       m_materials;
+    openglyph::renderer::ModelCreator        m_model_creator;
+
+    AsyncCache<openglyph::renderer::RenderModel> m_render_models;
+
+    std::size_t                m_memory_budget{UNLIMITED_BUDGET};
+    std::size_t                m_memory_usage{0};
+    std::atomic<std::uint64_t> m_use_counter{0};
+
+    std::mutex              m_upload_mutex;
+    std::condition_variable m_upload_cv;
+    std::deque<Upload>      m_uploads;
+
+    std::optional<khepri::renderer::TextureProcessOptions> m_texture_processing;
+    std::optional<khepri::renderer::io::TextureCache>      m_texture_cache;
+
+    // Declared last so that the workers are stopped before anything they use is destroyed
+    khepri::ThreadPool m_thread_pool;
 };
 
 } // namespace openglyph
@@ -8,6 +8,7 @@
 #include <memory>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 namespace openglyph {
 
@@ -19,6 +20,10 @@ namespace openglyph {
  * It is also flexible in finding asset filenames. Each asset type has a list of extensions that the
  * AssetLoader will attempt to look through. For instance, when requesting texture "W_BLANK", it
  * may look for "W_BLANK", "W_BLANK.DDS" and "W_BLANK.TGA".
+ *
+ * On construction, all loose files and MegaFile contents in the data paths are gathered into a
+ * single index, so opening an asset doesn't have to search the file system or MegaFiles. Files
+ * that are added to the data paths afterwards will not be found.
  */
 class AssetLoader
 {
@@ -59,12 +64,14 @@ public:
 
 private:
     class AssetLayer;
+    class AssetIndex;
 
     std::unique_ptr<khepri::io::Stream> open_file(const std::filesystem::path&      base_path,
                                                   std::string_view                  name,
                                                   gsl::span<const std::string_view> extensions);
 
     std::vector<std::unique_ptr<AssetLayer>> m_asset_layers;
+    std::unique_ptr<AssetIndex>              m_index;
 };
 
 } // namespace openglyph
@@ -4,6 +4,8 @@
 
 #include <openglyph/renderer/render_model.hpp>
 
+#include <memory>
+
 namespace openglyph {
 
 class RenderBehavior : public khepri::scene::Behavior
@@ -17,11 +19,20 @@ public:
         foreground
     };
 
-    explicit RenderBehavior(const renderer::RenderModel& model) : m_model(model) {}
+    /**
+     * Constructs the behavior.
+     *
+     * @param model the render model to render. The behavior shares ownership of the model, which
+     *              keeps the model from being evicted from the AssetCache.
+     */
+    explicit RenderBehavior(std::shared_ptr<const renderer::RenderModel> model)
+        : m_model(std::move(model))
+    {
+    }
 
-    [[nodiscard]] const auto& model() const noexcept
+    [[nodiscard]] const renderer::RenderModel& model() const noexcept
     {
-        return m_model;
+        return *m_model;
     }
 
     [[nodiscard]] double scale() const noexcept
@@ -45,9 +56,9 @@ public:
     }
 
 private:
-    const renderer::RenderModel& m_model;
-    double                       m_scale{1.0};
-    RenderLayer                  m_render_layer{RenderLayer::foreground};
+    std::shared_ptr<const renderer::RenderModel> m_model;
+    double                                       m_scale{1.0};
+    RenderLayer                                  m_render_layer{RenderLayer::foreground};
 };
 
 } // namespace openglyph
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "behaviors/render_behavior.hpp"
 #include "environment.hpp"
 #include "game_object_type_store.hpp"
 
@@ -55,33 +56,42 @@ public:
     }
 
     /**
-     * Adds an object to the scene.
+     * Creates a new object in the scene.
      *
-     * Does nothing if the object is already added.
+     * \param render_layer the layer to place the object in. Objects in the background layer are
+     *                     placed in the background scene.
      */
-    void add_object(const std::shared_ptr<khepri::scene::SceneObject>& object);
+    khepri::scene::SceneObject create_object(
+        RenderBehavior::RenderLayer render_layer = RenderBehavior::RenderLayer::foreground);
 
     /**
      * Removes an object from the scene.
      *
      * Does nothing if the object is not in the scene.
      */
-    void remove_object(const std::shared_ptr<khepri::scene::SceneObject>& object);
+    void remove_object(const khepri::scene::SceneObject& object);
 
+    /**
+     * Returns all objects in the foreground and background scenes that have a specified behavior.
+     *
+     * \see khepri::scene::ObjectView
+     */
     template <typename BehaviorType>
-    std::vector<std::shared_ptr<khepri::scene::SceneObject>> objects() const
+    [[nodiscard]] khepri::scene::ObjectView<BehaviorType, 2> objects() noexcept
     {
-        // Combine the objects from the foreground and background scenes
-        auto result    = m_foreground_scene.objects<BehaviorType>();
-        auto bg_result = m_background_scene.objects<BehaviorType>();
-        result.insert(result.end(), bg_result.begin(), bg_result.end());
-        return result;
+        return khepri::scene::ObjectView<BehaviorType, 2>(
+            {&m_foreground_scene, &m_background_scene});
     }
 
-private:
-    // Returns a reference to the scene the object should be placed into
-    khepri::scene::Scene& target_scene(const khepri::scene::SceneObject& object);
+    /// \copydoc objects()
+    template <typename BehaviorType>
+    [[nodiscard]] khepri::scene::ConstObjectView<BehaviorType, 2> objects() const noexcept
+    {
+        return khepri::scene::ConstObjectView<BehaviorType, 2>(
+            {&m_foreground_scene, &m_background_scene});
+    }
 
+private:
     const GameObjectTypeStore& m_game_object_types;
 
     // Special "background" scene that's rendered behind the foreground scene with special depth
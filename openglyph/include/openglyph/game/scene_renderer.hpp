@@ -1,15 +1,42 @@
 #pragma once
 
+#include <khepri/math/sphere.hpp>
 #include <khepri/renderer/camera.hpp>
 #include <khepri/renderer/renderer.hpp>
 
+#include <openglyph/game/behaviors/render_behavior.hpp>
 #include <openglyph/game/scene.hpp>
 
+#include <optional>
+#include <utility>
+#include <vector>
+
 namespace openglyph {
 
 class SceneRenderer
 {
 public:
+    /**
+     * Settings for selecting the level-of-detail (LOD) of rendered models.
+     *
+     * Every frame, an object's model is rendered at a LOD step based on the projected size of the
+     * model: the ratio of its projected diameter to the viewport height.
+     */
+    struct LodSettings
+    {
+        /**
+         * The projected sizes below which the next, less detailed, LOD step is used, in
+         * descending order. I.e. step N is used below the first N thresholds.
+         */
+        std::vector<double> thresholds{0.2, 0.08, 0.03};
+
+        /**
+         * The relative margin around every threshold in which an object keeps its current LOD
+         * step. This avoids objects switching back and forth when hovering around a threshold.
+         */
+        double hysteresis{0.15};
+    };
+
     SceneRenderer(khepri::renderer::Renderer&             renderer,
                   const khepri::renderer::RenderPipeline& render_pipeline)
         : m_renderer(renderer), m_render_pipeline(render_pipeline)
@@ -24,12 +51,28 @@ public:
 
     void render_scene(const openglyph::Scene& scene, const khepri::renderer::Camera& camera);
 
+    /**
+     * Returns the object-space bounds of an object that is rendered with \a render, to set on the
+     * object (see #khepri::scene::SceneObject::bounds).
+     *
+     * Objects with bounds are culled through the scene's spatial index. Billboarded meshes are
+     * moved and rotated when rendered, so objects with such meshes have no bounds (std::nullopt).
+     */
+    static std::optional<khepri::Sphere> object_bounds(const RenderBehavior& render);
+
+    /// Changes the settings for selecting the level-of-detail of rendered models
+    void lod_settings(LodSettings lod_settings)
+    {
+        m_lod_settings = std::move(lod_settings);
+    }
+
 private:
     void render_scene(const khepri::scene::Scene& scene, const openglyph::Environment& environment,
                       const khepri::renderer::Camera& camera);
 
     khepri::renderer::Renderer&             m_renderer;
     const khepri::renderer::RenderPipeline& m_render_pipeline;
+    LodSettings                             m_lod_settings;
 };
 
 } // namespace openglyph
@@ -4,9 +4,9 @@
 
 #include <gsl/gsl-lite.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
-#include <stack>
 #include <vector>
 
 namespace openglyph::io {
@@ -14,19 +14,33 @@ namespace openglyph::io {
 using ChunkId = std::uint32_t;
 
 /**
- * A chunk_reader reads the chunked file format from a stream
+ * A chunk_reader reads the chunked file format from a contiguous block of memory.
+ *
+ * Data chunks are returned as views into that memory, so reading chunks does not allocate or copy.
  */
 class ChunkReader final
 {
 public:
     /**
-     * Constructs a chunk reader.
+     * Constructs a chunk reader from a stream.
+     *
+     * The remainder of the stream is read into memory, unless the stream already is in memory
+     * (i.e. a khepri::io::SpanStream), in which case its data is used directly.
      *
      * \param[in] stream the underlying stream.
      *
      * \note The caller must ensure that @a stream is kept alive while this object is alive.
      */
     explicit ChunkReader(khepri::io::Stream& stream);
+
+    /**
+     * Constructs a chunk reader from a block of memory.
+     *
+     * \param[in] data the chunked data.
+     *
+     * \note The caller must ensure that @a data is kept alive while this object is alive.
+     */
+    explicit ChunkReader(gsl::span<const std::uint8_t> data);
     ~ChunkReader() = default;
 
     ChunkReader(const ChunkReader&)                = delete;
@@ -49,10 +63,10 @@ public:
     /**
      * Reads the current chunk's data.
      *
-     * \throws khepri::io::error if #has_chunks() is false, #has_data() is false or an I/O error
-     * occured.
+     * \throws khepri::io::error if #has_chunks() is false or #has_data() is false.
+     * \note the returned data remains valid while the underlying data is alive.
      */
-    std::vector<std::uint8_t> read_data();
+    [[nodiscard]] gsl::span<const std::uint8_t> read_data() const;
 
     /**
      * Has the end of the current level's chunks been reached?
@@ -81,19 +95,20 @@ public:
     void close();
 
 private:
-    void read_next();
+    void read_next(std::size_t pos);
 
     struct ChunkInfo
     {
-        ChunkId   id;
-        bool      data;
-        long long start;
-        long long end;
+        ChunkId     id;
+        bool        data;
+        std::size_t start;
+        std::size_t end;
     };
 
-    khepri::io::Stream&      m_stream;
-    std::optional<ChunkInfo> m_current;
-    std::stack<ChunkInfo>    m_parents;
+    std::vector<std::uint8_t>     m_buffer; // Only used if the data had to be read from a stream
+    gsl::span<const std::uint8_t> m_data;
+    std::optional<ChunkInfo>      m_current;
+    std::vector<ChunkInfo>        m_parents;
 };
 
 /**
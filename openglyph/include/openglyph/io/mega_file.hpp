@@ -1,10 +1,12 @@
 #pragma once
 
 #include <khepri/io/exceptions.hpp>
-#include <khepri/io/file.hpp>
-#include <khepri/io/stream.hpp>
+#include <khepri/io/memory_mapped_file.hpp>
+#include <khepri/io/span_stream.hpp>
 
 #include <cstdint>
+#include <filesystem>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -19,6 +21,8 @@ namespace openglyph::io {
  * including filenames and file info necessary for accessing
  * individual files within the archive.
  *
+ * The archive is memory-mapped, so opened files are read directly from memory.
+ *
  * Instances of this class are non-copyable and non-movable.
  */
 class MegaFile final
@@ -36,19 +40,51 @@ public:
      * @brief Opens a file from the MegaFile archive.
      *
      * Attempts to locate and open a file using the provided relative path.
-     * Returns a `Stream` for reading the file's contents if found; otherwise returns `nullptr`.
+     * Returns a `SpanStream` over the file's contents in the memory-mapped archive if found;
+     * otherwise returns `nullptr`. Use `SpanStream::data()` to access the contents without
+     * copying.
      *
      * @param path The relative path of the file to open.
-     * @return A unique pointer to a `khepri::io::Stream` for reading the file contents,
+     * @return A unique pointer to a `khepri::io::SpanStream` for reading the file contents,
      *         or `nullptr` if the file was not found.
      *
-     * @note The returned `khepri::io::Stream` must not outlive parent `openglyph::io::MegaFile`
-     * instance that created it.
+     * @note The returned `khepri::io::SpanStream` must not outlive parent
+     * `openglyph::io::MegaFile` instance that created it.
+     */
+    std::unique_ptr<khepri::io::SpanStream> open_file(const std::filesystem::path& path);
+
+    /**
+     * @brief Returns the number of files in the MegaFile archive.
+     */
+    [[nodiscard]] std::size_t file_count() const noexcept
+    {
+        return m_fileinfo.size();
+    }
+
+    /**
+     * @brief Returns the path of a file in the MegaFile archive, as stored in the archive.
+     *
+     * @param index The index of the file, between 0 and #file_count().
+     * @throws std::out_of_range if @a index is out of range.
+     */
+    [[nodiscard]] const std::string& file_path(std::size_t index) const
+    {
+        return m_filenames.at(m_fileinfo.at(index).file_name_index);
+    }
+
+    /**
+     * @brief Opens a file from the MegaFile archive by index.
+     *
+     * @param index The index of the file, between 0 and #file_count().
+     * @return A unique pointer to a `khepri::io::SpanStream` for reading the file contents.
+     * @throws std::out_of_range if @a index is out of range.
+     *
+     * @note The returned `khepri::io::SpanStream` must not outlive parent
+     * `openglyph::io::MegaFile` instance that created it.
      */
-    std::unique_ptr<khepri::io::Stream> open_file(const std::filesystem::path& path);
+    std::unique_ptr<khepri::io::SpanStream> open_file_at(std::size_t index);
 
 private:
-    class SubFile;
     struct SubFileInfo
     {
         std::uint32_t crc32;
@@ -60,7 +96,7 @@ private:
 
     std::tuple<std::vector<std::string>, std::vector<SubFileInfo>> extract_metadata();
 
-    std::unique_ptr<khepri::io::File> m_file;
+    khepri::io::MemoryMappedFile m_file;
 
     std::vector<std::string> m_filenames;
     std::vector<SubFileInfo> m_fileinfo;
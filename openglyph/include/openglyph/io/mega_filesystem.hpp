@@ -2,6 +2,8 @@
 
 #include <openglyph/io/mega_file.hpp>
 
+#include <gsl/gsl-lite.hpp>
+
 #include <cassert>
 #include <filesystem>
 #include <memory>
@@ -44,6 +46,14 @@ public:
      */
     std::unique_ptr<khepri::io::Stream> open_file(const std::filesystem::path& path);
 
+    /**
+     * Returns the MegaFiles in this file system, in search order.
+     */
+    [[nodiscard]] gsl::span<const std::unique_ptr<MegaFile>> mega_files() const noexcept
+    {
+        return m_mega_files;
+    }
+
 private:
     /**
      * @brief Parses the `megafiles.xml` index file to discover referenced MegaFile archives.
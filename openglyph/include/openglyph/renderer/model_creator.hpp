@@ -5,10 +5,41 @@
 
 #include <khepri/io/exceptions.hpp>
 #include <khepri/log/log.hpp>
+#include <khepri/math/sphere.hpp>
+#include <khepri/renderer/mesh_desc.hpp>
 #include <khepri/renderer/renderer.hpp>
 
+#include <string>
+#include <vector>
+
 namespace openglyph::renderer {
 
+/**
+ * CPU-side description of a RenderModel.
+ *
+ * This holds everything needed to create a RenderModel, but references no renderer resources.
+ * Materials and textures are referenced by name.
+ */
+struct RenderModelDesc
+{
+    struct Mesh
+    {
+        std::string                         name;
+        unsigned int                        lod;
+        unsigned int                        alt;
+        std::string                         material_name;
+        khepri::renderer::MeshDesc          mesh_desc;
+        std::vector<Model::Material::Param> params; ///< texture parameters hold the texture name
+        bool                                visible;
+        BillboardMode                       billboard_mode;
+        khepri::Matrixf                     root_transform;
+        khepri::Matrixf                     parent_transform;
+        khepri::Sphere                      bounding_sphere;
+    };
+
+    std::vector<Mesh> meshes;
+};
+
 class ModelCreator
 {
 public:
@@ -25,6 +56,21 @@ public:
     ModelCreator& operator=(const ModelCreator&)     = delete;
     ModelCreator& operator=(ModelCreator&&) noexcept = delete;
 
+    /**
+     * Creates the description of a render model from a model.
+     *
+     * This does not use the renderer or the loaders, and can be called from any thread.
+     */
+    static RenderModelDesc create_model_desc(const Model& model);
+
+    /**
+     * Creates a render model, including its renderer resources, from a description.
+     */
+    std::unique_ptr<RenderModel> create_model(const RenderModelDesc& model_desc);
+
+    /**
+     * Creates a render model, including its renderer resources, from a model.
+     */
     std::unique_ptr<RenderModel> create_model(const Model& model);
 
 private:
@@ -2,10 +2,12 @@
 
 #include "billboard.hpp"
 
+#include <khepri/math/sphere.hpp>
 #include <khepri/renderer/material.hpp>
 #include <khepri/renderer/mesh.hpp>
 #include <khepri/renderer/mesh_instance.hpp>
 
+#include <algorithm>
 #include <vector>
 
 namespace openglyph::renderer {
@@ -15,27 +17,61 @@ class RenderModel
 public:
     struct Mesh
     {
-        using Param = khepri::renderer::Material::Param;
+        using Param      = khepri::renderer::Material::Param;
+        using ParamBlock = khepri::renderer::Material::ParamBlock;
 
         std::string                             name;
+        unsigned int                            lod; // higher is more detail
+        unsigned int                            alt;
         std::unique_ptr<khepri::renderer::Mesh> render_mesh;
         BillboardMode                           billboard_mode;
         const khepri::renderer::Material*       material;
-        std::vector<Param>                      material_params;
+        ParamBlock                              material_params;  // compiled for material
         bool                                    visible;
         khepri::Matrixf                         root_transform;   // relative to the model's root
         khepri::Matrixf                         parent_transform; // relative to the mesh's parent
+        khepri::Sphere                          bounding_sphere;  // in the mesh's local space
+
+        // Position of this mesh among the LOD variants of the mesh (the meshes with the same name
+        // and alt), and the number of variants. Rank 0 is the most detailed variant.
+        // Set by the RenderModel.
+        unsigned int lod_rank{0};
+        unsigned int lod_count{1};
+
+        /// Checks if this mesh is the variant that is rendered at a model's LOD \a step
+        [[nodiscard]] bool in_lod_step(unsigned int step) const noexcept
+        {
+            return lod_rank == std::min(step, lod_count - 1);
+        }
     };
 
-    explicit RenderModel(std::vector<Mesh> meshes) : m_meshes(std::move(meshes)) {}
+    explicit RenderModel(std::vector<Mesh> meshes);
 
     [[nodiscard]] const auto& meshes() const noexcept
     {
         return m_meshes;
     }
 
+    /**
+     * Returns the number of LOD steps of the model. Step 0 renders the most detailed variant of
+     * every mesh; every next step renders the next less detailed variant of the meshes that have
+     * one. See #Mesh::in_lod_step.
+     */
+    [[nodiscard]] unsigned int lod_step_count() const noexcept
+    {
+        return m_lod_step_count;
+    }
+
+    /// Returns a sphere that encloses all meshes, relative to the model's root
+    [[nodiscard]] const khepri::Sphere& bounding_sphere() const noexcept
+    {
+        return m_bounding_sphere;
+    }
+
 private:
     std::vector<Mesh> m_meshes;
+    unsigned int      m_lod_step_count{1};
+    khepri::Sphere    m_bounding_sphere{{0, 0, 0}, 0.0};
 };
 
 } // namespace openglyph::renderer
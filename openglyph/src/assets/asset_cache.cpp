@@ -1,3 +1,5 @@
+#include <khepri/io/exceptions.hpp>
+#include <khepri/io/span_stream.hpp>
 #include <khepri/log/log.hpp>
 #include <khepri/renderer/io/shader.hpp>
 #include <khepri/renderer/io/texture.hpp>
@@ -7,8 +9,13 @@
 #include <openglyph/renderer/io/model.hpp>
 #include <openglyph/renderer/io/render_pipeline.hpp>
 
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <exception>
 #include <mutex>
 #include <set>
+#include <utility>
 
 namespace openglyph {
 namespace {
@@ -28,51 +35,92 @@ auto create_shader_loader(AssetLoader& asset_loader, khepri::renderer::Renderer&
     };
 }
 
-auto create_texture_loader(AssetLoader& asset_loader, khepri::renderer::Renderer& renderer)
+template <typename T>
+auto make_promise()
 {
-    return [&](std::string_view name) -> std::unique_ptr<khepri::renderer::Texture> {
-        if (auto stream = asset_loader.open_texture(name)) {
-            // Older games that do not support extended pixel format information are generally read
-            // in linear space, because their graphics APIs (e.g. DX9) lacked the notion of sRGB
-            // textures.
-            auto texture_desc =
-                khepri::renderer::io::load_texture(*stream, {khepri::renderer::ColorSpace::linear});
-            return renderer.create_texture(texture_desc);
-        }
-        return {};
-    };
+    return std::make_shared<std::promise<std::shared_ptr<const T>>>();
 }
 
-auto create_render_model_loader(AssetLoader&                       asset_loader,
-                                openglyph::renderer::ModelCreator& model_creator)
+std::vector<std::string> texture_names(const openglyph::renderer::RenderModelDesc& model_desc)
 {
-    return [&](std::string_view name) -> std::unique_ptr<openglyph::renderer::RenderModel> {
-        if (auto stream = asset_loader.open_model(name)) {
-            const auto model = openglyph::io::read_model(*stream);
-            return model_creator.create_model(model);
+    std::vector<std::string> names;
+    for (const auto& mesh : model_desc.meshes) {
+        for (const auto& param : mesh.params) {
+            if (const auto* texture_name = std::get_if<std::string>(&param.value)) {
+                names.push_back(*texture_name);
+            }
         }
-        return {};
-    };
+    }
+    return names;
+}
+
+std::size_t memory_size(const khepri::renderer::TextureDesc& texture_desc)
+{
+    return texture_desc.data().size();
+}
+
+std::size_t memory_size(const openglyph::renderer::RenderModelDesc& model_desc)
+{
+    std::size_t size = 0;
+    for (const auto& mesh : model_desc.meshes) {
+        const auto& mesh_desc = mesh.mesh_desc;
+        size += mesh_desc.vertices.size() * sizeof(mesh_desc.vertices[0]) +
+                mesh_desc.indices.size() * sizeof(mesh_desc.indices[0]);
+    }
+    return size;
 }
 
 } // namespace
 
-AssetCache::AssetCache(AssetLoader& asset_loader, khepri::renderer::Renderer& renderer)
-    : m_shader_cache(create_shader_loader(asset_loader, renderer))
-    , m_texture_cache(create_texture_loader(asset_loader, renderer))
+AssetCache::AssetCache(AssetLoader& asset_loader, khepri::renderer::Renderer& renderer,
+                       std::size_t                              num_threads,
+                       std::optional<TextureProcessingSettings> texture_processing)
+    : m_asset_loader(asset_loader)
+    , m_renderer(renderer)
+    , m_shader_cache(create_shader_loader(asset_loader, renderer))
+    , m_textures([this](std::string_view name) { return start_texture_load(name); })
     , m_render_pipelines(renderer)
-    , m_materials(renderer, m_shader_cache.as_loader(), m_texture_cache.as_loader())
+    , m_materials(renderer, m_shader_cache.as_loader(),
+                  [this](auto name) {
+                      // Materials live as long as the cache, so their textures are always pinned
+                      auto texture = get_texture(name);
+                      m_material_textures.push_back(texture);
+                      return texture.get();
+                  })
     , m_model_creator(
-          renderer, [this](auto name) { return get_material(name); }, m_texture_cache.as_loader())
-    , m_render_model_cache(create_render_model_loader(asset_loader, m_model_creator))
+          renderer, [this](auto name) { return get_material(name); },
+          // The render model's upload pins its textures
+          [this](auto name) { return get_texture(name).get(); })
+    , m_render_models([this](std::string_view name) { return start_render_model_load(name); })
+    , m_thread_pool(num_threads)
 {
+    // Set up texture processing before any textures are requested
+    if (texture_processing) {
+        m_texture_processing = texture_processing->options;
+        if (!texture_processing->cache_path.empty()) {
+            m_texture_cache.emplace(texture_processing->cache_path);
+        }
+    }
+
     if (auto stream = asset_loader.open_config("RenderPipelines")) {
         m_render_pipelines.register_render_pipelines(
             openglyph::renderer::io::load_render_pipelines(*stream));
     }
 
     if (auto stream = asset_loader.open_config("Materials")) {
-        m_materials.register_materials(openglyph::renderer::io::load_materials(*stream));
+        const auto materials = openglyph::renderer::io::load_materials(*stream);
+
+        // Start loading the materials' textures in parallel, so that creating the materials (and
+        // their shaders) overlaps with reading and decoding the textures.
+        for (const auto& material : materials) {
+            for (const auto& property : material.properties) {
+                if (const auto* texture_name = std::get_if<std::string>(&property.default_value)) {
+                    request_texture(*texture_name);
+                }
+            }
+        }
+
+        m_materials.register_materials(materials);
     }
 }
 
@@ -118,16 +166,303 @@ const khepri::renderer::Material* AssetCache::get_material(std::string_view name
     return nullptr;
 }
 
-const khepri::renderer::Texture* AssetCache::get_texture(std::string_view name)
+AssetCache::Handle<khepri::renderer::Texture> AssetCache::get_texture(std::string_view name)
 {
     // Unfindable textures are logged from the AssetLoader
-    return m_texture_cache.get(name);
+    return get(m_textures, name);
 }
 
-const openglyph::renderer::RenderModel* AssetCache::get_render_model(std::string_view name)
+AssetCache::Handle<openglyph::renderer::RenderModel>
+AssetCache::get_render_model(std::string_view name)
 {
     // Unfindable models are logged from the AssetLoader
-    return m_render_model_cache.get(name);
+    return get(m_render_models, name);
+}
+
+AssetCache::Future<khepri::renderer::Texture> AssetCache::request_texture(std::string_view name)
+{
+    return request(m_textures, name);
+}
+
+AssetCache::Future<openglyph::renderer::RenderModel>
+AssetCache::request_render_model(std::string_view name)
+{
+    return request(m_render_models, name);
+}
+
+template <typename T>
+AssetCache::Future<T> AssetCache::request(AsyncCache<T>& cache, std::string_view name)
+{
+    // The entry is shared, because the main thread can evict it while this runs on a worker thread
+    const auto entry = cache.get(name);
+    entry->last_used.store(++m_use_counter, std::memory_order_relaxed);
+    return entry->future;
+}
+
+template <typename T>
+AssetCache::Handle<T> AssetCache::get(AsyncCache<T>& cache, std::string_view name)
+{
+    const auto entry = cache.get(name);
+    entry->last_used.store(++m_use_counter, std::memory_order_relaxed);
+    return wait(entry->future);
+}
+
+std::unique_ptr<AssetCache::AsyncEntry<khepri::renderer::Texture>>
+AssetCache::start_texture_load(std::string_view name)
+{
+    using khepri::renderer::Texture;
+
+    auto promise   = make_promise<Texture>();
+    auto result    = std::make_unique<AsyncEntry<Texture>>();
+    result->future = promise->get_future().share();
+
+    auto& entry = *result;
+
+    // Note: every result, including failures, is published on the main thread via the upload
+    // queue. This way, a blocking wait only has to watch the upload queue.
+    m_thread_pool.submit([this, &entry, name = std::string(name), promise] {
+        try {
+            auto stream = m_asset_loader.open_texture(name);
+            if (!stream) {
+                queue_upload({{}, [promise] { promise->set_value(nullptr); }});
+                return;
+            }
+
+            auto texture_desc =
+                std::make_shared<khepri::renderer::TextureDesc>(load_texture(*stream, name));
+
+            queue_upload({{}, [this, &entry, texture_desc, promise] {
+                              try {
+                                  entry.asset = m_renderer.create_texture(*texture_desc);
+                                  entry.size  = memory_size(*texture_desc);
+                                  m_memory_usage += entry.size;
+                                  promise->set_value(entry.asset);
+                              } catch (...) {
+                                  promise->set_exception(std::current_exception());
+                              }
+                          }});
+        } catch (...) {
+            queue_upload(
+                {{}, [promise, e = std::current_exception()] { promise->set_exception(e); }});
+        }
+    });
+    return result;
+}
+
+khepri::renderer::TextureDesc AssetCache::load_texture(khepri::io::Stream& stream,
+                                                      std::string_view    name) const
+{
+    // Older games that do not support extended pixel format information are generally read in
+    // linear space, because their graphics APIs (e.g. DX9) lacked the notion of sRGB textures.
+    const khepri::renderer::io::TextureLoadOptions load_options{
+        khepri::renderer::ColorSpace::linear};
+    if (!m_texture_processing) {
+        return khepri::renderer::io::load_texture(stream, load_options);
+    }
+
+    // Get the whole file, so that the cache can check if its entry was created from it
+    gsl::span<const std::uint8_t> source;
+    std::vector<std::uint8_t>     buffer;
+    if (auto* span_stream = dynamic_cast<khepri::io::SpanStream*>(&stream)) {
+        // The data is already in memory, no need to copy it
+        source = span_stream->data();
+    } else {
+        const auto size = stream.seek(0, khepri::io::SeekOrigin::end);
+        stream.seek(0, khepri::io::SeekOrigin::begin);
+        buffer.resize(static_cast<std::size_t>(size));
+        if (stream.read(buffer.data(), buffer.size()) != buffer.size()) {
+            throw khepri::io::InvalidFormatError();
+        }
+        source = buffer;
+    }
+
+    const auto& options = *m_texture_processing;
+    const auto  key     = fmt::format("{}:{}:{}:{}", name, options.generate_mips,
+                                      static_cast<int>(options.mip_filter), options.compress);
+    if (m_texture_cache) {
+        if (auto texture_desc = m_texture_cache->find(key, source)) {
+            return std::move(*texture_desc);
+        }
+    }
+
+    khepri::io::SpanStream source_stream(source);
+    auto texture_desc = khepri::renderer::io::load_texture(source_stream, load_options);
+    if (!khepri::renderer::can_process_texture(texture_desc, options)) {
+        return texture_desc;
+    }
+
+    // This already runs on a worker thread, so don't compress on the thread pool as well
+    auto processed = khepri::renderer::process_texture(texture_desc, options);
+    if (m_texture_cache) {
+        m_texture_cache->store(key, source, processed);
+    }
+    return processed;
+}
+
+std::unique_ptr<AssetCache::AsyncEntry<openglyph::renderer::RenderModel>>
+AssetCache::start_render_model_load(std::string_view name)
+{
+    using openglyph::renderer::RenderModel;
+
+    auto promise   = make_promise<RenderModel>();
+    auto result    = std::make_unique<AsyncEntry<RenderModel>>();
+    result->future = promise->get_future().share();
+
+    auto& entry = *result;
+
+    m_thread_pool.submit([this, &entry, name = std::string(name), promise] {
+        try {
+            auto stream = m_asset_loader.open_model(name);
+            if (!stream) {
+                queue_upload({{}, [promise] { promise->set_value(nullptr); }});
+                return;
+            }
+
+            auto model_desc = std::make_shared<openglyph::renderer::RenderModelDesc>(
+                openglyph::renderer::ModelCreator::create_model_desc(
+                    openglyph::io::read_model(*stream)));
+
+            // Load the model's textures in parallel as well. The model's upload waits for them,
+            // so that creating the model doesn't have to load any textures.
+            std::vector<Future<khepri::renderer::Texture>> textures;
+            for (const auto& texture_name : texture_names(*model_desc)) {
+                textures.push_back(request_texture(texture_name));
+            }
+
+            const auto textures_ready = [textures = std::move(textures)] {
+                return std::all_of(textures.begin(), textures.end(), [](const auto& texture) {
+                    return texture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+                });
+            };
+
+            queue_upload({textures_ready, [this, &entry, model_desc, promise] {
+                              try {
+                                  for (const auto& texture_name : texture_names(*model_desc)) {
+                                      entry.dependencies.push_back(get_texture(texture_name));
+                                  }
+                                  entry.asset = m_model_creator.create_model(*model_desc);
+                                  entry.size  = memory_size(*model_desc);
+                                  m_memory_usage += entry.size;
+                                  promise->set_value(entry.asset);
+                              } catch (...) {
+                                  promise->set_exception(std::current_exception());
+                              }
+                          }});
+        } catch (...) {
+            queue_upload(
+                {{}, [promise, e = std::current_exception()] { promise->set_exception(e); }});
+        }
+    });
+    return result;
+}
+
+void AssetCache::process_uploads(std::chrono::steady_clock::duration budget)
+{
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    while (run_upload(false) && std::chrono::steady_clock::now() < deadline) {
+    }
+
+    evict();
+}
+
+void AssetCache::evict()
+{
+    struct Candidate
+    {
+        std::uint64_t last_used;
+        std::size_t   size;
+        bool          is_render_model;
+        std::string   name;
+    };
+
+    const auto is_evictable = [](const auto& entry) {
+        // Failed loads are kept, so they aren't retried on every request. An unpinned asset is only
+        // referenced by its entry and by the entry's future; copies of that future keep an evicted
+        // asset alive.
+        return entry.asset != nullptr && entry.asset.use_count() <= 2;
+    };
+
+    // Evicting a render model can unpin textures, so keep going until nothing can be evicted
+    while (m_memory_usage > m_memory_budget) {
+        std::vector<Candidate> candidates;
+        m_render_models.for_each([&](const std::string& name, const auto& entry) {
+            if (is_evictable(entry)) {
+                candidates.push_back({entry.last_used.load(), entry.size, true, name});
+            }
+        });
+        m_textures.for_each([&](const std::string& name, const auto& entry) {
+            if (is_evictable(entry)) {
+                candidates.push_back({entry.last_used.load(), entry.size, false, name});
+            }
+        });
+        if (candidates.empty()) {
+            break;
+        }
+
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const auto& c1, const auto& c2) { return c1.last_used < c2.last_used; });
+
+        for (const auto& candidate : candidates) {
+            if (m_memory_usage <= m_memory_budget) {
+                break;
+            }
+            const bool evicted = candidate.is_render_model
+                                     ? m_render_models.erase(candidate.name)
+                                     : m_textures.erase(candidate.name);
+            if (evicted) {
+                m_memory_usage -= candidate.size;
+            }
+        }
+    }
+}
+
+template <typename T>
+AssetCache::Handle<T> AssetCache::wait(const Future<T>& future)
+{
+    while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        run_upload(true);
+    }
+    return future.get();
+}
+
+void AssetCache::queue_upload(Upload upload)
+{
+    {
+        const std::lock_guard lock(m_upload_mutex);
+        m_uploads.push_back(std::move(upload));
+    }
+    m_upload_cv.notify_one();
+}
+
+bool AssetCache::run_upload(bool block)
+{
+    std::unique_lock lock(m_upload_mutex);
+
+    const auto find_ready = [this] {
+        return std::find_if(m_uploads.begin(), m_uploads.end(), [](const Upload& upload) {
+            return !upload.is_ready || upload.is_ready();
+        });
+    };
+
+    auto it = find_ready();
+    if (block) {
+        // Uploads only become ready when other uploads have run, so waiting for new uploads to be
+        // queued is sufficient.
+        m_upload_cv.wait(lock, [&] {
+            it = find_ready();
+            return it != m_uploads.end();
+        });
+    }
+    if (it == m_uploads.end()) {
+        return false;
+    }
+
+    auto run = std::move(it->run);
+    m_uploads.erase(it);
+    lock.unlock();
+
+    run();
+    return true;
 }
 
 } // namespace openglyph
@@ -1,13 +1,18 @@
 #include <khepri/io/exceptions.hpp>
 #include <khepri/io/file.hpp>
 #include <khepri/log/log.hpp>
+#include <khepri/utility/crc.hpp>
 #include <khepri/utility/string.hpp>
 
 #include <openglyph/assets/asset_loader.hpp>
 #include <openglyph/io/mega_filesystem.hpp>
 
 #include <algorithm>
+#include <cassert>
 #include <cctype>
+#include <limits>
+#include <system_error>
+#include <tuple>
 
 namespace fs = std::filesystem;
 
@@ -19,18 +24,21 @@ fs::path base_path()
 {
     return "Data";
 }
+
+// Returns the normalized form of a path for the asset index: uppercase, with forward slashes
+std::string normalize_path(std::string_view path)
+{
+    std::string normalized = khepri::uppercase(path);
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+    return normalized;
+}
 } // namespace
 
 /**
  * @brief Provides access to asset files from a single data source (physical or MegaFile).
  *
- * Each AssetLayer represents one data path.
- *
- * The class abstracts the file-loading logic by attempting to open files in the following
- * order:
- * 1. From the physical file system rooted at `data_path`.
- * 2. From a MegaFile archive using `MegaFileSystem`.
- *
+ * Each AssetLayer represents one data path: the physical files under the data path and the
+ * MegaFile archives listed in its `megafiles.xml`.
  */
 class AssetLoader::AssetLayer
 {
@@ -46,28 +54,92 @@ public:
     AssetLayer& operator=(AssetLayer&&) = delete;
 
     /**
-     * @brief Attempts to open a file from this asset layer.
-     *
-     * The method tries to open the specified file in the following order:
-     * 1. Directly from the physical filesystem under the base data path.
-     * 2. From physical files with each of the given extensions appended.
-     * 3. From the MegaFile archive (if available) using the base path.
-     * 4. From the MegaFile archive (if available) with each of the given extensions appended.
-     *
-     * @param path The relative path of the file to open.
-     * @param extensions A list of alternative file extensions to try if the base file is not
-     * found or an extension is not provided in the path.
-     * @return A unique pointer to a Stream representing the opened file, or nullptr if no file
-     * could be opened.
+     * @brief Returns the root path of the physical files in this layer.
+     */
+    [[nodiscard]] const std::filesystem::path& data_path() const noexcept
+    {
+        return m_data_path;
+    }
+
+    /**
+     * @brief Returns the MegaFile archives in this layer, in search order.
      */
-    std::unique_ptr<khepri::io::Stream> open_file(const std::filesystem::path&      path,
-                                                  gsl::span<const std::string_view> extensions);
+    [[nodiscard]] gsl::span<const std::unique_ptr<io::MegaFile>> mega_files() const noexcept
+    {
+        return m_megafs.mega_files();
+    }
 
 private:
     std::filesystem::path m_data_path{};
     io::MegaFileSystem    m_megafs;
 };
 
+/**
+ * @brief Index of all files in all asset layers.
+ *
+ * Maps the normalized path of every file to its location: either a physical file in a layer or a
+ * file in one of the layer's MegaFile archives. Every path is stored once, for the location that
+ * takes precedence: earlier layers override later layers, and within a layer, physical files
+ * override MegaFiles, which override each other in search order.
+ *
+ * The index is a flat open-addressing hash table with linear probing, keyed by the CRC32 of the
+ * normalized path.
+ */
+class AssetLoader::AssetIndex
+{
+public:
+    /// Value of Location::archive for physical files
+    static constexpr std::uint32_t PHYSICAL_FILE = std::numeric_limits<std::uint32_t>::max();
+
+    /// Location of a file
+    struct Location
+    {
+        /// Index of the asset layer containing the file
+        std::uint32_t layer;
+
+        /// Index of the MegaFile in the layer containing the file, or PHYSICAL_FILE
+        std::uint32_t archive;
+
+        /// Index of the file in the MegaFile (if not a physical file)
+        std::uint32_t file_index;
+
+        /// Path of the physical file, relative to the layer's data path (if a physical file)
+        std::filesystem::path physical_path;
+    };
+
+    explicit AssetIndex(gsl::span<const std::unique_ptr<AssetLayer>> layers);
+
+    /**
+     * @brief Finds the location of a file.
+     *
+     * @param path the path of the file, relative to the data paths. Case-insensitive.
+     * @return the location of the file, or nullptr if the file does not exist.
+     */
+    [[nodiscard]] const Location* find(std::string_view path) const;
+
+private:
+    static constexpr std::uint32_t EMPTY_SLOT = std::numeric_limits<std::uint32_t>::max();
+
+    struct Entry
+    {
+        std::string path; // Normalized path
+        Location    location;
+    };
+
+    struct Slot
+    {
+        std::uint32_t crc{0};
+        std::uint32_t entry{EMPTY_SLOT};
+    };
+
+    // Returns the index of the slot for the normalized path with the given CRC32: either the slot
+    // that contains the path, or the empty slot where it would be inserted.
+    [[nodiscard]] std::size_t find_slot(const std::string& path, std::uint32_t crc) const;
+
+    std::vector<Entry> m_entries;
+    std::vector<Slot>  m_slots;
+};
+
 AssetLoader::~AssetLoader() = default;
 
 AssetLoader::AssetLoader(std::vector<fs::path> data_paths)
@@ -76,6 +148,7 @@ AssetLoader::AssetLoader(std::vector<fs::path> data_paths)
     for (const fs::path& data_path : data_paths) {
         m_asset_layers.push_back(std::make_unique<AssetLayer>(data_path));
     }
+    m_index = std::make_unique<AssetIndex>(m_asset_layers);
 }
 
 std::unique_ptr<khepri::io::Stream> AssetLoader::open_config(std::string_view name)
@@ -117,15 +190,52 @@ AssetLoader::open_file(const fs::path& base_path, std::string_view name_,
     }
 
     fs::path path = base_path / name_;
-    for (auto& asset_layer : m_asset_layers) {
-        if (auto file = asset_layer->open_file(path, extensions)) {
-            LOG.info("Opened file \"{}\"", path.string());
-            return file;
+
+    // Look up the path as-is and with every extension. If several exist, pick the one that takes
+    // precedence: layers are searched in order and in every layer, physical files are searched
+    // before MegaFiles. Candidates are searched in order.
+    const AssetIndex::Location* location           = nullptr;
+    std::size_t                 location_candidate = 0;
+
+    const auto& precedence = [](const AssetIndex::Location& loc, std::size_t candidate) {
+        return std::tuple(loc.layer, loc.archive != AssetIndex::PHYSICAL_FILE, candidate,
+                          loc.archive);
+    };
+
+    const auto& try_candidate = [&](const fs::path& candidate_path, std::size_t candidate) {
+        const auto* loc = m_index->find(candidate_path.string());
+        if (loc != nullptr &&
+            (location == nullptr ||
+             precedence(*loc, candidate) < precedence(*location, location_candidate))) {
+            location           = loc;
+            location_candidate = candidate;
         }
+    };
+
+    try_candidate(path, 0);
+    for (std::size_t i = 0; i < extensions.size(); ++i) {
+        fs::path extended_path = path;
+        extended_path.replace_extension(extensions[i]);
+        try_candidate(extended_path, i + 1);
     }
 
-    LOG.error("unable to open file \"{}\"", path.string());
-    return {};
+    if (location == nullptr) {
+        LOG.error("unable to open file \"{}\"", path.string());
+        return {};
+    }
+
+    const auto& layer = *m_asset_layers[location->layer];
+
+    std::unique_ptr<khepri::io::Stream> file;
+    if (location->archive == AssetIndex::PHYSICAL_FILE) {
+        file = std::make_unique<khepri::io::File>(layer.data_path() / location->physical_path,
+                                                  khepri::io::OpenMode::read);
+    } else {
+        file = layer.mega_files()[location->archive]->open_file_at(location->file_index);
+    }
+
+    LOG.info("Opened file \"{}\"", path.string());
+    return file;
 }
 
 AssetLoader::AssetLayer::AssetLayer(const std::filesystem::path& data_path)
@@ -133,49 +243,84 @@ AssetLoader::AssetLayer::AssetLayer(const std::filesystem::path& data_path)
 {
 }
 
-std::unique_ptr<khepri::io::Stream>
-AssetLoader::AssetLayer::open_file(const std::filesystem::path&      path,
-                                   gsl::span<const std::string_view> extensions)
+AssetLoader::AssetIndex::AssetIndex(gsl::span<const std::unique_ptr<AssetLayer>> layers)
 {
-    const auto& try_open_physical_file =
-        [this](const std::filesystem::path& p) -> std::unique_ptr<khepri::io::Stream> {
-        if (std::filesystem::exists(m_data_path / p)) {
-            return std::make_unique<khepri::io::File>(m_data_path / p, khepri::io::OpenMode::read);
-        }
-        return nullptr;
-    };
+    // Collect all files, in order of precedence
+    for (std::uint32_t layer_index = 0; layer_index < layers.size(); ++layer_index) {
+        const auto& layer = *layers[layer_index];
 
-    const auto& try_open_mega_file =
-        [this](const std::filesystem::path& p) -> std::unique_ptr<khepri::io::Stream> {
-        return m_megafs.open_file(p);
-    };
-
-    const auto& try_with_extensions =
-        [&](const auto& try_open_fn) -> std::unique_ptr<khepri::io::Stream> {
-        if (auto stream = try_open_fn(path)) {
-            return stream;
+        const auto root = layer.data_path() / base_path();
+        if (std::error_code ec; fs::is_directory(root, ec)) {
+            auto it = fs::recursive_directory_iterator(
+                root, fs::directory_options::skip_permission_denied, ec);
+            for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (it->is_regular_file(ec)) {
+                    auto path = it->path().lexically_relative(layer.data_path());
+                    m_entries.push_back({normalize_path(path.generic_string()),
+                                         {layer_index, PHYSICAL_FILE, 0, std::move(path)}});
+                }
+            }
+            if (ec) {
+                LOG.error("unable to index files in \"{}\": {}", root.string(), ec.message());
+            }
         }
 
-        for (const auto& ext : extensions) {
-            std::filesystem::path extended_path = path;
-            extended_path.replace_extension(ext);
-            if (auto stream = try_open_fn(extended_path)) {
-                return stream;
+        const auto mega_files = layer.mega_files();
+        for (std::uint32_t archive = 0; archive < mega_files.size(); ++archive) {
+            const auto& mega_file = *mega_files[archive];
+            for (std::uint32_t i = 0; i < mega_file.file_count(); ++i) {
+                m_entries.push_back(
+                    {normalize_path(mega_file.file_path(i)), {layer_index, archive, i, {}}});
             }
         }
+    }
 
-        return nullptr;
-    };
-
-    if (auto stream = try_with_extensions(try_open_physical_file)) {
-        return stream;
+    // Size the table to keep the load factor at or below 50%
+    std::size_t slot_count = 1;
+    while (slot_count < m_entries.size() * 2) {
+        slot_count *= 2;
     }
+    m_slots.resize(slot_count);
 
-    if (auto stream = try_with_extensions(try_open_mega_file)) {
-        return stream;
+    // Insert the entries. Entries for paths that already exist have a lower precedence and are
+    // dropped, so the surviving entries are compacted in place.
+    std::size_t entry_count = 0;
+    for (auto& entry : m_entries) {
+        const auto crc  = khepri::CRC32::calculate(entry.path);
+        auto&      slot = m_slots[find_slot(entry.path, crc)];
+        if (slot.entry == EMPTY_SLOT) {
+            slot.crc   = crc;
+            slot.entry = static_cast<std::uint32_t>(entry_count);
+            if (&entry != &m_entries[entry_count]) {
+                m_entries[entry_count] = std::move(entry);
+            }
+            ++entry_count;
+        }
     }
+    m_entries.resize(entry_count);
 
-    return nullptr;
+    LOG.info("Indexed {} asset files", m_entries.size());
+}
+
+const AssetLoader::AssetIndex::Location*
+AssetLoader::AssetIndex::find(std::string_view path) const
+{
+    const auto  normalized = normalize_path(path);
+    const auto& slot       = m_slots[find_slot(normalized, khepri::CRC32::calculate(normalized))];
+    return (slot.entry != EMPTY_SLOT) ? &m_entries[slot.entry].location : nullptr;
+}
+
+std::size_t AssetLoader::AssetIndex::find_slot(const std::string& path, std::uint32_t crc) const
+{
+    // The table is never full, so this always finds a slot
+    assert(!m_slots.empty());
+    const std::size_t mask = m_slots.size() - 1;
+    for (std::size_t index = crc & mask;; index = (index + 1) & mask) {
+        const auto& slot = m_slots[index];
+        if (slot.entry == EMPTY_SLOT || (slot.crc == crc && m_entries[slot.entry].path == path)) {
+            return index;
+        }
+    }
 }
 
 } // namespace openglyph
@@ -1,6 +1,8 @@
 #include <openglyph/game/behaviors/render_behavior.hpp>
 #include <openglyph/game/scene_renderer.hpp>
 
+#include <algorithm>
+
 namespace openglyph {
 namespace {
 
@@ -16,9 +18,9 @@ class RenderState
 public:
     struct Mesh
     {
-        using Param = renderer::RenderModel::Mesh::Param;
+        using ParamBlock = renderer::RenderModel::Mesh::ParamBlock;
 
-        std::vector<Param> material_params;
+        ParamBlock material_params;
     };
 
     explicit RenderState(const renderer::RenderModel& model, const khepri::Matrixf& transform)
@@ -26,16 +28,41 @@ public:
     {
         const auto& model_meshes = model.meshes();
         for (std::size_t i = 0; i < model_meshes.size(); ++i) {
-            meshes[i].material_params.insert(meshes[i].material_params.end(),
-                                             model_meshes[i].material_params.begin(),
-                                             model_meshes[i].material_params.end());
+            meshes[i].material_params = model_meshes[i].material_params;
         }
     }
 
     std::vector<Mesh> meshes;
     khepri::Matrixf   transform;
+
+    // The LOD step the model was last rendered at
+    unsigned int lod_step{0};
 };
 
+/**
+ * Selects the LOD step to render an object at, given its current step and its \a projected_size
+ * (see #khepri::renderer::Camera::projected_size).
+ *
+ * The object only moves to a less detailed step once its size is below a threshold by more than
+ * the hysteresis margin, and only moves back once it's above that threshold by more than the
+ * margin.
+ */
+unsigned int select_lod_step(const SceneRenderer::LodSettings& settings, unsigned int current_step,
+                             double projected_size)
+{
+    unsigned int min_step = 0;
+    unsigned int max_step = 0;
+    for (const auto threshold : settings.thresholds) {
+        if (projected_size < threshold * (1 - settings.hysteresis)) {
+            ++min_step;
+        }
+        if (projected_size < threshold * (1 + settings.hysteresis)) {
+            ++max_step;
+        }
+    }
+    return std::clamp(current_step, min_step, max_step);
+}
+
 /**
  * Overwrites \a transform's rotational aspects so that it aligns the -Y axis (typically "front" in
  * object space) with the \a front argument, and the +Z axis (typically "up" in object space) with
@@ -202,38 +229,73 @@ void SceneRenderer::render_scene(const khepri::scene::Scene&     scene,
 {
     std::vector<khepri::renderer::MeshInstance> meshes;
 
-    for (const auto& object : scene.objects()) {
-        if (const auto* render = object->behavior<RenderBehavior>()) {
-            auto* state = object->user_data<RenderState>();
-            if (state == nullptr) {
-                object->user_data(RenderState{
-                    render->model(),
-                    khepri::Matrixf::create_scaling(static_cast<float>(render->scale()))});
-                state = object->user_data<RenderState>();
-            }
+    // Meshes whose bounding sphere lies entirely outside the view frustum are not rendered
+    const auto& frustum = camera.frustum();
+    auto&       states  = scene.user_data<RenderState>();
+
+    const auto render_object = [&](const khepri::scene::ConstSceneObject& object,
+                                   const RenderBehavior&                  render) {
+        const auto slot  = object.id().index;
+        auto*      state = states.get(slot);
+        if (state == nullptr) {
+            state = &states.emplace(
+                slot, render.model(),
+                khepri::Matrixf::create_scaling(static_cast<float>(render.scale())));
+        }
+
+        const auto& scene_transform = OBJECT_ROTATION_CORRECTION * object.transform();
+        const auto& model           = render.model();
+        const auto& model_meshes    = model.meshes();
+
+        if (model.lod_step_count() > 1) {
+            const auto bounds =
+                model.bounding_sphere().transform(state->transform * scene_transform);
+            state->lod_step =
+                select_lod_step(m_lod_settings, state->lod_step, camera.projected_size(bounds));
+        }
+
+        assert(model_meshes.size() == state->meshes.size());
+        for (std::size_t i = 0; i < state->meshes.size(); ++i) {
+            if (model_meshes[i].visible && model_meshes[i].in_lod_step(state->lod_step)) {
+                // Create the mesh's transformation: first transform the mesh according to the
+                // in-model's transformation. Then apply any object-specific transformations
+                // (first scale from the RenderState, then the rotation and position in the
+                // scene).
+                khepri::Matrixf transform =
+                    model_meshes[i].root_transform * state->transform * scene_transform;
+
+                if (model_meshes[i].billboard_mode != renderer::BillboardMode::none) {
+                    //  Then apply billboarding. This will overwrite the rotation
+                    //  components of the transformation, and in some cases its position too.
+                    apply_billboard(transform, model_meshes[i], environment, camera);
+                }
 
-            const auto& scene_transform = OBJECT_ROTATION_CORRECTION * object->transform();
-            const auto& model_meshes    = render->model().meshes();
-
-            assert(model_meshes.size() == state->meshes.size());
-            for (std::size_t i = 0; i < state->meshes.size(); ++i) {
-                if (model_meshes[i].visible) {
-                    // Create the mesh's transformation: first transform the mesh according to the
-                    // in-model's transformation. Then apply any object-specific transformations
-                    // (first scale from the RenderState, then the rotation and position in the
-                    // scene).
-                    khepri::Matrixf transform =
-                        model_meshes[i].root_transform * state->transform * scene_transform;
-
-                    if (model_meshes[i].billboard_mode != renderer::BillboardMode::none) {
-                        //  Then apply billboarding. This will overwrite the rotation
-                        //  components of the transformation, and in some cases its position too.
-                        apply_billboard(transform, model_meshes[i], environment, camera);
-                    }
-
-                    meshes.push_back({model_meshes[i].render_mesh.get(), transform,
-                                      model_meshes[i].material, state->meshes[i].material_params});
+                if (!frustum.intersects(model_meshes[i].bounding_sphere.transform(transform))) {
+                    continue;
                 }
+
+                meshes.push_back({model_meshes[i].render_mesh.get(), transform,
+                                  model_meshes[i].material, &state->meshes[i].material_params});
+            }
+        }
+    };
+
+    // Objects with bounds are found through the scene's spatial index, which skips entire regions
+    // of the scene outside the view frustum
+    scene.query(frustum, [&](const khepri::scene::ConstSceneObject& object) {
+        if (const auto* render = object.behavior<RenderBehavior>()) {
+            render_object(object, *render);
+        }
+    });
+
+    // Objects without bounds are visited by iterating over the behaviors directly
+    if (const auto* renders = scene.behaviors<RenderBehavior>()) {
+        const auto owners    = renders->owners();
+        const auto behaviors = renders->components();
+        for (std::size_t index = 0; index < behaviors.size(); ++index) {
+            const auto object = scene.object(owners[index]);
+            if (!object.bounds()) {
+                render_object(object, behaviors[index]);
             }
         }
     }
@@ -241,4 +303,19 @@ void SceneRenderer::render_scene(const khepri::scene::Scene&     scene,
     m_renderer.render_meshes(m_render_pipeline, meshes, camera);
 }
 
+std::optional<khepri::Sphere> SceneRenderer::object_bounds(const RenderBehavior& render)
+{
+    const auto& model_meshes = render.model().meshes();
+    if (std::any_of(model_meshes.begin(), model_meshes.end(), [](const auto& mesh) {
+            return mesh.billboard_mode != renderer::BillboardMode::none;
+        })) {
+        return std::nullopt;
+    }
+
+    // The same transformations as applied when rendering, before the object's own transformation
+    return render.model().bounding_sphere().transform(
+        khepri::Matrixf::create_scaling(static_cast<float>(render.scale())) *
+        OBJECT_ROTATION_CORRECTION);
+}
+
 } // namespace openglyph
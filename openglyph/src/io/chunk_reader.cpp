@@ -1,4 +1,5 @@
 #include <khepri/io/exceptions.hpp>
+#include <khepri/io/span_stream.hpp>
 
 #include <openglyph/io/chunk_reader.hpp>
 
@@ -6,16 +7,55 @@
 
 namespace openglyph::io {
 
-ChunkReader::ChunkReader(khepri::io::Stream& stream) : m_stream(stream)
+namespace {
+constexpr std::size_t CHUNK_HEADER_SIZE = 8;
+
+// Typical chunked files are not nested much deeper than this
+constexpr std::size_t TYPICAL_MAX_DEPTH = 8;
+
+std::uint32_t read_uint32(gsl::span<const std::uint8_t> data, std::size_t pos) noexcept
+{
+    // Chunked files are little-endian
+    return static_cast<std::uint32_t>(data[pos]) |
+           (static_cast<std::uint32_t>(data[pos + 1]) << 8U) |
+           (static_cast<std::uint32_t>(data[pos + 2]) << 16U) |
+           (static_cast<std::uint32_t>(data[pos + 3]) << 24U);
+}
+} // namespace
+
+ChunkReader::ChunkReader(khepri::io::Stream& stream)
 {
-    auto stream_size = m_stream.seek(0, khepri::io::SeekOrigin::end);
-    m_stream.seek(0, khepri::io::SeekOrigin::begin);
+    const auto pos = stream.seek(0, khepri::io::SeekOrigin::current);
+    if (auto* span_stream = dynamic_cast<khepri::io::SpanStream*>(&stream)) {
+        // The data is already in memory, no need to copy it
+        m_data = span_stream->data().subspan(static_cast<std::size_t>(pos));
+    } else {
+        const auto end = stream.seek(0, khepri::io::SeekOrigin::end);
+        stream.seek(pos, khepri::io::SeekOrigin::begin);
 
-    // The top-level chunk is "fake": the entire stream
-    m_parents.push({0, false, 0, stream_size});
+        m_buffer.resize(static_cast<std::size_t>(end - pos));
+        if (stream.read(m_buffer.data(), m_buffer.size()) != m_buffer.size()) {
+            throw khepri::io::InvalidFormatError();
+        }
+        m_data = m_buffer;
+    }
+
+    // The top-level chunk is "fake": the entire data
+    m_parents.reserve(TYPICAL_MAX_DEPTH);
+    m_parents.push_back({0, false, 0, m_data.size()});
 
     // Read the first real chunk
-    read_next();
+    read_next(0);
+}
+
+ChunkReader::ChunkReader(gsl::span<const std::uint8_t> data) : m_data(data)
+{
+    // The top-level chunk is "fake": the entire data
+    m_parents.reserve(TYPICAL_MAX_DEPTH);
+    m_parents.push_back({0, false, 0, m_data.size()});
+
+    // Read the first real chunk
+    read_next(0);
 }
 
 bool ChunkReader::has_chunk() const noexcept
@@ -39,17 +79,12 @@ bool ChunkReader::has_data() const
     return m_current->data;
 }
 
-std::vector<std::uint8_t> ChunkReader::read_data()
+gsl::span<const std::uint8_t> ChunkReader::read_data() const
 {
     if (!has_data()) {
         throw khepri::io::Error("not a data chunk");
     }
-
-    std::vector<std::uint8_t> data(m_current->end - m_current->start);
-    if (m_stream.read(data.data(), data.size()) != data.size()) {
-        throw khepri::io::InvalidFormatError();
-    }
-    return data;
+    return m_data.subspan(m_current->start, m_current->end - m_current->start);
 }
 
 void ChunkReader::open()
@@ -58,10 +93,10 @@ void ChunkReader::open()
         throw khepri::io::Error("not a parent chunk");
     }
 
-    m_parents.push(*m_current);
+    m_parents.push_back(*m_current);
     m_current = {};
 
-    read_next();
+    read_next(m_parents.back().start);
 }
 
 void ChunkReader::close()
@@ -70,10 +105,8 @@ void ChunkReader::close()
         throw khepri::io::Error("no chunk to close");
     }
 
-    m_current = m_parents.top();
-    m_parents.pop();
-
-    m_stream.seek(m_current->start, khepri::io::SeekOrigin::begin);
+    m_current = m_parents.back();
+    m_parents.pop_back();
 }
 
 void ChunkReader::next()
@@ -86,27 +119,26 @@ void ChunkReader::next()
     auto pos  = m_current->end;
     m_current = {};
 
-    if (pos < m_parents.top().end) {
-        m_stream.seek(pos, khepri::io::SeekOrigin::begin);
-        read_next();
+    if (pos < m_parents.back().end) {
+        read_next(pos);
     }
 }
 
-void ChunkReader::read_next()
+void ChunkReader::read_next(std::size_t pos)
 {
-    auto pos = m_stream.seek(0, khepri::io::SeekOrigin::current);
-    if (pos + 8 > m_parents.top().end) {
+    const auto parent_end = m_parents.back().end;
+    if (pos + CHUNK_HEADER_SIZE > parent_end) {
         // The header doesn't fit
         throw khepri::io::InvalidFormatError();
     }
 
-    auto       id   = m_stream.read_uint32();
-    auto       size = m_stream.read_uint32();
+    const auto id   = read_uint32(m_data, pos);
+    auto       size = read_uint32(m_data, pos + 4);
     const bool data = ((size & 0x80000000U) == 0);
-    pos += 8;
+    pos += CHUNK_HEADER_SIZE;
     size = (size & 0x7fffffffU);
 
-    if (pos + size > m_parents.top().end) {
+    if (size > parent_end - pos) {
         // The chunk itself doesn't fit
         throw khepri::io::InvalidFormatError();
     }
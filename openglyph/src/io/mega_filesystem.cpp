@@ -1,3 +1,4 @@
+#include <khepri/io/file.hpp>
 #include <khepri/log/log.hpp>
 #include <khepri/utility/string.hpp>
 
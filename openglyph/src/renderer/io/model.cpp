@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <charconv>
+#include <cstring>
 #include <limits>
 #include <tuple>
 
@@ -50,114 +51,82 @@ enum ModelChunkId : std::uint32_t
     connections_proxy  = 0x603,
 };
 
-struct VertexV1 : Model::Vertex
-{};
+// Sizes, in bytes, of the vertex formats in the submesh vertex chunks.
+// Both formats start with the fields of Model::Vertex, in order. The remaining fields (skinning
+// data and, in V2, an extra vector) are not used.
+constexpr std::size_t VERTEX_V1_SIZE = 128;
+constexpr std::size_t VERTEX_V2_SIZE = 144;
 
-struct VertexV2 : Model::Vertex
-{};
-} // namespace
-} // namespace openglyph::io
-
-namespace khepri::io {
-/// Specialization of #khepri::io::SerializeTraits for \c VertexV1
-template <>
-struct SerializeTraits<openglyph::io::VertexV1>
+void verify(bool condition)
 {
-    /// \see #khepri::io::SerializeTraits::serialize
-    static void serialize(Serializer& s, const openglyph::io::VertexV1& value)
-    {
-        s.write(value.position);
-        s.write(value.normal);
-        for (auto uv : value.uv) {
-            s.write(uv);
-        }
-        s.write(value.tangent);
-        s.write(value.binormal);
-        s.write(value.color);
-        for (int i = 0; i < 4; ++i) {
-            s.write(std::uint32_t{0});
-        }
-        for (int i = 0; i < 4; ++i) {
-            s.write(0.0F);
-        }
+    if (!condition) {
+        throw khepri::io::InvalidFormatError();
     }
+}
 
-    /// \see #khepri::io::SerializeTraits::deserialize
-    static openglyph::io::VertexV1 deserialize(Deserializer& d)
-    {
-        openglyph::io::VertexV1 v;
-        v.position = d.read<khepri::Vector3f>();
-        v.normal   = d.read<khepri::Vector3f>();
-        for (auto& uv : v.uv) {
-            uv = d.read<khepri::Vector2f>();
-        }
-        v.tangent  = d.read<khepri::Vector3f>();
-        v.binormal = d.read<khepri::Vector3f>();
-        v.color    = d.read<khepri::ColorRGBA>();
-        for (int i = 0; i < 4; ++i) {
-            d.read<std::uint32_t>();
-        }
-        for (int i = 0; i < 4; ++i) {
-            d.read<float>();
-        }
-        return v;
-    }
-};
+// The load_* functions read little-endian values from unaligned memory without bounds checks.
+// Compilers reduce the byte shuffling to plain loads on little-endian hosts.
+std::uint16_t load_uint16(const std::uint8_t* data) noexcept
+{
+    return static_cast<std::uint16_t>(data[0] | (data[1] << 8U));
+}
 
-/// Specialization of #khepri::io::SerializeTraits for \c vertex_v2
-template <>
-struct SerializeTraits<openglyph::io::VertexV2>
+float load_float(const std::uint8_t* data) noexcept
 {
-    /// \see #khepri::io::SerializeTraits::serialize
-    static void serialize(Serializer& s, const openglyph::io::VertexV2& value)
-    {
-        s.write(value.position);
-        s.write(value.normal);
-        for (const auto& uv : value.uv) {
-            s.write(uv);
-        }
-        s.write(value.tangent);
-        s.write(value.binormal);
-        s.write(value.color);
-        s.write(khepri::Vector4f{0, 0, 0, 0});
-        for (int i = 0; i < 4; ++i) {
-            s.write(std::uint32_t{0});
-        }
-        for (int i = 0; i < 4; ++i) {
-            s.write(0.0F);
-        }
-    }
+    const std::uint32_t bits =
+        static_cast<std::uint32_t>(data[0]) | (static_cast<std::uint32_t>(data[1]) << 8U) |
+        (static_cast<std::uint32_t>(data[2]) << 16U) | (static_cast<std::uint32_t>(data[3]) << 24U);
 
-    /// \see #khepri::io::SerializeTraits::deserialize
-    static openglyph::io::VertexV2 deserialize(Deserializer& d)
-    {
-        openglyph::io::VertexV2 v;
-        v.position = d.read<khepri::Vector3f>();
-        v.normal   = d.read<khepri::Vector3f>();
-        for (auto& uv : v.uv) {
-            uv = d.read<khepri::Vector2f>();
-        }
-        v.tangent  = d.read<khepri::Vector3f>();
-        v.binormal = d.read<khepri::Vector3f>();
-        v.color    = d.read<khepri::ColorRGBA>();
-        d.read<khepri::Vector4f>();
-        for (int i = 0; i < 4; ++i) {
-            d.read<std::uint32_t>();
-        }
-        for (int i = 0; i < 4; ++i) {
-            d.read<float>();
+    float value{};
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+khepri::Vector2f load_vector2(const std::uint8_t* data) noexcept
+{
+    return {load_float(data), load_float(data + 4)};
+}
+
+khepri::Vector3f load_vector3(const std::uint8_t* data) noexcept
+{
+    return {load_float(data), load_float(data + 4), load_float(data + 8)};
+}
+
+khepri::ColorRGBA load_color(const std::uint8_t* data) noexcept
+{
+    return {load_float(data), load_float(data + 4), load_float(data + 8), load_float(data + 12)};
+}
+
+// Decodes an array of vertices with the specified size, in bytes, per vertex
+void decode_vertices(gsl::span<const std::uint8_t> data, std::size_t vertex_size,
+                     gsl::span<Model::Vertex> vertices)
+{
+    verify(data.size() / vertex_size >= vertices.size());
+
+    const auto* src = data.data();
+    for (auto& v : vertices) {
+        v.position = load_vector3(src);
+        v.normal   = load_vector3(src + 12);
+        for (std::size_t i = 0; i < v.uv.size(); ++i) {
+            v.uv[i] = load_vector2(src + 24 + i * 8);
         }
-        return v;
+        v.tangent  = load_vector3(src + 56);
+        v.binormal = load_vector3(src + 68);
+        v.color    = load_color(src + 80);
+        src += vertex_size;
     }
-};
-} // namespace khepri::io
+}
 
-namespace openglyph::io {
-namespace {
-void verify(bool condition)
+// Decodes an array of 16-bit indices
+void decode_indices(gsl::span<const std::uint8_t> data, gsl::span<Model::Index> indices)
 {
-    if (!condition) {
-        throw khepri::io::InvalidFormatError();
+    static_assert(sizeof(Model::Index) == sizeof(std::uint16_t));
+    verify(data.size() / sizeof(std::uint16_t) >= indices.size());
+
+    const auto* src = data.data();
+    for (auto& index : indices) {
+        index = load_uint16(src);
+        src += sizeof(std::uint16_t);
     }
 }
 
@@ -222,31 +191,20 @@ auto read_submesh(ChunkReader& reader)
             break;
         }
 
-        case ModelChunkId::submesh_vertices_v1: {
+        case ModelChunkId::submesh_vertices_v1:
             verify(reader.has_data());
-            const auto               data = reader.read_data();
-            khepri::io::Deserializer d(data);
-            std::generate(vertices.begin(), vertices.end(),
-                          [&]() -> Model::Vertex { return d.read<VertexV1>(); });
+            decode_vertices(reader.read_data(), VERTEX_V1_SIZE, vertices);
             break;
-        }
 
-        case ModelChunkId::submesh_vertices_v2: {
+        case ModelChunkId::submesh_vertices_v2:
             verify(reader.has_data());
-            const auto               data = reader.read_data();
-            khepri::io::Deserializer d(data);
-            std::generate(vertices.begin(), vertices.end(),
-                          [&]() -> Model::Vertex { return d.read<VertexV2>(); });
+            decode_vertices(reader.read_data(), VERTEX_V2_SIZE, vertices);
             break;
-        }
 
-        case ModelChunkId::submesh_indices: {
+        case ModelChunkId::submesh_indices:
             verify(reader.has_data());
-            const auto               data = reader.read_data();
-            khepri::io::Deserializer d(data);
-            std::generate(indices.begin(), indices.end(), [&] { return d.read<Model::Index>(); });
+            decode_indices(reader.read_data(), indices);
             break;
-        }
 
         default:
             break;
@@ -1,7 +1,11 @@
+#include <khepri/renderer/mesh_optimizer.hpp>
 #include <khepri/utility/string.hpp>
 
 #include <openglyph/renderer/model_creator.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace openglyph::renderer {
 namespace {
 /**
@@ -20,6 +24,35 @@ khepri::Matrixf absolute_transform(const std::vector<Model::Bone>& bones,
     }
     return transform;
 }
+
+/**
+ * Calculates a bounding sphere for a set of vertices. The sphere is centered on the center of the
+ * vertices' axis-aligned bounding box, which is a cheap, reasonably tight fit for typical meshes.
+ */
+khepri::Sphere bounding_sphere(const std::vector<Model::Vertex>& vertices)
+{
+    if (vertices.empty()) {
+        // Degenerate sphere
+        return {{0, 0, 0}, 0.0};
+    }
+
+    khepri::Vector3f min = vertices[0].position;
+    khepri::Vector3f max = vertices[0].position;
+    for (const auto& v : vertices) {
+        min = {std::min(min.x, v.position.x), std::min(min.y, v.position.y),
+               std::min(min.z, v.position.z)};
+        max = {std::max(max.x, v.position.x), std::max(max.y, v.position.y),
+               std::max(max.z, v.position.z)};
+    }
+
+    const khepri::Vector3 center = (khepri::Vector3{min} + khepri::Vector3{max}) / 2.0;
+
+    double radius_sq = 0.0;
+    for (const auto& v : vertices) {
+        radius_sq = std::max(radius_sq, (khepri::Vector3{v.position} - center).length_sq());
+    }
+    return {center, std::sqrt(radius_sq)};
+}
 } // namespace
 
 ModelCreator::ModelCreator(khepri::renderer::Renderer&              renderer,
@@ -31,25 +64,69 @@ ModelCreator::ModelCreator(khepri::renderer::Renderer&              renderer,
 {
 }
 
-std::unique_ptr<RenderModel> ModelCreator::create_model(const Model& model)
+RenderModelDesc ModelCreator::create_model_desc(const Model& model)
 {
-    std::vector<RenderModel::Mesh> render_meshes;
+    RenderModelDesc model_desc;
+    model_desc.meshes.reserve(model.meshes.size());
     for (const auto& mesh : model.meshes) {
         const auto& material = mesh.materials[0];
-        if (auto* render_material = m_material_loader(khepri::basename(material.name))) {
-            // Create the renderable mesh
-            khepri::renderer::MeshDesc mesh_desc;
-            mesh_desc.vertices.reserve(material.vertices.size());
-            for (const auto& v : material.vertices) {
-                mesh_desc.vertices.push_back(
-                    {v.position, v.normal, v.tangent, v.binormal, v.uv[0], v.color});
+
+        RenderModelDesc::Mesh mesh_desc{mesh.name,
+                                        mesh.lod,
+                                        mesh.alt,
+                                        std::string(khepri::basename(material.name)),
+                                        {},
+                                        {},
+                                        mesh.visible,
+                                        BillboardMode::none,
+                                        khepri::Matrixf::IDENTITY,
+                                        khepri::Matrixf::IDENTITY,
+                                        bounding_sphere(material.vertices)};
+
+        mesh_desc.mesh_desc.vertices.reserve(material.vertices.size());
+        for (const auto& v : material.vertices) {
+            mesh_desc.mesh_desc.vertices.push_back(
+                {v.position, v.normal, v.tangent, v.binormal, v.uv[0], v.color});
+        }
+        mesh_desc.mesh_desc.indices = material.indices;
+
+        // Exporters write triangles in arbitrary order, so optimize them for the vertex cache.
+        // Overdraw is not optimized; it's only meant for opaque meshes, and whether the material
+        // blends isn't known here.
+        khepri::renderer::optimize_mesh(mesh_desc.mesh_desc);
+
+        mesh_desc.params.reserve(material.params.size());
+        for (const auto& param : material.params) {
+            if (const auto* const val = std::get_if<std::string>(&param.value)) {
+                mesh_desc.params.push_back({param.name, std::string(khepri::basename(*val))});
+            } else {
+                mesh_desc.params.push_back(param);
             }
-            mesh_desc.indices = material.indices;
-            auto render_mesh  = m_renderer.create_mesh(mesh_desc);
+        }
+
+        if (mesh.bone_index) {
+            const auto& bone           = model.bones[*mesh.bone_index];
+            mesh_desc.billboard_mode   = bone.billboard_mode;
+            mesh_desc.root_transform   = absolute_transform(model.bones, mesh.bone_index);
+            mesh_desc.parent_transform = bone.parent_transform;
+        }
+
+        model_desc.meshes.push_back(std::move(mesh_desc));
+    }
+    return model_desc;
+}
+
+std::unique_ptr<RenderModel> ModelCreator::create_model(const RenderModelDesc& model_desc)
+{
+    std::vector<RenderModel::Mesh> render_meshes;
+    for (const auto& mesh : model_desc.meshes) {
+        if (auto* render_material = m_material_loader(mesh.material_name)) {
+            // Create the renderable mesh
+            auto render_mesh = m_renderer.create_mesh(mesh.mesh_desc);
 
             // Set up material parameters
             std::vector<RenderModel::Mesh::Param> params;
-            for (const auto& param : material.params) {
+            for (const auto& param : mesh.params) {
                 if (const auto* const val = std::get_if<std::int32_t>(&param.value)) {
                     params.push_back({param.name, *val});
                 } else if (const auto* const val = std::get_if<float>(&param.value)) {
@@ -59,32 +136,26 @@ std::unique_ptr<RenderModel> ModelCreator::create_model(const Model& model)
                 } else if (const auto* const val = std::get_if<khepri::Vector4f>(&param.value)) {
                     params.push_back({param.name, *val});
                 } else if (const auto* const val = std::get_if<std::string>(&param.value)) {
-                    if (auto* texture = m_texture_loader(khepri::basename(*val))) {
+                    if (auto* texture = m_texture_loader(*val)) {
                         params.push_back({param.name, texture});
                     }
                 }
             }
 
-            RenderModel::Mesh created_mesh{mesh.name,
-                                           std::move(render_mesh),
-                                           BillboardMode::none,
-                                           render_material,
-                                           std::move(params),
-                                           mesh.visible,
-                                           khepri::Matrixf::IDENTITY,
-                                           khepri::Matrixf::IDENTITY};
-
-            if (mesh.bone_index) {
-                const auto& bone              = model.bones[*mesh.bone_index];
-                created_mesh.billboard_mode   = bone.billboard_mode;
-                created_mesh.root_transform   = absolute_transform(model.bones, mesh.bone_index);
-                created_mesh.parent_transform = bone.parent_transform;
-            }
-
-            render_meshes.push_back(std::move(created_mesh));
+            // Resolve the parameters once, so rendering doesn't have to match them by name
+            render_meshes.push_back({mesh.name, mesh.lod, mesh.alt, std::move(render_mesh),
+                                     mesh.billboard_mode, render_material,
+                                     render_material->compile_params(params), mesh.visible,
+                                     mesh.root_transform, mesh.parent_transform,
+                                     mesh.bounding_sphere});
         }
     }
     return std::make_unique<RenderModel>(std::move(render_meshes));
 }
 
+std::unique_ptr<RenderModel> ModelCreator::create_model(const Model& model)
+{
+    return create_model(create_model_desc(model));
+}
+
 } // namespace openglyph::renderer
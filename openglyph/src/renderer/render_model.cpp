@@ -0,0 +1,57 @@
+#include <openglyph/renderer/render_model.hpp>
+
+#include <map>
+#include <tuple>
+
+namespace openglyph::renderer {
+namespace {
+// Returns the smallest sphere that encloses both spheres
+khepri::Sphere merge(const khepri::Sphere& s1, const khepri::Sphere& s2)
+{
+    const auto offset   = s2.center() - s1.center();
+    const auto distance = offset.length();
+    if (distance + s2.radius() <= s1.radius()) {
+        return s1;
+    }
+    if (distance + s1.radius() <= s2.radius()) {
+        return s2;
+    }
+    const auto radius = (distance + s1.radius() + s2.radius()) / 2;
+    return {s1.center() + offset * ((radius - s1.radius()) / distance), radius};
+}
+} // namespace
+
+RenderModel::RenderModel(std::vector<Mesh> meshes) : m_meshes(std::move(meshes))
+{
+    // Group the LOD variants of every mesh, ordered from most to least detailed
+    std::map<std::tuple<std::string, unsigned int>, std::vector<Mesh*>> lod_groups;
+    for (auto& mesh : m_meshes) {
+        lod_groups[{mesh.name, mesh.alt}].push_back(&mesh);
+    }
+
+    for (auto& [_, group] : lod_groups) {
+        std::stable_sort(group.begin(), group.end(),
+                         [](const Mesh* m1, const Mesh* m2) { return m1->lod > m2->lod; });
+
+        // Variants with the same LOD level have the same rank
+        unsigned int rank = 0;
+        for (std::size_t i = 0; i < group.size(); ++i) {
+            if (i > 0 && group[i]->lod != group[i - 1]->lod) {
+                ++rank;
+            }
+            group[i]->lod_rank = rank;
+        }
+        for (auto* mesh : group) {
+            mesh->lod_count = rank + 1;
+        }
+        m_lod_step_count = std::max(m_lod_step_count, rank + 1);
+    }
+
+    for (std::size_t i = 0; i < m_meshes.size(); ++i) {
+        const auto& mesh   = m_meshes[i];
+        const auto  sphere = mesh.bounding_sphere.transform(mesh.root_transform);
+        m_bounding_sphere  = (i == 0) ? sphere : merge(m_bounding_sphere, sphere);
+    }
+}
+
+} // namespace openglyph::renderer
@@ -0,0 +1,283 @@
+#include <khepri/math/math.hpp>
+#include <khepri/math/matrix.hpp>
+#include <khepri/math/quaternion.hpp>
+#include <khepri/renderer/camera.hpp>
+#include <khepri/renderer/null/renderer.hpp>
+
+#include <openglyph/assets/asset_cache.hpp>
+#include <openglyph/assets/asset_loader.hpp>
+#include <openglyph/game/behaviors/render_behavior.hpp>
+#include <openglyph/game/game_object_type_store.hpp>
+#include <openglyph/game/scene.hpp>
+#include <openglyph/game/scene_renderer.hpp>
+#include <openglyph/renderer/render_model.hpp>
+
+#include <cxxopts.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr auto PROGRAM_NAME = "scenebench";
+
+using khepri::renderer::Material;
+using khepri::renderer::MeshDesc;
+using openglyph::renderer::RenderModel;
+
+// Size, in world units, of the square area that the objects are placed in
+constexpr double SCENE_SIZE = 1000.0;
+
+// Every model has this many parts, each with a detailed and a simple LOD variant
+constexpr std::size_t PARTS_PER_MODEL = 3;
+
+struct Options
+{
+    std::size_t objects;
+    std::size_t models;
+    std::size_t materials;
+    std::size_t frames;
+};
+
+// The renderer resources and models of the synthetic scene
+struct Resources
+{
+    std::unique_ptr<khepri::renderer::Shader>                shader;
+    std::unique_ptr<khepri::renderer::Texture>               texture;
+    std::vector<std::unique_ptr<khepri::renderer::Material>> materials;
+    std::unique_ptr<khepri::renderer::RenderPipeline>        render_pipeline;
+    std::vector<std::shared_ptr<const RenderModel>>          models;
+};
+
+// Creates a box whose faces are split into a grid of subdivisions x subdivisions quads
+MeshDesc create_box_mesh(float size, int subdivisions)
+{
+    MeshDesc mesh;
+    for (int axis = 0; axis < 3; ++axis) {
+        for (const float sign : {-1.0F, 1.0F}) {
+            khepri::Vector3f normal(0, 0, 0);
+            khepri::Vector3f tangent(0, 0, 0);
+            khepri::Vector3f binormal(0, 0, 0);
+            normal[axis]             = sign;
+            tangent[(axis + 1) % 3]  = 1;
+            binormal[(axis + 2) % 3] = 1;
+
+            const auto first_vertex = static_cast<MeshDesc::Index>(mesh.vertices.size());
+            for (int y = 0; y <= subdivisions; ++y) {
+                for (int x = 0; x <= subdivisions; ++x) {
+                    const auto u = static_cast<float>(x) / static_cast<float>(subdivisions);
+                    const auto v = static_cast<float>(y) / static_cast<float>(subdivisions);
+
+                    MeshDesc::Vertex vertex{};
+                    vertex.position =
+                        (normal + tangent * (u * 2 - 1) + binormal * (v * 2 - 1)) * (size / 2);
+                    vertex.normal   = normal;
+                    vertex.tangent  = tangent;
+                    vertex.binormal = binormal;
+                    vertex.uv       = khepri::Vector2f(u, v);
+                    vertex.color    = khepri::ColorRGBA(1, 1, 1, 1);
+                    mesh.vertices.push_back(vertex);
+                }
+            }
+
+            const auto vertex = [&](int x, int y) {
+                return first_vertex + static_cast<MeshDesc::Index>(y * (subdivisions + 1) + x);
+            };
+            for (int y = 0; y < subdivisions; ++y) {
+                for (int x = 0; x < subdivisions; ++x) {
+                    mesh.indices.insert(mesh.indices.end(),
+                                        {vertex(x, y), vertex(x + 1, y), vertex(x + 1, y + 1),
+                                         vertex(x, y), vertex(x + 1, y + 1), vertex(x, y + 1)});
+                }
+            }
+        }
+    }
+    return mesh;
+}
+
+Resources create_resources(khepri::renderer::Renderer& renderer, const Options& options)
+{
+    using namespace khepri::renderer;
+
+    Resources    resources;
+    std::mt19937 rng(0); // Fixed seed, so every run renders the same scene
+
+    resources.shader = renderer.create_shader("scenebench.hlsl", [](const auto&) {
+        return ShaderDesc(std::vector<std::uint8_t>{});
+    });
+
+    resources.texture = renderer.create_texture(
+        TextureDesc(TextureDimension::texture_2d, 1, 1, 0, 1, PixelFormat::r8g8b8a8_unorm,
+                    {{0, 4, 4, 0}}, {255, 255, 255, 255}));
+
+    // One in four materials is transparent, the rest is opaque
+    for (std::size_t i = 0; i < options.materials; ++i) {
+        MaterialDesc desc;
+        desc.type                   = (i % 4 == 3) ? "Transparent" : "Opaque";
+        desc.num_directional_lights = 1;
+        desc.shader                 = resources.shader.get();
+        desc.properties             = {{"DiffuseTexture", resources.texture.get()},
+                                       {"DiffuseColor", khepri::Vector4f(1, 1, 1, 1)},
+                                       {"Shininess", 1.0F}};
+        resources.materials.push_back(renderer.create_material(desc));
+    }
+
+    RenderPipelineDesc pipeline_desc;
+    pipeline_desc.render_passes.push_back(
+        {"Opaque", RenderPassDesc::DepthSorting::front_to_back, {}});
+    pipeline_desc.render_passes.push_back(
+        {"Transparent", RenderPassDesc::DepthSorting::back_to_front, {}});
+    resources.render_pipeline = renderer.create_render_pipeline(pipeline_desc);
+
+    // Every model consists of a few parts next to each other
+    std::uniform_real_distribution<float>      part_size(1.0F, 10.0F);
+    std::uniform_int_distribution<std::size_t> material_index(0, options.materials - 1);
+    std::uniform_real_distribution<float>      color(0.0F, 1.0F);
+    for (std::size_t i = 0; i < options.models; ++i) {
+        std::vector<RenderModel::Mesh> meshes;
+        for (std::size_t part = 0; part < PARTS_PER_MODEL; ++part) {
+            const auto  size     = part_size(rng);
+            const auto* material = resources.materials[material_index(rng)].get();
+            const std::vector<Material::Param> params{
+                {"DiffuseColor", khepri::Vector4f(color(rng), color(rng), color(rng), 1)}};
+            const auto transform = khepri::Matrixf::create_translation(
+                khepri::Vector3f(static_cast<float>(part) * 10.0F, 0, 0));
+            const khepri::Sphere bounding_sphere({0, 0, 0}, size * std::sqrt(3.0) / 2);
+
+            for (const unsigned int lod : {1U, 0U}) {
+                meshes.push_back({"part" + std::to_string(part), lod, 0,
+                                  renderer.create_mesh(create_box_mesh(size, 1 + 3 * lod)),
+                                  openglyph::renderer::BillboardMode::none, material,
+                                  material->compile_params(params), true, transform, transform,
+                                  bounding_sphere});
+            }
+        }
+        resources.models.push_back(std::make_shared<const RenderModel>(std::move(meshes)));
+    }
+    return resources;
+}
+
+void populate_scene(openglyph::Scene& scene, const Resources& resources, const Options& options)
+{
+    std::mt19937 rng(1);
+
+    std::uniform_real_distribution<double>     position(-SCENE_SIZE / 2, SCENE_SIZE / 2);
+    std::uniform_real_distribution<double>     angle(0, 2 * khepri::PI);
+    std::uniform_int_distribution<std::size_t> model_index(0, options.models - 1);
+
+    for (std::size_t i = 0; i < options.objects; ++i) {
+        auto  object = scene.create_object();
+        auto& render =
+            object.create_behavior<openglyph::RenderBehavior>(resources.models[model_index(rng)]);
+        object.bounds(openglyph::SceneRenderer::object_bounds(render));
+        object.rotation(khepri::Quaternion::from_axis_angle({0, 0, 1}, angle(rng)));
+        object.position({position(rng), position(rng), 0});
+    }
+}
+
+std::size_t get_option(const cxxopts::ParseResult& result, const std::string& name)
+{
+    const auto value = result[name].as<std::size_t>();
+    if (value == 0) {
+        throw std::runtime_error("option '" + name + "' must be greater than 0");
+    }
+    return value;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    try {
+        cxxopts::Options options(PROGRAM_NAME,
+                                 "Measures the CPU cost of rendering a synthetic scene with the "
+                                 "scene renderer and a headless renderer, including culling, "
+                                 "level-of-detail selection and material binding");
+
+        auto adder = options.add_options();
+        adder("h,help", "display this help and exit");
+        adder("n,objects", "Number of objects in the scene",
+              cxxopts::value<std::size_t>()->default_value("10000"));
+        adder("models", "Number of distinct models",
+              cxxopts::value<std::size_t>()->default_value("64"));
+        adder("materials", "Number of distinct materials",
+              cxxopts::value<std::size_t>()->default_value("16"));
+        adder("f,frames", "Number of frames to render",
+              cxxopts::value<std::size_t>()->default_value("100"));
+
+        auto result = options.parse(argc, argv);
+        if (result.count("help") != 0) {
+            std::cout << options.help({"", "Group"}) << "\n";
+            return 0;
+        }
+
+        const Options bench_options{get_option(result, "objects"), get_option(result, "models"),
+                                    get_option(result, "materials"),
+                                    get_option(result, "frames")};
+
+        khepri::renderer::null::Renderer renderer({1920, 1080});
+        const auto                       resources = create_resources(renderer, bench_options);
+
+        // Without data paths, no assets are loaded: the scene only contains the synthetic objects
+        openglyph::AssetLoader         asset_loader({});
+        openglyph::AssetCache          asset_cache(asset_loader, renderer);
+        openglyph::GameObjectTypeStore game_object_types(asset_loader, "GameObjectFiles");
+        openglyph::Scene               scene(asset_cache, game_object_types, {});
+        populate_scene(scene, resources, bench_options);
+
+        openglyph::SceneRenderer scene_renderer(renderer, *resources.render_pipeline);
+
+        khepri::renderer::Camera camera({khepri::renderer::Camera::Type::perspective,
+                                         {0, -SCENE_SIZE / 2, SCENE_SIZE / 2},
+                                         {0, 0, 0},
+                                         {0, 0, 1},
+                                         khepri::PI / 4,
+                                         0,
+                                         16.0 / 9.0,
+                                         1.0,
+                                         SCENE_SIZE * 2});
+
+        // Render one frame to warm up, then measure
+        scene_renderer.render_scene(scene, camera);
+        renderer.present();
+        renderer.reset_statistics();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t frame = 0; frame < bench_options.frames; ++frame) {
+            renderer.clear(khepri::renderer::Renderer::clear_all);
+            scene_renderer.render_scene(scene, camera);
+            renderer.present();
+        }
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        const auto& stats  = renderer.statistics();
+        const auto  frames = static_cast<double>(stats.frames);
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "objects:           " << bench_options.objects << "\n";
+        std::cout << "frames:            " << stats.frames << "\n";
+        std::cout << "time per frame:    " << elapsed.count() / frames << " ms\n";
+        std::cout << "per frame:\n";
+        std::cout << "  draw calls:      " << stats.draw_calls / frames << "\n";
+        std::cout << "  instances:       " << stats.instances / frames << "\n";
+        std::cout << "  triangles:       " << stats.triangles / frames << "\n";
+        std::cout << "  pipeline states: " << stats.pipeline_changes / frames << "\n";
+        std::cout << "  material params: " << stats.material_param_changes / frames << "\n";
+        std::cout << "  mesh changes:    " << stats.mesh_changes / frames << "\n";
+        std::cout << "  bytes uploaded:  " << stats.bytes_uploaded / frames << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << '\n';
+        return 1;
+    } catch (...) {
+        std::cerr << "unknown error\n";
+        return 1;
+    }
+    return 0;
+}
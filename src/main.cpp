@@ -33,6 +33,10 @@
 
 #include <cstdlib>
 #include <cxxopts.hpp>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <system_error>
 
 namespace {
 constexpr auto APPLICATION_NAME = "OpenEAW";
@@ -41,6 +45,12 @@ constexpr auto PROGRAM_NAME     = "OpenEAW";
 // Time, in seconds, between each 'game logic' update step.
 constexpr auto UPDATE_STEP_TIME = 1.0 / 60;
 
+// Time, per frame, spent creating renderer resources for assets loaded in the background.
+constexpr auto ASSET_UPLOAD_BUDGET = std::chrono::milliseconds(2);
+
+// Size, in bytes, of textures and models kept in the asset cache when they're no longer in use.
+constexpr std::size_t ASSET_MEMORY_BUDGET = 1024 * 1024 * 1024;
+
 constexpr khepri::log::Logger LOG("openeaw");
 
 auto full_version_string()
@@ -55,8 +65,28 @@ struct CmdlineArgs
     bool show_version{false};
 
     std::vector<std::filesystem::path> modpaths;
+
+    // Directory to cache compiled shaders in, or empty to disable the cache
+    std::filesystem::path shader_cache_path;
+
+    // Create graphics pipelines when first rendered, instead of at startup
+    bool lazy_pipelines{false};
+
+    // Generate mips for and compress uncompressed textures when they're loaded
+    bool process_textures{true};
+
+    // Directory to cache processed textures in, or empty to disable the cache
+    std::filesystem::path texture_cache_path;
 };
 
+// Compiled shaders and processed textures are cached in the temporary directory by default
+std::filesystem::path default_cache_path(std::string_view name)
+{
+    std::error_code ec;
+    const auto      temp_path = std::filesystem::temp_directory_path(ec);
+    return ec ? std::filesystem::path() : temp_path / APPLICATION_NAME / name;
+}
+
 auto create_cmdline_options()
 {
     cxxopts::Options options(PROGRAM_NAME,
@@ -67,6 +97,12 @@ auto create_cmdline_options()
     adder("v,version", "display version information");
     adder("m,modpaths", "comma-separate list of paths to preferred source of game data",
           cxxopts::value<std::string>());
+    adder("shader-cache", "directory to cache compiled shaders in, or empty to disable caching",
+          cxxopts::value<std::string>());
+    adder("lazy-pipelines", "create graphics pipelines when first rendered, instead of at startup");
+    adder("raw-textures", "use textures as they are, without generating mips or compressing them");
+    adder("texture-cache", "directory to cache processed textures in, or empty to disable caching",
+          cxxopts::value<std::string>());
     return options;
 }
 
@@ -92,6 +128,24 @@ std::optional<CmdlineArgs> parse_cmdline_arguments(int argc, const char* argv[])
                 args.modpaths.emplace_back(path);
             }
         }
+
+        args.shader_cache_path = default_cache_path("ShaderCache");
+        if (result.count("shader-cache") != 0) {
+            args.shader_cache_path = result["shader-cache"].as<std::string>();
+        }
+
+        if (result.count("lazy-pipelines") != 0) {
+            args.lazy_pipelines = true;
+        }
+
+        if (result.count("raw-textures") != 0) {
+            args.process_textures = false;
+        }
+
+        args.texture_cache_path = default_cache_path("TextureCache");
+        if (result.count("texture-cache") != 0) {
+            args.texture_cache_path = result["texture-cache"].as<std::string>();
+        }
         return args;
     } catch (const cxxopts::OptionException& e) {
         std::cerr << "error: " << e.what() << "\n"
@@ -129,42 +183,50 @@ CreateScene(std::string_view map_name, openglyph::AssetLoader& asset_loader,
             environment = map.environments[map.active_environment];
         }
 
+        // Start loading all models in the background, before waiting for the first one.
+        for (const auto& obj : map.objects) {
+            if (const auto* type = game_object_types.get(obj.type_crc)) {
+                asset_cache.request_render_model(type->space_model_name);
+            }
+        }
+
         auto scene =
             std::make_unique<openglyph::Scene>(asset_cache, game_object_types, environment);
 
         for (const auto& obj : map.objects) {
             if (const auto* type = game_object_types.get(obj.type_crc)) {
-                auto object = std::make_shared<khepri::scene::SceneObject>();
+                auto object = scene->create_object(
+                    type->is_in_background ? openglyph::RenderBehavior::RenderLayer::background
+                                           : openglyph::RenderBehavior::RenderLayer::foreground);
 
                 // Store a (dumb, non-owning) reference to the GameObjectType
-                object->user_data(type);
+                object.user_data(type);
 
-                if (const auto* render_model =
-                        asset_cache.get_render_model(type->space_model_name)) {
-                    auto& behavior =
-                        object->create_behavior<openglyph::RenderBehavior>(*render_model);
+                if (auto render_model = asset_cache.get_render_model(type->space_model_name)) {
+                    auto& behavior = object.create_behavior<openglyph::RenderBehavior>(
+                        std::move(render_model));
                     behavior.scale(type->scale_factor);
                     if (type->is_in_background) {
                         behavior.render_layer(openglyph::RenderBehavior::RenderLayer::background);
                     }
+                    object.bounds(openglyph::SceneRenderer::object_bounds(behavior));
                 }
 
                 if (type->is_marker) {
-                    object->create_behavior<openglyph::MarkerBehavior>();
+                    object.create_behavior<openglyph::MarkerBehavior>();
                 }
 
-                object->rotation(obj.facing);
-                object->position(obj.position);
-                scene->add_object(std::move(object));
+                object.rotation(obj.facing);
+                object.position(obj.position);
             }
         }
 
         // Find the first "player 0" marker to place the camera at.
         for (const auto& object : scene->objects<openglyph::MarkerBehavior>()) {
-            if (const auto** type_ptr = object->user_data<const openglyph::GameObjectType*>()) {
+            if (const auto* type_ptr = object.user_data<const openglyph::GameObjectType*>()) {
                 if (khepri::case_insensitive_equals((*type_ptr)->name,
                                                     "Player_0_Spawn_Point_Marker")) {
-                    camera.target({object->position().x, object->position().y});
+                    camera.target({object.position().x, object.position().y});
                     break;
                 }
             }
@@ -220,8 +282,15 @@ int main(int argc, const char* argv[])
         // Note: Empire at War was written for DX9 and does not natively support sRGB mode. Textures
         // are read & modified in linear space and (roughly) gamma-corrected in the shader. Thus,
         // the output format should be in linear space.
-        khepri::renderer::diligent::Renderer renderer(window.native_handle(),
-                                                      khepri::renderer::ColorSpace::linear);
+        //
+        // Meshes are stored in the compact vertex format to save video memory and bandwidth
+        khepri::renderer::diligent::Renderer renderer(
+            window.native_handle(), khepri::renderer::ColorSpace::linear, args->shader_cache_path,
+            khepri::renderer::VertexFormat::compact);
+        if (args->lazy_pipelines) {
+            renderer.pipeline_creation(
+                khepri::renderer::diligent::Renderer::PipelineCreation::lazy);
+        }
 
         khepri::renderer::Camera camera = create_camera(window.render_size());
         window.add_size_listener([&] {
@@ -231,7 +300,13 @@ int main(int argc, const char* argv[])
         });
         renderer.render_size(window.render_size());
 
-        openglyph::AssetCache                asset_cache(asset_loader, renderer);
+        std::optional<openglyph::TextureProcessingSettings> texture_processing;
+        if (args->process_textures) {
+            texture_processing = openglyph::TextureProcessingSettings{{}, args->texture_cache_path};
+        }
+
+        openglyph::AssetCache                asset_cache(asset_loader, renderer, 0,
+                                                         texture_processing);
         const openglyph::GameObjectTypeStore game_object_types(asset_loader, "GameObjectFiles.xml");
         const openglyph::TacticalCameraStore tactical_camera_store(asset_loader,
                                                                    "TacticalCameras.xml");
@@ -242,6 +317,8 @@ int main(int argc, const char* argv[])
             return khepri::game::RtsCameraController(camera, {0, 0});
         }();
 
+        asset_cache.memory_budget(ASSET_MEMORY_BUDGET);
+
         khepri::WindowInputEventGenerator       input_event_generator(window);
         openglyph::ui::TacticalModeInputHandler tactical_mode_input_handler(rts_camera, window);
         input_event_generator.AddEventHandler(&tactical_mode_input_handler);
@@ -276,6 +353,8 @@ int main(int argc, const char* argv[])
                 last_update_time = current_time;
             }
 
+            asset_cache.process_uploads(ASSET_UPLOAD_BUDGET);
+
             renderer.clear(khepri::renderer::Renderer::clear_all);
             if (scene) {
                 scene_renderer.render_scene(*scene, camera);